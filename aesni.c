@@ -0,0 +1,459 @@
+/**
+ * @file      aesni.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     x86 AES-NI engine, selected at runtime when CPUID reports the AES instructions.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_AESNI
+
+#include <cpuid.h>
+#include <wmmintrin.h>
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+/*
+ * The instructions are enabled per function, so this file builds with the
+ * default compiler flags and the rest of the library stays runnable on CPUs
+ * without AES-NI.
+ */
+#define AESNI_FN          __attribute__((target("aes,sse2")))
+#define CLMUL_FN          __attribute__((target("pclmul,ssse3,sse2")))
+
+#define CPUID_ECX_AES     ( 1U << 25 )
+#define CPUID_ECX_PCLMUL  ( 1U << 1 )
+#define CPUID_ECX_SSSE3   ( 1U << 9 )
+
+#define LOAD(p)           _mm_loadu_si128((const __m128i *)(const void *)(p))
+#define STORE(p, v)       _mm_storeu_si128((__m128i *)(void *)(p), (v))
+
+/* 0 = not probed yet, 1 = supported, -1 = unsupported. */
+static volatile int aesni_support = 0;
+static volatile int clmul_support = 0;
+
+static int aesni_available(void)
+{
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+  if(0 == aesni_support)
+  {
+    aesni_support = ( __get_cpuid(1, &eax, &ebx, &ecx, &edx) && ( ecx & CPUID_ECX_AES ) ) ? (1) : (-1);
+  }
+  return ( 1 == aesni_support ) ? (1) : (0);
+}
+
+/**
+ * @brief           Computes SubWord(RotWord(word)) ^ Rcon[step] with AESKEYGENASSIST.
+ * @param word      Previous key schedule word.
+ * @param step      Key expansion step (idx / Nk), 1 to 10.
+ * @return uint32_t Transformed word.
+ */
+AESNI_FN static uint32_t aesni_rot_sub_rcon(uint32_t word, size_t step)
+{
+  __m128i x = _mm_shuffle_epi32(_mm_cvtsi32_si128((int)word), 0x00);
+
+  /* The round constant is an immediate operand. */
+  switch(step)
+  {
+    case 1:  x = _mm_aeskeygenassist_si128(x, 0x01); break;
+    case 2:  x = _mm_aeskeygenassist_si128(x, 0x02); break;
+    case 3:  x = _mm_aeskeygenassist_si128(x, 0x04); break;
+    case 4:  x = _mm_aeskeygenassist_si128(x, 0x08); break;
+    case 5:  x = _mm_aeskeygenassist_si128(x, 0x10); break;
+    case 6:  x = _mm_aeskeygenassist_si128(x, 0x20); break;
+    case 7:  x = _mm_aeskeygenassist_si128(x, 0x40); break;
+    case 8:  x = _mm_aeskeygenassist_si128(x, 0x80); break;
+    case 9:  x = _mm_aeskeygenassist_si128(x, 0x1b); break;
+    default: x = _mm_aeskeygenassist_si128(x, 0x36); break;
+  }
+  /* dword 1 holds RotWord(SubWord(X1)) ^ Rcon. */
+  return (uint32_t)_mm_cvtsi128_si32(_mm_shuffle_epi32(x, 0x55));
+}
+
+/**
+ * @brief           Computes SubWord(word) with AESKEYGENASSIST.
+ * @param word      Previous key schedule word.
+ * @return uint32_t Substituted word.
+ */
+AESNI_FN static uint32_t aesni_sub(uint32_t word)
+{
+  __m128i x = _mm_shuffle_epi32(_mm_cvtsi32_si128((int)word), 0x00);
+
+  /* dword 0 holds SubWord(X1). */
+  x = _mm_aeskeygenassist_si128(x, 0x00);
+  return (uint32_t)_mm_cvtsi128_si32(x);
+}
+
+/**
+ * @brief       Expands the encryption schedule with AESKEYGENASSIST and, if requested,
+ *              derives the equivalent inverse cipher schedule with AESIMC.
+ * @param ctx   Pointer to key context, Nk, Nr and usage already set.
+ * @param key   Pointer to key buffer.
+ */
+AESNI_FN static void aesni_setkey(uaes_ctx_t *ctx, uint8_t *key)
+{
+  const size_t Nk = ctx->Nk, Nr = ctx->Nr, Ns = uAES_NB * (Nr + 1UL);
+  uint32_t *w = ctx->kschd;
+  uint32_t tmp = 0;
+
+  for(size_t idx = 0; idx < Nk; idx++)
+  {
+    w[idx] = ( uint32_t )( key[4*idx] | key[4*idx + 1] << 8 | key[4*idx + 2] << 16 | (uint32_t)key[4*idx + 3] << 24 );
+  }
+  for(size_t idx = Nk; idx < Ns; idx++)
+  {
+    tmp = w[idx - 1];
+    if( 0 == ( idx % Nk ) )
+    {
+      tmp = aesni_rot_sub_rcon(tmp, idx / Nk);
+    }
+    else if( ( Nk > 6 ) && ( 4 == ( idx % Nk ) ) )
+    {
+      tmp = aesni_sub(tmp);
+    }
+    w[idx] = w[idx - Nk] ^ tmp;
+  }
+
+  if(0 != (ctx->usage & uAES_CTX_DECRYPT))
+  {
+    STORE(&ctx->dkschd[0], LOAD(&w[4*Nr]));
+    for(size_t round = 1; round < Nr; round++)
+    {
+      STORE(&ctx->dkschd[4*round], _mm_aesimc_si128(LOAD(&w[4*(Nr - round)])));
+    }
+    STORE(&ctx->dkschd[4*Nr], LOAD(&w[0]));
+  }
+  return;
+}
+
+AESNI_FN static void aesni_encrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks)
+{
+  const size_t Nr = ctx->Nr;
+  __m128i rk[uAES_MAX_KSCHD_SIZE / 4];
+  __m128i b0, b1, b2, b3;
+  size_t round = 0;
+
+  for(round = 0; round <= Nr; round++)
+  {
+    rk[round] = LOAD(&ctx->kschd[4*round]);
+  }
+
+  /* Four independent blocks keep the AES unit pipeline busy. */
+  for(; nblocks >= 4; nblocks -= 4, in += 64, out += 64)
+  {
+    b0 = _mm_xor_si128(LOAD(in),      rk[0]);
+    b1 = _mm_xor_si128(LOAD(in + 16), rk[0]);
+    b2 = _mm_xor_si128(LOAD(in + 32), rk[0]);
+    b3 = _mm_xor_si128(LOAD(in + 48), rk[0]);
+    for(round = 1; round < Nr; round++)
+    {
+      b0 = _mm_aesenc_si128(b0, rk[round]);
+      b1 = _mm_aesenc_si128(b1, rk[round]);
+      b2 = _mm_aesenc_si128(b2, rk[round]);
+      b3 = _mm_aesenc_si128(b3, rk[round]);
+    }
+    STORE(out,      _mm_aesenclast_si128(b0, rk[Nr]));
+    STORE(out + 16, _mm_aesenclast_si128(b1, rk[Nr]));
+    STORE(out + 32, _mm_aesenclast_si128(b2, rk[Nr]));
+    STORE(out + 48, _mm_aesenclast_si128(b3, rk[Nr]));
+  }
+  for(; nblocks > 0; nblocks--, in += 16, out += 16)
+  {
+    b0 = _mm_xor_si128(LOAD(in), rk[0]);
+    for(round = 1; round < Nr; round++)
+    {
+      b0 = _mm_aesenc_si128(b0, rk[round]);
+    }
+    STORE(out, _mm_aesenclast_si128(b0, rk[Nr]));
+  }
+  return;
+}
+
+AESNI_FN static void aesni_decrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks)
+{
+  const size_t Nr = ctx->Nr;
+  __m128i rk[uAES_MAX_KSCHD_SIZE / 4];
+  __m128i b0, b1, b2, b3;
+  size_t round = 0;
+
+  for(round = 0; round <= Nr; round++)
+  {
+    rk[round] = LOAD(&ctx->dkschd[4*round]);
+  }
+
+  for(; nblocks >= 4; nblocks -= 4, in += 64, out += 64)
+  {
+    b0 = _mm_xor_si128(LOAD(in),      rk[0]);
+    b1 = _mm_xor_si128(LOAD(in + 16), rk[0]);
+    b2 = _mm_xor_si128(LOAD(in + 32), rk[0]);
+    b3 = _mm_xor_si128(LOAD(in + 48), rk[0]);
+    for(round = 1; round < Nr; round++)
+    {
+      b0 = _mm_aesdec_si128(b0, rk[round]);
+      b1 = _mm_aesdec_si128(b1, rk[round]);
+      b2 = _mm_aesdec_si128(b2, rk[round]);
+      b3 = _mm_aesdec_si128(b3, rk[round]);
+    }
+    STORE(out,      _mm_aesdeclast_si128(b0, rk[Nr]));
+    STORE(out + 16, _mm_aesdeclast_si128(b1, rk[Nr]));
+    STORE(out + 32, _mm_aesdeclast_si128(b2, rk[Nr]));
+    STORE(out + 48, _mm_aesdeclast_si128(b3, rk[Nr]));
+  }
+  for(; nblocks > 0; nblocks--, in += 16, out += 16)
+  {
+    b0 = _mm_xor_si128(LOAD(in), rk[0]);
+    for(round = 1; round < Nr; round++)
+    {
+      b0 = _mm_aesdec_si128(b0, rk[round]);
+    }
+    STORE(out, _mm_aesdeclast_si128(b0, rk[Nr]));
+  }
+  return;
+}
+
+AESNI_FN static void aesni_cbc_encrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *iv)
+{
+  const size_t Nr = ctx->Nr;
+  __m128i rk[uAES_MAX_KSCHD_SIZE / 4];
+  __m128i chain = LOAD(iv);
+  size_t round = 0;
+
+  for(round = 0; round <= Nr; round++)
+  {
+    rk[round] = LOAD(&ctx->kschd[4*round]);
+  }
+
+  for(; nblocks > 0; nblocks--, in += 16, out += 16)
+  {
+    chain = _mm_xor_si128(_mm_xor_si128(LOAD(in), chain), rk[0]);
+    for(round = 1; round < Nr; round++)
+    {
+      chain = _mm_aesenc_si128(chain, rk[round]);
+    }
+    chain = _mm_aesenclast_si128(chain, rk[Nr]);
+    STORE(out, chain);
+  }
+  STORE(iv, chain);
+  return;
+}
+
+/**
+ * @brief         CBC encrypts one block of each lane, each lane has its own key.
+ *                Lanes go four at a time, short groups repeat their last lane so the
+ *                four round pipelines stay full, the repeated lane stores the same value.
+ * @param ctx     Key context of each lane, all with the same Nr.
+ * @param blocks  Block of each lane, encrypted in place.
+ * @param iv      Chaining value of each lane, updated.
+ * @param nlanes  Number of lanes, 1 to uAES_MB_LANES.
+ */
+AESNI_FN static void aesni_cbc_encrypt_lanes(const uaes_ctx_t *const *ctx, uint8_t *const *blocks, uint8_t *const *iv, size_t nlanes)
+{
+  const size_t Nr = ctx[0]->Nr;
+  const uint32_t *k0, *k1, *k2, *k3;
+  __m128i b0, b1, b2, b3;
+  size_t l0, l1, l2, l3, round = 0;
+
+  for(l0 = 0; l0 < nlanes; l0 += 4)
+  {
+    l1 = ( (l0 + 1) < nlanes ) ? (l0 + 1) : (nlanes - 1);
+    l2 = ( (l0 + 2) < nlanes ) ? (l0 + 2) : (nlanes - 1);
+    l3 = ( (l0 + 3) < nlanes ) ? (l0 + 3) : (nlanes - 1);
+    k0 = ctx[l0]->kschd;
+    k1 = ctx[l1]->kschd;
+    k2 = ctx[l2]->kschd;
+    k3 = ctx[l3]->kschd;
+    b0 = _mm_xor_si128(_mm_xor_si128(LOAD(blocks[l0]), LOAD(iv[l0])), LOAD(k0));
+    b1 = _mm_xor_si128(_mm_xor_si128(LOAD(blocks[l1]), LOAD(iv[l1])), LOAD(k1));
+    b2 = _mm_xor_si128(_mm_xor_si128(LOAD(blocks[l2]), LOAD(iv[l2])), LOAD(k2));
+    b3 = _mm_xor_si128(_mm_xor_si128(LOAD(blocks[l3]), LOAD(iv[l3])), LOAD(k3));
+    for(round = 1; round < Nr; round++)
+    {
+      b0 = _mm_aesenc_si128(b0, LOAD(&k0[4*round]));
+      b1 = _mm_aesenc_si128(b1, LOAD(&k1[4*round]));
+      b2 = _mm_aesenc_si128(b2, LOAD(&k2[4*round]));
+      b3 = _mm_aesenc_si128(b3, LOAD(&k3[4*round]));
+    }
+    b0 = _mm_aesenclast_si128(b0, LOAD(&k0[4*Nr]));
+    b1 = _mm_aesenclast_si128(b1, LOAD(&k1[4*Nr]));
+    b2 = _mm_aesenclast_si128(b2, LOAD(&k2[4*Nr]));
+    b3 = _mm_aesenclast_si128(b3, LOAD(&k3[4*Nr]));
+    STORE(blocks[l0], b0);
+    STORE(blocks[l1], b1);
+    STORE(blocks[l2], b2);
+    STORE(blocks[l3], b3);
+    STORE(iv[l0], b0);
+    STORE(iv[l1], b1);
+    STORE(iv[l2], b2);
+    STORE(iv[l3], b3);
+  }
+  return;
+}
+
+AESNI_FN static void aesni_cbc_decrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *iv)
+{
+  const size_t Nr = ctx->Nr;
+  __m128i rk[uAES_MAX_KSCHD_SIZE / 4];
+  __m128i chain = LOAD(iv);
+  __m128i c0, c1, c2, c3, b0, b1, b2, b3;
+  size_t round = 0;
+
+  for(round = 0; round <= Nr; round++)
+  {
+    rk[round] = LOAD(&ctx->dkschd[4*round]);
+  }
+
+  /* Ciphertexts are loaded before any store, so in-place buffers are safe. */
+  for(; nblocks >= 4; nblocks -= 4, in += 64, out += 64)
+  {
+    c0 = LOAD(in);
+    c1 = LOAD(in + 16);
+    c2 = LOAD(in + 32);
+    c3 = LOAD(in + 48);
+    b0 = _mm_xor_si128(c0, rk[0]);
+    b1 = _mm_xor_si128(c1, rk[0]);
+    b2 = _mm_xor_si128(c2, rk[0]);
+    b3 = _mm_xor_si128(c3, rk[0]);
+    for(round = 1; round < Nr; round++)
+    {
+      b0 = _mm_aesdec_si128(b0, rk[round]);
+      b1 = _mm_aesdec_si128(b1, rk[round]);
+      b2 = _mm_aesdec_si128(b2, rk[round]);
+      b3 = _mm_aesdec_si128(b3, rk[round]);
+    }
+    STORE(out,      _mm_xor_si128(_mm_aesdeclast_si128(b0, rk[Nr]), chain));
+    STORE(out + 16, _mm_xor_si128(_mm_aesdeclast_si128(b1, rk[Nr]), c0));
+    STORE(out + 32, _mm_xor_si128(_mm_aesdeclast_si128(b2, rk[Nr]), c1));
+    STORE(out + 48, _mm_xor_si128(_mm_aesdeclast_si128(b3, rk[Nr]), c2));
+    chain = c3;
+  }
+  for(; nblocks > 0; nblocks--, in += 16, out += 16)
+  {
+    c0 = LOAD(in);
+    b0 = _mm_xor_si128(c0, rk[0]);
+    for(round = 1; round < Nr; round++)
+    {
+      b0 = _mm_aesdec_si128(b0, rk[round]);
+    }
+    STORE(out, _mm_xor_si128(_mm_aesdeclast_si128(b0, rk[Nr]), chain));
+    chain = c0;
+  }
+  STORE(iv, chain);
+  return;
+}
+
+/**
+ * @brief       Tells whether the CPU has PCLMULQDQ and PSHUFB for uaes_ghash_clmul().
+ * @return int  [1] if supported, [0] otherwise.
+ */
+int uaes_ghash_clmul_available(void)
+{
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+  if(0 == clmul_support)
+  {
+    clmul_support = ( __get_cpuid(1, &eax, &ebx, &ecx, &edx) &&
+                      ( CPUID_ECX_PCLMUL == ( ecx & CPUID_ECX_PCLMUL ) ) &&
+                      ( CPUID_ECX_SSSE3 == ( ecx & CPUID_ECX_SSSE3 ) ) ) ? (1) : (-1);
+  }
+  return ( 1 == clmul_support ) ? (1) : (0);
+}
+
+/**
+ * @brief           Multiplies two byte-reflected GF(2^128) elements, GCM bit order
+ *                  (Intel carry-less multiplication white paper, algorithm 5).
+ * @param a         First factor, bytes reversed.
+ * @param b         Second factor, bytes reversed.
+ * @return __m128i  Product, bytes reversed.
+ */
+CLMUL_FN static __m128i clmul_gfmul(__m128i a, __m128i b)
+{
+  __m128i lo, mid, hi, t0, t1, t2;
+
+  /* 256-bit carry-less product hi:lo. */
+  lo  = _mm_clmulepi64_si128(a, b, 0x00);
+  mid = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+  hi  = _mm_clmulepi64_si128(a, b, 0x11);
+  lo  = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+  hi  = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+  /* GCM reflects the bits, shift the product left by one. */
+  t0 = _mm_srli_epi32(lo, 31);
+  t1 = _mm_srli_epi32(hi, 31);
+  lo = _mm_slli_epi32(lo, 1);
+  hi = _mm_slli_epi32(hi, 1);
+  t2 = _mm_srli_si128(t0, 12);
+  t1 = _mm_slli_si128(t1, 4);
+  t0 = _mm_slli_si128(t0, 4);
+  lo = _mm_or_si128(lo, t0);
+  hi = _mm_or_si128(_mm_or_si128(hi, t1), t2);
+
+  /* Reduce modulo x^128 + x^7 + x^2 + x + 1. */
+  t0 = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+  t1 = _mm_srli_si128(t0, 4);
+  lo = _mm_xor_si128(lo, _mm_slli_si128(t0, 12));
+  t2 = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+  lo = _mm_xor_si128(lo, _mm_xor_si128(t2, t1));
+  return _mm_xor_si128(hi, lo);
+}
+
+/**
+ * @brief           GHASH with PCLMULQDQ, Y = (Y ^ X[i]) * H for every block X[i].
+ * @param y         16-byte hash state, updated in place.
+ * @param h         16-byte hash subkey.
+ * @param in        Pointer to input blocks.
+ * @param nblocks   Number of 16-byte blocks.
+ */
+CLMUL_FN void uaes_ghash_clmul(uint8_t *y, const uint8_t *h, const uint8_t *in, size_t nblocks)
+{
+  const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  const __m128i hv = _mm_shuffle_epi8(LOAD(h), bswap);
+  __m128i acc = _mm_shuffle_epi8(LOAD(y), bswap);
+
+  for(; nblocks > 0; nblocks--, in += 16)
+  {
+    acc = clmul_gfmul(_mm_xor_si128(acc, _mm_shuffle_epi8(LOAD(in), bswap)), hv);
+  }
+  STORE(y, _mm_shuffle_epi8(acc, bswap));
+  return;
+}
+
+const uaes_engine_t uaes_engine_aesni =
+{
+  .name         = "aesni",
+  .id           = uAES_ENGINE_AESNI,
+  .available    = aesni_available,
+  .setkey       = aesni_setkey,
+  .encrypt      = aesni_encrypt,
+  .decrypt      = aesni_decrypt,
+  .cbc_encrypt  = aesni_cbc_encrypt,
+  .cbc_decrypt  = aesni_cbc_decrypt,
+  .cbc_encrypt_lanes = aesni_cbc_encrypt_lanes,
+  .caps         = uAES_CAPS_SOFTWARE(uAES_CAP_CONST_TIME),
+};
+
+#endif /*uAES_CFG_AESNI*/
@@ -0,0 +1,439 @@
+/**
+ * @file      armce.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     ARMv8 Crypto Extensions engine (AESE/AESD/AESMC/AESIMC), AArch64 and AArch32.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_ARMCE
+
+#include <arm_neon.h>
+
+#if defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES)
+/* Built with -march=armv8-a+crypto (or -mfpu=crypto-neon-fp-armv8), always usable. */
+#define ARMCE_FN
+#define ARMCE_RUNTIME     0
+#else
+/*
+ * The instructions are enabled per function and the engine is only selected
+ * if the kernel reports them, the rest of the library stays runnable on cores
+ * without the extension.
+ */
+#include <sys/auxv.h>
+#define ARMCE_RUNTIME     1
+#if defined(__aarch64__)
+#define ARMCE_FN          __attribute__((target("+crypto")))
+#define ARMCE_AT_HWCAP    AT_HWCAP
+#define ARMCE_HWCAP_AES   ( 1UL << 3 )    // HWCAP_AES
+#define ARMCE_HWCAP_PMULL ( 1UL << 4 )    // HWCAP_PMULL
+#else
+#define ARMCE_FN          __attribute__((target("fpu=crypto-neon-fp-armv8")))
+#define ARMCE_AT_HWCAP    AT_HWCAP2
+#define ARMCE_HWCAP_AES   ( 1UL << 0 )    // HWCAP2_AES
+#define ARMCE_HWCAP_PMULL ( 1UL << 1 )    // HWCAP2_PMULL
+#endif
+#endif /*__ARM_FEATURE_CRYPTO*/
+
+#define LOAD(p)           vld1q_u8((const uint8_t *)(const void *)(p))
+#define STORE(p, v)       vst1q_u8((uint8_t *)(void *)(p), (v))
+
+/* AESE/AESD add the round key first, so one full round is AESE + AESMC with the previous key. */
+#define ENC_ROUND(b, k)   vaesmcq_u8(vaeseq_u8((b), (k)))
+#define DEC_ROUND(b, k)   vaesimcq_u8(vaesdq_u8((b), (k)))
+
+#if ARMCE_RUNTIME
+/* 0 = not probed yet, 1 = supported, -1 = unsupported. */
+static volatile int armce_support = 0;
+#if uAES_GHASH_PMULL
+static volatile int pmull_support = 0;
+#endif /*uAES_GHASH_PMULL*/
+#endif /*ARMCE_RUNTIME*/
+
+static int armce_available(void)
+{
+#if ARMCE_RUNTIME
+  if(0 == armce_support)
+  {
+    armce_support = ( 0UL != ( getauxval(ARMCE_AT_HWCAP) & ARMCE_HWCAP_AES ) ) ? (1) : (-1);
+  }
+  return ( 1 == armce_support ) ? (1) : (0);
+#else
+  return 1;
+#endif /*ARMCE_RUNTIME*/
+}
+
+/**
+ * @brief           Computes SubWord(word) with AESE.
+ *                  With all four columns equal ShiftRows has no effect, and a zero
+ *                  round key leaves SubBytes alone.
+ * @param word      Key schedule word.
+ * @return uint32_t Substituted word.
+ */
+ARMCE_FN static uint32_t armce_sub(uint32_t word)
+{
+  uint8x16_t x = vreinterpretq_u8_u32(vdupq_n_u32(word));
+
+  x = vaeseq_u8(x, vdupq_n_u8(0));
+  return vgetq_lane_u32(vreinterpretq_u32_u8(x), 0);
+}
+
+/**
+ * @brief       Expands the encryption schedule with AESE and, if requested,
+ *              derives the equivalent inverse cipher schedule with AESIMC.
+ * @param ctx   Pointer to key context, Nk, Nr and usage already set.
+ * @param key   Pointer to key buffer.
+ */
+ARMCE_FN static void armce_setkey(uaes_ctx_t *ctx, uint8_t *key)
+{
+  static const uint8_t rcon[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+  const size_t Nk = ctx->Nk, Nr = ctx->Nr, Ns = uAES_NB * (Nr + 1UL);
+  uint32_t *w = ctx->kschd;
+  uint32_t tmp = 0;
+
+  for(size_t idx = 0; idx < Nk; idx++)
+  {
+    w[idx] = ( uint32_t )( key[4*idx] | key[4*idx + 1] << 8 | key[4*idx + 2] << 16 | (uint32_t)key[4*idx + 3] << 24 );
+  }
+  for(size_t idx = Nk; idx < Ns; idx++)
+  {
+    tmp = w[idx - 1];
+    if( 0 == ( idx % Nk ) )
+    {
+      /* RotWord moves byte 0 to byte 3, it commutes with SubWord. */
+      tmp = armce_sub( ( tmp >> 8 ) | ( tmp << 24 ) ) ^ rcon[( idx / Nk ) - 1];
+    }
+    else if( ( Nk > 6 ) && ( 4 == ( idx % Nk ) ) )
+    {
+      tmp = armce_sub(tmp);
+    }
+    w[idx] = w[idx - Nk] ^ tmp;
+  }
+
+  if(0 != (ctx->usage & uAES_CTX_DECRYPT))
+  {
+    STORE(&ctx->dkschd[0], LOAD(&w[4*Nr]));
+    for(size_t round = 1; round < Nr; round++)
+    {
+      STORE(&ctx->dkschd[4*round], vaesimcq_u8(LOAD(&w[4*(Nr - round)])));
+    }
+    STORE(&ctx->dkschd[4*Nr], LOAD(&w[0]));
+  }
+  return;
+}
+
+ARMCE_FN static void armce_encrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks)
+{
+  const size_t Nr = ctx->Nr;
+  uint8x16_t rk[uAES_MAX_KSCHD_SIZE / 4];
+  uint8x16_t b0, b1, b2, b3;
+  size_t round = 0;
+
+  for(round = 0; round <= Nr; round++)
+  {
+    rk[round] = LOAD(&ctx->kschd[4*round]);
+  }
+
+  /* Four independent blocks hide the AESE/AESMC latency on in-order cores. */
+  for(; nblocks >= 4; nblocks -= 4, in += 64, out += 64)
+  {
+    b0 = LOAD(in);
+    b1 = LOAD(in + 16);
+    b2 = LOAD(in + 32);
+    b3 = LOAD(in + 48);
+    for(round = 0; round < (Nr - 1); round++)
+    {
+      b0 = ENC_ROUND(b0, rk[round]);
+      b1 = ENC_ROUND(b1, rk[round]);
+      b2 = ENC_ROUND(b2, rk[round]);
+      b3 = ENC_ROUND(b3, rk[round]);
+    }
+    STORE(out,      veorq_u8(vaeseq_u8(b0, rk[Nr - 1]), rk[Nr]));
+    STORE(out + 16, veorq_u8(vaeseq_u8(b1, rk[Nr - 1]), rk[Nr]));
+    STORE(out + 32, veorq_u8(vaeseq_u8(b2, rk[Nr - 1]), rk[Nr]));
+    STORE(out + 48, veorq_u8(vaeseq_u8(b3, rk[Nr - 1]), rk[Nr]));
+  }
+  for(; nblocks > 0; nblocks--, in += 16, out += 16)
+  {
+    b0 = LOAD(in);
+    for(round = 0; round < (Nr - 1); round++)
+    {
+      b0 = ENC_ROUND(b0, rk[round]);
+    }
+    STORE(out, veorq_u8(vaeseq_u8(b0, rk[Nr - 1]), rk[Nr]));
+  }
+  return;
+}
+
+ARMCE_FN static void armce_decrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks)
+{
+  const size_t Nr = ctx->Nr;
+  uint8x16_t rk[uAES_MAX_KSCHD_SIZE / 4];
+  uint8x16_t b0, b1, b2, b3;
+  size_t round = 0;
+
+  for(round = 0; round <= Nr; round++)
+  {
+    rk[round] = LOAD(&ctx->dkschd[4*round]);
+  }
+
+  for(; nblocks >= 4; nblocks -= 4, in += 64, out += 64)
+  {
+    b0 = LOAD(in);
+    b1 = LOAD(in + 16);
+    b2 = LOAD(in + 32);
+    b3 = LOAD(in + 48);
+    for(round = 0; round < (Nr - 1); round++)
+    {
+      b0 = DEC_ROUND(b0, rk[round]);
+      b1 = DEC_ROUND(b1, rk[round]);
+      b2 = DEC_ROUND(b2, rk[round]);
+      b3 = DEC_ROUND(b3, rk[round]);
+    }
+    STORE(out,      veorq_u8(vaesdq_u8(b0, rk[Nr - 1]), rk[Nr]));
+    STORE(out + 16, veorq_u8(vaesdq_u8(b1, rk[Nr - 1]), rk[Nr]));
+    STORE(out + 32, veorq_u8(vaesdq_u8(b2, rk[Nr - 1]), rk[Nr]));
+    STORE(out + 48, veorq_u8(vaesdq_u8(b3, rk[Nr - 1]), rk[Nr]));
+  }
+  for(; nblocks > 0; nblocks--, in += 16, out += 16)
+  {
+    b0 = LOAD(in);
+    for(round = 0; round < (Nr - 1); round++)
+    {
+      b0 = DEC_ROUND(b0, rk[round]);
+    }
+    STORE(out, veorq_u8(vaesdq_u8(b0, rk[Nr - 1]), rk[Nr]));
+  }
+  return;
+}
+
+ARMCE_FN static void armce_cbc_encrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *iv)
+{
+  const size_t Nr = ctx->Nr;
+  uint8x16_t rk[uAES_MAX_KSCHD_SIZE / 4];
+  uint8x16_t chain = LOAD(iv);
+  size_t round = 0;
+
+  for(round = 0; round <= Nr; round++)
+  {
+    rk[round] = LOAD(&ctx->kschd[4*round]);
+  }
+
+  for(; nblocks > 0; nblocks--, in += 16, out += 16)
+  {
+    chain = veorq_u8(LOAD(in), chain);
+    for(round = 0; round < (Nr - 1); round++)
+    {
+      chain = ENC_ROUND(chain, rk[round]);
+    }
+    chain = veorq_u8(vaeseq_u8(chain, rk[Nr - 1]), rk[Nr]);
+    STORE(out, chain);
+  }
+  STORE(iv, chain);
+  return;
+}
+
+/**
+ * @brief         CBC encrypts one block of each lane, each lane has its own key.
+ *                Lanes go four at a time, short groups repeat their last lane so the
+ *                four round pipelines stay full, the repeated lane stores the same value.
+ * @param ctx     Key context of each lane, all with the same Nr.
+ * @param blocks  Block of each lane, encrypted in place.
+ * @param iv      Chaining value of each lane, updated.
+ * @param nlanes  Number of lanes, 1 to uAES_MB_LANES.
+ */
+ARMCE_FN static void armce_cbc_encrypt_lanes(const uaes_ctx_t *const *ctx, uint8_t *const *blocks, uint8_t *const *iv, size_t nlanes)
+{
+  const size_t Nr = ctx[0]->Nr;
+  const uint32_t *k0, *k1, *k2, *k3;
+  uint8x16_t b0, b1, b2, b3;
+  size_t l0, l1, l2, l3, round = 0;
+
+  for(l0 = 0; l0 < nlanes; l0 += 4)
+  {
+    l1 = ( (l0 + 1) < nlanes ) ? (l0 + 1) : (nlanes - 1);
+    l2 = ( (l0 + 2) < nlanes ) ? (l0 + 2) : (nlanes - 1);
+    l3 = ( (l0 + 3) < nlanes ) ? (l0 + 3) : (nlanes - 1);
+    k0 = ctx[l0]->kschd;
+    k1 = ctx[l1]->kschd;
+    k2 = ctx[l2]->kschd;
+    k3 = ctx[l3]->kschd;
+    b0 = veorq_u8(LOAD(blocks[l0]), LOAD(iv[l0]));
+    b1 = veorq_u8(LOAD(blocks[l1]), LOAD(iv[l1]));
+    b2 = veorq_u8(LOAD(blocks[l2]), LOAD(iv[l2]));
+    b3 = veorq_u8(LOAD(blocks[l3]), LOAD(iv[l3]));
+    for(round = 0; round < (Nr - 1); round++)
+    {
+      b0 = ENC_ROUND(b0, LOAD(&k0[4*round]));
+      b1 = ENC_ROUND(b1, LOAD(&k1[4*round]));
+      b2 = ENC_ROUND(b2, LOAD(&k2[4*round]));
+      b3 = ENC_ROUND(b3, LOAD(&k3[4*round]));
+    }
+    b0 = veorq_u8(vaeseq_u8(b0, LOAD(&k0[4*(Nr - 1)])), LOAD(&k0[4*Nr]));
+    b1 = veorq_u8(vaeseq_u8(b1, LOAD(&k1[4*(Nr - 1)])), LOAD(&k1[4*Nr]));
+    b2 = veorq_u8(vaeseq_u8(b2, LOAD(&k2[4*(Nr - 1)])), LOAD(&k2[4*Nr]));
+    b3 = veorq_u8(vaeseq_u8(b3, LOAD(&k3[4*(Nr - 1)])), LOAD(&k3[4*Nr]));
+    STORE(blocks[l0], b0);
+    STORE(blocks[l1], b1);
+    STORE(blocks[l2], b2);
+    STORE(blocks[l3], b3);
+    STORE(iv[l0], b0);
+    STORE(iv[l1], b1);
+    STORE(iv[l2], b2);
+    STORE(iv[l3], b3);
+  }
+  return;
+}
+
+ARMCE_FN static void armce_cbc_decrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *iv)
+{
+  const size_t Nr = ctx->Nr;
+  uint8x16_t rk[uAES_MAX_KSCHD_SIZE / 4];
+  uint8x16_t chain = LOAD(iv);
+  uint8x16_t c0, c1, c2, c3, b0, b1, b2, b3;
+  size_t round = 0;
+
+  for(round = 0; round <= Nr; round++)
+  {
+    rk[round] = LOAD(&ctx->dkschd[4*round]);
+  }
+
+  /* Ciphertexts are loaded before any store, so in-place buffers are safe. */
+  for(; nblocks >= 4; nblocks -= 4, in += 64, out += 64)
+  {
+    c0 = b0 = LOAD(in);
+    c1 = b1 = LOAD(in + 16);
+    c2 = b2 = LOAD(in + 32);
+    c3 = b3 = LOAD(in + 48);
+    for(round = 0; round < (Nr - 1); round++)
+    {
+      b0 = DEC_ROUND(b0, rk[round]);
+      b1 = DEC_ROUND(b1, rk[round]);
+      b2 = DEC_ROUND(b2, rk[round]);
+      b3 = DEC_ROUND(b3, rk[round]);
+    }
+    STORE(out,      veorq_u8(veorq_u8(vaesdq_u8(b0, rk[Nr - 1]), rk[Nr]), chain));
+    STORE(out + 16, veorq_u8(veorq_u8(vaesdq_u8(b1, rk[Nr - 1]), rk[Nr]), c0));
+    STORE(out + 32, veorq_u8(veorq_u8(vaesdq_u8(b2, rk[Nr - 1]), rk[Nr]), c1));
+    STORE(out + 48, veorq_u8(veorq_u8(vaesdq_u8(b3, rk[Nr - 1]), rk[Nr]), c2));
+    chain = c3;
+  }
+  for(; nblocks > 0; nblocks--, in += 16, out += 16)
+  {
+    c0 = b0 = LOAD(in);
+    for(round = 0; round < (Nr - 1); round++)
+    {
+      b0 = DEC_ROUND(b0, rk[round]);
+    }
+    STORE(out, veorq_u8(veorq_u8(vaesdq_u8(b0, rk[Nr - 1]), rk[Nr]), chain));
+    chain = c0;
+  }
+  STORE(iv, chain);
+  return;
+}
+
+#if uAES_GHASH_PMULL
+
+/**
+ * @brief       Tells whether the core has the 64-bit PMULL instruction for uaes_ghash_pmull().
+ * @return int  [1] if supported, [0] otherwise.
+ */
+int uaes_ghash_pmull_available(void)
+{
+#if ARMCE_RUNTIME
+  if(0 == pmull_support)
+  {
+    pmull_support = ( 0UL != ( getauxval(ARMCE_AT_HWCAP) & ARMCE_HWCAP_PMULL ) ) ? (1) : (-1);
+  }
+  return ( 1 == pmull_support ) ? (1) : (0);
+#else
+  return 1;
+#endif /*ARMCE_RUNTIME*/
+}
+
+#define PMULL(a, b)       vreinterpretq_u64_p128(vmull_p64((poly64_t)(a), (poly64_t)(b)))
+
+/**
+ * @brief           GHASH with PMULL, Y = (Y ^ X[i]) * H for every block X[i].
+ *                  Reversing the bits of every byte turns GCM's reflected order into
+ *                  plain polynomials (bit K of the little-endian value is x^K), so the
+ *                  product reduces modulo x^128 + x^7 + x^2 + x + 1 with two folds.
+ * @param y         16-byte hash state, updated in place.
+ * @param h         16-byte hash subkey.
+ * @param in        Pointer to input blocks.
+ * @param nblocks   Number of 16-byte blocks.
+ */
+ARMCE_FN void uaes_ghash_pmull(uint8_t *y, const uint8_t *h, const uint8_t *in, size_t nblocks)
+{
+  const uint64x2_t hv = vreinterpretq_u64_u8(vrbitq_u8(LOAD(h)));
+  const uint64_t h0 = vgetq_lane_u64(hv, 0), h1 = vgetq_lane_u64(hv, 1);
+  uint64x2_t x, lo, mid, hi, fold;
+  uint64_t p0 = 0, p1 = 0, p2 = 0, p3 = 0, x0 = 0, x1 = 0;
+
+  x = vreinterpretq_u64_u8(vrbitq_u8(LOAD(y)));
+  for(; nblocks > 0; nblocks--, in += 16)
+  {
+    x  = veorq_u64(x, vreinterpretq_u64_u8(vrbitq_u8(LOAD(in))));
+    x0 = vgetq_lane_u64(x, 0);
+    x1 = vgetq_lane_u64(x, 1);
+    lo  = PMULL(x0, h0);
+    hi  = PMULL(x1, h1);
+    mid = veorq_u64(PMULL(x0, h1), PMULL(x1, h0));
+    p0 = vgetq_lane_u64(lo, 0);
+    p1 = vgetq_lane_u64(lo, 1) ^ vgetq_lane_u64(mid, 0);
+    p2 = vgetq_lane_u64(hi, 0) ^ vgetq_lane_u64(mid, 1);
+    p3 = vgetq_lane_u64(hi, 1);
+
+    /* x^128 = x^7 + x^2 + x + 1: fold p3 into p2:p1, then p2 into p1:p0. */
+    fold = PMULL(p3, 0x87);
+    p1 ^= vgetq_lane_u64(fold, 0);
+    p2 ^= vgetq_lane_u64(fold, 1);
+    fold = PMULL(p2, 0x87);
+    p0 ^= vgetq_lane_u64(fold, 0);
+    p1 ^= vgetq_lane_u64(fold, 1);
+    x = vcombine_u64(vcreate_u64(p0), vcreate_u64(p1));
+  }
+  STORE(y, vrbitq_u8(vreinterpretq_u8_u64(x)));
+  return;
+}
+
+#endif /*uAES_GHASH_PMULL*/
+
+const uaes_engine_t uaes_engine_armce =
+{
+  .name         = "armce",
+  .id           = uAES_ENGINE_ARMCE,
+  .available    = armce_available,
+  .setkey       = armce_setkey,
+  .encrypt      = armce_encrypt,
+  .decrypt      = armce_decrypt,
+  .cbc_encrypt  = armce_cbc_encrypt,
+  .cbc_decrypt  = armce_cbc_decrypt,
+  .cbc_encrypt_lanes = armce_cbc_encrypt_lanes,
+  .caps         = uAES_CAPS_SOFTWARE(uAES_CAP_CONST_TIME),
+};
+
+#endif /*uAES_CFG_ARMCE*/
@@ -0,0 +1,588 @@
+/**
+ * @file      bitslice.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     Bitsliced constant-time engine, runs eight blocks at once on 64-bit bit planes.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_BITSLICE
+
+/*
+ * State layout: BS_LANES blocks are held in 16 words. Word q[8*H + J] is bit
+ * plane J of state rows 2H and 2H + 1, every row takes 32 bits (row R, column C
+ * in byte 8*((R % 2)*4 + C)) and bit K of each byte belongs to block K.
+ * ShiftRows becomes a rotation inside each row and MixColumns a rotation of
+ * rows, neither the data nor the key select a memory address or a branch.
+ */
+#define BS_LANES          8
+
+#define LO32              ( 0x00000000ffffffffULL )
+#define HI32              ( 0xffffffff00000000ULL )
+
+/* Rotates both 32-bit rows of a word right by n bits. */
+#define ROW_MASK(n)       ( ( 0xffffffffULL >> (n) ) * 0x0000000100000001ULL )
+#define ROW_ROTR(x, n)    ( ( ( (x) >> (n) ) & ROW_MASK(n) ) | ( ( (x) << ( 32 - (n) ) ) & ~ROW_MASK(n) ) )
+
+/* Constant-time xtime on the four bytes of a key schedule word. */
+#define XTIME_WORD(w)     ( ( ( (w) & 0x7f7f7f7fUL ) << 1 ) ^ ( ( ( (w) >> 7 ) & 0x01010101UL ) * 0x1bUL ) )
+#define ROTR_WORD(w, n)   ( ( (w) >> (n) ) | ( (w) << ( 32 - (n) ) ) )
+
+/**
+ * @brief     Transposes an 8x8 bit matrix, bit J of byte K swaps with bit K of byte J.
+ * @param x   Matrix, byte K is row K.
+ * @return uint64_t Transposed matrix.
+ */
+static uint64_t bs_transpose8(uint64_t x)
+{
+  uint64_t t = 0;
+
+  t = ( x ^ ( x >> 7 ) )  & 0x00aa00aa00aa00aaULL; x ^= t ^ ( t << 7 );
+  t = ( x ^ ( x >> 14 ) ) & 0x0000cccc0000ccccULL; x ^= t ^ ( t << 14 );
+  t = ( x ^ ( x >> 28 ) ) & 0x00000000f0f0f0f0ULL; x ^= t ^ ( t << 28 );
+  return x;
+}
+
+/* Bit offset of state byte idx (column idx / 4, row idx % 4) inside its word. */
+#define BYTE_SHIFT(idx)   ( 8U * ( ( ( (idx) & 1U ) << 2 ) | ( (idx) >> 2 ) ) )
+#define BYTE_WORD(idx)    ( ( (idx) >> 1 ) & 1U )
+
+/**
+ * @brief         Converts up to BS_LANES blocks into bit planes, missing lanes are zero.
+ * @param q       Pointer to the 16 state words.
+ * @param in      Pointer to nblocks consecutive blocks.
+ * @param nblocks Number of blocks, 1 to BS_LANES.
+ */
+static void bs_load(uint64_t *q, const uint8_t *in, size_t nblocks)
+{
+  uint64_t x = 0;
+
+  for(size_t idx = 0; idx < 16; idx++)
+  {
+    q[idx] = 0;
+  }
+  for(size_t idx = 0; idx < 16; idx++)
+  {
+    x = 0;
+    for(size_t lane = 0; lane < nblocks; lane++)
+    {
+      x |= (uint64_t)in[16*lane + idx] << ( 8*lane );
+    }
+    x = bs_transpose8(x);
+    for(size_t bit = 0; bit < 8; bit++)
+    {
+      q[8*BYTE_WORD(idx) + bit] |= ( ( x >> ( 8*bit ) ) & 0xffULL ) << BYTE_SHIFT(idx);
+    }
+  }
+  return;
+}
+
+/**
+ * @brief         Converts bit planes back into blocks.
+ * @param out     Pointer to nblocks consecutive blocks.
+ * @param q       Pointer to the 16 state words.
+ * @param nblocks Number of blocks to write, 1 to BS_LANES.
+ */
+static void bs_store(uint8_t *out, const uint64_t *q, size_t nblocks)
+{
+  uint64_t x = 0;
+
+  for(size_t idx = 0; idx < 16; idx++)
+  {
+    x = 0;
+    for(size_t bit = 0; bit < 8; bit++)
+    {
+      x |= ( ( q[8*BYTE_WORD(idx) + bit] >> BYTE_SHIFT(idx) ) & 0xffULL ) << ( 8*bit );
+    }
+    x = bs_transpose8(x);
+    for(size_t lane = 0; lane < nblocks; lane++)
+    {
+      out[16*lane + idx] = (uint8_t)( x >> ( 8*lane ) );
+    }
+  }
+  return;
+}
+
+/**
+ * @brief       Broadcasts round keys to all lanes of the bit plane layout.
+ * @param rk    Pointer to 16 * (Nr + 1) words.
+ * @param w     Pointer to the key schedule.
+ * @param Nr    Number of rounds.
+ */
+static void bs_load_keys(uint64_t *rk, const uint32_t *w, size_t Nr)
+{
+  uint64_t kb = 0;
+
+  for(size_t round = 0; round <= Nr; round++, rk += 16, w += 4)
+  {
+    for(size_t idx = 0; idx < 16; idx++)
+    {
+      rk[idx] = 0;
+    }
+    for(size_t idx = 0; idx < 16; idx++)
+    {
+      kb = ( w[idx / 4] >> ( 8*(idx % 4) ) ) & 0xffUL;
+      for(size_t bit = 0; bit < 8; bit++)
+      {
+        rk[8*BYTE_WORD(idx) + bit] |= ( 0xffULL & ( 0ULL - ( ( kb >> bit ) & 1ULL ) ) ) << BYTE_SHIFT(idx);
+      }
+    }
+  }
+  return;
+}
+
+static void bs_add_round_key(uint64_t *q, const uint64_t *rk)
+{
+  for(size_t idx = 0; idx < 16; idx++)
+  {
+    q[idx] ^= rk[idx];
+  }
+  return;
+}
+
+/**
+ * @brief     S-box on eight bit planes, Boyar-Peralta circuit (113 gates).
+ * @param q   Pointer to bit planes 0 (least significant) to 7.
+ */
+static void bs_sbox(uint64_t *q)
+{
+  uint64_t x0, x1, x2, x3, x4, x5, x6, x7;
+  uint64_t y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11, y12, y13, y14, y15, y16, y17, y18, y19, y20, y21;
+  uint64_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9, z10, z11, z12, z13, z14, z15, z16, z17;
+  uint64_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+  uint64_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29, t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+  uint64_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+  uint64_t t60, t61, t62, t63, t64, t65, t66, t67;
+  uint64_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+  x0 = q[7]; x1 = q[6]; x2 = q[5]; x3 = q[4];
+  x4 = q[3]; x5 = q[2]; x6 = q[1]; x7 = q[0];
+
+  /* Top linear transformation. */
+  y14 = x3 ^ x5;  y13 = x0 ^ x6;  y9 = x0 ^ x3;   y8 = x0 ^ x5;
+  t0 = x1 ^ x2;   y1 = t0 ^ x7;   y4 = y1 ^ x3;   y12 = y13 ^ y14;
+  y2 = y1 ^ x0;   y5 = y1 ^ x6;   y3 = y5 ^ y8;   t1 = x4 ^ y12;
+  y15 = t1 ^ x5;  y20 = t1 ^ x1;  y6 = y15 ^ x7;  y10 = y15 ^ t0;
+  y11 = y20 ^ y9; y7 = x7 ^ y11;  y17 = y10 ^ y11; y19 = y10 ^ y8;
+  y16 = t0 ^ y11; y21 = y13 ^ y16; y18 = x0 ^ y16;
+
+  /* Shared non-linear core, GF(2^4) inversion. */
+  t2 = y12 & y15;  t3 = y3 & y6;    t4 = t3 ^ t2;    t5 = y4 & x7;
+  t6 = t5 ^ t2;    t7 = y13 & y16;  t8 = y5 & y1;    t9 = t8 ^ t7;
+  t10 = y2 & y7;   t11 = t10 ^ t7;  t12 = y9 & y11;  t13 = y14 & y17;
+  t14 = t13 ^ t12; t15 = y8 & y10;  t16 = t15 ^ t12; t17 = t4 ^ t14;
+  t18 = t6 ^ t16;  t19 = t9 ^ t14;  t20 = t11 ^ t16; t21 = t17 ^ y20;
+  t22 = t18 ^ y19; t23 = t19 ^ y21; t24 = t20 ^ y18;
+
+  t25 = t21 ^ t22; t26 = t21 & t23; t27 = t24 ^ t26; t28 = t25 & t27;
+  t29 = t28 ^ t22; t30 = t23 ^ t24; t31 = t22 ^ t26; t32 = t31 & t30;
+  t33 = t32 ^ t24; t34 = t23 ^ t33; t35 = t27 ^ t33; t36 = t24 & t35;
+  t37 = t36 ^ t34; t38 = t27 ^ t36; t39 = t29 & t38; t40 = t25 ^ t39;
+
+  t41 = t40 ^ t37; t42 = t29 ^ t33; t43 = t29 ^ t40; t44 = t33 ^ t37;
+  t45 = t42 ^ t41;
+  z0 = t44 & y15;  z1 = t37 & y6;   z2 = t33 & x7;   z3 = t43 & y16;
+  z4 = t40 & y1;   z5 = t29 & y7;   z6 = t42 & y11;  z7 = t45 & y17;
+  z8 = t41 & y10;  z9 = t44 & y12;  z10 = t37 & y3;  z11 = t33 & y4;
+  z12 = t43 & y13; z13 = t40 & y5;  z14 = t29 & y2;  z15 = t42 & y9;
+  z16 = t45 & y14; z17 = t41 & y8;
+
+  /* Bottom linear transformation. */
+  t46 = z15 ^ z16; t47 = z10 ^ z11; t48 = z5 ^ z13;  t49 = z9 ^ z10;
+  t50 = z2 ^ z12;  t51 = z2 ^ z5;   t52 = z7 ^ z8;   t53 = z0 ^ z3;
+  t54 = z6 ^ z7;   t55 = z16 ^ z17; t56 = z12 ^ t48; t57 = t50 ^ t53;
+  t58 = z4 ^ t46;  t59 = z3 ^ t54;  t60 = t46 ^ t57; t61 = z14 ^ t57;
+  t62 = t52 ^ t58; t63 = t49 ^ t58; t64 = z4 ^ t59;  t65 = t61 ^ t62;
+  t66 = z1 ^ t63;
+  s0 = t59 ^ t63;  s6 = t56 ^ ~t62; s7 = t48 ^ ~t60; t67 = t64 ^ t65;
+  s3 = t53 ^ t66;  s4 = t51 ^ t66;  s5 = t47 ^ t65;  s1 = t64 ^ ~s3;
+  s2 = t55 ^ ~t67;
+
+  q[7] = s0; q[6] = s1; q[5] = s2; q[4] = s3;
+  q[3] = s4; q[2] = s5; q[1] = s6; q[0] = s7;
+  return;
+}
+
+/**
+ * @brief     Inverse of the linear part of the S-box affine map on eight bit planes.
+ * @param q   Pointer to bit planes 0 to 7.
+ */
+static void bs_inv_affine(uint64_t *q)
+{
+  uint64_t t[8];
+
+  for(size_t bit = 0; bit < 8; bit++)
+  {
+    t[bit] = q[(bit + 2) % 8] ^ q[(bit + 5) % 8] ^ q[(bit + 7) % 8];
+  }
+  for(size_t bit = 0; bit < 8; bit++)
+  {
+    q[bit] = t[bit];
+  }
+  return;
+}
+
+/**
+ * @brief     Inverse S-box on eight bit planes.
+ *            InvSubBytes(y) = A'(S(A'(y ^ 0x63)) ^ 0x63), with A' the inverse linear map,
+ *            so the forward circuit is reused.
+ * @param q   Pointer to bit planes 0 to 7.
+ */
+static void bs_inv_sbox(uint64_t *q)
+{
+  /* 0x63 sets bits 0, 1, 5 and 6. */
+  q[0] = ~q[0]; q[1] = ~q[1]; q[5] = ~q[5]; q[6] = ~q[6];
+  bs_inv_affine(q);
+  bs_sbox(q);
+  q[0] = ~q[0]; q[1] = ~q[1]; q[5] = ~q[5]; q[6] = ~q[6];
+  bs_inv_affine(q);
+  return;
+}
+
+static void bs_sub_bytes(uint64_t *q)
+{
+  bs_sbox(&q[0]);
+  bs_sbox(&q[8]);
+  return;
+}
+
+static void bs_inv_sub_bytes(uint64_t *q)
+{
+  bs_inv_sbox(&q[0]);
+  bs_inv_sbox(&q[8]);
+  return;
+}
+
+/* Row R of the output takes column C from column C + R of the input. */
+static void bs_shift_rows(uint64_t *q)
+{
+  for(size_t bit = 0; bit < 8; bit++)
+  {
+    q[bit]     = ( q[bit] & LO32 ) | ( ROW_ROTR(q[bit], 8) & HI32 );
+    q[8 + bit] = ( ROW_ROTR(q[8 + bit], 16) & LO32 ) | ( ROW_ROTR(q[8 + bit], 24) & HI32 );
+  }
+  return;
+}
+
+static void bs_inv_shift_rows(uint64_t *q)
+{
+  for(size_t bit = 0; bit < 8; bit++)
+  {
+    q[bit]     = ( q[bit] & LO32 ) | ( ROW_ROTR(q[bit], 24) & HI32 );
+    q[8 + bit] = ( ROW_ROTR(q[8 + bit], 16) & LO32 ) | ( ROW_ROTR(q[8 + bit], 8) & HI32 );
+  }
+  return;
+}
+
+/**
+ * @brief     Multiplies eight bit planes by x modulo the AES polynomial (0x11b).
+ * @param a   Pointer to bit planes 0 to 7, updated in place.
+ */
+static void bs_xtime(uint64_t *a)
+{
+  const uint64_t msb = a[7];
+
+  a[7] = a[6];
+  a[6] = a[5];
+  a[5] = a[4];
+  a[4] = a[3] ^ msb;
+  a[3] = a[2] ^ msb;
+  a[2] = a[1];
+  a[1] = a[0] ^ msb;
+  a[0] = msb;
+  return;
+}
+
+/*
+ * Rows are whole 32-bit halves, so rows R + 1, R + 2 and R + 3 of every
+ * column come from swapping halves between the two words of a plane.
+ * Each output row is 2*a ^ 3*b ^ c ^ d = 2*(a ^ b) ^ b ^ c ^ d.
+ */
+static void bs_mix_columns(uint64_t *q)
+{
+  uint64_t u0[8], u1[8], s[8];
+  uint64_t r0 = 0, r1 = 0;
+
+  for(size_t bit = 0; bit < 8; bit++)
+  {
+    r0 = ( q[bit] >> 32 ) | ( q[8 + bit] << 32 );   // rows 1 | 2
+    r1 = ( q[8 + bit] >> 32 ) | ( q[bit] << 32 );   // rows 3 | 0
+    u0[bit] = q[bit] ^ r0;
+    u1[bit] = q[8 + bit] ^ r1;
+    s[bit]  = r0 ^ r1;
+  }
+  bs_xtime(u0);
+  bs_xtime(u1);
+  for(size_t bit = 0; bit < 8; bit++)
+  {
+    r0 = q[bit];
+    q[bit]     = u0[bit] ^ s[bit] ^ q[8 + bit];
+    q[8 + bit] = u1[bit] ^ s[bit] ^ r0;
+  }
+  return;
+}
+
+/* InvMixColumns = MixColumns after adding 4*(a[R] ^ a[R + 2]) to rows R and R + 2. */
+static void bs_inv_mix_columns(uint64_t *q)
+{
+  uint64_t u[8];
+
+  for(size_t bit = 0; bit < 8; bit++)
+  {
+    u[bit] = q[bit] ^ q[8 + bit];
+  }
+  bs_xtime(u);
+  bs_xtime(u);
+  for(size_t bit = 0; bit < 8; bit++)
+  {
+    q[bit]     ^= u[bit];
+    q[8 + bit] ^= u[bit];
+  }
+  bs_mix_columns(q);
+  return;
+}
+
+static void bs_encrypt_lanes(uint64_t *q, const uint64_t *rk, size_t Nr)
+{
+  bs_add_round_key(q, &rk[0]);
+  for(size_t round = 1; round < Nr; round++)
+  {
+    bs_sub_bytes(q);
+    bs_shift_rows(q);
+    bs_mix_columns(q);
+    bs_add_round_key(q, &rk[16*round]);
+  }
+  bs_sub_bytes(q);
+  bs_shift_rows(q);
+  bs_add_round_key(q, &rk[16*Nr]);
+  return;
+}
+
+static void bs_decrypt_lanes(uint64_t *q, const uint64_t *rk, size_t Nr)
+{
+  bs_add_round_key(q, &rk[0]);
+  for(size_t round = 1; round < Nr; round++)
+  {
+    bs_inv_sub_bytes(q);
+    bs_inv_shift_rows(q);
+    bs_inv_mix_columns(q);
+    bs_add_round_key(q, &rk[16*round]);
+  }
+  bs_inv_sub_bytes(q);
+  bs_inv_shift_rows(q);
+  bs_add_round_key(q, &rk[16*Nr]);
+  return;
+}
+
+static int bs_available(void)
+{
+  return 1;
+}
+
+/**
+ * @brief           Computes SubWord(word) with the bitsliced S-box, one byte per bit lane.
+ * @param word      Key schedule word.
+ * @return uint32_t Substituted word.
+ */
+static uint32_t bs_sub_word(uint32_t word)
+{
+  uint64_t q[8];
+  uint32_t out = 0;
+
+  for(size_t bit = 0; bit < 8; bit++)
+  {
+    q[bit] = 0;
+    for(size_t idx = 0; idx < 4; idx++)
+    {
+      q[bit] |= (uint64_t)( ( word >> ( 8*idx + bit ) ) & 1UL ) << idx;
+    }
+  }
+  bs_sbox(q);
+  for(size_t bit = 0; bit < 8; bit++)
+  {
+    for(size_t idx = 0; idx < 4; idx++)
+    {
+      out |= (uint32_t)( ( q[bit] >> idx ) & 1ULL ) << ( 8*idx + bit );
+    }
+  }
+  return out;
+}
+
+/**
+ * @brief           Computes InvMixColumns on one column of a round key.
+ * @param w         Key schedule word, byte 0 in row 0.
+ * @return uint32_t Transformed word.
+ */
+static uint32_t bs_inv_mix_word(uint32_t w)
+{
+  uint32_t u = XTIME_WORD(w ^ ROTR_WORD(w, 16));
+
+  w ^= XTIME_WORD(u);
+  return XTIME_WORD(w ^ ROTR_WORD(w, 8)) ^ ROTR_WORD(w, 8) ^ ROTR_WORD(w, 16) ^ ROTR_WORD(w, 24);
+}
+
+/**
+ * @brief       Expands the key schedules without table lookups, so the key does not
+ *              leak through the cache either.
+ * @param ctx   Pointer to key context, Nk, Nr and usage already set.
+ * @param key   Pointer to key buffer.
+ */
+static void bs_setkey(uaes_ctx_t *ctx, uint8_t *key)
+{
+  static const uint8_t rcon[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+  const size_t Nk = ctx->Nk, Nr = ctx->Nr, Ns = uAES_NB * (Nr + 1UL);
+  uint32_t *w = ctx->kschd;
+  uint32_t tmp = 0;
+
+  for(size_t idx = 0; idx < Nk; idx++)
+  {
+    w[idx] = ( uint32_t )( key[4*idx] | key[4*idx + 1] << 8 | key[4*idx + 2] << 16 | (uint32_t)key[4*idx + 3] << 24 );
+  }
+  for(size_t idx = Nk; idx < Ns; idx++)
+  {
+    tmp = w[idx - 1];
+    if( 0 == ( idx % Nk ) )
+    {
+      tmp = bs_sub_word(ROTR_WORD(tmp, 8)) ^ rcon[( idx / Nk ) - 1];
+    }
+    else if( ( Nk > 6 ) && ( 4 == ( idx % Nk ) ) )
+    {
+      tmp = bs_sub_word(tmp);
+    }
+    w[idx] = w[idx - Nk] ^ tmp;
+  }
+
+  if(0 != (ctx->usage & uAES_CTX_DECRYPT))
+  {
+    for(size_t idx = 0; idx < uAES_NB; idx++)
+    {
+      ctx->dkschd[idx] = w[uAES_NB*Nr + idx];
+      ctx->dkschd[uAES_NB*Nr + idx] = w[idx];
+    }
+    for(size_t round = 1; round < Nr; round++)
+    {
+      for(size_t idx = 0; idx < uAES_NB; idx++)
+      {
+        ctx->dkschd[uAES_NB*round + idx] = bs_inv_mix_word(w[uAES_NB*(Nr - round) + idx]);
+      }
+    }
+  }
+  return;
+}
+
+/*
+ * A tail shorter than BS_LANES blocks runs through the same rounds with the
+ * unused lanes zeroed, so the single-block path costs a full batch but keeps
+ * the timing independent of the data.
+ */
+static void bs_encrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks)
+{
+  uint64_t rk[16 * (uAES_MAX_KSCHD_SIZE / 4)];
+  uint64_t q[16];
+  size_t lanes = 0;
+
+  bs_load_keys(rk, ctx->kschd, ctx->Nr);
+  for(; nblocks > 0; nblocks -= lanes, in += 16*lanes, out += 16*lanes)
+  {
+    lanes = ( nblocks < BS_LANES ) ? (nblocks) : (BS_LANES);
+    bs_load(q, in, lanes);
+    bs_encrypt_lanes(q, rk, ctx->Nr);
+    bs_store(out, q, lanes);
+  }
+  return;
+}
+
+static void bs_decrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks)
+{
+  uint64_t rk[16 * (uAES_MAX_KSCHD_SIZE / 4)];
+  uint64_t q[16];
+  size_t lanes = 0;
+
+  bs_load_keys(rk, ctx->dkschd, ctx->Nr);
+  for(; nblocks > 0; nblocks -= lanes, in += 16*lanes, out += 16*lanes)
+  {
+    lanes = ( nblocks < BS_LANES ) ? (nblocks) : (BS_LANES);
+    bs_load(q, in, lanes);
+    bs_decrypt_lanes(q, rk, ctx->Nr);
+    bs_store(out, q, lanes);
+  }
+  return;
+}
+
+static void bs_cbc_decrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *iv)
+{
+  uint64_t rk[16 * (uAES_MAX_KSCHD_SIZE / 4)];
+  uint64_t q[16];
+  uint8_t chain[16 * (BS_LANES + 1)];
+  size_t lanes = 0;
+
+  bs_load_keys(rk, ctx->dkschd, ctx->Nr);
+  for(size_t idx = 0; idx < 16; idx++)
+  {
+    chain[idx] = iv[idx];
+  }
+  for(; nblocks > 0; nblocks -= lanes, in += 16*lanes, out += 16*lanes)
+  {
+    lanes = ( nblocks < BS_LANES ) ? (nblocks) : (BS_LANES);
+    /* chain holds the previous ciphertext then this batch, so out may alias in. */
+    for(size_t idx = 0; idx < 16*lanes; idx++)
+    {
+      chain[16 + idx] = in[idx];
+    }
+    bs_load(q, in, lanes);
+    bs_decrypt_lanes(q, rk, ctx->Nr);
+    bs_store(out, q, lanes);
+    for(size_t idx = 0; idx < 16*lanes; idx++)
+    {
+      out[idx] ^= chain[idx];
+    }
+    for(size_t idx = 0; idx < 16; idx++)
+    {
+      chain[idx] = chain[16*lanes + idx];
+    }
+  }
+  for(size_t idx = 0; idx < 16; idx++)
+  {
+    iv[idx] = chain[idx];
+  }
+  return;
+}
+
+const uaes_engine_t uaes_engine_bitslice =
+{
+  .name         = "bitslice",
+  .id           = uAES_ENGINE_BITSLICE,
+  .available    = bs_available,
+  .setkey       = bs_setkey,
+  .encrypt      = bs_encrypt,
+  .decrypt      = bs_decrypt,
+  .cbc_encrypt  = NULL,
+  .cbc_decrypt  = bs_cbc_decrypt,
+  .cbc_encrypt_lanes = NULL,
+  .caps         = uAES_CAPS_SOFTWARE(uAES_CAP_CONST_TIME),
+};
+
+#endif /*uAES_CFG_BITSLICE*/
@@ -0,0 +1,329 @@
+/**
+ * @file      ccm.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     Counter with CBC-MAC (CCM) authenticated encryption, NIST SP 800-38C and RFC 3610.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_CCM
+
+#define CCM_MIN_NONCE       ( 7UL )
+#define CCM_MAX_NONCE       ( 13UL )
+#define CCM_MIN_TAG         ( 4UL )
+
+/*
+ * One pass over the data. The work buffer holds the next CBC-MAC input,
+ * X[i-1] ^ P[i-1], followed by the counter block A[i], and both go through
+ * the engine in one call: the MAC chain of the previous block and the
+ * keystream of the current one. P[i] is then known in either direction and
+ * folded into the MAC input for the next call. The last MAC block shares its
+ * call with A[0], the counter block that encrypts the tag.
+ */
+typedef struct
+{
+  const uaes_ctx_t  *ctx;
+  uint8_t           w[2 * uAES_BLOCK_SIZE];   // Pending MAC input, then a counter block.
+  uint8_t           a[uAES_BLOCK_SIZE];       // Next counter block.
+  size_t            q;                        // Counter field size in bytes, 15 - nonce length.
+}ccm_state_t;
+
+/**
+ * @brief       Encrypts the pending MAC input on its own and folds a block into it.
+ * @param st    Pointer to CCM state.
+ * @param blk   Pointer to 16-byte block.
+ */
+static void ccm_mac_block(ccm_state_t *st, const uint8_t *blk)
+{
+  st->ctx->engine->encrypt(st->ctx, st->w, st->w, 1UL);
+  for(size_t idx = 0; idx < uAES_BLOCK_SIZE; idx++)
+  {
+    st->w[idx] ^= blk[idx];
+  }
+  return;
+}
+
+/**
+ * @brief         Authenticates the associated data with its length prefix, zero-padded
+ *                to whole blocks.
+ * @param st      Pointer to CCM state.
+ * @param aad     Pointer to associated data.
+ * @param aad_len AAD size in bytes, not 0.
+ */
+static void ccm_aad(ccm_state_t *st, const uint8_t *aad, size_t aad_len)
+{
+  uint8_t blk[uAES_BLOCK_SIZE];
+  size_t fill = 0, n = 0;
+
+  if(aad_len < 0xff00UL)
+  {
+    blk[0] = (uint8_t)( aad_len >> 8 );
+    blk[1] = (uint8_t)aad_len;
+    fill = 2;
+  }
+  else
+  {
+    blk[0] = 0xff;
+    blk[1] = 0xfe;
+    for(size_t idx = 0; idx < 4; idx++)
+    {
+      blk[2 + idx] = (uint8_t)( (uint64_t)aad_len >> ( 24 - 8*idx ) );
+    }
+    fill = 6;
+  }
+  n = ( aad_len < (uAES_BLOCK_SIZE - fill) ) ? (aad_len) : (uAES_BLOCK_SIZE - fill);
+  memcpy(&blk[fill], aad, n);
+  memset(&blk[fill + n], 0x00, uAES_BLOCK_SIZE - fill - n);
+  ccm_mac_block(st, blk);
+  aad += n;
+  aad_len -= n;
+  for(; aad_len >= uAES_BLOCK_SIZE; aad_len -= uAES_BLOCK_SIZE, aad += uAES_BLOCK_SIZE)
+  {
+    ccm_mac_block(st, aad);
+  }
+  if(0 != aad_len)
+  {
+    memcpy(blk, aad, aad_len);
+    memset(&blk[aad_len], 0x00, uAES_BLOCK_SIZE - aad_len);
+    ccm_mac_block(st, blk);
+  }
+  uaes_wipe(blk, sizeof(blk));
+  return;
+}
+
+/**
+ * @brief         Encrypts or decrypts the payload in place while authenticating the
+ *                plaintext, the last MAC block is left pending.
+ * @param st      Pointer to CCM state.
+ * @param buf     Pointer to payload.
+ * @param size    Payload size, any value.
+ * @param decrypt [0] encrypt, [1] decrypt.
+ */
+static void ccm_payload(ccm_state_t *st, uint8_t *buf, size_t size, int decrypt)
+{
+  uint8_t *ks = &st->w[uAES_BLOCK_SIZE];
+  uint8_t p = 0;
+  size_t n = 0;
+
+  for(; size > 0; size -= n, buf += n)
+  {
+    n = ( size < uAES_BLOCK_SIZE ) ? (size) : (uAES_BLOCK_SIZE);
+    memcpy(ks, st->a, uAES_BLOCK_SIZE);
+    for(size_t idx = uAES_BLOCK_SIZE; (idx > (uAES_BLOCK_SIZE - st->q)) && (0 == ++st->a[idx - 1]); idx--);
+    st->ctx->engine->encrypt(st->ctx, st->w, st->w, 2UL);
+    for(size_t idx = 0; idx < n; idx++)
+    {
+      p = decrypt ? (uint8_t)( buf[idx] ^ ks[idx] ) : (buf[idx]);
+      buf[idx] ^= ks[idx];
+      st->w[idx] ^= p;
+    }
+  }
+  return;
+}
+
+/**
+ * @brief         Runs a whole CCM message and computes the full 16-byte tag, the
+ *                arguments are checked by the caller.
+ * @param tag     Pointer to 16-byte output, encrypted with A[0].
+ * @param tag_len Tag size in bytes, coded into B[0].
+ * @param decrypt [0] encrypt, [1] decrypt.
+ */
+static void ccm_run(const uaes_ctx_t *ctx,
+                    const uint8_t *nonce,
+                    size_t nonce_len,
+                    const uint8_t *aad,
+                    size_t aad_len,
+                    uint8_t *buf,
+                    size_t size,
+                    uint8_t *tag,
+                    size_t tag_len,
+                    int decrypt)
+{
+  ccm_state_t st;
+  uAES_PROF_START(t0);
+
+  st.ctx = ctx;
+  st.q = uAES_BLOCK_SIZE - 1UL - nonce_len;
+
+  /* B[0] = flags || N || Q and A[0] = q - 1 || N || 0, both zero-filled first. */
+  uaes_wipe(st.w, sizeof(st.w));
+  uaes_wipe(st.a, sizeof(st.a));
+  st.w[0] = (uint8_t)( ( (0 != aad_len) ? (0x40U) : (0x00U) ) | ( ( ( tag_len - 2UL ) / 2UL ) << 3 ) | ( st.q - 1UL ) );
+  st.a[0] = (uint8_t)( st.q - 1UL );
+  memcpy(&st.w[1], nonce, nonce_len);
+  memcpy(&st.a[1], nonce, nonce_len);
+  for(size_t idx = 0; (idx < st.q) && (idx < sizeof(size_t)); idx++)
+  {
+    st.w[uAES_BLOCK_SIZE - 1UL - idx] = (uint8_t)( size >> ( 8*idx ) );
+  }
+
+  if(0 != aad_len)
+  {
+    ccm_aad(&st, aad, aad_len);
+  }
+  st.a[uAES_BLOCK_SIZE - 1UL] = 0x01;
+  ccm_payload(&st, buf, size, decrypt);
+
+  /* Last MAC block and the tag keystream S[0] in one call. */
+  for(size_t idx = uAES_BLOCK_SIZE - st.q; idx < uAES_BLOCK_SIZE; idx++)
+  {
+    st.a[idx] = 0x00;
+  }
+  memcpy(&st.w[uAES_BLOCK_SIZE], st.a, uAES_BLOCK_SIZE);
+  ctx->engine->encrypt(ctx, st.w, st.w, 2UL);
+  for(size_t idx = 0; idx < uAES_BLOCK_SIZE; idx++)
+  {
+    tag[idx] = st.w[idx] ^ st.w[uAES_BLOCK_SIZE + idx];
+  }
+
+  uaes_wipe(&st, sizeof(st));
+  uAES_PROF_STOP(ctx, uAES_PROF_CCM, t0);
+  return;
+}
+
+/**
+ * @brief         Checks the parameters of a CCM call.
+ * @return int    [1] if usable, [0] otherwise.
+ */
+static int ccm_args_ok(const uaes_ctx_t *ctx,
+                       const uint8_t *nonce,
+                       size_t nonce_len,
+                       const uint8_t *aad,
+                       size_t aad_len,
+                       const uint8_t *buf,
+                       size_t size,
+                       const uint8_t *tag,
+                       size_t tag_len)
+{
+  const size_t q = uAES_BLOCK_SIZE - 1UL - nonce_len;
+
+  return ( (NULL != ctx)                                            &&
+           (0 != (ctx->usage & uAES_CTX_ENCRYPT))                   &&
+           (NULL != nonce)                                          &&
+           (CCM_MIN_NONCE <= nonce_len)                             &&
+           (CCM_MAX_NONCE >= nonce_len)                             &&
+           ((NULL != aad) || (0 == aad_len))                        &&
+           (uAES_MAX_INPUT_SIZE >= aad_len)                         &&
+           ((NULL != buf) || (0 == size))                           &&
+           (uAES_MAX_INPUT_SIZE >= size)                            &&
+           ((q >= sizeof(uint32_t)) || ((size >> (8UL * q)) == 0))  &&
+           (NULL != tag)                                            &&
+           (CCM_MIN_TAG <= tag_len)                                 &&
+           (uAES_BLOCK_SIZE >= tag_len)                             &&
+           (0 == (tag_len & 1UL)) ) ? (1) : (0);
+}
+
+/**
+ * @brief           Performs AES-CCM authenticated encryption in place using a previously
+ *                  initialised key context. The CBC-MAC and the counter keystream share
+ *                  every engine call, the key is never expanded again.
+ * @param ctx       Pointer to key context, uAES_CTX_ENCRYPT is enough for both directions.
+ * @param nonce     Pointer to nonce, never reuse one with the same key.
+ * @param nonce_len Nonce size in bytes, 7 to 13 (13 for BLE and IEEE 802.15.4).
+ * @param aad       Pointer to associated data, may be NULL if aad_len is 0.
+ * @param aad_len   AAD size in bytes.
+ * @param buf       Pointer to plaintext, encrypted in place.
+ * @param size      Plaintext size, any value below 2^(8 * (15 - nonce_len)).
+ * @param tag       Pointer to tag output.
+ * @param tag_len   Tag size in bytes, 4 to 16 and even.
+ * @return int      [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_ccm_encryption(const uaes_ctx_t *ctx,
+                            const uint8_t *nonce,
+                            size_t nonce_len,
+                            const uint8_t *aad,
+                            size_t aad_len,
+                            uint8_t *buf,
+                            size_t size,
+                            uint8_t *tag,
+                            size_t tag_len)
+{
+  int err = -1;
+  uint8_t full[uAES_BLOCK_SIZE];
+
+  if(ccm_args_ok(ctx, nonce, nonce_len, aad, aad_len, buf, size, tag, tag_len))
+  {
+    ccm_run(ctx, nonce, nonce_len, aad, aad_len, buf, size, full, tag_len, 0);
+    memcpy(tag, full, tag_len);
+    uaes_wipe(full, sizeof(full));
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief           Performs AES-CCM authenticated decryption in place using a previously
+ *                  initialised key context. The tag is checked in constant time and the
+ *                  buffer is zeroed if it does not match.
+ * @param ctx       Pointer to key context, uAES_CTX_ENCRYPT.
+ * @param nonce     Pointer to nonce.
+ * @param nonce_len Nonce size in bytes, 7 to 13.
+ * @param aad       Pointer to associated data, may be NULL if aad_len is 0.
+ * @param aad_len   AAD size in bytes.
+ * @param buf       Pointer to ciphertext, decrypted in place.
+ * @param size      Ciphertext size without the tag.
+ * @param tag       Pointer to received tag.
+ * @param tag_len   Tag size in bytes, 4 to 16 and even.
+ * @return int      [0] if sucessful, [-1] on failure or authentication error.
+ */
+int uaes_ctx_ccm_decryption(const uaes_ctx_t *ctx,
+                            const uint8_t *nonce,
+                            size_t nonce_len,
+                            const uint8_t *aad,
+                            size_t aad_len,
+                            uint8_t *buf,
+                            size_t size,
+                            const uint8_t *tag,
+                            size_t tag_len)
+{
+  int err = -1;
+  uint8_t full[uAES_BLOCK_SIZE];
+  uint8_t diff = 0;
+
+  if(ccm_args_ok(ctx, nonce, nonce_len, aad, aad_len, buf, size, tag, tag_len))
+  {
+    ccm_run(ctx, nonce, nonce_len, aad, aad_len, buf, size, full, tag_len, 1);
+    for(size_t idx = 0; idx < tag_len; idx++)
+    {
+      diff |= full[idx] ^ tag[idx];
+    }
+    uaes_wipe(full, sizeof(full));
+    if(0 == diff)
+    {
+      err = 0;
+    }
+    else if(NULL != buf)
+    {
+      memset(buf, 0x00, size);
+    }
+  }
+
+  return err;
+}
+
+#endif /*uAES_CFG_CCM*/
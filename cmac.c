@@ -0,0 +1,252 @@
+/**
+ * @file      cmac.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     AES-CMAC message authentication, NIST SP 800-38B and RFC 4493.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_CMAC
+
+#define CMAC_MIN_TAG        ( 4UL )
+
+/*
+ * The subkeys are derived once per message in uaes_cmac_init(). The last
+ * block of the message is held back in cmac->part until uaes_cmac_final(),
+ * it is the one masked with K1 or K2, every block before it is chained
+ * straight from the caller's buffer.
+ */
+
+/**
+ * @brief     Doubles a 16-byte big-endian value in GF(2^128) without branching on it.
+ * @param out Pointer to output, may be in.
+ * @param in  Pointer to input.
+ */
+static void cmac_dbl(uint8_t *out, const uint8_t *in)
+{
+  const uint8_t carry = (uint8_t)( 0U - ( in[0] >> 7 ) );
+
+  for(size_t idx = 0; idx < (uAES_BLOCK_SIZE - 1UL); idx++)
+  {
+    out[idx] = (uint8_t)( ( in[idx] << 1 ) | ( in[idx + 1] >> 7 ) );
+  }
+  out[uAES_BLOCK_SIZE - 1UL] = (uint8_t)( ( in[uAES_BLOCK_SIZE - 1UL] << 1 ) ^ ( carry & 0x87U ) );
+  return;
+}
+
+/**
+ * @brief         Chains whole blocks into the MAC state, X = E(K, X ^ M[i]).
+ * @param cmac    Pointer to CMAC state.
+ * @param in      Pointer to message blocks.
+ * @param nblocks Number of 16-byte blocks.
+ */
+static void cmac_chain(uaes_cmac_t *cmac, const uint8_t *in, size_t nblocks)
+{
+  for(; nblocks > 0; nblocks--, in += uAES_BLOCK_SIZE)
+  {
+    for(size_t idx = 0; idx < uAES_BLOCK_SIZE; idx++)
+    {
+      cmac->x[idx] ^= in[idx];
+    }
+    cmac->ctx->engine->encrypt(cmac->ctx, cmac->x, cmac->x, 1UL);
+  }
+  return;
+}
+
+/**
+ * @brief         Starts a CMAC message and derives the subkeys.
+ * @param cmac    Pointer to CMAC state.
+ * @param ctx     Pointer to key context, uAES_CTX_ENCRYPT. It is only read, and must
+ *                outlive the message.
+ * @return int    [0] if sucessful, [-1] on failure.
+ */
+int uaes_cmac_init(uaes_cmac_t *cmac, const uaes_ctx_t *ctx)
+{
+  int err = -1;
+
+  if((NULL != cmac) && (NULL != ctx) && (0 != (ctx->usage & uAES_CTX_ENCRYPT)))
+  {
+    uaes_wipe(cmac, sizeof(*cmac));
+    cmac->ctx = ctx;
+    uAES_PROF_OP(ctx, uAES_PROF_CMAC, ctx->engine->encrypt(ctx, cmac->k1, cmac->k1, 1UL));
+    cmac_dbl(cmac->k1, cmac->k1);
+    cmac_dbl(cmac->k2, cmac->k1);
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief         Authenticates the next message bytes.
+ * @param cmac    Pointer to CMAC state.
+ * @param msg     Pointer to message bytes, may be NULL if len is 0.
+ * @param len     Size in bytes, any value.
+ * @return int    [0] if sucessful, [-1] on failure.
+ */
+int uaes_cmac_update(uaes_cmac_t *cmac, const uint8_t *msg, size_t len)
+{
+  int err = -1;
+  size_t n = 0;
+
+  if((NULL != cmac) && (NULL != cmac->ctx) && ((NULL != msg) || (0 == len)) && (uAES_MAX_INPUT_SIZE >= len))
+  {
+    uAES_PROF_START(t0);
+
+    /* Top up the held back block, it is only chained once more bytes follow it. */
+    if((0 != len) && (uAES_BLOCK_SIZE > cmac->fill))
+    {
+      n = ( len < (uAES_BLOCK_SIZE - cmac->fill) ) ? (len) : (uAES_BLOCK_SIZE - cmac->fill);
+      memcpy(&cmac->part[cmac->fill], msg, n);
+      cmac->fill += n;
+      msg += n;
+      len -= n;
+    }
+    if(0 != len)
+    {
+      cmac_chain(cmac, cmac->part, 1UL);
+      n = ( len - 1UL ) / uAES_BLOCK_SIZE;
+      cmac_chain(cmac, msg, n);
+      msg += n * uAES_BLOCK_SIZE;
+      len -= n * uAES_BLOCK_SIZE;
+      memcpy(cmac->part, msg, len);
+      cmac->fill = len;
+    }
+    uAES_PROF_STOP(cmac->ctx, uAES_PROF_CMAC, t0);
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief         Computes the full 16-byte tag.
+ * @param cmac    Pointer to CMAC state.
+ * @param tag     Pointer to 16-byte output.
+ */
+static void cmac_tag(uaes_cmac_t *cmac, uint8_t *tag)
+{
+  const uint8_t *k = ( uAES_BLOCK_SIZE == cmac->fill ) ? (cmac->k1) : (cmac->k2);
+  uAES_PROF_START(t0);
+
+  if(uAES_BLOCK_SIZE != cmac->fill)
+  {
+    cmac->part[cmac->fill] = 0x80;
+    memset(&cmac->part[cmac->fill + 1UL], 0x00, uAES_BLOCK_SIZE - cmac->fill - 1UL);
+  }
+  for(size_t idx = 0; idx < uAES_BLOCK_SIZE; idx++)
+  {
+    cmac->part[idx] ^= k[idx];
+  }
+  cmac_chain(cmac, cmac->part, 1UL);
+  memcpy(tag, cmac->x, uAES_BLOCK_SIZE);
+  uAES_PROF_STOP(cmac->ctx, uAES_PROF_CMAC, t0);
+  return;
+}
+
+/**
+ * @brief         Ends a message and outputs the tag, the state is wiped.
+ * @param cmac    Pointer to CMAC state.
+ * @param tag     Pointer to tag output.
+ * @param tag_len Tag size in bytes, 4 to 16 (SP 800-38B recommends 8 or more).
+ * @return int    [0] if sucessful, [-1] on failure.
+ */
+int uaes_cmac_final(uaes_cmac_t *cmac, uint8_t *tag, size_t tag_len)
+{
+  int err = -1;
+  uint8_t full[uAES_BLOCK_SIZE];
+
+  if((NULL != cmac) && (NULL != cmac->ctx) && (NULL != tag) && (CMAC_MIN_TAG <= tag_len) && (uAES_BLOCK_SIZE >= tag_len))
+  {
+    cmac_tag(cmac, full);
+    memcpy(tag, full, tag_len);
+    uaes_wipe(full, sizeof(full));
+    uaes_wipe(cmac, sizeof(*cmac));
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief         Ends a message and checks a received tag in constant time, the state
+ *                is wiped.
+ * @param cmac    Pointer to CMAC state.
+ * @param tag     Pointer to received tag.
+ * @param tag_len Tag size in bytes, 4 to 16.
+ * @return int    [0] if the tag matches, [-1] on failure or mismatch.
+ */
+int uaes_cmac_verify(uaes_cmac_t *cmac, const uint8_t *tag, size_t tag_len)
+{
+  int err = -1;
+  uint8_t full[uAES_BLOCK_SIZE];
+  uint8_t diff = 0;
+
+  if((NULL != cmac) && (NULL != cmac->ctx) && (NULL != tag) && (CMAC_MIN_TAG <= tag_len) && (uAES_BLOCK_SIZE >= tag_len))
+  {
+    cmac_tag(cmac, full);
+    for(size_t idx = 0; idx < tag_len; idx++)
+    {
+      diff |= full[idx] ^ tag[idx];
+    }
+    uaes_wipe(full, sizeof(full));
+    uaes_wipe(cmac, sizeof(*cmac));
+    err = ( 0 == diff ) ? (0) : (-1);
+  }
+
+  return err;
+}
+
+/**
+ * @brief         Computes the AES-CMAC of a message using a previously initialised key
+ *                context.
+ * @param ctx     Pointer to key context, uAES_CTX_ENCRYPT.
+ * @param msg     Pointer to message, may be NULL if len is 0.
+ * @param len     Message size, any value.
+ * @param tag     Pointer to tag output.
+ * @param tag_len Tag size in bytes, 4 to 16.
+ * @return int    [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_cmac(const uaes_ctx_t *ctx, const uint8_t *msg, size_t len, uint8_t *tag, size_t tag_len)
+{
+  int err = -1;
+  uaes_cmac_t cmac;
+
+  if(0 == uaes_cmac_init(&cmac, ctx))
+  {
+    if((0 == uaes_cmac_update(&cmac, msg, len)) &&
+       (0 == uaes_cmac_final(&cmac, tag, tag_len)))
+    {
+      err = 0;
+    }
+    uaes_wipe(&cmac, sizeof(cmac));
+  }
+
+  return err;
+}
+
+#endif /*uAES_CFG_CMAC*/
@@ -0,0 +1,264 @@
+/**
+ * @file      ctr.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     Counter (CTR) mode, NIST SP 800-38A 6.5.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_CTR
+
+/**
+ * @brief         Increments the counter field of a counter block, the field is big-endian
+ *                and wraps modulo 2^(8*width) without carrying into the nonce.
+ * @param ctr     Pointer to the 16-byte counter block.
+ * @param width   Counter field size in bytes, taken from the end of the block.
+ */
+static void uaes_ctr_increment(uint8_t *ctr, size_t width)
+{
+  for(size_t idx = uAES_BLOCK_SIZE; idx > (uAES_BLOCK_SIZE - width); idx--)
+  {
+    if(0 != ++ctr[idx - 1])
+    {
+      break;
+    }
+  }
+  return;
+}
+
+/**
+ * @brief         Counts the blocks a counter block can still encrypt before its
+ *                field wraps around, the current value included.
+ * @param ctr     Pointer to the 16-byte counter block.
+ * @param width   Counter field size in bytes, 1 to 16.
+ * @return uint64_t 2^(8*width) minus the field value, at most UINT64_MAX.
+ */
+uint64_t uaes_ctr_left(const uint8_t *ctr, size_t width)
+{
+  const size_t low = ( width < sizeof(uint64_t) ) ? (width) : (sizeof(uint64_t));
+  uint64_t value = 0;
+
+  /* A field byte above the low 64 bits that is not 0xff leaves 2^64 blocks or more. */
+  for(size_t idx = uAES_BLOCK_SIZE - width; idx < (uAES_BLOCK_SIZE - low); idx++)
+  {
+    if(0xFF != ctr[idx])
+    {
+      return UINT64_MAX;
+    }
+  }
+  for(size_t idx = uAES_BLOCK_SIZE - low; idx < uAES_BLOCK_SIZE; idx++)
+  {
+    value = ( value << 8 ) | ctr[idx];
+  }
+  if(sizeof(uint64_t) > low)
+  {
+    return ( 1ULL << (8UL * low) ) - value;
+  }
+  return ( 0ULL == value ) ? (UINT64_MAX) : ((0ULL - value));
+}
+
+/**
+ * @brief         Adds a block count to the counter field of a counter block, modulo
+ *                2^(8*width) like uaes_ctr_increment().
+ * @param ctr     Pointer to the 16-byte counter block.
+ * @param width   Counter field size in bytes, taken from the end of the block.
+ * @param n       Number of blocks to skip.
+ */
+void uaes_ctr_add(uint8_t *ctr, size_t width, size_t n)
+{
+  unsigned int carry = 0;
+
+  for(size_t idx = uAES_BLOCK_SIZE; idx > (uAES_BLOCK_SIZE - width); idx--)
+  {
+    carry += ctr[idx - 1] + (unsigned int)(n & 0xFFUL);
+    ctr[idx - 1] = (uint8_t)carry;
+    carry >>= 8;
+    n >>= 8;
+    if((0 == carry) && (0 == n))
+    {
+      break;
+    }
+  }
+  return;
+}
+
+/**
+ * @brief             XORs the keystream of consecutive counter blocks into a buffer,
+ *                    the arguments are checked by the caller.
+ * @param ctx         Pointer to key context.
+ * @param buf         Pointer to data buffer.
+ * @param size        Buffer size, greater than 0.
+ * @param ctr_blk     16-byte counter block, advanced past every block used.
+ * @param ctr_width   Counter field size in bytes, 1 to 16.
+ */
+void uaes_ctr_xor(const uaes_ctx_t *ctx, uint8_t *buf, size_t size, uint8_t *ctr_blk, size_t ctr_width)
+{
+  uint8_t keystream[uAES_BLOCK_SIZE * uAES_CFG_CTR_BLOCKS];
+  size_t nblocks = ( size + uAES_BLOCK_SIZE - 1UL ) / uAES_BLOCK_SIZE;
+  size_t batch = 0, len = 0;
+  uAES_PROF_START(t0);
+
+  while(0 < size)
+  {
+    batch = ( nblocks < uAES_CFG_CTR_BLOCKS ) ? (nblocks) : (uAES_CFG_CTR_BLOCKS);
+    for(size_t idx = 0; idx < batch; idx++)
+    {
+      memcpy(&keystream[uAES_BLOCK_SIZE * idx], ctr_blk, uAES_BLOCK_SIZE);
+      uaes_ctr_increment(ctr_blk, ctr_width);
+    }
+    ctx->engine->encrypt(ctx, keystream, keystream, batch);
+
+    len = ( size < (uAES_BLOCK_SIZE * batch) ) ? (size) : (uAES_BLOCK_SIZE * batch);
+    for(size_t idx = 0; idx < len; idx++)
+    {
+      buf[idx] ^= keystream[idx];
+    }
+    buf     += len;
+    size    -= len;
+    nblocks -= batch;
+  }
+  uaes_wipe(keystream, sizeof(keystream));
+  uAES_PROF_STOP(ctx, uAES_PROF_CTR, t0);
+  return;
+}
+
+/**
+ * @brief             Performs AES Counter mode encryption on given buffer using a
+ *                    previously initialised key context.
+ *                    The counter block is the caller's nonce followed by a big-endian
+ *                    counter of ctr_width bytes, it is advanced past every block used
+ *                    (a trailing partial block included) so consecutive calls continue
+ *                    the keystream. Large buffers are spread over the worker pool
+ *                    when it is running (see uaes_pool_start()), a registered offload
+ *                    driver takes the call first (see uaes_offload_register()).
+ * @param ctx         Pointer to key context, uAES_CTX_ENCRYPT is enough for both directions.
+ * @param buf         Pointer to data buffer, any size.
+ * @param size        Buffer size.
+ * @param ctr_blk     16-byte counter block, updated on return.
+ * @param ctr_width   Counter field size in bytes, 1 to 16.
+ * @return int        [0] if sucessful, [-1] on failure or if the counter field would
+ *                    wrap around within this call, counting from its value in ctr_blk.
+ */
+int uaes_ctx_ctr_encryption(const uaes_ctx_t *ctx,
+                            uint8_t *buf,
+                            size_t size,
+                            uint8_t *ctr_blk,
+                            size_t ctr_width)
+{
+  int err = -1;
+  size_t nblocks = ( size + uAES_BLOCK_SIZE - 1UL ) / uAES_BLOCK_SIZE;
+
+  if((NULL != ctx)                                  &&
+     (0 != (ctx->usage & uAES_CTX_ENCRYPT))         &&
+     (NULL != buf)                                  &&
+     (NULL != ctr_blk)                              &&
+     (0 < size)                                     &&
+     (uAES_MAX_INPUT_SIZE >= size)                  &&
+     (0 < ctr_width)                                &&
+     (uAES_BLOCK_SIZE >= ctr_width)                 &&
+     ((uint64_t)nblocks <= uaes_ctr_left(ctr_blk, ctr_width)))
+  {
+    if((0 != uaes_offload_run(ctx, uAES_OP_CTR, buf, buf, size, ctr_blk, ctr_width)) &&
+       (0 != uaes_pool_ctr(ctx, buf, size, ctr_blk, ctr_width)))
+    {
+      uaes_ctr_xor(ctx, buf, size, ctr_blk, ctr_width);
+    }
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief             Performs AES Counter mode decryption, the same operation as
+ *                    uaes_ctx_ctr_encryption().
+ * @param ctx         Pointer to key context.
+ * @param buf         Pointer to data buffer, any size.
+ * @param size        Buffer size.
+ * @param ctr_blk     16-byte counter block, updated on return.
+ * @param ctr_width   Counter field size in bytes, 1 to 16.
+ * @return int        [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_ctr_decryption(const uaes_ctx_t *ctx,
+                            uint8_t *buf,
+                            size_t size,
+                            uint8_t *ctr_blk,
+                            size_t ctr_width)
+{
+  return uaes_ctx_ctr_encryption(ctx, buf, size, ctr_blk, ctr_width);
+}
+
+/**
+ * @brief             Performs AES Counter mode encryption on given buffer.
+ * @param buf         Pointer to data buffer.
+ * @param size        Buffer size.
+ * @param key         Pointer to key buffer.
+ * @param ctr_blk     16-byte counter block (nonce || counter), updated on return.
+ * @param ctr_width   Counter field size in bytes, 1 to 16.
+ * @param aes_length  Encryption/Decryption key length.
+ * @return int        [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctr_encryption(uint8_t *buf,
+                        size_t size,
+                        uint8_t *key,
+                        uint8_t *ctr_blk,
+                        size_t ctr_width,
+                        aes_length_t aes_length)
+{
+  int err = -1;
+  uaes_ctx_t ctx;
+
+  if(0 == uaes_ctx_init(&ctx, key, aes_length, uAES_CTX_ENCRYPT))
+  {
+    err = uaes_ctx_ctr_encryption(&ctx, buf, size, ctr_blk, ctr_width);
+    uaes_ctx_clear(&ctx);
+  }
+
+  return err;
+}
+
+/**
+ * @brief             Performs AES Counter mode decryption on given buffer.
+ * @param buf         Pointer to data buffer.
+ * @param size        Buffer size.
+ * @param key         Pointer to key buffer.
+ * @param ctr_blk     16-byte counter block (nonce || counter), updated on return.
+ * @param ctr_width   Counter field size in bytes, 1 to 16.
+ * @param aes_length  Encryption/Decryption key length.
+ * @return int        [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctr_decryption(uint8_t *buf,
+                        size_t size,
+                        uint8_t *key,
+                        uint8_t *ctr_blk,
+                        size_t ctr_width,
+                        aes_length_t aes_length)
+{
+  return uaes_ctr_encryption(buf, size, key, ctr_blk, ctr_width, aes_length);
+}
+
+#endif /*uAES_CFG_CTR*/
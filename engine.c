@@ -0,0 +1,110 @@
+/**
+ * @file      engine.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     Cipher engine registry and runtime selection.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+/* Compiled-in engines, in order of preference for uAES_ENGINE_AUTO. */
+static const uaes_engine_t *const engines[] =
+{
+#if (uAES_CFG_BITSLICE == 2)
+  &uaes_engine_bitslice,
+#endif /*uAES_CFG_BITSLICE*/
+#if uAES_CFG_AESNI
+  &uaes_engine_aesni,
+#endif /*uAES_CFG_AESNI*/
+#if uAES_CFG_ARMCE
+  &uaes_engine_armce,
+#endif /*uAES_CFG_ARMCE*/
+#if (uAES_CFG_VPERM == 2)
+  &uaes_engine_vperm,
+#endif /*uAES_CFG_VPERM*/
+  &uaes_engine_portable,
+#if (uAES_CFG_VPERM == 1)
+  &uaes_engine_vperm,
+#endif /*uAES_CFG_VPERM*/
+#if (uAES_CFG_BITSLICE == 1)
+  &uaes_engine_bitslice,
+#endif /*uAES_CFG_BITSLICE*/
+};
+
+/**
+ * @brief             Finds a compiled-in engine that the running CPU supports.
+ * @param id          Engine identifier, uAES_ENGINE_AUTO returns the first usable engine.
+ * @return const uaes_engine_t* Engine, NULL if not built or not supported.
+ */
+const uaes_engine_t *uaes_engine_lookup(uaes_engine_id_t id)
+{
+  const uaes_engine_t *engine = NULL;
+
+  for(size_t idx = 0; idx < (sizeof(engines) / sizeof(engines[0])); idx++)
+  {
+    if( ( ( uAES_ENGINE_AUTO == id ) || ( engines[idx]->id == id ) ) && engines[idx]->available() )
+    {
+      engine = engines[idx];
+      break;
+    }
+  }
+  return engine;
+}
+
+/**
+ * @brief             Tells whether an engine is compiled in and supported by the running CPU.
+ * @param id          Engine identifier.
+ * @return int        [1] if available, [0] otherwise.
+ */
+int uaes_engine_available(uaes_engine_id_t id)
+{
+  return ( NULL != uaes_engine_lookup(id) ) ? (1) : (0);
+}
+
+/**
+ * @brief             Reports the capabilities of an engine.
+ * @param id          Engine identifier, uAES_ENGINE_OFFLOAD for the registered driver.
+ * @param caps        Pointer to capabilities output.
+ * @return int        [0] if sucessful, [-1] if the engine is not available.
+ */
+int uaes_engine_caps(uaes_engine_id_t id, uaes_engine_caps_t *caps)
+{
+  int err = -1;
+  const uaes_engine_t *engine = uaes_engine_lookup(id);
+
+#if uAES_CFG_OFFLOAD
+  if(uAES_ENGINE_OFFLOAD == id)
+  {
+    engine = uaes_offload_engine();
+  }
+#endif /*uAES_CFG_OFFLOAD*/
+  if((NULL != caps) && (NULL != engine))
+  {
+    *caps = engine->caps;
+    err = 0;
+  }
+
+  return err;
+}
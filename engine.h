@@ -0,0 +1,190 @@
+/**
+ * @file      engine.h
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     Cipher engine interface, lets the API dispatch block operations to the best backend at runtime.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "uaes.h"
+
+/**
+ * @brief Whole-buffer operations of an offload driver, see uaes_engine_t.process.
+ */
+typedef enum uaes_op
+{
+  uAES_OP_ECB_ENCRYPT = 0,
+  uAES_OP_ECB_DECRYPT = 1,
+  uAES_OP_CBC_ENCRYPT = 2,
+  uAES_OP_CBC_DECRYPT = 3,
+  uAES_OP_CTR         = 4,
+}uaes_op_t;
+
+/**
+ * @brief Engine operations. Every engine reads and writes the key schedules
+ *        of uaes_ctx_t in the same format (FIPS-197 words, byte 0 in the least
+ *        significant bits), so a context can be moved between engines freely.
+ *        Block buffers may be unaligned and out may alias in.
+ *        The chaining value of the CBC operations is updated on return.
+ *        cbc_encrypt and cbc_decrypt are optional, generic loops over
+ *        encrypt/decrypt are used when they are NULL.
+ *        cbc_encrypt_lanes is optional too, it CBC encrypts one block in place
+ *        for each of 1 to uAES_MB_LANES independent messages, each under its own
+ *        context and chaining value. The contexts all use this engine and have
+ *        the same number of rounds.
+ *        caps declares what the engine handles. process is only used for an
+ *        offload driver, see below.
+ */
+struct uaes_engine
+{
+  const char        *name;
+  uaes_engine_id_t  id;
+  int   (*available)(void);
+  void  (*setkey)(uaes_ctx_t *ctx, uint8_t *key);
+  void  (*encrypt)(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks);
+  void  (*decrypt)(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks);
+  void  (*cbc_encrypt)(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *iv);
+  void  (*cbc_decrypt)(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *iv);
+  void  (*cbc_encrypt_lanes)(const uaes_ctx_t *const *ctx, uint8_t *const *blocks, uint8_t *const *iv, size_t nlanes);
+  uaes_engine_caps_t caps;
+  int   (*process)(const uaes_ctx_t *ctx, uaes_op_t op, uint8_t *out, const uint8_t *in, size_t size, uint8_t *iv, size_t ctr_width);
+};
+
+/*
+ * Offload drivers (uAES_CFG_OFFLOAD). A driver for an on-chip AES peripheral
+ * (STM32 CRYP/AES, ESP32 AES, NXP DCP, ...) is a uaes_engine_t with id
+ * uAES_ENGINE_OFFLOAD, its caps and process set; the block functions may be
+ * NULL, contexts keep their software engine for every other mode. process
+ * runs one ECB, CBC or CTR buffer to completion before returning, DMA
+ * included. size is a multiple of 16 bytes except for CTR, iv is the CBC
+ * chaining value or the CTR counter block and is updated like the software
+ * paths do (last ciphertext block, counter advanced past every block used,
+ * ctr_width bytes wide, NULL for ECB). The key is the first Nk words of
+ * ctx->kschd. It returns [0] when done and [-1] to have the call run in
+ * software instead, e.g. while the peripheral is busy, for an unsupported
+ * counter width or if it did not touch the buffers.
+ *
+ *   static int stm32_cryp_process(const uaes_ctx_t *ctx, uaes_op_t op, uint8_t *out,
+ *                                 const uint8_t *in, size_t size, uint8_t *iv, size_t ctr_width);
+ *
+ *   const uaes_engine_t stm32_cryp =
+ *   {
+ *     .name = "stm32-cryp", .id = uAES_ENGINE_OFFLOAD, .available = stm32_cryp_ready,
+ *     .caps = { .keys = uAES_CAP_KEY_ALL, .modes = uAES_CAP_MODE_ALL,
+ *               .flags = uAES_CAP_HARDWARE | uAES_CAP_DMA, .align = 4, .min_size = 64 },
+ *     .process = stm32_cryp_process,
+ *   };
+ *
+ *   uaes_offload_register(&stm32_cryp);
+ */
+
+/* Capabilities of the software engines. */
+#define uAES_CAPS_SOFTWARE( f )   { .keys = uAES_CAP_KEY_ALL, .modes = uAES_CAP_MODE_ALL, .flags = (f), \
+                                    .align = 1U, .min_size = 0UL, .max_size = 0UL }
+
+/* Most messages interleaved by one cbc_encrypt_lanes call. */
+#define uAES_MB_LANES   8
+
+extern const uaes_engine_t uaes_engine_portable;
+#if uAES_CFG_AESNI
+extern const uaes_engine_t uaes_engine_aesni;
+#endif /*uAES_CFG_AESNI*/
+#if uAES_CFG_ARMCE
+extern const uaes_engine_t uaes_engine_armce;
+#endif /*uAES_CFG_ARMCE*/
+#if uAES_CFG_BITSLICE
+extern const uaes_engine_t uaes_engine_bitslice;
+#endif /*uAES_CFG_BITSLICE*/
+#if uAES_CFG_VPERM
+extern const uaes_engine_t uaes_engine_vperm;
+#endif /*uAES_CFG_VPERM*/
+
+/*
+ * Carry-less multiply GHASH for GCM, Y = (Y ^ X[i]) * H for every block X[i].
+ * y, h and the input blocks are in GCM byte order.
+ */
+#if uAES_CFG_AESNI
+extern int  uaes_ghash_clmul_available(void);
+extern void uaes_ghash_clmul(uint8_t *y, const uint8_t *h, const uint8_t *in, size_t nblocks);
+#endif /*uAES_CFG_AESNI*/
+#if uAES_GHASH_PMULL
+extern int  uaes_ghash_pmull_available(void);
+extern void uaes_ghash_pmull(uint8_t *y, const uint8_t *h, const uint8_t *in, size_t nblocks);
+#endif /*uAES_GHASH_PMULL*/
+
+extern const uaes_engine_t *uaes_engine_lookup(uaes_engine_id_t id);
+
+/* Block loops shared by the modes and the worker pool, arguments are checked by the callers. */
+extern void uaes_cbc_encrypt_blocks(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *iv);
+extern void uaes_cbc_decrypt_blocks(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *iv);
+
+/* Zeroes a secret buffer with stores the compiler cannot drop. */
+extern void uaes_wipe(void *buf, size_t size);
+#if uAES_CFG_CTR
+extern void uaes_ctr_add(uint8_t *ctr, size_t width, size_t n);
+extern uint64_t uaes_ctr_left(const uint8_t *ctr, size_t width);
+extern void uaes_ctr_xor(const uaes_ctx_t *ctx, uint8_t *buf, size_t size, uint8_t *ctr_blk, size_t ctr_width);
+#else
+#define uaes_ctr_left(ctr, width)   (0ULL)
+#endif /*uAES_CFG_CTR*/
+#if uAES_CFG_XTS
+extern void uaes_xts_sectors(const uaes_ctx_t *ctx, const uaes_ctx_t *tweak_ctx, uint8_t *buf, size_t nsectors,
+                             size_t sector_size, uint64_t sector, uint64_t first, int decrypt);
+#endif /*uAES_CFG_XTS*/
+
+/*
+ * Worker pool dispatch, [0] if the pool processed the buffer, [-1] if the pool
+ * is not running, busy with another thread's buffer or the buffer is too small,
+ * the caller then does the work.
+ */
+#if uAES_CFG_THREADS
+extern int uaes_pool_ecb(const uaes_ctx_t *ctx, uint8_t *buf, size_t nblocks, int decrypt);
+extern int uaes_pool_cbc_decrypt(const uaes_ctx_t *ctx, uint8_t *buf, size_t nblocks, uint8_t *iv);
+#if uAES_CFG_CTR
+extern int uaes_pool_ctr(const uaes_ctx_t *ctx, uint8_t *buf, size_t size, uint8_t *ctr_blk, size_t ctr_width);
+#endif /*uAES_CFG_CTR*/
+#if uAES_CFG_XTS
+extern int uaes_pool_xts(const uaes_ctx_t *ctx, const uaes_ctx_t *tweak_ctx, uint8_t *buf, size_t size,
+                         size_t sector_size, uint64_t sector, int decrypt);
+#endif /*uAES_CFG_XTS*/
+#else
+#define uaes_pool_ecb(ctx, buf, nblocks, decrypt)               (-1)
+#define uaes_pool_cbc_decrypt(ctx, buf, nblocks, iv)            (-1)
+#define uaes_pool_ctr(ctx, buf, size, ctr_blk, ctr_width)       (-1)
+#define uaes_pool_xts(ctx, tctx, buf, size, ssize, sector, dec) (-1)
+#endif /*uAES_CFG_THREADS*/
+
+/*
+ * Offload dispatch, [0] if the registered driver processed the buffer, [-1] if
+ * there is none, the call does not fit its capabilities or it declined it,
+ * the caller then does the work.
+ */
+#if uAES_CFG_OFFLOAD
+extern const uaes_engine_t *uaes_offload_engine(void);
+extern int uaes_offload_run(const uaes_ctx_t *ctx, uaes_op_t op, uint8_t *out, const uint8_t *in, size_t size,
+                            uint8_t *iv, size_t ctr_width);
+#else
+#define uaes_offload_run(ctx, op, out, in, size, iv, ctr_width)  (-1)
+#endif /*uAES_CFG_OFFLOAD*/
+
+#endif /*ENGINE_H*/
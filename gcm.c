@@ -0,0 +1,622 @@
+/**
+ * @file      gcm.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     Galois/Counter Mode (GCM) authenticated encryption, NIST SP 800-38D.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_GCM
+
+#define GCM_PHASE_AAD       ( 0U )
+#define GCM_PHASE_DATA      ( 1U )
+
+#define GCM_CTR_WIDTH       ( 4UL )                         // inc32()
+#define GCM_MAX_DATA        ( ( 1ULL << 36 ) - 32ULL )      // 2^39 - 256 bits.
+#define GCM_MIN_TAG         ( 4UL )
+
+/*
+ * Whole blocks are encrypted and hashed a chunk at a time, so the ciphertext
+ * is still in the data cache when GHASH reads it.
+ */
+#define GCM_CHUNK_BLOCKS    ( 32UL )
+
+#define GET_U64_BE(p)   ( ( (uint64_t)(p)[0] << 56 ) | ( (uint64_t)(p)[1] << 48 ) | \
+                          ( (uint64_t)(p)[2] << 40 ) | ( (uint64_t)(p)[3] << 32 ) | \
+                          ( (uint64_t)(p)[4] << 24 ) | ( (uint64_t)(p)[5] << 16 ) | \
+                          ( (uint64_t)(p)[6] << 8 )  | ( (uint64_t)(p)[7] ) )
+
+static void gcm_put_u64_be(uint8_t *p, uint64_t v)
+{
+  for(size_t idx = 0; idx < 8; idx++)
+  {
+    p[idx] = (uint8_t)( v >> ( 56 - 8*idx ) );
+  }
+  return;
+}
+
+/* Reduction of the four bits shifted out of the low end, times x^124 mod P. */
+static const uint64_t gcm_last4[16] =
+{
+  0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+  0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+
+/**
+ * @brief       Precomputes the 4-bit GHASH tables (Shoup's method), entry i holds i * H
+ *              with the nibble i in GCM bit order.
+ * @param gcm   Pointer to GCM state, hash subkey already set.
+ */
+static void gcm_table_init(uaes_gcm_t *gcm)
+{
+  uint64_t vh = GET_U64_BE(&gcm->h[0]);
+  uint64_t vl = GET_U64_BE(&gcm->h[8]);
+  uint64_t t = 0;
+
+  gcm->hh[0] = 0;
+  gcm->hl[0] = 0;
+  gcm->hh[8] = vh;
+  gcm->hl[8] = vl;
+  for(size_t idx = 4; idx > 0; idx >>= 1)
+  {
+    t  = ( vl & 1ULL ) * 0xe1000000ULL;
+    vl = ( vh << 63 ) | ( vl >> 1 );
+    vh = ( vh >> 1 ) ^ ( t << 32 );
+    gcm->hh[idx] = vh;
+    gcm->hl[idx] = vl;
+  }
+  for(size_t idx = 2; idx <= 8; idx *= 2)
+  {
+    for(size_t sub = 1; sub < idx; sub++)
+    {
+      gcm->hh[idx + sub] = gcm->hh[idx] ^ gcm->hh[sub];
+      gcm->hl[idx + sub] = gcm->hl[idx] ^ gcm->hl[sub];
+    }
+  }
+  return;
+}
+
+/**
+ * @brief           Table-driven GHASH, Y = (Y ^ X[i]) * H for every block X[i].
+ *                  Needs 256 bytes of tables and no multiplier, the default on MCUs.
+ * @param gcm       Pointer to GCM state.
+ * @param in        Pointer to input blocks.
+ * @param nblocks   Number of 16-byte blocks.
+ */
+static void gcm_ghash_table(uaes_gcm_t *gcm, const uint8_t *in, size_t nblocks)
+{
+  uint8_t x[16];
+  uint64_t zh = 0, zl = 0, rem = 0;
+  uint8_t lo = 0, hi = 0;
+
+  for(; nblocks > 0; nblocks--, in += 16)
+  {
+    for(size_t idx = 0; idx < 16; idx++)
+    {
+      x[idx] = gcm->y[idx] ^ in[idx];
+    }
+
+    lo = x[15] & 0x0f;
+    zh = gcm->hh[lo];
+    zl = gcm->hl[lo];
+    for(size_t idx = 16; idx > 0; idx--)
+    {
+      lo = x[idx - 1] & 0x0f;
+      hi = x[idx - 1] >> 4;
+      if(16 != idx)
+      {
+        rem = zl & 0x0f;
+        zl  = ( zh << 60 ) | ( zl >> 4 );
+        zh  = ( zh >> 4 ) ^ ( gcm_last4[rem] << 48 );
+        zh ^= gcm->hh[lo];
+        zl ^= gcm->hl[lo];
+      }
+      rem = zl & 0x0f;
+      zl  = ( zh << 60 ) | ( zl >> 4 );
+      zh  = ( zh >> 4 ) ^ ( gcm_last4[rem] << 48 );
+      zh ^= gcm->hh[hi];
+      zl ^= gcm->hl[hi];
+    }
+    gcm_put_u64_be(&gcm->y[0], zh);
+    gcm_put_u64_be(&gcm->y[8], zl);
+  }
+  return;
+}
+
+#if uAES_CFG_AESNI
+static void gcm_ghash_clmul(uaes_gcm_t *gcm, const uint8_t *in, size_t nblocks)
+{
+  uaes_ghash_clmul(gcm->y, gcm->h, in, nblocks);
+  return;
+}
+#endif /*uAES_CFG_AESNI*/
+
+#if uAES_GHASH_PMULL
+static void gcm_ghash_pmull(uaes_gcm_t *gcm, const uint8_t *in, size_t nblocks)
+{
+  uaes_ghash_pmull(gcm->y, gcm->h, in, nblocks);
+  return;
+}
+#endif /*uAES_GHASH_PMULL*/
+
+/**
+ * @brief       Picks the carry-less multiply GHASH if the CPU has one, the tables otherwise.
+ * @param gcm   Pointer to GCM state, hash subkey already set.
+ */
+static void gcm_ghash_select(uaes_gcm_t *gcm)
+{
+  gcm->ghash = gcm_ghash_table;
+#if uAES_CFG_AESNI
+  if(uaes_ghash_clmul_available())
+  {
+    gcm->ghash = gcm_ghash_clmul;
+  }
+#endif /*uAES_CFG_AESNI*/
+#if uAES_GHASH_PMULL
+  if(uaes_ghash_pmull_available())
+  {
+    gcm->ghash = gcm_ghash_pmull;
+  }
+#endif /*uAES_GHASH_PMULL*/
+  if(gcm_ghash_table == gcm->ghash)
+  {
+    gcm_table_init(gcm);
+  }
+  return;
+}
+
+/**
+ * @brief       Hashes a byte string, a partial block is kept in gcm->part.
+ * @param gcm   Pointer to GCM state.
+ * @param data  Pointer to data.
+ * @param len   Data size.
+ * @param fill  Bytes already pending in gcm->part.
+ */
+static void gcm_absorb(uaes_gcm_t *gcm, const uint8_t *data, size_t len, size_t fill)
+{
+  size_t n = 0;
+
+  if(0 != fill)
+  {
+    n = ( len < (uAES_BLOCK_SIZE - fill) ) ? (len) : (uAES_BLOCK_SIZE - fill);
+    memcpy(&gcm->part[fill], data, n);
+    fill += n;
+    data += n;
+    len  -= n;
+    if(uAES_BLOCK_SIZE == fill)
+    {
+      gcm->ghash(gcm, gcm->part, 1UL);
+    }
+  }
+  if(uAES_BLOCK_SIZE <= len)
+  {
+    gcm->ghash(gcm, data, len / uAES_BLOCK_SIZE);
+    data += len & ~(uAES_BLOCK_SIZE - 1UL);
+    len  &= (uAES_BLOCK_SIZE - 1UL);
+  }
+  if(0 != len)
+  {
+    memcpy(gcm->part, data, len);
+  }
+  return;
+}
+
+/**
+ * @brief       Zero-pads and hashes the pending partial block, if any.
+ * @param gcm   Pointer to GCM state.
+ * @param fill  Bytes pending in gcm->part.
+ */
+static void gcm_pad(uaes_gcm_t *gcm, size_t fill)
+{
+  if(0 != fill)
+  {
+    memset(&gcm->part[fill], 0x00, uAES_BLOCK_SIZE - fill);
+    gcm->ghash(gcm, gcm->part, 1UL);
+  }
+  return;
+}
+
+/**
+ * @brief       Hashes the [len(A)]64 || [len(C)]64 block, both in bits.
+ * @param gcm   Pointer to GCM state.
+ * @param a     First length in bytes.
+ * @param c     Second length in bytes.
+ */
+static void gcm_lengths(uaes_gcm_t *gcm, uint64_t a, uint64_t c)
+{
+  uint8_t blk[uAES_BLOCK_SIZE];
+
+  gcm_put_u64_be(&blk[0], a << 3);
+  gcm_put_u64_be(&blk[8], c << 3);
+  gcm->ghash(gcm, blk, 1UL);
+  return;
+}
+
+/**
+ * @brief         Starts a GCM message.
+ * @param gcm     Pointer to GCM state.
+ * @param ctx     Pointer to key context, uAES_CTX_ENCRYPT is enough for both directions.
+ *                It is only read, and must outlive the message.
+ * @param iv      Pointer to initialisation vector, 12 bytes recommended.
+ * @param iv_len  IV size in bytes.
+ * @return int    [0] if sucessful, [-1] on failure.
+ */
+int uaes_gcm_init(uaes_gcm_t *gcm, const uaes_ctx_t *ctx, const uint8_t *iv, size_t iv_len)
+{
+  int err = -1;
+
+  if((NULL != gcm)                                &&
+     (NULL != ctx)                                &&
+     (0 != (ctx->usage & uAES_CTX_ENCRYPT))       &&
+     (NULL != iv)                                 &&
+     (0 < iv_len)                                 &&
+     (uAES_MAX_INPUT_SIZE >= iv_len))
+  {
+    uaes_wipe(gcm, sizeof(*gcm));
+    gcm->ctx = ctx;
+    uAES_PROF_OP(ctx, uAES_PROF_GCM, ctx->engine->encrypt(ctx, gcm->h, gcm->h, 1UL));
+    gcm_ghash_select(gcm);
+
+    if(12 == iv_len)
+    {
+      memcpy(gcm->j0, iv, iv_len);
+      gcm->j0[15] = 0x01;
+    }
+    else
+    {
+      gcm_absorb(gcm, iv, iv_len, 0UL);
+      gcm_pad(gcm, iv_len % uAES_BLOCK_SIZE);
+      gcm_lengths(gcm, 0ULL, (uint64_t)iv_len);
+      memcpy(gcm->j0, gcm->y, uAES_BLOCK_SIZE);
+      memset(gcm->y, 0x00, uAES_BLOCK_SIZE);
+    }
+    memcpy(gcm->ctr, gcm->j0, uAES_BLOCK_SIZE);
+    for(size_t idx = uAES_BLOCK_SIZE; (idx > (uAES_BLOCK_SIZE - GCM_CTR_WIDTH)) && (0 == ++gcm->ctr[idx - 1]); idx--);
+    gcm->phase = GCM_PHASE_AAD;
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief         Authenticates additional data, may be called several times before
+ *                the first update call.
+ * @param gcm     Pointer to GCM state.
+ * @param aad     Pointer to additional authenticated data.
+ * @param aad_len AAD size in bytes.
+ * @return int    [0] if sucessful, [-1] on failure or once data has been processed.
+ */
+int uaes_gcm_aad(uaes_gcm_t *gcm, const uint8_t *aad, size_t aad_len)
+{
+  int err = -1;
+
+  if((NULL != gcm) && (NULL != gcm->ctx) && (GCM_PHASE_AAD == gcm->phase) && ((NULL != aad) || (0 == aad_len)))
+  {
+    if(0 != aad_len)
+    {
+      gcm_absorb(gcm, aad, aad_len, (size_t)(gcm->aad_len % uAES_BLOCK_SIZE));
+      gcm->aad_len += aad_len;
+    }
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief         Encrypts or decrypts the next bytes of the message in one pass,
+ *                GHASH runs over the ciphertext chunk right after CTR produces or
+ *                before it consumes it.
+ * @param gcm     Pointer to GCM state.
+ * @param buf     Pointer to data, processed in place.
+ * @param size    Data size, any value.
+ * @param decrypt [0] encrypt, [1] decrypt.
+ * @return int    [0] if sucessful, [-1] on failure.
+ */
+static int gcm_update(uaes_gcm_t *gcm, uint8_t *buf, size_t size, int decrypt)
+{
+  int err = -1;
+  size_t fill = 0, n = 0;
+
+  if((NULL != gcm)                                &&
+     (NULL != gcm->ctx)                           &&
+     ((NULL != buf) || (0 == size))               &&
+     (uAES_MAX_INPUT_SIZE >= size)                &&
+     ((GCM_MAX_DATA - gcm->data_len) >= size))
+  {
+    uAES_PROF_START(t0);
+
+    if(GCM_PHASE_AAD == gcm->phase)
+    {
+      gcm_pad(gcm, (size_t)(gcm->aad_len % uAES_BLOCK_SIZE));
+      gcm->phase = GCM_PHASE_DATA;
+    }
+    fill = (size_t)(gcm->data_len % uAES_BLOCK_SIZE);
+    gcm->data_len += size;
+
+    /* Finish the block left open by the previous call with its saved keystream. */
+    if(0 != fill)
+    {
+      n = ( size < (uAES_BLOCK_SIZE - fill) ) ? (size) : (uAES_BLOCK_SIZE - fill);
+      for(size_t idx = 0; idx < n; idx++, fill++)
+      {
+        if(decrypt)
+        {
+          gcm->part[fill] = buf[idx];
+        }
+        buf[idx] ^= gcm->ks[fill];
+        if(!decrypt)
+        {
+          gcm->part[fill] = buf[idx];
+        }
+      }
+      buf  += n;
+      size -= n;
+      if(uAES_BLOCK_SIZE == fill)
+      {
+        gcm->ghash(gcm, gcm->part, 1UL);
+      }
+    }
+
+    while(uAES_BLOCK_SIZE <= size)
+    {
+      n = size / uAES_BLOCK_SIZE;
+      n = ( n < GCM_CHUNK_BLOCKS ) ? (n) : (GCM_CHUNK_BLOCKS);
+      if(decrypt)
+      {
+        gcm->ghash(gcm, buf, n);
+      }
+      uaes_ctr_xor(gcm->ctx, buf, n * uAES_BLOCK_SIZE, gcm->ctr, GCM_CTR_WIDTH);
+      if(!decrypt)
+      {
+        gcm->ghash(gcm, buf, n);
+      }
+      buf  += n * uAES_BLOCK_SIZE;
+      size -= n * uAES_BLOCK_SIZE;
+    }
+
+    /* Trailing partial block, its keystream is kept for the next call. */
+    if(0 != size)
+    {
+      memset(gcm->ks, 0x00, uAES_BLOCK_SIZE);
+      uaes_ctr_xor(gcm->ctx, gcm->ks, uAES_BLOCK_SIZE, gcm->ctr, GCM_CTR_WIDTH);
+      for(size_t idx = 0; idx < size; idx++)
+      {
+        if(decrypt)
+        {
+          gcm->part[idx] = buf[idx];
+        }
+        buf[idx] ^= gcm->ks[idx];
+        if(!decrypt)
+        {
+          gcm->part[idx] = buf[idx];
+        }
+      }
+    }
+    uAES_PROF_STOP(gcm->ctx, uAES_PROF_GCM, t0);
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief         Encrypts the next plaintext bytes of the message in place.
+ * @param gcm     Pointer to GCM state.
+ * @param buf     Pointer to plaintext.
+ * @param size    Plaintext size, any value.
+ * @return int    [0] if sucessful, [-1] on failure.
+ */
+int uaes_gcm_encrypt_update(uaes_gcm_t *gcm, uint8_t *buf, size_t size)
+{
+  return gcm_update(gcm, buf, size, 0);
+}
+
+/**
+ * @brief         Decrypts the next ciphertext bytes of the message in place.
+ *                The plaintext must not be used before uaes_gcm_verify() succeeds.
+ * @param gcm     Pointer to GCM state.
+ * @param buf     Pointer to ciphertext.
+ * @param size    Ciphertext size, any value.
+ * @return int    [0] if sucessful, [-1] on failure.
+ */
+int uaes_gcm_decrypt_update(uaes_gcm_t *gcm, uint8_t *buf, size_t size)
+{
+  return gcm_update(gcm, buf, size, 1);
+}
+
+/**
+ * @brief         Computes the full 16-byte tag.
+ * @param gcm     Pointer to GCM state.
+ * @param tag     Pointer to 16-byte output.
+ */
+static void gcm_tag(uaes_gcm_t *gcm, uint8_t *tag)
+{
+  uAES_PROF_START(t0);
+
+  if(GCM_PHASE_AAD == gcm->phase)
+  {
+    gcm_pad(gcm, (size_t)(gcm->aad_len % uAES_BLOCK_SIZE));
+  }
+  else
+  {
+    gcm_pad(gcm, (size_t)(gcm->data_len % uAES_BLOCK_SIZE));
+  }
+  gcm_lengths(gcm, gcm->aad_len, gcm->data_len);
+
+  memcpy(tag, gcm->j0, uAES_BLOCK_SIZE);
+  gcm->ctx->engine->encrypt(gcm->ctx, tag, tag, 1UL);
+  for(size_t idx = 0; idx < uAES_BLOCK_SIZE; idx++)
+  {
+    tag[idx] ^= gcm->y[idx];
+  }
+  uAES_PROF_STOP(gcm->ctx, uAES_PROF_GCM, t0);
+  return;
+}
+
+/**
+ * @brief         Ends an encryption and outputs the authentication tag, the state is wiped.
+ * @param gcm     Pointer to GCM state.
+ * @param tag     Pointer to tag output.
+ * @param tag_len Tag size in bytes, 4 to 16 (SP 800-38D recommends 12 or more).
+ * @return int    [0] if sucessful, [-1] on failure.
+ */
+int uaes_gcm_final(uaes_gcm_t *gcm, uint8_t *tag, size_t tag_len)
+{
+  int err = -1;
+  uint8_t full[uAES_BLOCK_SIZE];
+
+  if((NULL != gcm) && (NULL != gcm->ctx) && (NULL != tag) && (GCM_MIN_TAG <= tag_len) && (uAES_BLOCK_SIZE >= tag_len))
+  {
+    gcm_tag(gcm, full);
+    memcpy(tag, full, tag_len);
+    uaes_wipe(full, sizeof(full));
+    uaes_wipe(gcm, sizeof(*gcm));
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief         Ends a decryption and checks the authentication tag in constant time,
+ *                the state is wiped.
+ * @param gcm     Pointer to GCM state.
+ * @param tag     Pointer to received tag.
+ * @param tag_len Tag size in bytes, 4 to 16.
+ * @return int    [0] if the tag matches, [-1] on failure or mismatch.
+ */
+int uaes_gcm_verify(uaes_gcm_t *gcm, const uint8_t *tag, size_t tag_len)
+{
+  int err = -1;
+  uint8_t full[uAES_BLOCK_SIZE];
+  uint8_t diff = 0;
+
+  if((NULL != gcm) && (NULL != gcm->ctx) && (NULL != tag) && (GCM_MIN_TAG <= tag_len) && (uAES_BLOCK_SIZE >= tag_len))
+  {
+    gcm_tag(gcm, full);
+    for(size_t idx = 0; idx < tag_len; idx++)
+    {
+      diff |= full[idx] ^ tag[idx];
+    }
+    uaes_wipe(full, sizeof(full));
+    uaes_wipe(gcm, sizeof(*gcm));
+    err = ( 0 == diff ) ? (0) : (-1);
+  }
+
+  return err;
+}
+
+/**
+ * @brief         Performs AES-GCM authenticated encryption on given plaintext using a
+ *                previously initialised key context.
+ * @param ctx     Pointer to key context.
+ * @param iv      Pointer to initialisation vector, never reuse one with the same key.
+ * @param iv_len  IV size in bytes, 12 recommended.
+ * @param aad     Pointer to additional authenticated data, may be NULL if aad_len is 0.
+ * @param aad_len AAD size in bytes.
+ * @param buf     Pointer to plaintext, encrypted in place.
+ * @param size    Plaintext size, any value.
+ * @param tag     Pointer to tag output.
+ * @param tag_len Tag size in bytes, 4 to 16.
+ * @return int    [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_gcm_encryption(const uaes_ctx_t *ctx,
+                            const uint8_t *iv,
+                            size_t iv_len,
+                            const uint8_t *aad,
+                            size_t aad_len,
+                            uint8_t *buf,
+                            size_t size,
+                            uint8_t *tag,
+                            size_t tag_len)
+{
+  int err = -1;
+  uaes_gcm_t gcm;
+
+  if(0 == uaes_gcm_init(&gcm, ctx, iv, iv_len))
+  {
+    if((0 == uaes_gcm_aad(&gcm, aad, aad_len))            &&
+       (0 == uaes_gcm_encrypt_update(&gcm, buf, size))    &&
+       (0 == uaes_gcm_final(&gcm, tag, tag_len)))
+    {
+      err = 0;
+    }
+    uaes_wipe(&gcm, sizeof(gcm));
+  }
+
+  return err;
+}
+
+/**
+ * @brief         Performs AES-GCM authenticated decryption on given ciphertext using a
+ *                previously initialised key context. The buffer is zeroed if the tag
+ *                does not match.
+ * @param ctx     Pointer to key context.
+ * @param iv      Pointer to initialisation vector.
+ * @param iv_len  IV size in bytes.
+ * @param aad     Pointer to additional authenticated data, may be NULL if aad_len is 0.
+ * @param aad_len AAD size in bytes.
+ * @param buf     Pointer to ciphertext, decrypted in place.
+ * @param size    Ciphertext size, any value.
+ * @param tag     Pointer to received tag.
+ * @param tag_len Tag size in bytes, 4 to 16.
+ * @return int    [0] if sucessful, [-1] on failure or authentication error.
+ */
+int uaes_ctx_gcm_decryption(const uaes_ctx_t *ctx,
+                            const uint8_t *iv,
+                            size_t iv_len,
+                            const uint8_t *aad,
+                            size_t aad_len,
+                            uint8_t *buf,
+                            size_t size,
+                            const uint8_t *tag,
+                            size_t tag_len)
+{
+  int err = -1;
+  uaes_gcm_t gcm;
+
+  if(0 == uaes_gcm_init(&gcm, ctx, iv, iv_len))
+  {
+    if((0 == uaes_gcm_aad(&gcm, aad, aad_len))            &&
+       (0 == uaes_gcm_decrypt_update(&gcm, buf, size))    &&
+       (0 == uaes_gcm_verify(&gcm, tag, tag_len)))
+    {
+      err = 0;
+    }
+    else if(NULL != buf)
+    {
+      memset(buf, 0x00, size);
+    }
+    uaes_wipe(&gcm, sizeof(gcm));
+  }
+
+  return err;
+}
+
+#endif /*uAES_CFG_GCM*/
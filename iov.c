@@ -0,0 +1,274 @@
+/**
+ * @file      iov.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     Scatter/gather ECB and CBC over lists of buffer segments.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_IOV
+
+typedef enum
+{
+  IOV_ECB_ENC = 0,
+  IOV_ECB_DEC,
+  IOV_CBC_ENC,
+  IOV_CBC_DEC,
+}iov_op_t;
+
+/* Position inside a segment list, empty segments are skipped. */
+typedef struct
+{
+  const uaes_iovec_t  *seg;
+  size_t              cnt;
+  size_t              off;
+}iov_cursor_t;
+
+static void iov_skip_empty(iov_cursor_t *cur)
+{
+  while((0 != cur->cnt) && (cur->off == cur->seg->len))
+  {
+    cur->seg++;
+    cur->cnt--;
+    cur->off = 0;
+  }
+  return;
+}
+
+static void iov_advance(iov_cursor_t *cur, size_t len)
+{
+  cur->off += len;
+  iov_skip_empty(cur);
+  return;
+}
+
+/**
+ * @brief         Sums the segment sizes of a list.
+ * @param iov     Pointer to segment list.
+ * @param cnt     Number of segments.
+ * @param total   Receives the total size.
+ * @return int    [0] if sucessful, [-1] if a non-empty segment has no buffer or the sum overflows.
+ */
+static int iov_total(const uaes_iovec_t *iov, size_t cnt, size_t *total)
+{
+  *total = 0;
+  for(size_t idx = 0; idx < cnt; idx++)
+  {
+    if(((NULL == iov[idx].base) && (0 != iov[idx].len)) || ((SIZE_MAX - *total) < iov[idx].len))
+    {
+      return -1;
+    }
+    *total += iov[idx].len;
+  }
+  return 0;
+}
+
+static void iov_blocks(const uaes_ctx_t *ctx, iov_op_t op, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *iv)
+{
+  switch(op)
+  {
+    case IOV_ECB_ENC:
+      ctx->engine->encrypt(ctx, out, in, nblocks);
+      break;
+    case IOV_ECB_DEC:
+      ctx->engine->decrypt(ctx, out, in, nblocks);
+      break;
+    case IOV_CBC_ENC:
+      uaes_cbc_encrypt_blocks(ctx, out, in, nblocks, iv);
+      break;
+    case IOV_CBC_DEC:
+      uaes_cbc_decrypt_blocks(ctx, out, in, nblocks, iv);
+      break;
+    default:
+      break;
+  }
+  return;
+}
+
+/**
+ * @brief           Runs a mode over two segment lists as one logical buffer. Runs of
+ *                  blocks that are contiguous in both lists go to the engine directly,
+ *                  only blocks split across segments are gathered into a bounce block.
+ * @param ctx       Pointer to key context.
+ * @param op        Mode and direction.
+ * @param dst       Output segment list.
+ * @param dst_cnt   Number of output segments.
+ * @param src       Input segment list, read only.
+ * @param src_cnt   Number of input segments.
+ * @param iv        16-byte initialisation vector, CBC only.
+ * @return int      [0] if sucessful, [-1] on failure.
+ */
+static int iov_run(const uaes_ctx_t *ctx,
+                   iov_op_t op,
+                   const uaes_iovec_t *dst,
+                   size_t dst_cnt,
+                   const uaes_iovec_t *src,
+                   size_t src_cnt,
+                   const uint8_t *iv)
+{
+  int err = -1;
+  const uint8_t usage = ( (IOV_ECB_DEC == op) || (IOV_CBC_DEC == op) ) ? (uAES_CTX_DECRYPT) : (uAES_CTX_ENCRYPT);
+  iov_cursor_t in = { src, src_cnt, 0 }, out = { dst, dst_cnt, 0 };
+  uint8_t chain[uAES_BLOCK_SIZE] = {0U};
+  uint8_t blk[uAES_BLOCK_SIZE];
+  size_t src_size = 0, dst_size = 0, n = 0, len = 0;
+
+  if((NULL != ctx)                                          &&
+     (0 != (ctx->usage & usage))                            &&
+     (NULL != dst)                                          &&
+     (NULL != src)                                          &&
+     ((IOV_ECB_ENC == op) || (IOV_ECB_DEC == op) || (NULL != iv))  &&
+     (0 == iov_total(src, src_cnt, &src_size))              &&
+     (0 == iov_total(dst, dst_cnt, &dst_size))              &&
+     (src_size == dst_size)                                 &&
+     (0 < src_size)                                         &&
+     (0 == (src_size & uAES_BLOCK_ALIGN_MASK)))
+  {
+    if(NULL != iv)
+    {
+      memcpy(chain, iv, uAES_BLOCK_SIZE);
+    }
+    iov_skip_empty(&in);
+    iov_skip_empty(&out);
+    while(0 != in.cnt)
+    {
+      n = (in.seg->len - in.off) < (out.seg->len - out.off) ? (in.seg->len - in.off) : (out.seg->len - out.off);
+      n /= uAES_BLOCK_SIZE;
+      if(0 != n)
+      {
+        iov_blocks(ctx, op, &out.seg->base[out.off], &in.seg->base[in.off], n, chain);
+        iov_advance(&in, n * uAES_BLOCK_SIZE);
+        iov_advance(&out, n * uAES_BLOCK_SIZE);
+      }
+      else
+      {
+        for(size_t pos = 0; pos < uAES_BLOCK_SIZE; pos += len)
+        {
+          len = ( (in.seg->len - in.off) < (uAES_BLOCK_SIZE - pos) ) ? (in.seg->len - in.off) : (uAES_BLOCK_SIZE - pos);
+          memcpy(&blk[pos], &in.seg->base[in.off], len);
+          iov_advance(&in, len);
+        }
+        iov_blocks(ctx, op, blk, blk, 1UL, chain);
+        for(size_t pos = 0; pos < uAES_BLOCK_SIZE; pos += len)
+        {
+          len = ( (out.seg->len - out.off) < (uAES_BLOCK_SIZE - pos) ) ? (out.seg->len - out.off) : (uAES_BLOCK_SIZE - pos);
+          memcpy(&out.seg->base[out.off], &blk[pos], len);
+          iov_advance(&out, len);
+        }
+      }
+    }
+    uaes_wipe(blk, sizeof(blk));
+    uaes_wipe(chain, sizeof(chain));
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * NOTE: AES-ECB IS NO LONGER CONSIDERED SAFE, USE IT AT YOUR OWN RISK.
+ *
+ * @brief           Performs AES-ECB encryption of a segment list into another, blocks
+ *                  may straddle segment boundaries.
+ * @param ctx       Pointer to key context.
+ * @param dst       Output segment list, same total size as src. May be src itself.
+ * @param dst_cnt   Number of output segments.
+ * @param src       Input segment list, total size a multiple of 16 bytes.
+ * @param src_cnt   Number of input segments.
+ * @return int      [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_ecb_encryption_iov(const uaes_ctx_t *ctx,
+                                const uaes_iovec_t *dst,
+                                size_t dst_cnt,
+                                const uaes_iovec_t *src,
+                                size_t src_cnt)
+{
+  return iov_run(ctx, IOV_ECB_ENC, dst, dst_cnt, src, src_cnt, NULL);
+}
+
+/**
+ * NOTE: AES-ECB IS NO LONGER CONSIDERED SAFE, USE IT AT YOUR OWN RISK.
+ *
+ * @brief           Performs AES-ECB decryption of a segment list into another.
+ * @param ctx       Pointer to key context.
+ * @param dst       Output segment list, same total size as src. May be src itself.
+ * @param dst_cnt   Number of output segments.
+ * @param src       Input segment list, total size a multiple of 16 bytes.
+ * @param src_cnt   Number of input segments.
+ * @return int      [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_ecb_decryption_iov(const uaes_ctx_t *ctx,
+                                const uaes_iovec_t *dst,
+                                size_t dst_cnt,
+                                const uaes_iovec_t *src,
+                                size_t src_cnt)
+{
+  return iov_run(ctx, IOV_ECB_DEC, dst, dst_cnt, src, src_cnt, NULL);
+}
+
+/**
+ * @brief           Performs AES-CBC encryption of a segment list into another, the
+ *                  segments are chained as one message.
+ * @param ctx       Pointer to key context.
+ * @param dst       Output segment list, same total size as src. May be src itself.
+ * @param dst_cnt   Number of output segments.
+ * @param src       Input segment list, total size a multiple of 16 bytes.
+ * @param src_cnt   Number of input segments.
+ * @param iv        16-byte initialisation vector.
+ * @return int      [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_cbc_encryption_iov(const uaes_ctx_t *ctx,
+                                const uaes_iovec_t *dst,
+                                size_t dst_cnt,
+                                const uaes_iovec_t *src,
+                                size_t src_cnt,
+                                const uint8_t *iv)
+{
+  return iov_run(ctx, IOV_CBC_ENC, dst, dst_cnt, src, src_cnt, iv);
+}
+
+/**
+ * @brief           Performs AES-CBC decryption of a segment list into another.
+ * @param ctx       Pointer to key context.
+ * @param dst       Output segment list, same total size as src. May be src itself.
+ * @param dst_cnt   Number of output segments.
+ * @param src       Input segment list, total size a multiple of 16 bytes.
+ * @param src_cnt   Number of input segments.
+ * @param iv        16-byte initialisation vector.
+ * @return int      [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_cbc_decryption_iov(const uaes_ctx_t *ctx,
+                                const uaes_iovec_t *dst,
+                                size_t dst_cnt,
+                                const uaes_iovec_t *src,
+                                size_t src_cnt,
+                                const uint8_t *iv)
+{
+  return iov_run(ctx, IOV_CBC_DEC, dst, dst_cnt, src, src_cnt, iv);
+}
+
+#endif /*uAES_CFG_IOV*/
@@ -0,0 +1,230 @@
+/**
+ * @file      job.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     Sliced jobs, ECB, CBC and CTR advanced a bounded number of blocks per call.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_JOB
+
+/*
+ * A job walks its buffer front to back. Each uaes_job_step() call processes
+ * at most max_blocks blocks of the input bytes marked ready, so its run time
+ * is bounded by the caller whatever the buffer size. Input filled by DMA is
+ * announced with uaes_job_feed() as it lands and uaes_job_done() tells how
+ * much output can already be sent, so transfers in both directions overlap
+ * the cipher. feed() and step() may run in different contexts (an interrupt
+ * and the main loop), each field has a single writer.
+ */
+
+/**
+ * @brief         Runs len bytes of a job from its current position.
+ * @param job     Pointer to job.
+ * @param len     Bytes, whole blocks except for the last CTR slice.
+ */
+static void job_run(uaes_job_t *job, size_t len)
+{
+  const uaes_ctx_t *ctx = job->ctx;
+  uint8_t *out = &job->out[job->done];
+  const uint8_t *in = &job->in[job->done];
+
+  switch(job->mode)
+  {
+    case uAES_JOB_ECB_ENCRYPT:
+      uAES_PROF_OP(ctx, uAES_PROF_ECB, ctx->engine->encrypt(ctx, out, in, len / uAES_BLOCK_SIZE));
+      break;
+    case uAES_JOB_ECB_DECRYPT:
+      uAES_PROF_OP(ctx, uAES_PROF_ECB, ctx->engine->decrypt(ctx, out, in, len / uAES_BLOCK_SIZE));
+      break;
+    case uAES_JOB_CBC_ENCRYPT:
+      uaes_cbc_encrypt_blocks(ctx, out, in, len / uAES_BLOCK_SIZE, job->iv);
+      break;
+    case uAES_JOB_CBC_DECRYPT:
+      uaes_cbc_decrypt_blocks(ctx, out, in, len / uAES_BLOCK_SIZE, job->iv);
+      break;
+#if uAES_CFG_CTR
+    case uAES_JOB_CTR:
+      if(out != in)
+      {
+        memmove(out, in, len);
+      }
+      uaes_ctr_xor(ctx, out, len, job->iv, job->ctr_width);
+      break;
+#endif /*uAES_CFG_CTR*/
+    default:
+      break;
+  }
+  return;
+}
+
+/**
+ * @brief           Prepares a job, no block is processed until uaes_job_step().
+ *                  The whole input is taken as ready, see uaes_job_feed() for
+ *                  input that is still arriving.
+ * @param job       Pointer to job.
+ * @param ctx       Pointer to key context, uAES_CTX_DECRYPT for ECB and CBC
+ *                  decryption, uAES_CTX_ENCRYPT otherwise. Must outlive the job.
+ * @param mode      Job mode.
+ * @param out       Pointer to output buffer, size bytes.
+ * @param in        Pointer to input buffer, may be out but must not overlap it otherwise.
+ * @param size      Buffer size, a multiple of 16 bytes except for CTR.
+ * @param iv        16-byte initialisation vector (CBC) or counter block (CTR), NULL for ECB.
+ * @param ctr_width CTR counter field size in bytes, 1 to 16, ignored otherwise.
+ * @param cb        Completion callback, NULL if the caller polls uaes_job_step().
+ * @param arg       Callback argument.
+ * @return int      [0] if sucessful, [-1] on failure or if the CTR counter field
+ *                  would wrap around, counting from its value in iv.
+ */
+int uaes_job_init(uaes_job_t *job,
+                  const uaes_ctx_t *ctx,
+                  uaes_job_mode_t mode,
+                  uint8_t *out,
+                  const uint8_t *in,
+                  size_t size,
+                  const uint8_t *iv,
+                  size_t ctr_width,
+                  uaes_job_cb_t cb,
+                  void *arg)
+{
+  int err = -1;
+  const uint8_t usage = ( (uAES_JOB_ECB_DECRYPT == mode) || (uAES_JOB_CBC_DECRYPT == mode) ) ? (uAES_CTX_DECRYPT) : (uAES_CTX_ENCRYPT);
+  const uint64_t nblocks = ((uint64_t)size + uAES_BLOCK_SIZE - 1ULL) / uAES_BLOCK_SIZE;
+
+  if((NULL != job)                                            &&
+     (NULL != ctx)                                            &&
+     (0 != (ctx->usage & usage))                              &&
+     (uAES_JOB_RGE > mode)                                    &&
+     (uAES_CFG_CTR || (uAES_JOB_CTR != mode))                 &&
+     (NULL != out)                                            &&
+     (NULL != in)                                             &&
+     (0 < size)                                               &&
+     ((uAES_JOB_CTR == mode) || (0 == (size & uAES_BLOCK_ALIGN_MASK)))            &&
+     ((uAES_JOB_ECB_ENCRYPT == mode) || (uAES_JOB_ECB_DECRYPT == mode) || (NULL != iv)) &&
+     ((uAES_JOB_CTR != mode) || ((0 < ctr_width) && (uAES_BLOCK_SIZE >= ctr_width) &&
+                                 (nblocks <= uaes_ctr_left(iv, ctr_width)))))
+  {
+    memset(job, 0x00, sizeof(uaes_job_t));
+    job->ctx        = ctx;
+    job->mode       = mode;
+    job->out        = out;
+    job->in         = in;
+    job->size       = size;
+    job->ready      = size;
+    job->ctr_width  = ctr_width;
+    job->cb         = cb;
+    job->arg        = arg;
+    if(NULL != iv)
+    {
+      memcpy(job->iv, iv, uAES_BLOCK_SIZE);
+    }
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief           Tells the job how much of its input is valid, for input filled by
+ *                  DMA or a peripheral. Call it with 0 right after uaes_job_init()
+ *                  and then with the running total as data lands, from any context.
+ * @param job       Pointer to job.
+ * @param ready     Input bytes valid from the start of the buffer, never lower than a
+ *                  previous call and at most the job size.
+ * @return int      [0] if sucessful, [-1] on failure or if ready went backwards.
+ */
+int uaes_job_feed(uaes_job_t *job, size_t ready)
+{
+  int err = -1;
+
+  /* The first call replaces the whole-input default of uaes_job_init(). */
+  if((NULL != job)                            &&
+     (ready <= job->size)                     &&
+     (ready >= job->done)                     &&
+     ((0 == job->fed) || (ready >= job->ready)))
+  {
+    job->ready = ready;
+    job->fed   = 1U;
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief           Processes up to max_blocks more blocks of the ready input. When the
+ *                  last byte is written the completion callback runs, once.
+ * @param job       Pointer to job.
+ * @param max_blocks Most blocks handled by this call, bounds its run time.
+ * @return int      [1] once the job is complete, [0] if blocks remain (or input is
+ *                  awaited), [-1] on failure.
+ */
+int uaes_job_step(uaes_job_t *job, size_t max_blocks)
+{
+  int err = -1;
+  size_t len = 0, ready = 0;
+
+  if((NULL != job) && (NULL != job->ctx) && (0 < max_blocks))
+  {
+    ready = job->ready;
+    len   = ( ready > job->done ) ? (ready - job->done) : (0UL);
+    if((len / uAES_BLOCK_SIZE) >= max_blocks)
+    {
+      len = max_blocks * uAES_BLOCK_SIZE;
+    }
+    else if(ready != job->size)
+    {
+      /* Only the end of the input may be a partial block. */
+      len &= ~(uAES_BLOCK_SIZE - 1UL);
+    }
+    if(0 != len)
+    {
+      job_run(job, len);
+      job->done += len;
+      if((job->size == job->done) && (NULL != job->cb))
+      {
+        job->cb(job, job->arg);
+      }
+    }
+    err = ( job->size == job->done ) ? (1) : (0);
+  }
+
+  return err;
+}
+
+/**
+ * @brief           Output bytes written so far, from the start of the buffer. They are
+ *                  final and may be handed to DMA while the job goes on.
+ * @param job       Pointer to job.
+ * @return size_t   Bytes written, the job size once complete.
+ */
+size_t uaes_job_done(const uaes_job_t *job)
+{
+  return ( NULL != job ) ? (job->done) : (0UL);
+}
+
+#endif /*uAES_CFG_JOB*/
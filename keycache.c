@@ -0,0 +1,351 @@
+/**
+ * @file      keycache.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     Fixed-capacity key schedule cache with LRU eviction.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_KEYCACHE
+
+/*
+ * A key identifier is hashed to one set of uAES_KEYCACHE_WAYS ways. Lookups
+ * compare the identifiers of the set and copy the matching context out to
+ * the caller, so an entry may be evicted at any time without invalidating
+ * contexts in use. Every way has a sequence count, odd while an insert
+ * rewrites it: a reader that sees it change during the copy tries again.
+ * Inserts of one set are serialised by its lock, the key is expanded
+ * before the lock is taken. Each set keeps its own use clock and counters
+ * so that threads working on different keys do not share cache lines.
+ */
+
+/**
+ * @brief         Maps a key identifier to its set (64-bit finaliser of MurmurHash3).
+ * @param kc      Pointer to cache.
+ * @param key_id  Key identifier.
+ * @return uaes_keycache_set_t* The set.
+ */
+static uaes_keycache_set_t *keycache_set(const uaes_keycache_t *kc, uint64_t key_id)
+{
+  key_id ^= key_id >> 33;
+  key_id *= 0xff51afd7ed558ccdULL;
+  key_id ^= key_id >> 33;
+  key_id *= 0xc4ceb9fe1a85ec53ULL;
+  key_id ^= key_id >> 33;
+  return &kc->set[key_id % kc->nsets];
+}
+
+static void keycache_lock(uaes_keycache_set_t *set)
+{
+  while(atomic_flag_test_and_set_explicit(&set->lock, memory_order_acquire))
+  {
+  }
+  return;
+}
+
+static void keycache_unlock(uaes_keycache_set_t *set)
+{
+  atomic_flag_clear_explicit(&set->lock, memory_order_release);
+  return;
+}
+
+/**
+ * @brief         Searches a set and copies the matching context out.
+ * @param set     Pointer to set.
+ * @param key_id  Key identifier.
+ * @param aes_length Key length the context must have.
+ * @param usage   uAES_CTX_* flags the context must cover.
+ * @param ctx     Receives the context, holds another key's copy on a miss.
+ * @return int    [0] on a hit, [-1] on a miss.
+ */
+static int keycache_find(uaes_keycache_set_t *set, uint64_t key_id, aes_length_t aes_length, uint8_t usage, uaes_ctx_t *ctx)
+{
+  uint32_t seq = 0;
+  uint64_t id = 0;
+
+  for(size_t way = 0; way < uAES_KEYCACHE_WAYS; way++)
+  {
+    if(key_id != atomic_load_explicit(&set->id[way], memory_order_relaxed))
+    {
+      continue;
+    }
+    do
+    {
+      seq = atomic_load_explicit(&set->seq[way], memory_order_acquire);
+      if(0 == (seq & 1U))
+      {
+        memcpy(ctx, &set->ctx[way], sizeof(uaes_ctx_t));
+        id = atomic_load_explicit(&set->id[way], memory_order_relaxed);
+      }
+      atomic_thread_fence(memory_order_acquire);
+    }while((0 != (seq & 1U)) || (seq != atomic_load_explicit(&set->seq[way], memory_order_relaxed)));
+
+    /* The way may have been refilled between the identifier test and the copy. */
+    if((key_id == id) &&
+       (0 != ctx->usage) &&
+       (aes_length == ctx->aes_length) &&
+       (usage == (ctx->usage & usage)))
+    {
+      atomic_store_explicit(&set->stamp[way],
+                            atomic_fetch_add_explicit(&set->clock, 1ULL, memory_order_relaxed) + 1ULL,
+                            memory_order_relaxed);
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief         Rewrites a way, the caller holds the set lock.
+ * @param set     Pointer to set.
+ * @param way     Way index.
+ * @param key_id  Key identifier.
+ * @param ctx     Context to store, NULL empties the way.
+ */
+static void keycache_write(uaes_keycache_set_t *set, size_t way, uint64_t key_id, const uaes_ctx_t *ctx)
+{
+  const uint32_t seq = atomic_load_explicit(&set->seq[way], memory_order_relaxed);
+
+  atomic_store_explicit(&set->seq[way], seq + 1U, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  if(NULL != ctx)
+  {
+    memcpy(&set->ctx[way], ctx, sizeof(uaes_ctx_t));
+    atomic_store_explicit(&set->id[way], key_id, memory_order_relaxed);
+    atomic_store_explicit(&set->stamp[way],
+                          atomic_fetch_add_explicit(&set->clock, 1ULL, memory_order_relaxed) + 1ULL,
+                          memory_order_relaxed);
+  }
+  else
+  {
+    uaes_ctx_clear(&set->ctx[way]);
+    atomic_store_explicit(&set->stamp[way], 0ULL, memory_order_relaxed);
+  }
+  atomic_store_explicit(&set->seq[way], seq + 2U, memory_order_release);
+  return;
+}
+
+/**
+ * @brief         Sets up a cache over caller storage, nothing is allocated.
+ *                Holds nsets * uAES_KEYCACHE_WAYS keys.
+ * @param kc      Pointer to cache.
+ * @param sets    Array of nsets sets, used until the cache is no longer needed.
+ * @param nsets   Number of sets, at least 1.
+ * @return int    [0] if sucessful, [-1] on failure.
+ */
+int uaes_keycache_init(uaes_keycache_t *kc, uaes_keycache_set_t *sets, size_t nsets)
+{
+  int err = -1;
+
+  if((NULL != kc) && (NULL != sets) && (0 != nsets))
+  {
+    for(size_t idx = 0; idx < nsets; idx++)
+    {
+      atomic_flag_clear_explicit(&sets[idx].lock, memory_order_relaxed);
+      atomic_init(&sets[idx].clock, 0ULL);
+      atomic_init(&sets[idx].hits, 0ULL);
+      atomic_init(&sets[idx].misses, 0ULL);
+      atomic_init(&sets[idx].evictions, 0ULL);
+      for(size_t way = 0; way < uAES_KEYCACHE_WAYS; way++)
+      {
+        atomic_init(&sets[idx].seq[way], 0U);
+        atomic_init(&sets[idx].id[way], 0ULL);
+        atomic_init(&sets[idx].stamp[way], 0ULL);
+        uaes_ctx_clear(&sets[idx].ctx[way]);
+      }
+    }
+    kc->set   = sets;
+    kc->nsets = nsets;
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief           Copies the cached context of a key into ctx, expanding and
+ *                  caching the key on a miss. The identifier must stand for one
+ *                  key, call uaes_keycache_invalidate() before reusing it for
+ *                  another. Safe to call from any number of threads.
+ * @param kc        Pointer to cache.
+ * @param key_id    Caller's key identifier.
+ * @param key       Pointer to key, only read on a miss.
+ * @param aes_length Key length option.
+ * @param usage     uAES_CTX_* flags, cached contexts are kept per identifier
+ *                  so the same flags should be used for every call.
+ * @param ctx       Receives the context, owned by the caller (see uaes_ctx_clear()).
+ * @return int      [0] if sucessful, [-1] on failure.
+ */
+int uaes_keycache_get(uaes_keycache_t *kc, uint64_t key_id, uint8_t *key, aes_length_t aes_length, uint8_t usage, uaes_ctx_t *ctx)
+{
+  int err = -1;
+  uaes_keycache_set_t *set = NULL;
+  size_t victim = 0;
+
+  if((NULL != kc) && (NULL != kc->set) && (NULL != ctx))
+  {
+    set = keycache_set(kc, key_id);
+    if(0 == keycache_find(set, key_id, aes_length, usage, ctx))
+    {
+      atomic_fetch_add_explicit(&set->hits, 1ULL, memory_order_relaxed);
+      err = 0;
+    }
+    else if(0 == uaes_ctx_init(ctx, key, aes_length, usage))
+    {
+      atomic_fetch_add_explicit(&set->misses, 1ULL, memory_order_relaxed);
+      keycache_lock(set);
+      /* Replace the way of this identifier if any, else the least recently used. */
+      for(size_t way = 0; way < uAES_KEYCACHE_WAYS; way++)
+      {
+        if((0 != set->ctx[way].usage) && (key_id == atomic_load_explicit(&set->id[way], memory_order_relaxed)))
+        {
+          victim = way;
+          break;
+        }
+        if(atomic_load_explicit(&set->stamp[way], memory_order_relaxed) <
+           atomic_load_explicit(&set->stamp[victim], memory_order_relaxed))
+        {
+          victim = way;
+        }
+      }
+      if((0 != set->ctx[victim].usage) && (key_id != atomic_load_explicit(&set->id[victim], memory_order_relaxed)))
+      {
+        atomic_fetch_add_explicit(&set->evictions, 1ULL, memory_order_relaxed);
+      }
+      keycache_write(set, victim, key_id, ctx);
+      keycache_unlock(set);
+      err = 0;
+    }
+    else
+    {
+      uaes_ctx_clear(ctx);
+    }
+  }
+
+  return err;
+}
+
+/**
+ * @brief           Copies the cached context of a key into ctx without expanding
+ *                  it on a miss, the miss is still counted.
+ * @param kc        Pointer to cache.
+ * @param key_id    Caller's key identifier.
+ * @param aes_length Key length option.
+ * @param usage     uAES_CTX_* flags the context must cover.
+ * @param ctx       Receives the context, undefined on a miss.
+ * @return int      [0] on a hit, [-1] on a miss or failure.
+ */
+int uaes_keycache_lookup(uaes_keycache_t *kc, uint64_t key_id, aes_length_t aes_length, uint8_t usage, uaes_ctx_t *ctx)
+{
+  int err = -1;
+  uaes_keycache_set_t *set = NULL;
+
+  if((NULL != kc) && (NULL != kc->set) && (NULL != ctx))
+  {
+    set = keycache_set(kc, key_id);
+    err = keycache_find(set, key_id, aes_length, usage, ctx);
+    atomic_fetch_add_explicit(( 0 == err ) ? (&set->hits) : (&set->misses), 1ULL, memory_order_relaxed);
+    if(0 != err)
+    {
+      uaes_ctx_clear(ctx);
+    }
+  }
+
+  return err;
+}
+
+/**
+ * @brief           Drops a key from the cache and wipes its schedule, contexts
+ *                  already copied out are not affected.
+ * @param kc        Pointer to cache.
+ * @param key_id    Caller's key identifier.
+ */
+void uaes_keycache_invalidate(uaes_keycache_t *kc, uint64_t key_id)
+{
+  uaes_keycache_set_t *set = NULL;
+
+  if((NULL != kc) && (NULL != kc->set))
+  {
+    set = keycache_set(kc, key_id);
+    keycache_lock(set);
+    for(size_t way = 0; way < uAES_KEYCACHE_WAYS; way++)
+    {
+      if((0 != set->ctx[way].usage) && (key_id == atomic_load_explicit(&set->id[way], memory_order_relaxed)))
+      {
+        keycache_write(set, way, key_id, NULL);
+      }
+    }
+    keycache_unlock(set);
+  }
+  return;
+}
+
+/**
+ * @brief           Drops and wipes every cached key, counters are kept.
+ * @param kc        Pointer to cache.
+ */
+void uaes_keycache_clear(uaes_keycache_t *kc)
+{
+  if((NULL != kc) && (NULL != kc->set))
+  {
+    for(size_t idx = 0; idx < kc->nsets; idx++)
+    {
+      keycache_lock(&kc->set[idx]);
+      for(size_t way = 0; way < uAES_KEYCACHE_WAYS; way++)
+      {
+        if(0 != kc->set[idx].ctx[way].usage)
+        {
+          keycache_write(&kc->set[idx], way, 0ULL, NULL);
+        }
+      }
+      keycache_unlock(&kc->set[idx]);
+    }
+  }
+  return;
+}
+
+/**
+ * @brief           Reads the hit, miss and eviction counters, summed over the sets.
+ * @param kc        Pointer to cache.
+ * @param stats     Receives the counters.
+ */
+void uaes_keycache_stats(const uaes_keycache_t *kc, uaes_keycache_stats_t *stats)
+{
+  if((NULL != kc) && (NULL != kc->set) && (NULL != stats))
+  {
+    memset(stats, 0x00, sizeof(uaes_keycache_stats_t));
+    for(size_t idx = 0; idx < kc->nsets; idx++)
+    {
+      stats->hits      += atomic_load_explicit(&kc->set[idx].hits, memory_order_relaxed);
+      stats->misses    += atomic_load_explicit(&kc->set[idx].misses, memory_order_relaxed);
+      stats->evictions += atomic_load_explicit(&kc->set[idx].evictions, memory_order_relaxed);
+    }
+  }
+  return;
+}
+
+#endif /*uAES_CFG_KEYCACHE*/
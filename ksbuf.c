@@ -0,0 +1,303 @@
+/**
+ * @file      ksbuf.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     CTR and OFB keystream precomputed into a ring buffer, packets only pay a XOR.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_KSBUF
+
+/*
+ * The producer, uaes_ksbuf_fill(), runs the cipher in idle time and appends
+ * whole keystream blocks at head. The consumer, uaes_ksbuf_xor(), takes bytes
+ * from tail, so encrypting a packet costs a XOR per byte whatever the key
+ * size. head and tail are free running byte counts and the ring size is a
+ * power of two, the precomputed amount is head - tail and a block never
+ * straddles the end of the ring. fill() and xor() may run in different
+ * contexts (the main loop and an interrupt), each field has a single writer.
+ * Used keystream is wiped from the ring as it is consumed.
+ */
+
+/**
+ * @brief         Blocks fill() may still produce before the counter field wraps,
+ *                counting from the counter block given to uaes_ksbuf_init().
+ * @param ks      Pointer to keystream buffer.
+ * @param nblocks Blocks wanted.
+ * @return size_t nblocks or fewer.
+ */
+static size_t ksbuf_limit(const uaes_ksbuf_t *ks, size_t nblocks)
+{
+  if((uAES_KSBUF_CTR == ks->mode) && ((uint64_t)nblocks > ks->ctr_left))
+  {
+    nblocks = (size_t)ks->ctr_left;
+  }
+  return nblocks;
+}
+
+/**
+ * @brief         Writes consecutive keystream blocks.
+ * @param ks      Pointer to keystream buffer.
+ * @param out     Pointer to ring slot, nblocks contiguous blocks.
+ * @param nblocks Number of blocks, greater than 0.
+ */
+static void ksbuf_run(uaes_ksbuf_t *ks, uint8_t *out, size_t nblocks)
+{
+  const uaes_ctx_t *ctx = ks->ctx;
+
+#if uAES_CFG_CTR
+  if(uAES_KSBUF_CTR == ks->mode)
+  {
+    /* The counter blocks are built in the ring and encrypted there in one call. */
+    for(size_t idx = 0; idx < nblocks; idx++)
+    {
+      memcpy(&out[uAES_BLOCK_SIZE * idx], ks->iv, uAES_BLOCK_SIZE);
+      uaes_ctr_add(ks->iv, ks->ctr_width, 1UL);
+    }
+    ctx->engine->encrypt(ctx, out, out, nblocks);
+    ks->ctr_left -= nblocks;
+  }
+  else
+#endif /*uAES_CFG_CTR*/
+  {
+    /* OFB, every block is the cipher of the one before it. */
+    for(size_t idx = 0; idx < nblocks; idx++)
+    {
+      ctx->engine->encrypt(ctx, &out[uAES_BLOCK_SIZE * idx], ks->iv, 1UL);
+      memcpy(ks->iv, &out[uAES_BLOCK_SIZE * idx], uAES_BLOCK_SIZE);
+    }
+  }
+  return;
+}
+
+/**
+ * @brief           Prepares an empty keystream buffer, no block is computed until
+ *                  uaes_ksbuf_fill().
+ * @param ks        Pointer to keystream buffer.
+ * @param ctx       Pointer to key context, uAES_CTX_ENCRYPT. Must outlive the buffer.
+ * @param mode      uAES_KSBUF_CTR or uAES_KSBUF_OFB.
+ * @param ring      Pointer to caller memory that holds the keystream.
+ * @param size      Ring size in bytes, a power of two of 16 or more.
+ * @param iv        16-byte counter block (CTR) or initialisation vector (OFB).
+ * @param ctr_width CTR counter field size in bytes, 1 to 16, ignored by OFB.
+ * @return int      [0] if sucessful, [-1] on failure.
+ */
+int uaes_ksbuf_init(uaes_ksbuf_t *ks,
+                    const uaes_ctx_t *ctx,
+                    uaes_ksbuf_mode_t mode,
+                    uint8_t *ring,
+                    size_t size,
+                    const uint8_t *iv,
+                    size_t ctr_width)
+{
+  int err = -1;
+
+  if((NULL != ks)                                             &&
+     (NULL != ctx)                                            &&
+     (0 != (ctx->usage & uAES_CTX_ENCRYPT))                   &&
+     (uAES_KSBUF_RGE > mode)                                  &&
+     (uAES_CFG_CTR || (uAES_KSBUF_CTR != mode))               &&
+     (NULL != ring)                                           &&
+     (NULL != iv)                                             &&
+     (uAES_BLOCK_SIZE <= size)                                &&
+     (0 == (size & (size - 1UL)))                             &&
+     ((uAES_KSBUF_CTR != mode) || ((0 < ctr_width) && (uAES_BLOCK_SIZE >= ctr_width))))
+  {
+    memset(ks, 0x00, sizeof(uaes_ksbuf_t));
+    ks->ctx       = ctx;
+    ks->mode      = mode;
+    ks->ring      = ring;
+    ks->size      = size;
+    ks->ctr_width = ctr_width;
+    memcpy(ks->iv, iv, uAES_BLOCK_SIZE);
+#if uAES_CFG_CTR
+    if(uAES_KSBUF_CTR == mode)
+    {
+      ks->ctr_left = uaes_ctr_left(iv, ctr_width);
+    }
+#endif /*uAES_CFG_CTR*/
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief         Sets the watermark callbacks, both may be NULL. on_low is called
+ *                by uaes_ksbuf_xor() when it leaves fewer than low bytes precomputed,
+ *                once per crossing and on every call refused for lack of keystream,
+ *                it typically wakes the producer. on_high is called by
+ *                uaes_ksbuf_fill() when it brings the buffer to high bytes or more.
+ *                Each runs in the context of the call that triggered it.
+ * @param ks      Pointer to keystream buffer.
+ * @param low     Low watermark in bytes.
+ * @param on_low  Low watermark callback.
+ * @param high    High watermark in bytes, low to the ring size.
+ * @param on_high High watermark callback.
+ * @param arg     Callback argument.
+ * @return int    [0] if sucessful, [-1] on failure.
+ */
+int uaes_ksbuf_watermarks(uaes_ksbuf_t *ks,
+                          size_t low,
+                          uaes_ksbuf_cb_t on_low,
+                          size_t high,
+                          uaes_ksbuf_cb_t on_high,
+                          void *arg)
+{
+  int err = -1;
+
+  if((NULL != ks) && (NULL != ks->ctx) && (low <= high) && (ks->size >= high))
+  {
+    ks->low     = low;
+    ks->on_low  = on_low;
+    ks->high    = high;
+    ks->on_high = on_high;
+    ks->arg     = arg;
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief             Precomputes keystream into the free part of the ring, meant for
+ *                    idle time. The run time is bounded by max_blocks.
+ * @param ks          Pointer to keystream buffer.
+ * @param max_blocks  Most blocks computed by this call, greater than 0.
+ * @return int        [1] if the ring is full (or the CTR counter field is used up),
+ *                    [0] if there is room left, [-1] on failure.
+ */
+int uaes_ksbuf_fill(uaes_ksbuf_t *ks, size_t max_blocks)
+{
+  int err = -1;
+  size_t head = 0, before = 0, after = 0, room = 0, idx = 0, n = 0;
+
+  if((NULL != ks) && (NULL != ks->ctx) && (0 < max_blocks))
+  {
+    head   = ks->head;
+    before = head - ks->tail;
+    room   = ksbuf_limit(ks, (ks->size - before) / uAES_BLOCK_SIZE);
+    room   = ( room < max_blocks ) ? (room) : (max_blocks);
+    if(0 < room)
+    {
+      uAES_PROF_START(t0);
+      while(0 < room)
+      {
+        idx = head & (ks->size - 1UL);
+        n   = ( ks->size - idx ) / uAES_BLOCK_SIZE;
+        n   = ( n < room ) ? (n) : (room);
+        ksbuf_run(ks, &ks->ring[idx], n);
+        head += uAES_BLOCK_SIZE * n;
+        room -= n;
+      }
+      ks->head = head;
+      uAES_PROF_STOP(ks->ctx, uAES_PROF_KSBUF, t0);
+    }
+    after = head - ks->tail;
+    if((NULL != ks->on_high) && (before < ks->high) && (after >= ks->high))
+    {
+      ks->on_high(ks, after, ks->arg);
+    }
+    err = ( 0 == ksbuf_limit(ks, (ks->size - after) / uAES_BLOCK_SIZE) ) ? (1) : (0);
+  }
+
+  return err;
+}
+
+/**
+ * @brief         Encrypts or decrypts a buffer with the next len bytes of
+ *                precomputed keystream. Nothing is consumed if fewer are available,
+ *                so both ends of a link stay at the same keystream position.
+ * @param ks      Pointer to keystream buffer.
+ * @param buf     Pointer to data buffer, may be NULL if len is 0.
+ * @param len     Buffer size, any value up to uaes_ksbuf_avail().
+ * @return int    [0] if sucessful, [-1] on failure or if not enough keystream is
+ *                precomputed.
+ */
+int uaes_ksbuf_xor(uaes_ksbuf_t *ks, uint8_t *buf, size_t len)
+{
+  int err = -1;
+  size_t tail = 0, before = 0, after = 0, idx = 0, n = 0;
+
+  if((NULL != ks) && (NULL != ks->ctx) && ((NULL != buf) || (0 == len)))
+  {
+    tail   = ks->tail;
+    before = ks->head - tail;
+    if(len <= before)
+    {
+      for(size_t pos = 0; pos < len; pos += n)
+      {
+        idx = tail & (ks->size - 1UL);
+        n   = ( (len - pos) < (ks->size - idx) ) ? (len - pos) : (ks->size - idx);
+        for(size_t off = 0; off < n; off++)
+        {
+          buf[pos + off] ^= ks->ring[idx + off];
+          ks->ring[idx + off] = 0x00;
+        }
+        tail += n;
+      }
+      ks->tail = tail;
+      err = 0;
+    }
+    after = before - ( (0 == err) ? (len) : (0UL) );
+    if((NULL != ks->on_low) && (after < ks->low) && ((0 != err) || (before >= ks->low)))
+    {
+      ks->on_low(ks, after, ks->arg);
+    }
+  }
+
+  return err;
+}
+
+/**
+ * @brief         Tells how much keystream is precomputed.
+ * @param ks      Pointer to keystream buffer.
+ * @return size_t Bytes uaes_ksbuf_xor() can take without waiting for the producer.
+ */
+size_t uaes_ksbuf_avail(const uaes_ksbuf_t *ks)
+{
+  return ( NULL != ks ) ? (ks->head - ks->tail) : (0UL);
+}
+
+/**
+ * @brief         Wipes the ring and the keystream state.
+ * @param ks      Pointer to keystream buffer.
+ */
+void uaes_ksbuf_clear(uaes_ksbuf_t *ks)
+{
+  if(NULL != ks)
+  {
+    if(NULL != ks->ring)
+    {
+      uaes_wipe(ks->ring, ks->size);
+    }
+    uaes_wipe(ks, sizeof(*ks));
+  }
+  return;
+}
+
+#endif /*uAES_CFG_KSBUF*/
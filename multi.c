@@ -0,0 +1,196 @@
+/**
+ * @file      multi.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     Multi-buffer CBC encryption, interleaves independent messages in one round loop.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_MULTI
+
+/* Message being encrypted in a lane. */
+typedef struct
+{
+  const uaes_cbc_job_t  *job;
+  size_t                off;
+}mb_lane_t;
+
+/* Jobs can share a lane loop when their contexts run on the same engine with the same round count. */
+static int mb_same_class(const uaes_cbc_job_t *a, const uaes_cbc_job_t *b)
+{
+  return (a->ctx->engine == b->ctx->engine) && (a->ctx->Nr == b->ctx->Nr);
+}
+
+static int mb_job_valid(const uaes_cbc_job_t *job)
+{
+  return (NULL != job->ctx)                          &&
+         (0 != (job->ctx->usage & uAES_CTX_ENCRYPT)) &&
+         (NULL != job->iv)                           &&
+         ((NULL != job->buf) || (0 == job->size))    &&
+         (0 == (job->size & uAES_BLOCK_ALIGN_MASK))  &&
+         (uAES_MAX_INPUT_SIZE >= job->size);
+}
+
+/**
+ * @brief         Finds the next job of a class that still has to be started.
+ * @param jobs    Job array.
+ * @param njobs   Number of jobs.
+ * @param lead    First job of the class.
+ * @param next    Index to resume the search from, updated.
+ * @return const uaes_cbc_job_t* Next job, NULL when the class is exhausted.
+ */
+static const uaes_cbc_job_t *mb_next_job(const uaes_cbc_job_t *jobs, size_t njobs, const uaes_cbc_job_t *lead, size_t *next)
+{
+  const uaes_cbc_job_t *job = NULL;
+
+  for(; (*next < njobs) && (NULL == job); (*next)++)
+  {
+    if((0 != jobs[*next].size) && mb_same_class(lead, &jobs[*next]))
+    {
+      job = &jobs[*next];
+    }
+  }
+  return job;
+}
+
+/**
+ * @brief         Encrypts every job of the class led by jobs[first], one block of
+ *                each active lane per engine call. A lane whose message is done is
+ *                refilled with the next job of the class, so short and long messages
+ *                mix without idle lanes until the class runs out.
+ * @param jobs    Job array.
+ * @param njobs   Number of jobs.
+ * @param first   Index of the first job of the class.
+ */
+static void mb_run_class(const uaes_cbc_job_t *jobs, size_t njobs, size_t first)
+{
+  const uaes_cbc_job_t *lead = &jobs[first], *job = NULL;
+  const uaes_engine_t *engine = lead->ctx->engine;
+  const uaes_ctx_t *key[uAES_MB_LANES];
+  uint8_t *blk[uAES_MB_LANES], *iv[uAES_MB_LANES];
+  uint8_t chain[uAES_MB_LANES][uAES_BLOCK_SIZE];
+  mb_lane_t lane[uAES_MB_LANES];
+  size_t active = 0, next = first, idx = 0;
+
+  if(NULL == engine->cbc_encrypt_lanes)
+  {
+    while(NULL != (job = mb_next_job(jobs, njobs, lead, &next)))
+    {
+      memcpy(chain[0], job->iv, uAES_BLOCK_SIZE);
+      uaes_cbc_encrypt_blocks(job->ctx, job->buf, job->buf, job->size / uAES_BLOCK_SIZE, chain[0]);
+    }
+    uaes_wipe(chain[0], uAES_BLOCK_SIZE);
+    return;
+  }
+
+  for(; (active < uAES_MB_LANES) && (NULL != (job = mb_next_job(jobs, njobs, lead, &next))); active++)
+  {
+    lane[active].job = job;
+    lane[active].off = 0;
+    iv[active] = chain[active];
+    memcpy(chain[active], job->iv, uAES_BLOCK_SIZE);
+  }
+
+  while(0 != active)
+  {
+    for(idx = 0; idx < active; idx++)
+    {
+      key[idx] = lane[idx].job->ctx;
+      blk[idx] = &lane[idx].job->buf[lane[idx].off];
+    }
+
+    engine->cbc_encrypt_lanes(key, blk, iv, active);
+
+    for(idx = 0; idx < active; )
+    {
+      lane[idx].off += uAES_BLOCK_SIZE;
+      if(lane[idx].off < lane[idx].job->size)
+      {
+        idx++;
+      }
+      else if(NULL != (job = mb_next_job(jobs, njobs, lead, &next)))
+      {
+        lane[idx].job = job;
+        lane[idx].off = 0;
+        memcpy(chain[idx], job->iv, uAES_BLOCK_SIZE);
+        idx++;
+      }
+      else
+      {
+        /* Class exhausted, the last lane takes the free slot with its chaining value. */
+        active--;
+        if(idx != active)
+        {
+          lane[idx] = lane[active];
+          memcpy(chain[idx], chain[active], uAES_BLOCK_SIZE);
+        }
+      }
+    }
+  }
+  uaes_wipe(chain, sizeof(chain));
+  return;
+}
+
+/**
+ * @brief           Performs AES-CBC encryption of many independent messages in one
+ *                  call. Each job has its own key context, initialisation vector and
+ *                  buffer, and is encrypted in place exactly as uaes_ctx_cbc_encryption()
+ *                  would. Blocks of different jobs whose contexts share an engine and
+ *                  key length go through the rounds together, which hides the latency
+ *                  of the serial CBC chain when the engine supports it (AES-NI, ARMCE).
+ *                  Other engines encrypt the jobs one after the other.
+ * @param jobs      Job array, every job is checked before any is processed.
+ * @param njobs     Number of jobs.
+ * @return int      [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_cbc_encryption_multi(const uaes_cbc_job_t *jobs, size_t njobs)
+{
+  int err = -1;
+  size_t idx = 0, prev = 0;
+
+  if((NULL != jobs) && (0 < njobs))
+  {
+    for(idx = 0; (idx < njobs) && mb_job_valid(&jobs[idx]); idx++);
+    if(idx == njobs)
+    {
+      for(idx = 0; idx < njobs; idx++)
+      {
+        /* Each class is run once, from its first job. */
+        for(prev = 0; (prev < idx) && !mb_same_class(&jobs[prev], &jobs[idx]); prev++);
+        if(prev == idx)
+        {
+          mb_run_class(jobs, njobs, idx);
+        }
+      }
+      err = 0;
+    }
+  }
+
+  return err;
+}
+
+#endif /*uAES_CFG_MULTI*/
@@ -0,0 +1,137 @@
+/**
+ * @file      offload.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     Crypto peripheral offload, routes ECB, CBC and CTR calls to a registered driver.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_OFFLOAD
+
+/*
+ * One driver slot, written by uaes_offload_register() during start-up and
+ * read once per call. The driver only sees calls that fit its declared
+ * capabilities and may still decline any of them, the call then runs on the
+ * context's software engine like it would without a driver.
+ */
+static const uaes_engine_t *volatile offload = NULL;
+
+/* Mode capability of each operation, indexed by uaes_op_t. */
+static const uint8_t offload_mode[] =
+{
+  uAES_CAP_ECB, uAES_CAP_ECB, uAES_CAP_CBC, uAES_CAP_CBC, uAES_CAP_CTR
+};
+
+/**
+ * @brief             Registers the crypto peripheral driver, replacing the previous one.
+ *                    Register before the contexts are used from other threads.
+ * @param engine      Pointer to driver, see engine.h. NULL unregisters the driver.
+ * @return int        [0] if sucessful, [-1] if the driver is incomplete or reports its
+ *                    peripheral as unavailable.
+ */
+int uaes_offload_register(const uaes_engine_t *engine)
+{
+  int err = -1;
+
+  if(NULL == engine)
+  {
+    offload = NULL;
+    err = 0;
+  }
+  else if((uAES_ENGINE_OFFLOAD == engine->id)                                   &&
+          (NULL != engine->available)                                           &&
+          (NULL != engine->process)                                             &&
+          (0 != engine->caps.keys)                                              &&
+          (0 != engine->caps.modes)                                             &&
+          (0 != engine->caps.align)                                             &&
+          (0 == (engine->caps.align & (engine->caps.align - 1U)))               &&
+          engine->available())
+  {
+    offload = engine;
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief             Returns the registered driver.
+ * @return const uaes_engine_t* Driver, NULL if none is registered.
+ */
+const uaes_engine_t *uaes_offload_engine(void)
+{
+  return offload;
+}
+
+/**
+ * @brief             Returns the name of the registered driver.
+ * @return const char* Driver name, NULL if none is registered.
+ */
+const char *uaes_offload_name(void)
+{
+  const uaes_engine_t *engine = offload;
+
+  return (NULL != engine) ? (engine->name) : (NULL);
+}
+
+/**
+ * @brief             Hands a buffer to the driver if it fits its capabilities, the
+ *                    arguments are checked by the caller.
+ * @param ctx         Pointer to key context.
+ * @param op          Operation.
+ * @param out         Pointer to output buffer, may be in.
+ * @param in          Pointer to input buffer.
+ * @param size        Buffer size in bytes.
+ * @param iv          CBC chaining value or CTR counter block, NULL for ECB.
+ * @param ctr_width   CTR counter field size in bytes.
+ * @return int        [0] if the driver processed the buffer, [-1] otherwise.
+ */
+int uaes_offload_run(const uaes_ctx_t *ctx, uaes_op_t op, uint8_t *out, const uint8_t *in, size_t size,
+                     uint8_t *iv, size_t ctr_width)
+{
+  const uaes_engine_t *engine = offload;
+  int err = -1;
+
+  if((NULL != engine)                                                                 &&
+     (0 != ctx->offload)                                                              &&
+     (0 != (engine->caps.keys & (1U << ctx->aes_length)))                             &&
+     (0 != (engine->caps.modes & offload_mode[op]))                                   &&
+     (0 == (((uintptr_t)out | (uintptr_t)in) & ((uintptr_t)engine->caps.align - 1U))) &&
+     (engine->caps.min_size <= size)                                                  &&
+     ((0 == engine->caps.max_size) || (engine->caps.max_size >= size)))
+  {
+    uAES_PROF_START(t0);
+    err = engine->process(ctx, op, out, in, size, iv, ctr_width);
+    if(0 == err)
+    {
+      uAES_PROF_STOP(ctx, uAES_PROF_OFFLOAD, t0);
+    }
+  }
+
+  return err;
+}
+
+#endif /*uAES_CFG_OFFLOAD*/
@@ -31,11 +31,17 @@
 
 #include "udbg.h"
 #include "ops.h"
+#include "luts.h"
 
 #define uAES_MAX_BLOCK_LEN  16
 
+#if uAES_CFG_SBOX_LUT
+const uint8_t uaes_s_box[256]     = { uAES_SBOX_DATA(uAES_LUT_BYTE) };
+const uint8_t uaes_inv_s_box[256] = { uAES_INV_SBOX_DATA(uAES_LUT_BYTE) };
+#else
 static const uint8_t  s_box_fwd_map       = 0x63;
 static const uint8_t  s_box_inv_map       = 0x05;
+#endif /*uAES_CFG_SBOX_LUT*/
 static const uint16_t rijndael_polynomial = 0x11B;
 
 static inline uint32_t rotword( uint32_t word );
@@ -44,9 +50,12 @@ static inline uint32_t inv_word_shift( uint32_t word, size_t nshifts );
 static inline uint8_t  circ_shift( uint8_t byte, size_t nshifts );
 static inline uint8_t  inv_circ_shift( uint8_t byte, size_t nshifts );
 static uint8_t  gf256_mul( uint8_t Na, uint8_t Nb );
+#if !uAES_CFG_SBOX_LUT
 static uint8_t  gf256_inv( uint8_t Na );
+#endif /*uAES_CFG_SBOX_LUT*/
 static uint32_t rcon( uint8_t val );
 static uint8_t  sub_bytes( uint8_t byte );
+static uint8_t  inv_sub_bytes( uint8_t sbyte );
 static uint32_t sub_word( uint32_t word );
 
 /**
@@ -120,6 +129,7 @@ static uint8_t gf256_mul(uint8_t Na, uint8_t Nb)
   return prod;
 }
 
+#if !uAES_CFG_SBOX_LUT
 /**
  * @brief           Computes the inverse multiplier of a given unsigned 8-bit number.
  * @param Na        Unsigned 8-bit number.
@@ -138,6 +148,7 @@ static uint8_t gf256_inv(uint8_t Na)
   }
   return Ninv;
 }
+#endif /*uAES_CFG_SBOX_LUT*/
 
 /**
  * @brief           Computes round constant for key expansion algorithm.
@@ -147,7 +158,7 @@ static uint8_t gf256_inv(uint8_t Na)
 static uint32_t rcon(uint8_t val)
 {
   uint32_t rconst = 0;
-  rconst = (val == 9)?(0x1b000000):((val == 10)?(0x36000000):(0x01000000 << (val - 1)));
+  rconst = (val == 9)?(0x1b):((val == 10)?(0x36):(0x01 << (val - 1)));
   return rconst;
 }
 
@@ -158,9 +169,13 @@ static uint32_t rcon(uint8_t val)
  */
 static uint8_t sub_bytes(uint8_t byte)
 {
+#if uAES_CFG_SBOX_LUT
+  return uaes_s_box[byte];
+#else
   uint8_t sbyte = gf256_inv(byte);
   sbyte = ( sbyte ^ circ_shift(sbyte, 1) ^ circ_shift(sbyte, 2) ^ circ_shift(sbyte, 3) ^ circ_shift(sbyte, 4) ) ^ s_box_fwd_map;
   return sbyte;
+#endif /*uAES_CFG_SBOX_LUT*/
 }
 
 /**
@@ -170,9 +185,13 @@ static uint8_t sub_bytes(uint8_t byte)
  */
 static uint8_t inv_sub_bytes(uint8_t sbyte)
 {
+#if uAES_CFG_SBOX_LUT
+  return uaes_inv_s_box[sbyte];
+#else
   uint8_t byte = ( circ_shift(sbyte, 1) ^ circ_shift(sbyte, 3) ^ circ_shift(sbyte, 6) ) ^ s_box_inv_map;
   byte = gf256_inv(byte);
   return byte;
+#endif /*uAES_CFG_SBOX_LUT*/
 }
 
 /**
@@ -354,6 +373,42 @@ void key_expansion(uint8_t *key, uint32_t *keysched, size_t Nk, size_t Ns)
   return;
 }
 
+/**
+ * @brief               Derives the decryption key schedule for the equivalent inverse cipher (FIPS-197 5.3.5).
+ *                      Round keys are stored in the order they are consumed, so decryption walks the
+ *                      schedule forwards exactly like encryption does: round 0 gets the last encryption
+ *                      round key, rounds 1 to Nr-1 get InvMixColumns of the matching encryption round key.
+ * @param keysched      Pointer to the first element of the encryption key schedule array.
+ * @param inv_keysched  Pointer to the first element of the decryption key schedule array.
+ * @param Nr            Number of rounds.
+ */
+void inv_key_expansion(const uint32_t *keysched, uint32_t *inv_keysched, size_t Nr)
+{
+  uint8_t rkey[uAES_MAX_BLOCK_LEN] = {0};
+
+  for(size_t round = 0; round <= Nr; round++)
+  {
+    memcpy(&inv_keysched[4*round], &keysched[4*(Nr - round)], sizeof(rkey));
+    if( ( 0 < round ) && ( Nr > round ) )
+    {
+      for(size_t C = 0; C < 4; C++)
+      {
+        for (size_t R = 0; R < 4; R++)
+        {
+          rkey[4*C + R] = ( uint8_t )( inv_keysched[4*round + C] >> 8 * R );
+        }
+      }
+      inv_mix_columns(rkey, 4);
+      for(size_t C = 0; C < 4; C++)
+      {
+        inv_keysched[4*round + C] = ( uint32_t )( rkey[4*C] | rkey[4*C + 1] << 8 | rkey[4*C + 2] << 16 | (uint32_t)rkey[4*C + 3] << 24 );
+      }
+    }
+  }
+  uAES_TRACE(uAES_TRACE_MSK_KEXP, "Inverse key schedule computed!");
+  return;
+}
+
 /**
  * @brief           Computes round key addition on given data block.
  * @param block     Pointer to the first element from the data block array.
@@ -361,7 +416,7 @@ void key_expansion(uint8_t *key, uint32_t *keysched, size_t Nk, size_t Ns)
  * @param round     Correspondent encryption/decryption round.
  * @param Nb        Number of 32-bit words present on data block array.
  */
-void add_round_key(uint8_t *block, uint32_t *keysched, size_t round, size_t Nb)
+void add_round_key(uint8_t *block, const uint32_t *keysched, size_t round, size_t Nb)
 {
   uint8_t keyidx = round * Nb;
   uint32_t tmp = 0;   
@@ -27,6 +27,13 @@
 #ifndef OPS_H
 #define OPS_H
 
+#include "uaes_config.h"
+
+#if uAES_CFG_SBOX_LUT
+extern const uint8_t uaes_s_box[256];
+extern const uint8_t uaes_inv_s_box[256];
+#endif /*uAES_CFG_SBOX_LUT*/
+
 extern void sub_block(uint8_t* block, size_t Nb);
 extern void inv_sub_block(uint8_t* block, size_t Nb);
 extern void shift_rows(uint8_t* block, size_t Nb);
@@ -34,6 +41,14 @@ extern void inv_shift_rows(uint8_t* block, size_t Nb);
 extern void mix_columns(uint8_t* block, size_t Nb);
 extern void inv_mix_columns(uint8_t* block, size_t Nb);
 extern void key_expansion(uint8_t* key, uint32_t* keysched, size_t Nk, size_t Ns);
-extern void add_round_key(uint8_t* block, uint32_t* keysched, size_t round, size_t Nb);
+extern void inv_key_expansion(const uint32_t* keysched, uint32_t* inv_keysched, size_t Nr);
+extern void add_round_key(uint8_t* block, const uint32_t* keysched, size_t round, size_t Nb);
+
+#if uAES_CFG_TTABLE
+extern void ttable_encrypt_block(uint8_t* block, const uint32_t* keysched, size_t Nr);
+extern void ttable_decrypt_block(uint8_t* block, const uint32_t* inv_keysched, size_t Nr);
+extern void ttable_encrypt_blocks(uint8_t* blocks, const uint32_t* keysched, size_t Nr, size_t nblocks);
+extern void ttable_decrypt_blocks(uint8_t* blocks, const uint32_t* inv_keysched, size_t Nr, size_t nblocks);
+#endif /*uAES_CFG_TTABLE*/
 
 #endif /*OPS_H*/
@@ -0,0 +1,485 @@
+/**
+ * @file      pool.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     Worker pool for bulk ECB, CTR and CBC decryption.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_THREADS
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+/*
+ * A buffer is cut into uAES_CFG_MT_CHUNK pieces (whole sectors for XTS) and
+ * every participant (the workers plus the calling thread) is dealt a
+ * contiguous run of them. Each one takes chunks from the front of its own
+ * run, so it reads memory sequentially, and once it is empty steals from the
+ * back of the other runs. All threads share the caller's key context, it is
+ * only read.
+ */
+
+#define uAES_POOL_CHUNK_BLKS  ( uAES_CFG_MT_CHUNK / uAES_BLOCK_SIZE )
+#define uAES_POOL_CBC_CHUNKS  ( 2UL * (uAES_CFG_THREADS + 1UL) )     // CBC chunks per round.
+
+typedef enum
+{
+  uAES_POOL_ECB_ENC = 0,
+  uAES_POOL_ECB_DEC,
+  uAES_POOL_CBC_DEC,
+  uAES_POOL_CTR,
+  uAES_POOL_XTS_ENC,
+  uAES_POOL_XTS_DEC,
+}uaes_pool_op_t;
+
+typedef struct
+{
+  uaes_pool_op_t    op;
+  const uaes_ctx_t  *ctx;
+  uint8_t           *buf;
+  size_t            size;               // Bytes, whole blocks except for CTR.
+  size_t            unit;               // Chunk size, uAES_CFG_MT_CHUNK except for XTS.
+  const uint8_t     (*iv)[16];          // CBC chaining value of each chunk.
+  const uint8_t     *ctr_blk;           // CTR counter block of chunk 0.
+  size_t            ctr_width;
+  const uaes_ctx_t  *tweak_ctx;         // XTS tweak key context.
+  size_t            sector_size;        // XTS sector size, unit is a multiple of it.
+  uint64_t          sector;             // XTS number of the first sector.
+}uaes_pool_job_t;
+
+/* Run of chunks [head, tail) packed as head << 32 | tail, one per cache line. */
+typedef struct
+{
+  _Atomic uint64_t  run;
+  uint8_t           pad[64 - sizeof(uint64_t)];
+}uaes_pool_run_t;
+
+static struct
+{
+  pthread_mutex_t         submit;       // One job at a time.
+  pthread_mutex_t         lock;
+  pthread_cond_t          wake;
+  pthread_cond_t          done;
+  pthread_t               thread[uAES_CFG_THREADS];
+  size_t                  nthreads;
+  int                     running;
+  unsigned long           generation;
+  unsigned long           first;        // Generation when the workers were started.
+  size_t                  busy;         // Workers still inside the current job.
+  const uaes_pool_job_t   *job;
+  uaes_pool_run_t         run[uAES_CFG_THREADS + 1];
+}pool =
+{
+  .submit = PTHREAD_MUTEX_INITIALIZER,
+  .lock   = PTHREAD_MUTEX_INITIALIZER,
+  .wake   = PTHREAD_COND_INITIALIZER,
+  .done   = PTHREAD_COND_INITIALIZER,
+};
+
+/**
+ * @brief         Processes one chunk of a job.
+ * @param job     Pointer to job.
+ * @param chunk   Chunk index.
+ */
+static void uaes_pool_chunk(const uaes_pool_job_t *job, size_t chunk)
+{
+  const size_t offset = chunk * job->unit;
+  const size_t len = ( (job->size - offset) < job->unit ) ? (job->size - offset) : (job->unit);
+  uint8_t *buf = &job->buf[offset];
+  uint8_t blk[uAES_BLOCK_SIZE];
+
+  switch(job->op)
+  {
+    case uAES_POOL_ECB_ENC:
+      job->ctx->engine->encrypt(job->ctx, buf, buf, len / uAES_BLOCK_SIZE);
+      break;
+    case uAES_POOL_ECB_DEC:
+      job->ctx->engine->decrypt(job->ctx, buf, buf, len / uAES_BLOCK_SIZE);
+      break;
+    case uAES_POOL_CBC_DEC:
+      memcpy(blk, job->iv[chunk], uAES_BLOCK_SIZE);
+      uaes_cbc_decrypt_blocks(job->ctx, buf, buf, len / uAES_BLOCK_SIZE, blk);
+      break;
+#if uAES_CFG_CTR
+    case uAES_POOL_CTR:
+      memcpy(blk, job->ctr_blk, uAES_BLOCK_SIZE);
+      uaes_ctr_add(blk, job->ctr_width, chunk * uAES_POOL_CHUNK_BLKS);
+      uaes_ctr_xor(job->ctx, buf, len, blk, job->ctr_width);
+      break;
+#endif /*uAES_CFG_CTR*/
+#if uAES_CFG_XTS
+    case uAES_POOL_XTS_ENC:
+    case uAES_POOL_XTS_DEC:
+      uaes_xts_sectors(job->ctx, job->tweak_ctx, buf, len / job->sector_size, job->sector_size,
+                       job->sector, (uint64_t)(offset / job->sector_size), (uAES_POOL_XTS_DEC == job->op) ? (1) : (0));
+      break;
+#endif /*uAES_CFG_XTS*/
+    default:
+      break;
+  }
+  return;
+}
+
+/**
+ * @brief         Takes a chunk from the front of a run, or from its back when stealing.
+ * @param run     Pointer to run.
+ * @param steal   [0] front, [1] back.
+ * @param chunk   Receives the chunk index.
+ * @return int    [1] if a chunk was taken, [0] if the run is empty.
+ */
+static int uaes_pool_take(uaes_pool_run_t *run, int steal, size_t *chunk)
+{
+  uint64_t cur = atomic_load_explicit(&run->run, memory_order_relaxed);
+  uint64_t head = 0, tail = 0;
+
+  do
+  {
+    head = cur >> 32;
+    tail = cur & 0xFFFFFFFFULL;
+    if(head >= tail)
+    {
+      return 0;
+    }
+    *chunk = (size_t)( steal ? (tail - 1ULL) : (head) );
+  }while(!atomic_compare_exchange_weak_explicit(&run->run, &cur,
+                                                steal ? ((head << 32) | (tail - 1ULL)) : (((head + 1ULL) << 32) | tail),
+                                                memory_order_relaxed, memory_order_relaxed));
+  return 1;
+}
+
+/**
+ * @brief         Runs chunks of the current job until every run is empty.
+ * @param job     Pointer to job.
+ * @param self    Index of the caller's own run.
+ */
+static void uaes_pool_work(const uaes_pool_job_t *job, size_t self)
+{
+  const size_t nruns = pool.nthreads + 1UL;
+  size_t chunk = 0;
+
+  while(uaes_pool_take(&pool.run[self], 0, &chunk))
+  {
+    uaes_pool_chunk(job, chunk);
+  }
+  for(size_t victim = 1; victim < nruns; victim++)
+  {
+    while(uaes_pool_take(&pool.run[(self + victim) % nruns], 1, &chunk))
+    {
+      uaes_pool_chunk(job, chunk);
+    }
+  }
+  return;
+}
+
+static void *uaes_pool_worker(void *arg)
+{
+  const size_t self = (size_t)(uintptr_t)arg;
+  unsigned long seen = 0;
+  const uaes_pool_job_t *job = NULL;
+
+  pthread_mutex_lock(&pool.lock);
+  seen = pool.first;
+  while(pool.running)
+  {
+    if(seen == pool.generation)
+    {
+      pthread_cond_wait(&pool.wake, &pool.lock);
+      continue;
+    }
+    seen = pool.generation;
+    job = pool.job;
+    pthread_mutex_unlock(&pool.lock);
+
+    uaes_pool_work(job, self);
+
+    pthread_mutex_lock(&pool.lock);
+    if(0 == --pool.busy)
+    {
+      pthread_cond_signal(&pool.done);
+    }
+  }
+  pthread_mutex_unlock(&pool.lock);
+  return NULL;
+}
+
+/**
+ * @brief         Splits a job into chunks and runs it on the workers and the calling thread.
+ * @param job     Pointer to job, job->size is at least uAES_CFG_MT_MIN_SIZE.
+ */
+static void uaes_pool_run(const uaes_pool_job_t *job)
+{
+  const size_t nchunks = ( job->size + job->unit - 1UL ) / job->unit;
+  const size_t nruns = pool.nthreads + 1UL;
+  uint64_t head = 0, tail = 0;
+
+  pthread_mutex_lock(&pool.lock);
+  for(size_t idx = 0; idx < nruns; idx++)
+  {
+    head = (uint64_t)( (nchunks * idx) / nruns );
+    tail = (uint64_t)( (nchunks * (idx + 1UL)) / nruns );
+    atomic_store_explicit(&pool.run[idx].run, (head << 32) | tail, memory_order_relaxed);
+  }
+  pool.job  = job;
+  pool.busy = pool.nthreads;
+  pool.generation++;
+  pthread_cond_broadcast(&pool.wake);
+  pthread_mutex_unlock(&pool.lock);
+
+  uaes_pool_work(job, pool.nthreads);
+
+  pthread_mutex_lock(&pool.lock);
+  while(0 != pool.busy)
+  {
+    pthread_cond_wait(&pool.done, &pool.lock);
+  }
+  pool.job = NULL;
+  pthread_mutex_unlock(&pool.lock);
+  return;
+}
+
+/**
+ * @brief               Starts the worker pool. Only one pool exists per process, calls on
+ *                      buffers of uAES_CFG_MT_MIN_SIZE or more are then spread over it.
+ * @param nthreads      Worker threads besides the calling thread, [0] for one less than the
+ *                      online cores. Clamped to uAES_CFG_THREADS.
+ * @return int          [0] if sucessful, [-1] if the pool is already running or a thread
+ *                      could not be created.
+ */
+int uaes_pool_start(size_t nthreads)
+{
+  int err = -1;
+  int started = 0;
+  long cores = 0;
+
+  if(0 == nthreads)
+  {
+    cores = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = ( cores > 1L ) ? ((size_t)cores - 1UL) : (0UL);
+  }
+  if(uAES_CFG_THREADS < nthreads)
+  {
+    nthreads = uAES_CFG_THREADS;
+  }
+
+  pthread_mutex_lock(&pool.submit);
+  if(0 == pool.running)
+  {
+    pool.running  = 1;
+    pool.nthreads = 0;
+    pool.first    = pool.generation;
+    started = 1;
+    err = 0;
+    for(size_t idx = 0; idx < nthreads; idx++)
+    {
+      if(0 != pthread_create(&pool.thread[idx], NULL, uaes_pool_worker, (void *)(uintptr_t)idx))
+      {
+        err = -1;
+        break;
+      }
+      pool.nthreads++;
+    }
+  }
+  pthread_mutex_unlock(&pool.submit);
+
+  if(started && (0 != err))
+  {
+    uaes_pool_stop();
+  }
+  return err;
+}
+
+/**
+ * @brief Stops the worker pool and joins its threads, waiting for a job in progress.
+ */
+void uaes_pool_stop(void)
+{
+  pthread_mutex_lock(&pool.submit);
+  pthread_mutex_lock(&pool.lock);
+  pool.running = 0;
+  pthread_cond_broadcast(&pool.wake);
+  pthread_mutex_unlock(&pool.lock);
+  for(size_t idx = 0; idx < pool.nthreads; idx++)
+  {
+    pthread_join(pool.thread[idx], NULL);
+  }
+  pool.nthreads = 0;
+  pthread_mutex_unlock(&pool.submit);
+  return;
+}
+
+/**
+ * @brief         Runs a job if the pool is running and the buffer is large enough.
+ *                A pool busy with the job of another thread is not waited for,
+ *                the caller runs its own buffer instead so concurrent callers
+ *                never queue behind each other.
+ * @param job     Pointer to job.
+ * @return int    [0] if the job ran, [-1] otherwise.
+ */
+static int uaes_pool_submit(const uaes_pool_job_t *job)
+{
+  int err = -1;
+
+  if((uAES_CFG_MT_MIN_SIZE <= job->size) && (0 == pthread_mutex_trylock(&pool.submit)))
+  {
+    if(0 != pool.running)
+    {
+      uaes_pool_run(job);
+      err = 0;
+    }
+    pthread_mutex_unlock(&pool.submit);
+  }
+  return err;
+}
+
+int uaes_pool_ecb(const uaes_ctx_t *ctx, uint8_t *buf, size_t nblocks, int decrypt)
+{
+  const uaes_pool_job_t job =
+  {
+    .op   = decrypt ? uAES_POOL_ECB_DEC : uAES_POOL_ECB_ENC,
+    .ctx  = ctx,
+    .buf  = buf,
+    .size = uAES_BLOCK_SIZE * nblocks,
+    .unit = uAES_CFG_MT_CHUNK,
+  };
+
+  return uaes_pool_submit(&job);
+}
+
+/*
+ * CBC chunks are decrypted in place, so the chaining block of each one is
+ * saved before the round starts. Rounds of uAES_POOL_CBC_CHUNKS chunks keep
+ * that copy small enough for the stack, a tail too small for the pool is
+ * run by the calling thread.
+ */
+int uaes_pool_cbc_decrypt(const uaes_ctx_t *ctx, uint8_t *buf, size_t nblocks, uint8_t *iv)
+{
+  int err = -1;
+  uint8_t chain[uAES_POOL_CBC_CHUNKS][16];
+  size_t size = uAES_BLOCK_SIZE * nblocks;
+  size_t nchunks = 0;
+  uaes_pool_job_t job =
+  {
+    .op   = uAES_POOL_CBC_DEC,
+    .ctx  = ctx,
+    .unit = uAES_CFG_MT_CHUNK,
+    .iv   = (const uint8_t (*)[16])chain,
+  };
+
+  if((uAES_CFG_MT_MIN_SIZE <= size) && (uAES_MAX_INPUT_SIZE >= size) && (0 == pthread_mutex_trylock(&pool.submit)))
+  {
+    if(0 != pool.running)
+    {
+      while(0 < size)
+      {
+        job.buf  = buf;
+        job.size = ( size < (uAES_POOL_CBC_CHUNKS * uAES_CFG_MT_CHUNK) ) ? (size) : (uAES_POOL_CBC_CHUNKS * uAES_CFG_MT_CHUNK);
+        nchunks  = ( job.size + uAES_CFG_MT_CHUNK - 1UL ) / uAES_CFG_MT_CHUNK;
+        memcpy(chain[0], iv, uAES_BLOCK_SIZE);
+        for(size_t idx = 1; idx < nchunks; idx++)
+        {
+          memcpy(chain[idx], &buf[(uAES_CFG_MT_CHUNK * idx) - uAES_BLOCK_SIZE], uAES_BLOCK_SIZE);
+        }
+        memcpy(iv, &buf[job.size - uAES_BLOCK_SIZE], uAES_BLOCK_SIZE);
+        if(uAES_CFG_MT_MIN_SIZE <= job.size)
+        {
+          uaes_pool_run(&job);
+        }
+        else
+        {
+          uaes_cbc_decrypt_blocks(ctx, buf, buf, job.size / uAES_BLOCK_SIZE, chain[0]);
+        }
+        buf  += job.size;
+        size -= job.size;
+      }
+      err = 0;
+    }
+    pthread_mutex_unlock(&pool.submit);
+  }
+  return err;
+}
+
+#if uAES_CFG_CTR
+int uaes_pool_ctr(const uaes_ctx_t *ctx, uint8_t *buf, size_t size, uint8_t *ctr_blk, size_t ctr_width)
+{
+  int err = -1;
+  const uaes_pool_job_t job =
+  {
+    .op         = uAES_POOL_CTR,
+    .ctx        = ctx,
+    .buf        = buf,
+    .size       = size,
+    .unit       = uAES_CFG_MT_CHUNK,
+    .ctr_blk    = ctr_blk,
+    .ctr_width  = ctr_width,
+  };
+
+  err = uaes_pool_submit(&job);
+  if(0 == err)
+  {
+    uaes_ctr_add(ctr_blk, ctr_width, ( size + uAES_BLOCK_SIZE - 1UL ) / uAES_BLOCK_SIZE);
+  }
+  return err;
+}
+#endif /*uAES_CFG_CTR*/
+
+#if uAES_CFG_XTS
+int uaes_pool_xts(const uaes_ctx_t *ctx, const uaes_ctx_t *tweak_ctx, uint8_t *buf, size_t size,
+                  size_t sector_size, uint64_t sector, int decrypt)
+{
+  /* Chunks hold whole sectors, at least one. */
+  const uaes_pool_job_t job =
+  {
+    .op           = decrypt ? uAES_POOL_XTS_DEC : uAES_POOL_XTS_ENC,
+    .ctx          = ctx,
+    .buf          = buf,
+    .size         = size,
+    .unit         = ( sector_size < uAES_CFG_MT_CHUNK ) ? (sector_size * (uAES_CFG_MT_CHUNK / sector_size)) : (sector_size),
+    .tweak_ctx    = tweak_ctx,
+    .sector_size  = sector_size,
+    .sector       = sector,
+  };
+
+  return uaes_pool_submit(&job);
+}
+#endif /*uAES_CFG_XTS*/
+
+#else
+
+int uaes_pool_start(size_t nthreads)
+{
+  (void)nthreads;
+  return -1;
+}
+
+void uaes_pool_stop(void)
+{
+  return;
+}
+
+#endif /*uAES_CFG_THREADS*/
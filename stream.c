@@ -0,0 +1,334 @@
+/**
+ * @file      stream.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     Streaming init/update/final API for CBC and CTR.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_STREAM
+
+/**
+ * @brief         Runs whole CBC blocks, in place when out equals in.
+ * @param st      Pointer to stream state.
+ * @param out     Pointer to output blocks.
+ * @param in      Pointer to input blocks.
+ * @param nblocks Number of 16-byte blocks.
+ */
+static void stream_cbc_blocks(uaes_stream_t *st, uint8_t *out, const uint8_t *in, size_t nblocks)
+{
+  if((uAES_STREAM_CBC_ENCRYPT == st->mode) || (uAES_STREAM_CBC_ENCRYPT_PKCS7 == st->mode))
+  {
+    uaes_cbc_encrypt_blocks(st->ctx, out, in, nblocks, st->iv);
+  }
+  else if((out != in) || (0 != uaes_pool_cbc_decrypt(st->ctx, out, nblocks, st->iv)))
+  {
+    uaes_cbc_decrypt_blocks(st->ctx, out, in, nblocks, st->iv);
+  }
+  return;
+}
+
+/**
+ * @brief         CBC update, input bytes short of a block are kept in the state.
+ *                PKCS#7 decryption also keeps the last whole block, final() strips
+ *                the padding from it.
+ * @param st      Pointer to stream state.
+ * @param out     Pointer to output buffer.
+ * @param in      Pointer to input data.
+ * @param size    Input size.
+ * @return size_t Bytes written to out.
+ */
+static size_t stream_cbc_update(uaes_stream_t *st, uint8_t *out, const uint8_t *in, size_t size)
+{
+  const int hold = ( uAES_STREAM_CBC_DECRYPT_PKCS7 == st->mode ) ? (1) : (0);
+  size_t done = 0, n = 0;
+
+  /* Complete the block left open by the previous call. */
+  if(0 != st->fill)
+  {
+    n = ( size < (uAES_BLOCK_SIZE - st->fill) ) ? (size) : (uAES_BLOCK_SIZE - st->fill);
+    memcpy(&st->part[st->fill], in, n);
+    st->fill += n;
+    in   += n;
+    size -= n;
+    if((uAES_BLOCK_SIZE == st->fill) && ((0 == hold) || (0 != size)))
+    {
+      stream_cbc_blocks(st, out, st->part, 1UL);
+      st->fill = 0;
+      done = uAES_BLOCK_SIZE;
+    }
+  }
+
+  n = size / uAES_BLOCK_SIZE;
+  if((0 != hold) && (0 != n) && (0 == (size % uAES_BLOCK_SIZE)))
+  {
+    n--;
+  }
+  if(0 != n)
+  {
+    stream_cbc_blocks(st, &out[done], in, n);
+    done += n * uAES_BLOCK_SIZE;
+    in   += n * uAES_BLOCK_SIZE;
+    size -= n * uAES_BLOCK_SIZE;
+  }
+
+  if(0 != size)
+  {
+    memcpy(st->part, in, size);
+    st->fill = size;
+  }
+  return done;
+}
+
+/**
+ * @brief         Ends a PKCS#7 message, encryption pads the last input bytes to a
+ *                whole block and outputs it, decryption checks the padding of the
+ *                held back block without branching on its bytes and outputs the rest.
+ * @param st      Pointer to stream state.
+ * @param out     Pointer to output buffer, 16 bytes.
+ * @param out_len Receives the number of bytes written to out.
+ * @return int    [0] if sucessful, [-1] if the input did not end on a whole block
+ *                (decryption) or the padding is invalid.
+ */
+static int stream_pkcs7_final(uaes_stream_t *st, uint8_t *out, size_t *out_len)
+{
+  int err = -1;
+  uint8_t pad = 0, bad = 0;
+
+  if(uAES_STREAM_CBC_ENCRYPT_PKCS7 == st->mode)
+  {
+    pad = (uint8_t)(uAES_BLOCK_SIZE - st->fill);
+    memset(&st->part[st->fill], pad, pad);
+    stream_cbc_blocks(st, out, st->part, 1UL);
+    *out_len = uAES_BLOCK_SIZE;
+    err = 0;
+  }
+  else if(uAES_BLOCK_SIZE == st->fill)
+  {
+    stream_cbc_blocks(st, st->part, st->part, 1UL);
+    pad = st->part[uAES_BLOCK_SIZE - 1UL];
+    bad = (uint8_t)( ( (unsigned int)pad - 1U ) >> 8 );              /* pad == 0 */
+    bad |= (uint8_t)( ( uAES_BLOCK_SIZE - (unsigned int)pad ) >> 8 ); /* pad > 16 */
+    for(size_t idx = 0; idx < uAES_BLOCK_SIZE; idx++)
+    {
+      /* Bytes at or past 16 - pad must all equal pad. */
+      const uint8_t in_pad = (uint8_t)( ( (unsigned int)idx + pad - uAES_BLOCK_SIZE ) >> 8 ) ^ 0xFFU;
+
+      bad |= in_pad & ( st->part[idx] ^ pad );
+    }
+    if(0 == bad)
+    {
+      memcpy(out, st->part, uAES_BLOCK_SIZE - pad);
+      *out_len = uAES_BLOCK_SIZE - pad;
+      err = 0;
+    }
+  }
+  return err;
+}
+
+#if uAES_CFG_CTR
+/**
+ * @brief         CTR update, the keystream left over from a partial block is kept
+ *                in the state for the next call.
+ * @param st      Pointer to stream state.
+ * @param out     Pointer to output buffer.
+ * @param in      Pointer to input data.
+ * @param size    Input size.
+ * @return size_t Bytes written to out, always size.
+ */
+static size_t stream_ctr_update(uaes_stream_t *st, uint8_t *out, const uint8_t *in, size_t size)
+{
+  size_t done = 0, n = 0;
+
+  if(0 != st->fill)
+  {
+    n = ( size < (uAES_BLOCK_SIZE - st->fill) ) ? (size) : (uAES_BLOCK_SIZE - st->fill);
+    for(size_t idx = 0; idx < n; idx++)
+    {
+      out[idx] = in[idx] ^ st->part[st->fill++];
+    }
+    st->fill = ( uAES_BLOCK_SIZE == st->fill ) ? (0UL) : (st->fill);
+    done = n;
+  }
+
+  n = (size - done) & ~(uAES_BLOCK_SIZE - 1UL);
+  if(0 != n)
+  {
+    if(out != in)
+    {
+      memmove(&out[done], &in[done], n);
+    }
+    if(0 != uaes_pool_ctr(st->ctx, &out[done], n, st->iv, st->ctr_width))
+    {
+      uaes_ctr_xor(st->ctx, &out[done], n, st->iv, st->ctr_width);
+    }
+    done += n;
+  }
+
+  if(done < size)
+  {
+    memset(st->part, 0x00, uAES_BLOCK_SIZE);
+    uaes_ctr_xor(st->ctx, st->part, uAES_BLOCK_SIZE, st->iv, st->ctr_width);
+    for(; done < size; done++)
+    {
+      out[done] = in[done] ^ st->part[st->fill++];
+    }
+  }
+  return done;
+}
+#endif /*uAES_CFG_CTR*/
+
+/**
+ * @brief           Starts a streaming message. The key context is only read, and must
+ *                  outlive the message.
+ * @param st        Pointer to stream state.
+ * @param ctx       Pointer to key context, uAES_CTX_DECRYPT for both CBC decryption
+ *                  modes, uAES_CTX_ENCRYPT otherwise.
+ * @param mode      Streaming mode.
+ * @param iv        16-byte initialisation vector (CBC) or counter block (CTR).
+ * @param ctr_width CTR counter field size in bytes, 1 to 16, ignored by CBC.
+ * @return int      [0] if sucessful, [-1] on failure.
+ */
+int uaes_stream_init(uaes_stream_t *st, const uaes_ctx_t *ctx, uaes_stream_mode_t mode, const uint8_t *iv, size_t ctr_width)
+{
+  int err = -1;
+  const uint8_t usage = ( (uAES_STREAM_CBC_DECRYPT == mode) || (uAES_STREAM_CBC_DECRYPT_PKCS7 == mode) ) ?
+                        (uAES_CTX_DECRYPT) : (uAES_CTX_ENCRYPT);
+
+  if((NULL != st)                                 &&
+     (NULL != ctx)                                &&
+     (0 != (ctx->usage & usage))                  &&
+     (uAES_STREAM_RGE > mode)                     &&
+     (uAES_CFG_CTR || (uAES_STREAM_CTR != mode))  &&
+     (NULL != iv)                                 &&
+     ((uAES_STREAM_CTR != mode) || ((0 < ctr_width) && (uAES_BLOCK_SIZE >= ctr_width))))
+  {
+    uaes_wipe(st, sizeof(*st));
+    st->ctx  = ctx;
+    st->mode = mode;
+    st->ctr_width = ctr_width;
+    memcpy(st->iv, iv, uAES_BLOCK_SIZE);
+#if uAES_CFG_CTR
+    if(uAES_STREAM_CTR == mode)
+    {
+      st->ctr_left = uaes_ctr_left(iv, ctr_width);
+    }
+#endif /*uAES_CFG_CTR*/
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief           Processes the next bytes of the message. CBC outputs every block
+ *                  completed so far and keeps the rest, so out needs room for size
+ *                  plus 15 bytes and may only equal in while the sizes fed are block
+ *                  multiples. PKCS#7 decryption holds one more block back, out then
+ *                  needs room for size plus 16 bytes and must not overlap in.
+ *                  CTR outputs size bytes and works in place at any size.
+ * @param st        Pointer to stream state.
+ * @param out       Pointer to output buffer.
+ * @param in        Pointer to input data.
+ * @param size      Input size, any value.
+ * @param out_len   Receives the number of bytes written to out.
+ * @return int      [0] if sucessful, [-1] on failure or if the CTR counter field
+ *                  would wrap around, counting from the counter block given to
+ *                  uaes_stream_init().
+ */
+int uaes_stream_update(uaes_stream_t *st, uint8_t *out, const uint8_t *in, size_t size, size_t *out_len)
+{
+  int err = -1;
+
+  if((NULL != st)                                 &&
+     (NULL != st->ctx)                            &&
+     (NULL != out_len)                            &&
+     (((NULL != out) && (NULL != in)) || (0 == size)))
+  {
+    *out_len = 0;
+    if(uAES_STREAM_CTR != st->mode)
+    {
+      *out_len = stream_cbc_update(st, out, in, size);
+      err = 0;
+    }
+#if uAES_CFG_CTR
+    else
+    {
+      /* Counter blocks this call starts, the open block is already counted. */
+      const size_t left = (uAES_BLOCK_SIZE - st->fill) % uAES_BLOCK_SIZE;
+      uint64_t blocks = 0;
+
+      if(size > left)
+      {
+        blocks = ((uint64_t)(size - left) + uAES_BLOCK_SIZE - 1ULL) / uAES_BLOCK_SIZE;
+      }
+      if(blocks <= st->ctr_left)
+      {
+        st->ctr_left -= blocks;
+        *out_len = stream_ctr_update(st, out, in, size);
+        err = 0;
+      }
+    }
+#endif /*uAES_CFG_CTR*/
+  }
+
+  return err;
+}
+
+/**
+ * @brief           Ends a streaming message, the state is wiped.
+ * @param st        Pointer to stream state.
+ * @param out       Pointer to output buffer for the last bytes, 16 bytes for the PKCS#7
+ *                  modes (the padded block, or the last plaintext bytes with the
+ *                  padding removed), unused by CBC and CTR since update already
+ *                  output everything.
+ * @param out_len   Receives the number of bytes written to out.
+ * @return int      [0] if sucessful, [-1] on failure, if CBC input ended short of
+ *                  a whole block or if the PKCS#7 padding is invalid.
+ */
+int uaes_stream_final(uaes_stream_t *st, uint8_t *out, size_t *out_len)
+{
+  int err = -1;
+
+  if((NULL != st) && (NULL != st->ctx) && (NULL != out_len))
+  {
+    *out_len = 0;
+    if((uAES_STREAM_CBC_ENCRYPT_PKCS7 == st->mode) || (uAES_STREAM_CBC_DECRYPT_PKCS7 == st->mode))
+    {
+      err = ( NULL != out ) ? (stream_pkcs7_final(st, out, out_len)) : (-1);
+    }
+    else if((uAES_STREAM_CTR == st->mode) || (0 == st->fill))
+    {
+      err = 0;
+    }
+    uaes_wipe(st, sizeof(*st));
+  }
+
+  return err;
+}
+
+#endif /*uAES_CFG_STREAM*/
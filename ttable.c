@@ -0,0 +1,353 @@
+/**
+ * @file      ttable.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     32-bit T-table round engine, merges SubBytes, ShiftRows and MixColumns in table lookups.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "udbg.h"
+#include "ops.h"
+#include "luts.h"
+
+#if uAES_CFG_TTABLE
+
+/*
+ * State layout: column C of the block is held in word s[C], row R of that
+ * column in bits 8R..8R+7. This is the same packing key_expansion() uses, so
+ * round keys are XORed in without any byte shuffling.
+ */
+#define GET_U32_LE(p)   uAES_BYTES2WORD((p)[0], (p)[1], (p)[2], (p)[3])
+#define PUT_U32_LE(p, w) do {                                   \
+  (p)[0] = (uint8_t)(w);                                        \
+  (p)[1] = (uint8_t)((w) >> 8);                                 \
+  (p)[2] = (uint8_t)((w) >> 16);                                \
+  (p)[3] = (uint8_t)((w) >> 24);                                \
+} while(0)
+
+#define ROTL8(w)        ( ((w) << 8) | ((w) >> 24) )
+#define B0(w)           ( (uint8_t)(w) )
+#define B1(w)           ( (uint8_t)((w) >> 8) )
+#define B2(w)           ( (uint8_t)((w) >> 16) )
+#define B3(w)           ( (uint8_t)((w) >> 24) )
+
+static const uint32_t ft0[256] = { uAES_SBOX_DATA(uAES_FT0) };
+#if (uAES_CFG_TTABLE == 4)
+static const uint32_t ft1[256] = { uAES_SBOX_DATA(uAES_FT1) };
+static const uint32_t ft2[256] = { uAES_SBOX_DATA(uAES_FT2) };
+static const uint32_t ft3[256] = { uAES_SBOX_DATA(uAES_FT3) };
+#define FT0(x)          ( ft0[x] )
+#define FT1(x)          ( ft1[x] )
+#define FT2(x)          ( ft2[x] )
+#define FT3(x)          ( ft3[x] )
+#else
+#define FT0(x)          ( ft0[x] )
+#define FT1(x)          ( ROTL8(ft0[x]) )
+#define FT2(x)          ( ROTL8(ROTL8(ft0[x])) )
+#define FT3(x)          ( ROTL8(ROTL8(ROTL8(ft0[x]))) )
+#endif /*uAES_CFG_TTABLE*/
+
+static const uint32_t it0[256] = { uAES_INV_SBOX_DATA(uAES_IT0) };
+#if (uAES_CFG_TTABLE == 4)
+static const uint32_t it1[256] = { uAES_INV_SBOX_DATA(uAES_IT1) };
+static const uint32_t it2[256] = { uAES_INV_SBOX_DATA(uAES_IT2) };
+static const uint32_t it3[256] = { uAES_INV_SBOX_DATA(uAES_IT3) };
+#define IT0(x)          ( it0[x] )
+#define IT1(x)          ( it1[x] )
+#define IT2(x)          ( it2[x] )
+#define IT3(x)          ( it3[x] )
+#else
+#define IT0(x)          ( it0[x] )
+#define IT1(x)          ( ROTL8(it0[x]) )
+#define IT2(x)          ( ROTL8(ROTL8(it0[x])) )
+#define IT3(x)          ( ROTL8(ROTL8(ROTL8(it0[x]))) )
+#endif /*uAES_CFG_TTABLE*/
+
+/* Row 1 of ft0 holds the plain S-box output, used by the last round. */
+#define SBOX(x)         ( (uint32_t)B1(ft0[x]) )
+
+/* Output column C takes row R from input column C + R (ShiftRows). */
+#define FWD_ROUND(t, s, rk) do {                                                  \
+  (t)[0] = FT0(B0((s)[0])) ^ FT1(B1((s)[1])) ^ FT2(B2((s)[2])) ^ FT3(B3((s)[3])) ^ (rk)[0]; \
+  (t)[1] = FT0(B0((s)[1])) ^ FT1(B1((s)[2])) ^ FT2(B2((s)[3])) ^ FT3(B3((s)[0])) ^ (rk)[1]; \
+  (t)[2] = FT0(B0((s)[2])) ^ FT1(B1((s)[3])) ^ FT2(B2((s)[0])) ^ FT3(B3((s)[1])) ^ (rk)[2]; \
+  (t)[3] = FT0(B0((s)[3])) ^ FT1(B1((s)[0])) ^ FT2(B2((s)[1])) ^ FT3(B3((s)[2])) ^ (rk)[3]; \
+} while(0)
+
+#define FWD_LAST_COLUMN(s, a, b, c, d, rk)                                        \
+  ( uAES_BYTES2WORD(SBOX(B0((s)[a])), SBOX(B1((s)[b])), SBOX(B2((s)[c])), SBOX(B3((s)[d]))) ^ (rk) )
+
+/* Output column C takes row R from input column C - R (InvShiftRows). */
+#define INV_ROUND(t, s, rk) do {                                                  \
+  (t)[0] = IT0(B0((s)[0])) ^ IT1(B1((s)[3])) ^ IT2(B2((s)[2])) ^ IT3(B3((s)[1])) ^ (rk)[0]; \
+  (t)[1] = IT0(B0((s)[1])) ^ IT1(B1((s)[0])) ^ IT2(B2((s)[3])) ^ IT3(B3((s)[2])) ^ (rk)[1]; \
+  (t)[2] = IT0(B0((s)[2])) ^ IT1(B1((s)[1])) ^ IT2(B2((s)[0])) ^ IT3(B3((s)[3])) ^ (rk)[2]; \
+  (t)[3] = IT0(B0((s)[3])) ^ IT1(B1((s)[2])) ^ IT2(B2((s)[1])) ^ IT3(B3((s)[0])) ^ (rk)[3]; \
+} while(0)
+
+#define INV_LAST_COLUMN(s, a, b, c, d, rk)                                        \
+  ( uAES_BYTES2WORD(uaes_inv_s_box[B0((s)[a])], uaes_inv_s_box[B1((s)[b])],      \
+                    uaes_inv_s_box[B2((s)[c])], uaes_inv_s_box[B3((s)[d])]) ^ (rk) )
+
+/*
+ * With uAES_CFG_UNROLL the round loops below are written out for a round
+ * count known at compile time: the cores are forced inline into one wrapper
+ * per key size, so the "Nr > 10" tests fold away and every round key offset
+ * is a constant, the states alternate between s and t and, Nr - 1 being odd
+ * for all key sizes, the last inner round leaves the state in t. Without it
+ * a single copy loops over the rounds, copying t back to s before each one.
+ */
+#if defined(__GNUC__)
+#define TTABLE_INLINE   static inline __attribute__((always_inline))
+#else
+#define TTABLE_INLINE   static inline
+#endif
+
+#define LOAD_STATE(s, p, rk) do {                               \
+  (s)[0] = GET_U32_LE(&(p)[0])  ^ (rk)[0];                      \
+  (s)[1] = GET_U32_LE(&(p)[4])  ^ (rk)[1];                      \
+  (s)[2] = GET_U32_LE(&(p)[8])  ^ (rk)[2];                      \
+  (s)[3] = GET_U32_LE(&(p)[12]) ^ (rk)[3];                      \
+} while(0)
+
+#define STORE_STATE(p, s) do {                                  \
+  PUT_U32_LE(&(p)[0],  (s)[0]);                                 \
+  PUT_U32_LE(&(p)[4],  (s)[1]);                                 \
+  PUT_U32_LE(&(p)[8],  (s)[2]);                                 \
+  PUT_U32_LE(&(p)[12], (s)[3]);                                 \
+} while(0)
+
+#define FWD_LAST(t, s, rk) do {                                 \
+  (t)[0] = FWD_LAST_COLUMN(s, 0, 1, 2, 3, (rk)[0]);             \
+  (t)[1] = FWD_LAST_COLUMN(s, 1, 2, 3, 0, (rk)[1]);             \
+  (t)[2] = FWD_LAST_COLUMN(s, 2, 3, 0, 1, (rk)[2]);             \
+  (t)[3] = FWD_LAST_COLUMN(s, 3, 0, 1, 2, (rk)[3]);             \
+} while(0)
+
+#define INV_LAST(t, s, rk) do {                                 \
+  (t)[0] = INV_LAST_COLUMN(s, 0, 3, 2, 1, (rk)[0]);             \
+  (t)[1] = INV_LAST_COLUMN(s, 1, 0, 3, 2, (rk)[1]);             \
+  (t)[2] = INV_LAST_COLUMN(s, 2, 1, 0, 3, (rk)[2]);             \
+  (t)[3] = INV_LAST_COLUMN(s, 3, 2, 1, 0, (rk)[3]);             \
+} while(0)
+
+/* Inner rounds 1 to Nr - 1 of one state, or of two states (a, b) side by side, the result is left in t. */
+#if uAES_CFG_UNROLL
+#define UNROLLED_ROUNDS(ROUND, COPY, Nr, rk, s, t) do {         \
+  ROUND(t, s, &(rk)[4]);  ROUND(s, t, &(rk)[8]);                \
+  ROUND(t, s, &(rk)[12]); ROUND(s, t, &(rk)[16]);               \
+  ROUND(t, s, &(rk)[20]); ROUND(s, t, &(rk)[24]);               \
+  ROUND(t, s, &(rk)[28]); ROUND(s, t, &(rk)[32]);               \
+  if((Nr) > 10)                                                 \
+  {                                                             \
+    ROUND(t, s, &(rk)[36]); ROUND(s, t, &(rk)[40]);             \
+  }                                                             \
+  if((Nr) > 12)                                                 \
+  {                                                             \
+    ROUND(t, s, &(rk)[44]); ROUND(s, t, &(rk)[48]);             \
+  }                                                             \
+  ROUND(t, s, &(rk)[4 * ((Nr) - 1)]);                           \
+} while(0)
+#else
+#define UNROLLED_ROUNDS(ROUND, COPY, Nr, rk, s, t) do {         \
+  COPY(t, s);                                                   \
+  for(size_t round = 1; round < (Nr); round++)                  \
+  {                                                             \
+    COPY(s, t);                                                 \
+    ROUND(t, s, &(rk)[4 * round]);                              \
+  }                                                             \
+} while(0)
+#endif /*uAES_CFG_UNROLL*/
+
+#define COPY_STATE(d, s) do {                                   \
+  (d)[0] = (s)[0]; (d)[1] = (s)[1]; (d)[2] = (s)[2]; (d)[3] = (s)[3]; \
+} while(0)
+
+#define COPY_STATE2(d, s) do {                                  \
+  COPY_STATE(d##a, s##a);                                       \
+  COPY_STATE(d##b, s##b);                                       \
+} while(0)
+
+#define FWD_ROUND2(t, s, rk) do {                               \
+  FWD_ROUND(t##a, s##a, rk);                                    \
+  FWD_ROUND(t##b, s##b, rk);                                    \
+} while(0)
+
+#define INV_ROUND2(t, s, rk) do {                               \
+  INV_ROUND(t##a, s##a, rk);                                    \
+  INV_ROUND(t##b, s##b, rk);                                    \
+} while(0)
+
+TTABLE_INLINE void ttable_enc1(uint8_t *block, const uint32_t *rk, const size_t Nr)
+{
+  uint32_t s[4], t[4];
+
+  LOAD_STATE(s, block, rk);
+  UNROLLED_ROUNDS(FWD_ROUND, COPY_STATE, Nr, rk, s, t);
+  FWD_LAST(s, t, &rk[4 * Nr]);
+  STORE_STATE(block, s);
+  return;
+}
+
+TTABLE_INLINE void ttable_dec1(uint8_t *block, const uint32_t *rk, const size_t Nr)
+{
+  uint32_t s[4], t[4];
+
+  LOAD_STATE(s, block, rk);
+  UNROLLED_ROUNDS(INV_ROUND, COPY_STATE, Nr, rk, s, t);
+  INV_LAST(s, t, &rk[4 * Nr]);
+  STORE_STATE(block, s);
+  return;
+}
+
+/*
+ * Two blocks at a time, the two states have no data dependency on each other,
+ * so their table lookups overlap on superscalar cores. Wider interleaves run
+ * out of general purpose registers and spill.
+ */
+TTABLE_INLINE void ttable_enc2(uint8_t *blocks, const uint32_t *rk, const size_t Nr, size_t nblocks)
+{
+  uint32_t sa[4], sb[4], ta[4], tb[4];
+
+  for(; nblocks >= 2; nblocks -= 2, blocks += 32)
+  {
+    LOAD_STATE(sa, &blocks[0], rk);
+    LOAD_STATE(sb, &blocks[16], rk);
+    UNROLLED_ROUNDS(FWD_ROUND2, COPY_STATE2, Nr, rk, s, t);
+    FWD_LAST(sa, ta, &rk[4 * Nr]);
+    FWD_LAST(sb, tb, &rk[4 * Nr]);
+    STORE_STATE(&blocks[0], sa);
+    STORE_STATE(&blocks[16], sb);
+  }
+  if(0 != nblocks)
+  {
+    ttable_encrypt_block(blocks, rk, Nr);
+  }
+  return;
+}
+
+TTABLE_INLINE void ttable_dec2(uint8_t *blocks, const uint32_t *rk, const size_t Nr, size_t nblocks)
+{
+  uint32_t sa[4], sb[4], ta[4], tb[4];
+
+  for(; nblocks >= 2; nblocks -= 2, blocks += 32)
+  {
+    LOAD_STATE(sa, &blocks[0], rk);
+    LOAD_STATE(sb, &blocks[16], rk);
+    UNROLLED_ROUNDS(INV_ROUND2, COPY_STATE2, Nr, rk, s, t);
+    INV_LAST(sa, ta, &rk[4 * Nr]);
+    INV_LAST(sb, tb, &rk[4 * Nr]);
+    STORE_STATE(&blocks[0], sa);
+    STORE_STATE(&blocks[16], sb);
+  }
+  if(0 != nblocks)
+  {
+    ttable_decrypt_block(blocks, rk, Nr);
+  }
+  return;
+}
+
+/* One specialised copy per key size, keys longer than uAES_CFG_MAX_KEY_BITS are never expanded. */
+#if uAES_CFG_UNROLL
+#if (uAES_CFG_MAX_KEY_BITS >= 192)
+#define TTABLE_CASE_192(call)   case 12: call(12); break;
+#else
+#define TTABLE_CASE_192(call)
+#endif
+#if (uAES_CFG_MAX_KEY_BITS >= 256)
+#define TTABLE_CASE_256(call)   case 14: call(14); break;
+#else
+#define TTABLE_CASE_256(call)
+#endif
+
+#define TTABLE_DISPATCH(Nr, call) do {                          \
+  switch(Nr)                                                    \
+  {                                                             \
+    TTABLE_CASE_192(call)                                       \
+    TTABLE_CASE_256(call)                                       \
+    default: call(10); break;                                   \
+  }                                                             \
+} while(0)
+#else
+#define TTABLE_DISPATCH(Nr, call)   call(Nr)
+#endif /*uAES_CFG_UNROLL*/
+
+/**
+ * @brief           Computes the foward cipher on a single block with the T-table round engine.
+ * @param block     Pointer to the 16-byte data block, encrypted in place.
+ * @param keysched  Pointer to the first element of the key schedule array.
+ * @param Nr        Number of rounds, 10, 12 or 14.
+ */
+void ttable_encrypt_block(uint8_t *block, const uint32_t *keysched, size_t Nr)
+{
+#define ENC1(n)   ttable_enc1(block, keysched, n)
+  TTABLE_DISPATCH(Nr, ENC1);
+#undef ENC1
+  return;
+}
+
+/**
+ * @brief               Computes the equivalent inverse cipher on a single block with the T-table round engine.
+ * @param block         Pointer to the 16-byte data block, decrypted in place.
+ * @param inv_keysched  Pointer to the first element of the decryption key schedule (see inv_key_expansion).
+ * @param Nr            Number of rounds, 10, 12 or 14.
+ */
+void ttable_decrypt_block(uint8_t *block, const uint32_t *inv_keysched, size_t Nr)
+{
+#define DEC1(n)   ttable_dec1(block, inv_keysched, n)
+  TTABLE_DISPATCH(Nr, DEC1);
+#undef DEC1
+  return;
+}
+
+/**
+ * @brief           Computes the foward cipher on consecutive blocks, two at a time.
+ * @param blocks    Pointer to the first block, all encrypted in place.
+ * @param keysched  Pointer to the first element of the key schedule array.
+ * @param Nr        Number of rounds, 10, 12 or 14.
+ * @param nblocks   Number of 16-byte blocks.
+ */
+void ttable_encrypt_blocks(uint8_t *blocks, const uint32_t *keysched, size_t Nr, size_t nblocks)
+{
+#define ENC2(n)   ttable_enc2(blocks, keysched, n, nblocks)
+  TTABLE_DISPATCH(Nr, ENC2);
+#undef ENC2
+  return;
+}
+
+/**
+ * @brief               Computes the equivalent inverse cipher on consecutive blocks, two at a time.
+ * @param blocks        Pointer to the first block, all decrypted in place.
+ * @param inv_keysched  Pointer to the first element of the decryption key schedule (see inv_key_expansion).
+ * @param Nr            Number of rounds, 10, 12 or 14.
+ * @param nblocks       Number of 16-byte blocks.
+ */
+void ttable_decrypt_blocks(uint8_t *blocks, const uint32_t *inv_keysched, size_t Nr, size_t nblocks)
+{
+#define DEC2(n)   ttable_dec2(blocks, inv_keysched, n, nblocks)
+  TTABLE_DISPATCH(Nr, DEC2);
+#undef DEC2
+  return;
+}
+
+#endif /*uAES_CFG_TTABLE*/
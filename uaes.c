@@ -31,29 +31,23 @@
 
 #include "uaes.h"
 #include "ops.h"
-
-#define uAES128_KSCHD_SIZE    ( 44UL )
-#define uAES192_KSCHD_SIZE    ( 52UL )
-#define uAES256_KSCHD_SIZE    ( 60UL )
-#define uAES_MAX_KSCHD_SIZE   ( uAES256_KSCHD_SIZE )
-
-uint8_t trace_msk = 0x00;
-static uint8_t input_buffer[uAES_MAX_INPUT_SIZE] = { 0 };
-static uint8_t key_buffer[uAES_MAX_KEY_SIZE] = { 0 };
+#include "engine.h"
 
 static size_t uaes_strnlen(char *str, size_t lim);
 static void   uaes_xor_iv(void *block, void *iv);
-static void   uaes_foward_cipher(uint8_t *buf, uint32_t *kschd, size_t Nk, size_t Nb, size_t Nr);
-static void   uaes_inverse_cipher(uint8_t *buf, uint32_t *kschd, size_t Nk, size_t Nb, size_t Nr);
+static size_t uaes_block_count(size_t size);
+static void   uaes_foward_cipher(uint8_t *buf, const uaes_ctx_t *ctx);
+static void   uaes_inverse_cipher(uint8_t *buf, const uaes_ctx_t *ctx);
 
 /**
- * @brief Sets trace mask for debugging.
+ * @brief Sets trace mask for debugging, for the calling thread only.
  * @param msk unsigned 8-bit variable expressing debugging options to be enabled.
- * @note If __uAES_DEBUG__ is not defined this function is not available.
- * @return uint8_t Returns current trace mask.
+ * @note If __uAES_DEBUG__ is not defined this function does nothing.
+ * @return uint8_t Returns current trace mask of the calling thread.
  */
 #ifdef __uAES_DEBUG__
-int     debug_line  = 0;
+uAES_THREAD_LOCAL uint8_t trace_msk   = 0x00;
+uAES_THREAD_LOCAL int     debug_line  = 0;
 uint8_t uaes_set_trace_msk(unsigned char msk)
 {
         trace_msk |= msk;
@@ -63,6 +57,7 @@ uint8_t uaes_set_trace_msk(unsigned char msk)
 
 uint8_t uaes_set_trace_msk(unsigned char msk)
 {
+        (void)msk;
         return 0;
 }
 #endif /*__uAES_DEBUG__*/
@@ -77,6 +72,22 @@ static size_t uaes_strnlen(char *str, size_t lim)
         return s;
 }
 
+/**
+ * @brief Computes the number of 16-byte blocks spanned by a buffer, a trailing
+ *        partial block counts as a whole block.
+ * 
+ * @param size  Buffer size in bytes.
+ * @return size_t Number of blocks.
+ */
+static size_t uaes_block_count(size_t size)
+{
+        if(0 != (size & uAES_BLOCK_ALIGN_MASK))
+        {
+                size = uAES_ALIGN(size, uAES_BLOCK_ALIGN);
+        }
+        return (size >> 4UL);
+}
+
 /**
  * @brief Performs XOR operation between initialisation vector and data block
  * 
@@ -98,186 +109,377 @@ static void uaes_xor_iv(void *block, void *iv)
 
 /**
  * @brief Computes foward cipher encryption on provided buffer.
- * @param data  Pointer to data buffer.
- * @param kschd Pointer to key schedule buffer generated by key expansion algorithm. 
- * @param Nk    Key length in 32-bit words.
- * @param Nb    Block length in 32-bit words.
- * @param Nr    Number of encryption rounds.
- * @return int If successful returns a 0, otherwise -1 will be returned.
+ * @param buf   Pointer to data buffer.
+ * @param ctx   Pointer to key context holding the encryption key schedule.
  */
-static void uaes_foward_cipher(uint8_t *buf, uint32_t *kschd, size_t Nk, size_t Nb, size_t Nr)
+static void uaes_foward_cipher(uint8_t *buf, const uaes_ctx_t *ctx)
 {
+        const size_t Nr = ctx->Nr;
+        const uint32_t *kschd = ctx->kschd;
+#if uAES_CFG_TTABLE
+        uAES_TRACE_BLOCK(uAES_TRACE_MSK_FWD, "round[%lu].block = ", buf, 0UL);
+        ttable_encrypt_block(buf, kschd, Nr);
+        uAES_TRACE_BLOCK(uAES_TRACE_MSK_FWD, "round[%lu].end = ", buf, Nr);
+#else
+        const size_t Nb = uAES_NB;
         uint8_t block[ uAES_BLOCK_SIZE ] = {0U};
 
         memcpy((void *)block, (void *)buf, uAES_BLOCK_SIZE);
 
         uAES_TRACE_BLOCK(uAES_TRACE_MSK_FWD, "round[%lu].block = ", block, 0UL);
-        add_round_key(block, kschd, 0, Nb);
+        uAES_PROF_OP(ctx, uAES_PROF_ADD_ROUND_KEY, add_round_key(block, kschd, 0, Nb));
         for( size_t round = 1; round < Nr; round++ )
         {
                 uAES_TRACE_BLOCK(uAES_TRACE_MSK_FWD, "round[%lu].start = ", block, round);
-                sub_block(block, Nb);
+                uAES_PROF_OP(ctx, uAES_PROF_SUB_BYTES, sub_block(block, Nb));
                 uAES_TRACE_BLOCK(uAES_TRACE_MSK_FWD, "round[%lu].s_box = ", block, round);
-                shift_rows(block, Nb);
+                uAES_PROF_OP(ctx, uAES_PROF_SHIFT_ROWS, shift_rows(block, Nb));
                 uAES_TRACE_BLOCK(uAES_TRACE_MSK_FWD, "round[%lu].sh_row = ", block, round);
-                mix_columns(block, Nb);
+                uAES_PROF_OP(ctx, uAES_PROF_MIX_COLUMNS, mix_columns(block, Nb));
                 uAES_TRACE_BLOCK(uAES_TRACE_MSK_FWD, "round[%lu].m_col = ", block, round);
-                add_round_key(block, kschd, round, Nb);
+                uAES_PROF_OP(ctx, uAES_PROF_ADD_ROUND_KEY, add_round_key(block, kschd, round, Nb));
         }
-        sub_block(block, Nb);
+        uAES_PROF_OP(ctx, uAES_PROF_SUB_BYTES, sub_block(block, Nb));
         uAES_TRACE_BLOCK(uAES_TRACE_MSK_FWD, "round[%lu].s_box = ", block, Nr);
-        shift_rows(block, Nb);
+        uAES_PROF_OP(ctx, uAES_PROF_SHIFT_ROWS, shift_rows(block, Nb));
         uAES_TRACE_BLOCK(uAES_TRACE_MSK_FWD, "round[%lu].sh_row = ", block, Nr);
-        add_round_key(block, kschd, Nr, Nb);
+        uAES_PROF_OP(ctx, uAES_PROF_ADD_ROUND_KEY, add_round_key(block, kschd, Nr, Nb));
         uAES_TRACE_BLOCK(uAES_TRACE_MSK_FWD, "round[%lu].end = ", block, Nr);
         memcpy((void *)buf, (void *)block, uAES_BLOCK_SIZE);
+#endif /*uAES_CFG_TTABLE*/
         return;
 }
 
 /**
- * @brief       Computes inverse cipher decryption on provided buffer.
- * @param data  Pointer to ciphertext buffer.
- * @param kschd Pointer to key schedule buffer generated by key expansion algorithm. 
- * @param Nk    Number of 32-bit words in a key.
- * @param Nb    Number of 32-bit words in a block.
- * @param Nr    Number of rounds.
+ * @brief       Computes the equivalent inverse cipher (FIPS-197 5.3.5) on provided buffer.
+ *              Rounds run in the same order as the foward cipher, with the
+ *              InvMixColumns-transformed round keys of the decryption schedule.
+ * @param buf   Pointer to ciphertext buffer.
+ * @param ctx   Pointer to key context holding the decryption key schedule.
  */
-static void uaes_inverse_cipher( uint8_t *buf, uint32_t *kschd, size_t Nk, size_t Nb, size_t Nr)
+static void uaes_inverse_cipher(uint8_t *buf, const uaes_ctx_t *ctx)
 {
+        const size_t Nr = ctx->Nr;
+        const uint32_t *dkschd = ctx->dkschd;
+#if uAES_CFG_TTABLE
+        uAES_TRACE_BLOCK(uAES_TRACE_MSK_INV, "round[%lu].block = ", buf, 0UL);
+        ttable_decrypt_block(buf, dkschd, Nr);
+        uAES_TRACE_BLOCK(uAES_TRACE_MSK_INV, "round[%lu].end = ", buf, Nr);
+#else
+        const size_t Nb = uAES_NB;
         uint8_t block[uAES_BLOCK_SIZE] = {0U};
 
         memcpy((void *) block, (void *) buf, uAES_BLOCK_SIZE);
 
-        uAES_TRACE_BLOCK( uAES_TRACE_MSK_INV, "round[%lu].block = ", block, Nr);
-        add_round_key(block, kschd, Nr, Nb);
-        for(size_t round = Nr - 1; round > 0; round--)
+        uAES_TRACE_BLOCK(uAES_TRACE_MSK_INV, "round[%lu].block = ", block, 0UL);
+        uAES_PROF_OP(ctx, uAES_PROF_ADD_ROUND_KEY, add_round_key(block, dkschd, 0, Nb));
+        for(size_t round = 1; round < Nr; round++)
         {
                 uAES_TRACE_BLOCK(uAES_TRACE_MSK_INV, "round[%lu].start = ", block, round);
-                inv_shift_rows(block, Nb);
-                uAES_TRACE_BLOCK( uAES_TRACE_MSK_INV, "round[%lu].inv_sh_row = ", block, round);
-                inv_sub_block(block, Nb);
+                uAES_PROF_OP(ctx, uAES_PROF_SUB_BYTES, inv_sub_block(block, Nb));
                 uAES_TRACE_BLOCK(uAES_TRACE_MSK_INV, "round[%lu].inv_s_box = ", block, round);
-                add_round_key(block, kschd, round, Nb);
-                uAES_TRACE_BLOCK(uAES_TRACE_MSK_INV, "round[%lu].add_rkey = ", block, round);
-                inv_mix_columns(block, Nb);
+                uAES_PROF_OP(ctx, uAES_PROF_SHIFT_ROWS, inv_shift_rows(block, Nb));
+                uAES_TRACE_BLOCK(uAES_TRACE_MSK_INV, "round[%lu].inv_sh_row = ", block, round);
+                uAES_PROF_OP(ctx, uAES_PROF_MIX_COLUMNS, inv_mix_columns(block, Nb));
+                uAES_TRACE_BLOCK(uAES_TRACE_MSK_INV, "round[%lu].inv_m_col = ", block, round);
+                uAES_PROF_OP(ctx, uAES_PROF_ADD_ROUND_KEY, add_round_key(block, dkschd, round, Nb));
         }
-        inv_shift_rows(block, Nb );
-        uAES_TRACE_BLOCK(uAES_TRACE_MSK_INV, "round[%lu].inv_sh_row = ", block, 0UL);
-        inv_sub_block(block, Nb );
-        uAES_TRACE_BLOCK(uAES_TRACE_MSK_INV, "round[%lu].inv_s_box = ", block, 0UL);
-        add_round_key(block, kschd, 0, Nb );
-        uAES_TRACE_BLOCK(uAES_TRACE_MSK_FWD, "round[%lu].end = ", block, 0UL);
+        uAES_PROF_OP(ctx, uAES_PROF_SUB_BYTES, inv_sub_block(block, Nb));
+        uAES_TRACE_BLOCK(uAES_TRACE_MSK_INV, "round[%lu].inv_s_box = ", block, Nr);
+        uAES_PROF_OP(ctx, uAES_PROF_SHIFT_ROWS, inv_shift_rows(block, Nb));
+        uAES_TRACE_BLOCK(uAES_TRACE_MSK_INV, "round[%lu].inv_sh_row = ", block, Nr);
+        uAES_PROF_OP(ctx, uAES_PROF_ADD_ROUND_KEY, add_round_key(block, dkschd, Nr, Nb));
+        uAES_TRACE_BLOCK(uAES_TRACE_MSK_INV, "round[%lu].end = ", block, Nr);
+
+        memcpy((void *)buf, (void *)block, uAES_BLOCK_SIZE);
+#endif /*uAES_CFG_TTABLE*/
+        return;
+}
 
-        memcpy((void *)buf, (void *)block, uAES_BLOCK_SIZE);  
+static int uaes_portable_available(void)
+{
+        return 1;
+}
 
+/**
+ * @brief Expands the key schedules of a context with the portable operators.
+ * @param ctx   Pointer to key context, Nk, Nr and usage already set.
+ * @param key   Pointer to key buffer.
+ */
+static void uaes_portable_setkey(uaes_ctx_t *ctx, uint8_t *key)
+{
+        key_expansion(key, ctx->kschd, ctx->Nk, (uAES_NB * (ctx->Nr + 1UL)));
+        if(0 != (ctx->usage & uAES_CTX_DECRYPT))
+        {
+                inv_key_expansion(ctx->kschd, ctx->dkschd, ctx->Nr);
+        }
         return;
 }
 
 /**
- * @brief Performs AES Cipher Block Chaining encryption on given plaintext.
- * 
- * @param plaintext             Pointer to plaintext buffer
- * @param plaintext_size        Plaintext buffer size.
- * @param key                   Pointer to key buffer.
- * @param iv                    16-Byte Initialisation vector.
- * @param aes_length            Encryption/Decryption key length.
- * @return int                  [0] if sucessful. [-1] on failure. 
+ * @brief Encrypts consecutive blocks with the portable operators. Unless the
+ *        round trace is enabled, the T-table engine runs several blocks side by side.
+ * @param ctx           Pointer to key context.
+ * @param out           Pointer to output blocks, may alias in.
+ * @param in            Pointer to input blocks.
+ * @param nblocks       Number of 16-byte blocks.
  */
-int uaes_cbc_encryption(uint8_t *plaintext, 
-                        size_t plaintext_size, 
-                        uint8_t *key, 
-                        uint8_t *iv, 
-                        aes_length_t aes_length)
+static void uaes_portable_encrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks)
 {
-        int err = -1;
-        uint32_t kschd[uAES_MAX_KSCHD_SIZE] = {0U};
-        size_t Nk, Nb, Nr, idx = 0UL, offset = plaintext_size;
+        uAES_PROF_START(t0);
 
-        if(0 != (plaintext_size & uAES_BLOCK_ALIGN_MASK))
+#if uAES_CFG_TTABLE
+        if(0 == uAES_TRACE_ON(uAES_TRACE_MSK_FWD))
+        {
+                if(out != in)
+                {
+                        memcpy(out, in, uAES_BLOCK_SIZE * nblocks);
+                }
+                ttable_encrypt_blocks(out, ctx->kschd, ctx->Nr, nblocks);
+                uAES_PROF_STOP(ctx, uAES_PROF_CIPHER, t0);
+                return;
+        }
+#endif /*uAES_CFG_TTABLE*/
+        for(size_t idx = 0; idx < nblocks; idx++)
         {
-                offset = uAES_ALIGN(plaintext_size, uAES_BLOCK_ALIGN);
+                if(out != in)
+                {
+                        memcpy(&out[uAES_BLOCK_SIZE * idx], &in[uAES_BLOCK_SIZE * idx], uAES_BLOCK_SIZE);
+                }
+                uaes_foward_cipher(&out[uAES_BLOCK_SIZE * idx], ctx);
         }
+        uAES_PROF_STOP(ctx, uAES_PROF_CIPHER, t0);
+        return;
+}
 
-        offset >>= 4UL; 
-        
-        Nb = 4UL;
-        Nk = Nb + (aes_length * 2UL);
-        Nr = Nb + (aes_length * 2UL);
-        
-        if( (NULL != key)                               && 
-            (NULL != plaintext)                         &&
-            (NULL != iv)                                && 
-            (0 < plaintext_size)                        && 
-            (uAES_MAX_INPUT_SIZE >= plaintext_size)     && 
-            (uAESRGE > aes_length) )
+/**
+ * @brief Decrypts consecutive blocks with the portable operators, see uaes_portable_encrypt().
+ * @param ctx           Pointer to key context.
+ * @param out           Pointer to output blocks, may alias in.
+ * @param in            Pointer to input blocks.
+ * @param nblocks       Number of 16-byte blocks.
+ */
+static void uaes_portable_decrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks)
+{
+        uAES_PROF_START(t0);
+
+#if uAES_CFG_TTABLE
+        if(0 == uAES_TRACE_ON(uAES_TRACE_MSK_INV))
+        {
+                if(out != in)
+                {
+                        memcpy(out, in, uAES_BLOCK_SIZE * nblocks);
+                }
+                ttable_decrypt_blocks(out, ctx->dkschd, ctx->Nr, nblocks);
+                uAES_PROF_STOP(ctx, uAES_PROF_CIPHER, t0);
+                return;
+        }
+#endif /*uAES_CFG_TTABLE*/
+        for(size_t idx = 0; idx < nblocks; idx++)
         {
-                key_expansion(key, kschd, Nk, (Nb * (Nr + 1)));
-                uaes_xor_iv(plaintext, iv);
-                uaes_foward_cipher(&plaintext[uAES_BLOCK_SIZE * idx], kschd, Nk, Nb, Nr);
-                idx++;
+                if(out != in)
+                {
+                        memcpy(&out[uAES_BLOCK_SIZE * idx], &in[uAES_BLOCK_SIZE * idx], uAES_BLOCK_SIZE);
+                }
+                uaes_inverse_cipher(&out[uAES_BLOCK_SIZE * idx], ctx);
+        }
+        uAES_PROF_STOP(ctx, uAES_PROF_CIPHER, t0);
+        return;
+}
+
+const uaes_engine_t uaes_engine_portable =
+{
+        .name           = "portable",
+        .id             = uAES_ENGINE_PORTABLE,
+        .available      = uaes_portable_available,
+        .setkey         = uaes_portable_setkey,
+        .encrypt        = uaes_portable_encrypt,
+        .decrypt        = uaes_portable_decrypt,
+        .cbc_encrypt    = NULL,
+        .cbc_decrypt    = NULL,
+        .cbc_encrypt_lanes = NULL,
+        .caps           = uAES_CAPS_SOFTWARE(0U),
+};
+
+/**
+ * @brief Chains and encrypts consecutive blocks in CBC mode through the context engine.
+ * 
+ * @param ctx           Pointer to key context.
+ * @param out           Pointer to output blocks, may alias in.
+ * @param in            Pointer to input blocks.
+ * @param nblocks       Number of 16-byte blocks.
+ * @param iv            Chaining value, holds the last ciphertext block on return.
+ */
+void uaes_cbc_encrypt_blocks(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *iv)
+{
+        const uaes_engine_t *engine = ctx->engine;
+        uAES_PROF_START(t0);
 
-                while(offset > idx)
+        if(NULL != engine->cbc_encrypt)
+        {
+                engine->cbc_encrypt(ctx, out, in, nblocks, iv);
+        }
+        else
+        {
+                for(size_t idx = 0; idx < nblocks; idx++)
                 {
-                        uaes_xor_iv(&plaintext[uAES_BLOCK_SIZE * idx], &plaintext[uAES_BLOCK_SIZE * (idx - 1)]);
-                        uaes_foward_cipher(&plaintext[ uAES_BLOCK_SIZE * idx ], kschd, Nk, Nb, Nr);
-                        idx++;
+                        if(out != in)
+                        {
+                                memcpy(&out[uAES_BLOCK_SIZE * idx], &in[uAES_BLOCK_SIZE * idx], uAES_BLOCK_SIZE);
+                        }
+                        uaes_xor_iv(&out[uAES_BLOCK_SIZE * idx], iv);
+                        engine->encrypt(ctx, &out[uAES_BLOCK_SIZE * idx], &out[uAES_BLOCK_SIZE * idx], 1UL);
+                        memcpy(iv, &out[uAES_BLOCK_SIZE * idx], uAES_BLOCK_SIZE);
                 }
+        }
+        uAES_PROF_STOP(ctx, uAES_PROF_CBC, t0);
+        return;
+}
 
-                err = 0;
+/**
+ * @brief Decrypts consecutive CBC blocks through the context engine.
+ *        Engines without a dedicated CBC routine are fed uAES_CFG_CBC_BATCH blocks
+ *        per call, front to back, so their multi-block paths overlap the rounds
+ *        of independent blocks. The ciphertext of each batch is saved before
+ *        decryption, which keeps in-place operation working.
+ * 
+ * @param ctx           Pointer to key context.
+ * @param out           Pointer to output blocks, may alias in.
+ * @param in            Pointer to input blocks.
+ * @param nblocks       Number of 16-byte blocks.
+ * @param iv            Chaining value, holds the last ciphertext block on return.
+ */
+void uaes_cbc_decrypt_blocks(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *iv)
+{
+        const uaes_engine_t *engine = ctx->engine;
+        uint8_t chain[uAES_BLOCK_SIZE * (uAES_CFG_CBC_BATCH + 1UL)];
+        size_t batch = 0;
+        uAES_PROF_START(t0);
+
+        if(NULL != engine->cbc_decrypt)
+        {
+                engine->cbc_decrypt(ctx, out, in, nblocks, iv);
         }
-        
-        return err;
+        else
+        {
+                memcpy(chain, iv, uAES_BLOCK_SIZE);
+                while(0 < nblocks)
+                {
+                        batch = ( nblocks < uAES_CFG_CBC_BATCH ) ? (nblocks) : (uAES_CFG_CBC_BATCH);
+                        memcpy(&chain[uAES_BLOCK_SIZE], in, uAES_BLOCK_SIZE * batch);
+                        engine->decrypt(ctx, out, in, batch);
+                        for(size_t idx = 0; idx < (uAES_BLOCK_SIZE * batch); idx++)
+                        {
+                                out[idx] ^= chain[idx];
+                        }
+                        memcpy(chain, &chain[uAES_BLOCK_SIZE * batch], uAES_BLOCK_SIZE);
+                        in      += uAES_BLOCK_SIZE * batch;
+                        out     += uAES_BLOCK_SIZE * batch;
+                        nblocks -= batch;
+                }
+                memcpy(iv, chain, uAES_BLOCK_SIZE);
+                uaes_wipe(chain, sizeof(chain));
+        }
+        uAES_PROF_STOP(ctx, uAES_PROF_CBC, t0);
+        return;
 }
 
 /**
- * @brief Performs AES Cipher Block Chaining decryption on given ciphertext 
+ * @brief Expands a user key into a caller-owned key context, so that the key
+ *        schedule is computed once and reused by every ECB/CBC/block call.
+ *        The decryption schedule is only derived when uAES_CTX_DECRYPT is set.
+ *        The fastest engine available on the running CPU is selected.
  * 
- * @param ciphertext            Pointer to ciphertext buffer.
- * @param ciphertext_size       Ciphertext buffer size.
+ * @param ctx                   Pointer to key context.
  * @param key                   Pointer to key buffer.
- * @param init_vec              16-Byte initialisation vector.
  * @param aes_length            Encryption/Decryption key length.
+ * @param usage                 Directions the context will be used for,
+ *                              uAES_CTX_ENCRYPT and/or uAES_CTX_DECRYPT.
  * @return int                  [0] if sucessful, [-1] on failure.
  */
-int uaes_cbc_decryption(uint8_t *ciphertext, 
-                        size_t ciphertext_size, 
-                        uint8_t *key, 
-                        uint8_t *iv,
-                        aes_length_t aes_length)
+int uaes_ctx_init(uaes_ctx_t *ctx, uint8_t *key, aes_length_t aes_length, uint8_t usage)
 {
         int err = -1;
-        uint32_t kschd[uAES_MAX_KSCHD_SIZE] = {0UL};
-        size_t Nk, Nb, Nr, idx = 0UL, offset = ciphertext_size;
 
-        if(0 != ( ciphertext_size & uAES_BLOCK_ALIGN_MASK))
+        if((NULL != ctx)                                &&
+           (NULL != key)                                &&
+           (uAESRGE > aes_length)                       &&
+           ((128UL + (64UL * aes_length)) <= uAES_CFG_MAX_KEY_BITS) &&
+           (0 != (usage & uAES_CTX_BOTH))               &&
+           (0 == (usage & ~uAES_CTX_BOTH)))
         {
-          offset = uAES_ALIGN(ciphertext_size, uAES_BLOCK_ALIGN);
+                ctx->aes_length = aes_length;
+                ctx->usage      = usage;
+                ctx->Nk         = uAES_NB + (aes_length * 2UL);
+                ctx->Nr         = ctx->Nk + 6UL;
+                ctx->engine     = uaes_engine_lookup(uAES_ENGINE_AUTO);
+#if uAES_CFG_OFFLOAD
+                ctx->offload    = 1;
+#endif /*uAES_CFG_OFFLOAD*/
+#if uAES_CFG_PROFILE
+                memset(&ctx->prof, 0x00, sizeof(uaes_prof_t));
+#endif /*uAES_CFG_PROFILE*/
+                uAES_PROF_OP(ctx, uAES_PROF_KEY_EXPANSION, ctx->engine->setkey(ctx, key));
+                err = 0;
         }
-        
-        offset >>= 4UL; 
-        
-        Nb = 4UL;
-        Nk = Nb + (aes_length * 2UL);
-        Nr = Nb + (aes_length * 2UL);
 
-        if( (NULL != key)                               && 
-            (NULL != ciphertext)                        &&
-            (NULL != iv)                                && 
-            (0 < ciphertext_size)                       && 
-            (uAES_MAX_INPUT_SIZE >= ciphertext_size)    && 
-            (uAESRGE > aes_length) )
+        return err;
+}
+
+/**
+ * @brief Wipes the key material held by a key context.
+ * 
+ * @param ctx                   Pointer to key context.
+ */
+void uaes_ctx_clear(uaes_ctx_t *ctx)
+{
+        if(NULL != ctx)
         {
-                idx = offset - 1UL;
-                key_expansion(key, kschd, Nk, (Nb * (Nr + 1)));
-                while(idx > 0)
-                {
-                        uaes_inverse_cipher(&ciphertext[uAES_BLOCK_SIZE * idx], kschd, Nk, Nb, Nr);
-                        uaes_xor_iv(&ciphertext[uAES_BLOCK_SIZE * idx], &ciphertext[uAES_BLOCK_SIZE * (idx - 1)]);
-                        idx--;
-                }
+                uaes_wipe(ctx, sizeof(uaes_ctx_t));
+        }
+        return;
+}
+
+/**
+ * @brief Zeroes a buffer that held key material, chaining values or data, through a
+ *        volatile pointer so that the stores survive optimisation even when the
+ *        buffer is about to go out of scope.
+ * 
+ * @param buf                   Pointer to buffer.
+ * @param size                  Buffer size.
+ */
+void uaes_wipe(void *buf, size_t size)
+{
+        volatile uint8_t *p = (volatile uint8_t *)buf;
+
+        for(size_t pos = 0; pos < size; pos++)
+        {
+                p[pos] = 0x00;
+        }
+        return;
+}
+
+/**
+ * @brief Selects the engine that will run the cipher operations of a context.
+ *        Every engine shares the key schedule format, the key is not expanded again.
+ *        Any other choice than uAES_ENGINE_AUTO also keeps the context's calls
+ *        off the offload driver.
+ * 
+ * @param ctx                   Pointer to an initialised key context.
+ * @param id                    Engine identifier, uAES_ENGINE_AUTO picks the fastest available.
+ * @return int                  [0] if sucessful, [-1] if the engine is not built or not supported by the CPU.
+ */
+int uaes_ctx_set_engine(uaes_ctx_t *ctx, uaes_engine_id_t id)
+{
+        int err = -1;
+        const uaes_engine_t *engine = uaes_engine_lookup(id);
 
-                uaes_inverse_cipher(&ciphertext[uAES_BLOCK_SIZE * idx], kschd, Nk, Nb, Nr);
-                uaes_xor_iv(&ciphertext[uAES_BLOCK_SIZE * idx], iv);
+        if((NULL != ctx) && (NULL != engine))
+        {
+                ctx->engine = engine;
+#if uAES_CFG_OFFLOAD
+                ctx->offload = ( uAES_ENGINE_AUTO == id ) ? (1) : (0);
+#endif /*uAES_CFG_OFFLOAD*/
                 err = 0;
         }
 
@@ -285,96 +487,112 @@ int uaes_cbc_decryption(uint8_t *ciphertext,
 }
 
 /**
- * NOTE: AES-ECB IS NO LONGER CONSIDERED SAFE, USE IT AT YOUR OWN RISK.
+ * @brief Returns the name of the engine in use by a context.
  * 
- * @brief Performs AES Electronic Code Book encryption on given plaintext.
+ * @param ctx                   Pointer to an initialised key context.
+ * @return const char*          Engine name, NULL if ctx is NULL.
+ */
+const char *uaes_ctx_engine_name(const uaes_ctx_t *ctx)
+{
+        return (NULL != ctx) ? (ctx->engine->name) : (NULL);
+}
+
+#if uAES_CFG_PROFILE
+/**
+ * @brief Returns the cycle counts recorded on a context since uaes_ctx_init()
+ *        or the last uaes_ctx_profile_reset() call.
  * 
- * @param plaintext             Pointer to plaintext buffer.
- * @param plaintext_size        Size of plaintext buffer.
- * @param key                   Pointer to key buffer.
- * @param aes_length            Encryption/Decryption key length. 
- * @return int                  [0] if sucessful, [-1] on failure. 
+ * @param ctx                   Pointer to an initialised key context.
+ * @return const uaes_prof_t*   Profile, NULL if ctx is NULL.
  */
-int uaes_ecb_encryption(uint8_t *plaintext, 
-                        size_t  plaintext_size, 
-                        uint8_t *key, 
-                        aes_length_t aes_length)
+const uaes_prof_t *uaes_ctx_profile(const uaes_ctx_t *ctx)
 {
-        int err = -1;
-        uint32_t kschd[uAES_MAX_KSCHD_SIZE] = {0UL};
-        size_t Nk, Nb, Nr, idx = 0UL, offset = plaintext_size;
+        return (NULL != ctx) ? (&ctx->prof) : (NULL);
+}
 
-        if(0 != (plaintext_size & uAES_BLOCK_ALIGN_MASK))
+/**
+ * @brief Clears the cycle counts of a context, the key expansion count included.
+ * 
+ * @param ctx                   Pointer to an initialised key context.
+ */
+void uaes_ctx_profile_reset(uaes_ctx_t *ctx)
+{
+        if(NULL != ctx)
         {
-                offset = uAES_ALIGN( plaintext_size, uAES_BLOCK_ALIGN );
+                memset(&ctx->prof, 0x00, sizeof(uaes_prof_t));
         }
+        return;
+}
+#endif /*uAES_CFG_PROFILE*/
 
-        offset >>= 4UL;
-
-        Nb = 4UL;
-        Nk = Nb + (aes_length * 2UL);
-        Nr = Nb + (aes_length * 2UL);
+/**
+ * @brief Performs AES Cipher Block Chaining encryption on given plaintext
+ *        using a previously initialised key context.
+ * 
+ * @param ctx                   Pointer to key context.
+ * @param plaintext             Pointer to plaintext buffer
+ * @param plaintext_size        Plaintext buffer size.
+ * @param iv                    16-Byte Initialisation vector.
+ * @return int                  [0] if sucessful. [-1] on failure. 
+ */
+int uaes_ctx_cbc_encryption(const uaes_ctx_t *ctx,
+                            uint8_t *plaintext, 
+                            size_t plaintext_size, 
+                            uint8_t *iv)
+{
+        int err = -1;
+        uint8_t chain[uAES_BLOCK_SIZE];
+        size_t offset = uaes_block_count(plaintext_size);
 
-        if((NULL != key)                                &&
-           (NULL != plaintext)                          && 
-           (0 < plaintext_size)                         && 
-           (uAES_MAX_INPUT_SIZE >= plaintext_size)      && 
-           (uAESRGE > aes_length))
+        if( (NULL != ctx)                               && 
+            (0 != (ctx->usage & uAES_CTX_ENCRYPT))      &&
+            (NULL != plaintext)                         &&
+            (NULL != iv)                                && 
+            (0 < plaintext_size)                        && 
+            (uAES_MAX_INPUT_SIZE >= plaintext_size) )
         {
-                key_expansion(key, kschd, Nk, (Nb * (Nr + 1)));
-                while(offset > idx)
+                memcpy(chain, iv, uAES_BLOCK_SIZE);
+                if(0 != uaes_offload_run(ctx, uAES_OP_CBC_ENCRYPT, plaintext, plaintext, uAES_BLOCK_SIZE * offset, chain, 0UL))
                 {
-                        uaes_foward_cipher(&plaintext[uAES_BLOCK_SIZE * idx], kschd, Nk, Nb, Nr);
-                        idx++;
+                        uaes_cbc_encrypt_blocks(ctx, plaintext, plaintext, offset, chain);
                 }
                 err = 0;
         }
-
+        
         return err;
 }
 
 /**
- * NOTE: AES-ECB IS NO LONGER CONSIDERED SAFE, USE IT AT YOUR OWN RISK.
- * 
- * @brief Performs AES-ECB decryption on given plaintext.
+ * @brief Performs AES Cipher Block Chaining decryption on given ciphertext
+ *        using a previously initialised key context.
  * 
+ * @param ctx                   Pointer to key context.
  * @param ciphertext            Pointer to ciphertext buffer.
- * @param ciphertext_size       Size of ciphertext buffer.
- * @param key                   Pointer to key buffer.
- * @param aes_length            Encryption/Decryption key length. 
+ * @param ciphertext_size       Ciphertext buffer size.
+ * @param iv                    16-Byte initialisation vector.
  * @return int                  [0] if sucessful, [-1] on failure.
  */
-int uaes_ecb_decryption(uint8_t *ciphertext,
-                        size_t ciphertext_size,
-                        uint8_t *key,
-                        aes_length_t aes_length)
+int uaes_ctx_cbc_decryption(const uaes_ctx_t *ctx,
+                            uint8_t *ciphertext, 
+                            size_t ciphertext_size, 
+                            uint8_t *iv)
 {
         int err = -1;
-        uint32_t kschd[ uAES_MAX_KSCHD_SIZE ] = {0UL};
-        size_t Nk, Nb, Nr, idx = 0UL, offset = ciphertext_size;
-
-        if(0 != ( ciphertext_size & uAES_BLOCK_ALIGN_MASK ) )
-        {
-                offset = uAES_ALIGN( ciphertext_size, uAES_BLOCK_ALIGN );
-        }
-        
-        offset >>= 4UL;
+        uint8_t chain[uAES_BLOCK_SIZE];
+        size_t offset = uaes_block_count(ciphertext_size);
 
-        Nb = 4UL;
-        Nk = Nb + (aes_length * 2UL);
-        Nr = Nb + (aes_length * 2UL);
-
-        if((NULL != key)                                && 
-           (NULL != ciphertext)                         && 
-           (0 < ciphertext_size)                        && 
-           (uAES_MAX_INPUT_SIZE >= ciphertext_size)     && 
-           (uAESRGE > aes_length))
+        if( (NULL != ctx)                               && 
+            (0 != (ctx->usage & uAES_CTX_DECRYPT))      &&
+            (NULL != ciphertext)                        &&
+            (NULL != iv)                                && 
+            (0 < ciphertext_size)                       && 
+            (uAES_MAX_INPUT_SIZE >= ciphertext_size) )
         {
-                key_expansion(key, kschd, Nk, (Nb * (Nr + 1)));
-                while(offset > idx)
+                memcpy(chain, iv, uAES_BLOCK_SIZE);
+                if((0 != uaes_offload_run(ctx, uAES_OP_CBC_DECRYPT, ciphertext, ciphertext, uAES_BLOCK_SIZE * offset, chain, 0UL)) &&
+                   (0 != uaes_pool_cbc_decrypt(ctx, ciphertext, offset, chain)))
                 {
-                        uaes_inverse_cipher(&ciphertext[uAES_BLOCK_SIZE * idx], kschd, Nk, Nb, Nr);
-                        idx++;
+                        uaes_cbc_decrypt_blocks(ctx, ciphertext, ciphertext, offset, chain);
                 }
                 err = 0;
         }
@@ -382,147 +600,987 @@ int uaes_ecb_decryption(uint8_t *ciphertext,
         return err;
 }
 
+#if uAES_CFG_CTS
 /**
- * @brief Computes AES-128 encryption on a single 16 byte plaintext block.
+ * @brief Performs AES-CBC encryption with ciphertext stealing (CBC-CS3, NIST
+ *        SP 800-38A addendum) using a previously initialised key context. The
+ *        ciphertext has the size of the plaintext and is written in place, no
+ *        padding is needed. The last two ciphertext blocks are always swapped,
+ *        the final one truncated to the length of the last plaintext block.
+ *        A single block is plain CBC.
  * 
+ * @param ctx                   Pointer to key context.
  * @param plaintext             Pointer to plaintext buffer.
- * @param key                   Pointer to key buffer.
- * @param plaintext_size        Plaintext buffer size.
+ * @param plaintext_size        Plaintext buffer size, 16 bytes or more.
+ * @param iv                    16-Byte initialisation vector.
  * @return int                  [0] if sucessful, [-1] on failure.
  */
-int uaes128enc(uint8_t *plaintext, uint8_t *key, size_t plaintext_size)
+int uaes_ctx_cbc_cs3_encryption(const uaes_ctx_t *ctx,
+                                uint8_t *plaintext,
+                                size_t plaintext_size,
+                                uint8_t *iv)
 {
         int err = -1;
-        const size_t Nk = 4, Nb = 4, Nr = 10;
-        uint32_t kschd[uAES128_KSCHD_SIZE] = {0UL};
+        uint8_t chain[uAES_BLOCK_SIZE];
+        uint8_t last[uAES_BLOCK_SIZE];
+        const size_t nblocks = uaes_block_count(plaintext_size);
+        size_t tail = 0;
+        uint8_t *pn1 = NULL;
 
-        if((NULL != key) && (NULL != plaintext) && (0 < plaintext_size) && (uAES_BLOCK_SIZE >= plaintext_size))
+        if( (NULL != ctx)                               &&
+            (0 != (ctx->usage & uAES_CTX_ENCRYPT))      &&
+            (NULL != plaintext)                         &&
+            (NULL != iv)                                &&
+            (uAES_BLOCK_SIZE <= plaintext_size)         &&
+            (uAES_MAX_INPUT_SIZE >= plaintext_size) )
         {
+                memcpy(chain, iv, uAES_BLOCK_SIZE);
+                if(1UL == nblocks)
+                {
+                        uaes_cbc_encrypt_blocks(ctx, plaintext, plaintext, 1UL, chain);
+                }
+                else
+                {
+                        tail = plaintext_size - (uAES_BLOCK_SIZE * (nblocks - 1UL));
+                        pn1  = &plaintext[uAES_BLOCK_SIZE * (nblocks - 2UL)];
+                        if((2UL < nblocks) &&
+                           (0 != uaes_offload_run(ctx, uAES_OP_CBC_ENCRYPT, plaintext, plaintext, uAES_BLOCK_SIZE * (nblocks - 2UL), chain, 0UL)))
+                        {
+                                uaes_cbc_encrypt_blocks(ctx, plaintext, plaintext, nblocks - 2UL, chain);
+                        }
+                        /* C*(n-1) = E(P(n-1) ^ C(n-2)), C(n) = E((P(n) || 0) ^ C*(n-1)). */
+                        uaes_cbc_encrypt_blocks(ctx, pn1, pn1, 1UL, chain);
+                        memcpy(last, chain, uAES_BLOCK_SIZE);
+                        for(size_t idx = 0; idx < tail; idx++)
+                        {
+                                last[idx] ^= pn1[uAES_BLOCK_SIZE + idx];
+                        }
+                        memcpy(&pn1[uAES_BLOCK_SIZE], pn1, tail);
+                        uAES_PROF_OP(ctx, uAES_PROF_CBC, ctx->engine->encrypt(ctx, pn1, last, 1UL));
+                }
+                uaes_wipe(last, sizeof(last));
+                uaes_wipe(chain, sizeof(chain));
                 err = 0;
-                key_expansion(key, kschd, Nk, (Nb * (Nr + 1)));
-                uaes_foward_cipher(plaintext, kschd, Nk, Nb, Nr);
         }
 
         return err;
 }
 
 /**
- * @brief Computes AES-192 encryption on a single 16 byte plaintext block.
+ * @brief Performs AES-CBC-CS3 decryption on given ciphertext using a previously
+ *        initialised key context, in place and length preserving. Every block
+ *        ahead of the last two goes through the regular CBC decryption paths.
  * 
- * @param plaintext             Pointer to plaintext buffer.
- * @param key                   Pointer to key buffer.
- * @param plaintext_size        Plaintext buffer size.
+ * @param ctx                   Pointer to key context.
+ * @param ciphertext            Pointer to ciphertext buffer.
+ * @param ciphertext_size       Ciphertext buffer size, 16 bytes or more.
+ * @param iv                    16-Byte initialisation vector.
  * @return int                  [0] if sucessful, [-1] on failure.
  */
-int uaes192enc(uint8_t *plaintext, uint8_t *key, size_t plaintext_size)
+int uaes_ctx_cbc_cs3_decryption(const uaes_ctx_t *ctx,
+                                uint8_t *ciphertext,
+                                size_t ciphertext_size,
+                                uint8_t *iv)
 {
         int err = -1;
-        const size_t Nk = 6, Nb = 4, Nr = 12;
-        uint32_t kschd[uAES192_KSCHD_SIZE] = {0UL};
+        uint8_t chain[uAES_BLOCK_SIZE];
+        uint8_t last[uAES_BLOCK_SIZE];
+        const size_t nblocks = uaes_block_count(ciphertext_size);
+        size_t tail = 0;
+        uint8_t *cn1 = NULL;
 
-        if((NULL != key) && (NULL != plaintext) && (0 < plaintext_size) && (uAES_BLOCK_SIZE >= plaintext_size))
+        if( (NULL != ctx)                               &&
+            (0 != (ctx->usage & uAES_CTX_DECRYPT))      &&
+            (NULL != ciphertext)                        &&
+            (NULL != iv)                                &&
+            (uAES_BLOCK_SIZE <= ciphertext_size)        &&
+            (uAES_MAX_INPUT_SIZE >= ciphertext_size) )
         {
+                memcpy(chain, iv, uAES_BLOCK_SIZE);
+                if(1UL == nblocks)
+                {
+                        uaes_cbc_decrypt_blocks(ctx, ciphertext, ciphertext, 1UL, chain);
+                }
+                else
+                {
+                        tail = ciphertext_size - (uAES_BLOCK_SIZE * (nblocks - 1UL));
+                        cn1  = &ciphertext[uAES_BLOCK_SIZE * (nblocks - 2UL)];
+                        if((2UL < nblocks) &&
+                           (0 != uaes_offload_run(ctx, uAES_OP_CBC_DECRYPT, ciphertext, ciphertext, uAES_BLOCK_SIZE * (nblocks - 2UL), chain, 0UL)) &&
+                           (0 != uaes_pool_cbc_decrypt(ctx, ciphertext, nblocks - 2UL, chain)))
+                        {
+                                uaes_cbc_decrypt_blocks(ctx, ciphertext, ciphertext, nblocks - 2UL, chain);
+                        }
+                        /* D(C(n)) = (P(n) || 0) ^ C*(n-1), its tail completes C*(n-1). */
+                        uAES_PROF_OP(ctx, uAES_PROF_CBC, ctx->engine->decrypt(ctx, last, cn1, 1UL));
+                        for(size_t idx = 0; idx < tail; idx++)
+                        {
+                                const uint8_t c = cn1[uAES_BLOCK_SIZE + idx];
+
+                                cn1[uAES_BLOCK_SIZE + idx] = last[idx] ^ c;
+                                last[idx] = c;
+                        }
+                        uaes_cbc_decrypt_blocks(ctx, cn1, last, 1UL, chain);
+                }
+                uaes_wipe(last, sizeof(last));
+                uaes_wipe(chain, sizeof(chain));
                 err = 0;
-                key_expansion(key, kschd, Nk, (Nb * (Nr + 1)));
-                uaes_foward_cipher(plaintext, kschd, Nk, Nb, Nr);
         }
 
         return err;
 }
+#endif /*uAES_CFG_CTS*/
 
 /**
- * @brief Computes AES-256 encryption on a single 16 byte plaintext block.
+ * NOTE: AES-ECB IS NO LONGER CONSIDERED SAFE, USE IT AT YOUR OWN RISK.
+ * 
+ * @brief Performs AES Electronic Code Book encryption on given plaintext
+ *        using a previously initialised key context.
  * 
+ * @param ctx                   Pointer to key context.
  * @param plaintext             Pointer to plaintext buffer.
- * @param key                   Pointer to key buffer.
- * @param plaintext_size        Plaintext buffer size.
+ * @param plaintext_size        Size of plaintext buffer.
  * @return int                  [0] if sucessful, [-1] on failure. 
  */
-int uaes256enc(uint8_t *plaintext, uint8_t *key, size_t plaintext_size)
+int uaes_ctx_ecb_encryption(const uaes_ctx_t *ctx,
+                            uint8_t *plaintext, 
+                            size_t  plaintext_size)
 {
         int err = -1;
-        const size_t Nk = 8, Nb = 4, Nr = 14;
-        uint32_t kschd[uAES256_KSCHD_SIZE] = {0UL};
+        size_t offset = uaes_block_count(plaintext_size);
 
-        if((NULL != key) && (NULL != plaintext) && (0 < plaintext_size) && (uAES_BLOCK_SIZE >= plaintext_size))
+        if((NULL != ctx)                                &&
+           (0 != (ctx->usage & uAES_CTX_ENCRYPT))       &&
+           (NULL != plaintext)                          && 
+           (0 < plaintext_size)                         && 
+           (uAES_MAX_INPUT_SIZE >= plaintext_size))
         {
+                uAES_PROF_START(t0);
+                if((0 != uaes_offload_run(ctx, uAES_OP_ECB_ENCRYPT, plaintext, plaintext, uAES_BLOCK_SIZE * offset, NULL, 0UL)) &&
+                   (0 != uaes_pool_ecb(ctx, plaintext, offset, 0)))
+                {
+                        ctx->engine->encrypt(ctx, plaintext, plaintext, offset);
+                }
+                uAES_PROF_STOP(ctx, uAES_PROF_ECB, t0);
                 err = 0;
-                key_expansion( key, kschd, Nk, ( Nb * ( Nr + 1 ) ) );
-                uaes_foward_cipher( plaintext, kschd, Nk, Nb, Nr );
         }
 
         return err;
 }
 
 /**
- * @brief Computes AES-128 decryption on a single 16 byte ciphertext block.
+ * NOTE: AES-ECB IS NO LONGER CONSIDERED SAFE, USE IT AT YOUR OWN RISK.
  * 
- * @param ciphertext            Pointer to ciphertext buffer
- * @param key                   Pointer to key buffer
- * @param ciphertext_size       Ciphertext buffer size.
+ * @brief Performs AES-ECB decryption on given ciphertext using a previously
+ *        initialised key context.
+ * 
+ * @param ctx                   Pointer to key context.
+ * @param ciphertext            Pointer to ciphertext buffer.
+ * @param ciphertext_size       Size of ciphertext buffer.
  * @return int                  [0] if sucessful, [-1] on failure.
  */
-extern int uaes128dec(uint8_t *ciphertext, uint8_t *key, size_t ciphertext_size)
+int uaes_ctx_ecb_decryption(const uaes_ctx_t *ctx,
+                            uint8_t *ciphertext,
+                            size_t ciphertext_size)
 {
         int err = -1;
-        const size_t Nk = 4, Nb = 4, Nr = 10;
-        uint32_t kschd[uAES128_KSCHD_SIZE] = {0UL};
+        size_t offset = uaes_block_count(ciphertext_size);
 
-        if((NULL != key) && (NULL != ciphertext) && (0 < ciphertext_size) && (uAES_BLOCK_SIZE >= ciphertext_size))
+        if((NULL != ctx)                                &&
+           (0 != (ctx->usage & uAES_CTX_DECRYPT))       &&
+           (NULL != ciphertext)                         && 
+           (0 < ciphertext_size)                        && 
+           (uAES_MAX_INPUT_SIZE >= ciphertext_size))
         {
+                uAES_PROF_START(t0);
+                if((0 != uaes_offload_run(ctx, uAES_OP_ECB_DECRYPT, ciphertext, ciphertext, uAES_BLOCK_SIZE * offset, NULL, 0UL)) &&
+                   (0 != uaes_pool_ecb(ctx, ciphertext, offset, 1)))
+                {
+                        ctx->engine->decrypt(ctx, ciphertext, ciphertext, offset);
+                }
+                uAES_PROF_STOP(ctx, uAES_PROF_ECB, t0);
                 err = 0;
-                key_expansion(key, kschd, Nk, (Nb * (Nr + 1)));
-                uaes_inverse_cipher(ciphertext, kschd, Nk, Nb, Nr);
         }
 
         return err;
 }
 
 /**
- * @brief Computes AES-192 decryption on a single 16 byte ciphertext block.
+ * @brief Performs AES Cipher Block Chaining encryption from one buffer into
+ *        another, the plaintext is left untouched.
  * 
- * @param ciphertext            Pointer to ciphertext buffer
- * @param key                   Pointer to key buffer
- * @param ciphertext_size       Ciphertext buffer size.
+ * @param ctx                   Pointer to key context.
+ * @param dst                   Pointer to ciphertext buffer, may be src but not overlap it otherwise.
+ * @param src                   Pointer to plaintext buffer.
+ * @param size                  Buffer size, a multiple of 16 bytes.
+ * @param iv                    16-Byte initialisation vector.
  * @return int                  [0] if sucessful, [-1] on failure.
  */
-extern int uaes192dec(uint8_t *ciphertext, uint8_t *key, size_t ciphertext_size)
+int uaes_ctx_cbc_encryption_oop(const uaes_ctx_t *ctx,
+                                uint8_t *dst,
+                                const uint8_t *src,
+                                size_t size,
+                                uint8_t *iv)
 {
         int err = -1;
-        const size_t Nk = 6, Nb = 4, Nr = 12;
-        uint32_t kschd[uAES192_KSCHD_SIZE] = {0UL};
-        
-        if((NULL != key) && (NULL != ciphertext) && (0 < ciphertext_size) && (uAES_BLOCK_SIZE >= ciphertext_size))
+        uint8_t chain[uAES_BLOCK_SIZE];
+
+        if( (NULL != ctx)                               && 
+            (0 != (ctx->usage & uAES_CTX_ENCRYPT))      &&
+            (NULL != dst)                               &&
+            (NULL != src)                               &&
+            (NULL != iv)                                && 
+            (0 < size)                                  && 
+            (0 == (size & uAES_BLOCK_ALIGN_MASK))       &&
+            (uAES_MAX_INPUT_SIZE >= size) )
         {
-              err = 0;
-              key_expansion(key, kschd, Nk, (Nb * (Nr + 1)));
-              uaes_inverse_cipher(ciphertext, kschd, Nk, Nb, Nr);
+                memcpy(chain, iv, uAES_BLOCK_SIZE);
+                if(0 != uaes_offload_run(ctx, uAES_OP_CBC_ENCRYPT, dst, src, size, chain, 0UL))
+                {
+                        uaes_cbc_encrypt_blocks(ctx, dst, src, size / uAES_BLOCK_SIZE, chain);
+                }
+                err = 0;
         }
-
+        
         return err;
 }
 
 /**
- * @brief Computes AES-256 decryption on a single 16 byte ciphertext block.
+ * @brief Performs AES Cipher Block Chaining decryption from one buffer into
+ *        another, the ciphertext is left untouched.
  * 
- * @param ciphertext            Pointer to ciphertext buffer
- * @param key                   Pointer to key buffer
- * @param ciphertext_size       Ciphertext buffer size.
+ * @param ctx                   Pointer to key context.
+ * @param dst                   Pointer to plaintext buffer, may be src but not overlap it otherwise.
+ * @param src                   Pointer to ciphertext buffer.
+ * @param size                  Buffer size, a multiple of 16 bytes.
+ * @param iv                    16-Byte initialisation vector.
  * @return int                  [0] if sucessful, [-1] on failure.
  */
-extern int uaes256dec(uint8_t *ciphertext, uint8_t *key, size_t ciphertext_size)
+int uaes_ctx_cbc_decryption_oop(const uaes_ctx_t *ctx,
+                                uint8_t *dst,
+                                const uint8_t *src,
+                                size_t size,
+                                uint8_t *iv)
 {
         int err = -1;
-        const size_t Nk = 8, Nb = 4, Nr = 14;
-        uint32_t kschd[uAES256_KSCHD_SIZE] = {0UL};
+        uint8_t chain[uAES_BLOCK_SIZE];
 
-        if((NULL != key) && (NULL != ciphertext) && (0 < ciphertext_size) && (uAES_BLOCK_SIZE >= ciphertext_size))
+        if( (NULL != ctx)                               && 
+            (0 != (ctx->usage & uAES_CTX_DECRYPT))      &&
+            (NULL != dst)                               &&
+            (NULL != src)                               &&
+            (NULL != iv)                                && 
+            (0 < size)                                  && 
+            (0 == (size & uAES_BLOCK_ALIGN_MASK))       &&
+            (uAES_MAX_INPUT_SIZE >= size) )
         {
+                memcpy(chain, iv, uAES_BLOCK_SIZE);
+                if((0 != uaes_offload_run(ctx, uAES_OP_CBC_DECRYPT, dst, src, size, chain, 0UL)) &&
+                   ((dst != src) || (0 != uaes_pool_cbc_decrypt(ctx, dst, size / uAES_BLOCK_SIZE, chain))))
+                {
+                        uaes_cbc_decrypt_blocks(ctx, dst, src, size / uAES_BLOCK_SIZE, chain);
+                }
                 err = 0;
-                key_expansion(key, kschd, Nk, (Nb * (Nr + 1)));
-                uaes_inverse_cipher(ciphertext, kschd, Nk, Nb, Nr);
         }
 
         return err;
 }
 
+/**
+ * NOTE: AES-ECB IS NO LONGER CONSIDERED SAFE, USE IT AT YOUR OWN RISK.
+ * 
+ * @brief Performs AES Electronic Code Book encryption from one buffer into
+ *        another, the plaintext is left untouched.
+ * 
+ * @param ctx                   Pointer to key context.
+ * @param dst                   Pointer to ciphertext buffer, may be src but not overlap it otherwise.
+ * @param src                   Pointer to plaintext buffer.
+ * @param size                  Buffer size, a multiple of 16 bytes.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_ecb_encryption_oop(const uaes_ctx_t *ctx,
+                                uint8_t *dst,
+                                const uint8_t *src,
+                                size_t size)
+{
+        int err = -1;
+
+        if((NULL != ctx)                                &&
+           (0 != (ctx->usage & uAES_CTX_ENCRYPT))       &&
+           (NULL != dst)                                &&
+           (NULL != src)                                && 
+           (0 < size)                                   && 
+           (0 == (size & uAES_BLOCK_ALIGN_MASK))        &&
+           (uAES_MAX_INPUT_SIZE >= size))
+        {
+                uAES_PROF_START(t0);
+                if((0 != uaes_offload_run(ctx, uAES_OP_ECB_ENCRYPT, dst, src, size, NULL, 0UL)) &&
+                   ((dst != src) || (0 != uaes_pool_ecb(ctx, dst, size / uAES_BLOCK_SIZE, 0))))
+                {
+                        ctx->engine->encrypt(ctx, dst, src, size / uAES_BLOCK_SIZE);
+                }
+                uAES_PROF_STOP(ctx, uAES_PROF_ECB, t0);
+                err = 0;
+        }
+
+        return err;
+}
+
+/**
+ * NOTE: AES-ECB IS NO LONGER CONSIDERED SAFE, USE IT AT YOUR OWN RISK.
+ * 
+ * @brief Performs AES-ECB decryption from one buffer into another, the
+ *        ciphertext is left untouched.
+ * 
+ * @param ctx                   Pointer to key context.
+ * @param dst                   Pointer to plaintext buffer, may be src but not overlap it otherwise.
+ * @param src                   Pointer to ciphertext buffer.
+ * @param size                  Buffer size, a multiple of 16 bytes.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_ecb_decryption_oop(const uaes_ctx_t *ctx,
+                                uint8_t *dst,
+                                const uint8_t *src,
+                                size_t size)
+{
+        int err = -1;
+
+        if((NULL != ctx)                                &&
+           (0 != (ctx->usage & uAES_CTX_DECRYPT))       &&
+           (NULL != dst)                                &&
+           (NULL != src)                                && 
+           (0 < size)                                   && 
+           (0 == (size & uAES_BLOCK_ALIGN_MASK))        &&
+           (uAES_MAX_INPUT_SIZE >= size))
+        {
+                uAES_PROF_START(t0);
+                if((0 != uaes_offload_run(ctx, uAES_OP_ECB_DECRYPT, dst, src, size, NULL, 0UL)) &&
+                   ((dst != src) || (0 != uaes_pool_ecb(ctx, dst, size / uAES_BLOCK_SIZE, 1))))
+                {
+                        ctx->engine->decrypt(ctx, dst, src, size / uAES_BLOCK_SIZE);
+                }
+                uAES_PROF_STOP(ctx, uAES_PROF_ECB, t0);
+                err = 0;
+        }
+
+        return err;
+}
+
+/**
+ * @brief Computes AES encryption on a single 16 byte plaintext block using a
+ *        previously initialised key context.
+ * 
+ * @param ctx                   Pointer to key context.
+ * @param plaintext             Pointer to plaintext buffer.
+ * @param plaintext_size        Plaintext buffer size.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_block_encryption(const uaes_ctx_t *ctx, uint8_t *plaintext, size_t plaintext_size)
+{
+        int err = -1;
+
+        if((NULL != ctx) && (0 != (ctx->usage & uAES_CTX_ENCRYPT)) && (NULL != plaintext) && (0 < plaintext_size) && (uAES_BLOCK_SIZE >= plaintext_size))
+        {
+                err = 0;
+                ctx->engine->encrypt(ctx, plaintext, plaintext, 1UL);
+        }
+
+        return err;
+}
+
+/**
+ * @brief Computes AES decryption on a single 16 byte ciphertext block using a
+ *        previously initialised key context.
+ * 
+ * @param ctx                   Pointer to key context.
+ * @param ciphertext            Pointer to ciphertext buffer.
+ * @param ciphertext_size       Ciphertext buffer size.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_block_decryption(const uaes_ctx_t *ctx, uint8_t *ciphertext, size_t ciphertext_size)
+{
+        int err = -1;
+
+        if((NULL != ctx) && (0 != (ctx->usage & uAES_CTX_DECRYPT)) && (NULL != ciphertext) && (0 < ciphertext_size) && (uAES_BLOCK_SIZE >= ciphertext_size))
+        {
+                err = 0;
+                ctx->engine->decrypt(ctx, ciphertext, ciphertext, 1UL);
+        }
+
+        return err;
+}
+
+#if uAES_CFG_PCBC
+/**
+ * @brief Performs AES Propagating Cipher Block Chaining encryption on given
+ *        plaintext using a previously initialised key context, each block is
+ *        chained with both the previous plaintext and ciphertext blocks.
+ * 
+ * @param ctx                   Pointer to key context.
+ * @param plaintext             Pointer to plaintext buffer.
+ * @param plaintext_size        Plaintext buffer size, a multiple of 16 bytes.
+ * @param iv                    16-Byte initialisation vector.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_pcbc_encryption(const uaes_ctx_t *ctx,
+                             uint8_t *plaintext,
+                             size_t plaintext_size,
+                             uint8_t *iv)
+{
+        int err = -1;
+        uint8_t chain[uAES_BLOCK_SIZE];
+        uint8_t blk[uAES_BLOCK_SIZE];
+
+        if( (NULL != ctx)                               &&
+            (0 != (ctx->usage & uAES_CTX_ENCRYPT))      &&
+            (NULL != plaintext)                         &&
+            (NULL != iv)                                &&
+            (0 < plaintext_size)                        &&
+            (0 == (plaintext_size & uAES_BLOCK_ALIGN_MASK)) &&
+            (uAES_MAX_INPUT_SIZE >= plaintext_size) )
+        {
+                uAES_PROF_START(t0);
+                memcpy(chain, iv, uAES_BLOCK_SIZE);
+                for(size_t pos = 0; pos < plaintext_size; pos += uAES_BLOCK_SIZE)
+                {
+                        memcpy(blk, &plaintext[pos], uAES_BLOCK_SIZE);
+                        uaes_xor_iv(&plaintext[pos], chain);
+                        ctx->engine->encrypt(ctx, &plaintext[pos], &plaintext[pos], 1UL);
+                        uaes_xor_iv(blk, &plaintext[pos]);
+                        memcpy(chain, blk, uAES_BLOCK_SIZE);
+                }
+                uaes_wipe(blk, sizeof(blk));
+                uaes_wipe(chain, sizeof(chain));
+                uAES_PROF_STOP(ctx, uAES_PROF_PCBC, t0);
+                err = 0;
+        }
+
+        return err;
+}
+
+/**
+ * @brief Performs AES-PCBC decryption on given ciphertext using a previously
+ *        initialised key context. The blocks are deciphered uAES_CFG_CBC_BATCH
+ *        at a time, only the chaining that follows is serial.
+ * 
+ * @param ctx                   Pointer to key context.
+ * @param ciphertext            Pointer to ciphertext buffer.
+ * @param ciphertext_size       Ciphertext buffer size, a multiple of 16 bytes.
+ * @param iv                    16-Byte initialisation vector.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_pcbc_decryption(const uaes_ctx_t *ctx,
+                             uint8_t *ciphertext,
+                             size_t ciphertext_size,
+                             uint8_t *iv)
+{
+        int err = -1;
+        uint8_t chain[uAES_BLOCK_SIZE];
+        uint8_t saved[uAES_BLOCK_SIZE * uAES_CFG_CBC_BATCH];
+        size_t nblocks = ciphertext_size / uAES_BLOCK_SIZE;
+        size_t batch = 0;
+
+        if( (NULL != ctx)                               &&
+            (0 != (ctx->usage & uAES_CTX_DECRYPT))      &&
+            (NULL != ciphertext)                        &&
+            (NULL != iv)                                &&
+            (0 < ciphertext_size)                       &&
+            (0 == (ciphertext_size & uAES_BLOCK_ALIGN_MASK)) &&
+            (uAES_MAX_INPUT_SIZE >= ciphertext_size) )
+        {
+                uAES_PROF_START(t0);
+                memcpy(chain, iv, uAES_BLOCK_SIZE);
+                while(0 < nblocks)
+                {
+                        batch = ( nblocks < uAES_CFG_CBC_BATCH ) ? (nblocks) : (uAES_CFG_CBC_BATCH);
+                        memcpy(saved, ciphertext, uAES_BLOCK_SIZE * batch);
+                        ctx->engine->decrypt(ctx, ciphertext, ciphertext, batch);
+                        for(size_t idx = 0; idx < batch; idx++)
+                        {
+                                uaes_xor_iv(&ciphertext[uAES_BLOCK_SIZE * idx], chain);
+                                memcpy(chain, &ciphertext[uAES_BLOCK_SIZE * idx], uAES_BLOCK_SIZE);
+                                uaes_xor_iv(chain, &saved[uAES_BLOCK_SIZE * idx]);
+                        }
+                        ciphertext += uAES_BLOCK_SIZE * batch;
+                        nblocks    -= batch;
+                }
+                uaes_wipe(saved, sizeof(saved));
+                uaes_wipe(chain, sizeof(chain));
+                uAES_PROF_STOP(ctx, uAES_PROF_PCBC, t0);
+                err = 0;
+        }
+
+        return err;
+}
+#endif /*uAES_CFG_PCBC*/
+
+#if uAES_CFG_CFB
+/**
+ * @brief Performs AES Cipher Feedback (CFB-128) encryption on given plaintext
+ *        using a previously initialised key context. A trailing partial block
+ *        uses the leading bytes of its keystream block.
+ * 
+ * @param ctx                   Pointer to key context, uAES_CTX_ENCRYPT is enough for both directions.
+ * @param plaintext             Pointer to plaintext buffer.
+ * @param plaintext_size        Plaintext buffer size, any value.
+ * @param iv                    16-Byte initialisation vector.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_cfb_encryption(const uaes_ctx_t *ctx,
+                            uint8_t *plaintext,
+                            size_t plaintext_size,
+                            uint8_t *iv)
+{
+        int err = -1;
+        uint8_t chain[uAES_BLOCK_SIZE];
+        size_t len = 0;
+
+        if( (NULL != ctx)                               &&
+            (0 != (ctx->usage & uAES_CTX_ENCRYPT))      &&
+            (NULL != plaintext)                         &&
+            (NULL != iv)                                &&
+            (0 < plaintext_size)                        &&
+            (uAES_MAX_INPUT_SIZE >= plaintext_size) )
+        {
+                uAES_PROF_START(t0);
+                memcpy(chain, iv, uAES_BLOCK_SIZE);
+                for(size_t pos = 0; pos < plaintext_size; pos += len)
+                {
+                        len = ( (plaintext_size - pos) < uAES_BLOCK_SIZE ) ? (plaintext_size - pos) : (uAES_BLOCK_SIZE);
+                        ctx->engine->encrypt(ctx, chain, chain, 1UL);
+                        for(size_t idx = 0; idx < len; idx++)
+                        {
+                                plaintext[pos + idx] ^= chain[idx];
+                                chain[idx] = plaintext[pos + idx];
+                        }
+                }
+                uaes_wipe(chain, sizeof(chain));
+                uAES_PROF_STOP(ctx, uAES_PROF_CFB, t0);
+                err = 0;
+        }
+
+        return err;
+}
+
+/**
+ * @brief Performs AES-CFB-128 decryption on given ciphertext using a previously
+ *        initialised key context. Every cipher input is the IV or a ciphertext
+ *        block already at hand, so uAES_CFG_CBC_BATCH of them go through the
+ *        engine per call and its multi-block paths overlap their rounds.
+ * 
+ * @param ctx                   Pointer to key context, uAES_CTX_ENCRYPT.
+ * @param ciphertext            Pointer to ciphertext buffer.
+ * @param ciphertext_size       Ciphertext buffer size, any value.
+ * @param iv                    16-Byte initialisation vector.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_cfb_decryption(const uaes_ctx_t *ctx,
+                            uint8_t *ciphertext,
+                            size_t ciphertext_size,
+                            uint8_t *iv)
+{
+        int err = -1;
+        uint8_t keystream[uAES_BLOCK_SIZE * uAES_CFG_CBC_BATCH];
+        uint8_t chain[uAES_BLOCK_SIZE];
+        size_t nblocks = uaes_block_count(ciphertext_size);
+        size_t batch = 0, len = 0;
+
+        if( (NULL != ctx)                               &&
+            (0 != (ctx->usage & uAES_CTX_ENCRYPT))      &&
+            (NULL != ciphertext)                        &&
+            (NULL != iv)                                &&
+            (0 < ciphertext_size)                       &&
+            (uAES_MAX_INPUT_SIZE >= ciphertext_size) )
+        {
+                uAES_PROF_START(t0);
+                memcpy(chain, iv, uAES_BLOCK_SIZE);
+                while(0 < nblocks)
+                {
+                        batch = ( nblocks < uAES_CFG_CBC_BATCH ) ? (nblocks) : (uAES_CFG_CBC_BATCH);
+                        len   = ( ciphertext_size < (uAES_BLOCK_SIZE * batch) ) ? (ciphertext_size) : (uAES_BLOCK_SIZE * batch);
+                        memcpy(keystream, chain, uAES_BLOCK_SIZE);
+                        memcpy(&keystream[uAES_BLOCK_SIZE], ciphertext, uAES_BLOCK_SIZE * (batch - 1UL));
+                        if((uAES_BLOCK_SIZE * batch) == len)
+                        {
+                                memcpy(chain, &ciphertext[uAES_BLOCK_SIZE * (batch - 1UL)], uAES_BLOCK_SIZE);
+                        }
+                        ctx->engine->encrypt(ctx, keystream, keystream, batch);
+                        for(size_t idx = 0; idx < len; idx++)
+                        {
+                                ciphertext[idx] ^= keystream[idx];
+                        }
+                        ciphertext      += len;
+                        ciphertext_size -= len;
+                        nblocks         -= batch;
+                }
+                uaes_wipe(keystream, sizeof(keystream));
+                uaes_wipe(chain, sizeof(chain));
+                uAES_PROF_STOP(ctx, uAES_PROF_CFB, t0);
+                err = 0;
+        }
+
+        return err;
+}
+#endif /*uAES_CFG_CFB*/
+
+/**
+ * @brief Performs AES Cipher Block Chaining encryption on given plaintext.
+ * 
+ * @param plaintext             Pointer to plaintext buffer
+ * @param plaintext_size        Plaintext buffer size.
+ * @param key                   Pointer to key buffer.
+ * @param iv                    16-Byte Initialisation vector.
+ * @param aes_length            Encryption/Decryption key length.
+ * @return int                  [0] if sucessful. [-1] on failure. 
+ */
+int uaes_cbc_encryption(uint8_t *plaintext, 
+                        size_t plaintext_size, 
+                        uint8_t *key, 
+                        uint8_t *iv, 
+                        aes_length_t aes_length)
+{
+        int err = -1;
+        uaes_ctx_t ctx;
+
+        if(0 == uaes_ctx_init(&ctx, key, aes_length, uAES_CTX_ENCRYPT))
+        {
+                err = uaes_ctx_cbc_encryption(&ctx, plaintext, plaintext_size, iv);
+                uaes_ctx_clear(&ctx);
+        }
+        
+        return err;
+}
+
+/**
+ * @brief Performs AES Cipher Block Chaining decryption on given ciphertext 
+ * 
+ * @param ciphertext            Pointer to ciphertext buffer.
+ * @param ciphertext_size       Ciphertext buffer size.
+ * @param key                   Pointer to key buffer.
+ * @param init_vec              16-Byte initialisation vector.
+ * @param aes_length            Encryption/Decryption key length.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes_cbc_decryption(uint8_t *ciphertext, 
+                        size_t ciphertext_size, 
+                        uint8_t *key, 
+                        uint8_t *iv,
+                        aes_length_t aes_length)
+{
+        int err = -1;
+        uaes_ctx_t ctx;
+
+        if(0 == uaes_ctx_init(&ctx, key, aes_length, uAES_CTX_DECRYPT))
+        {
+                err = uaes_ctx_cbc_decryption(&ctx, ciphertext, ciphertext_size, iv);
+                uaes_ctx_clear(&ctx);
+        }
+
+        return err;
+}
+
+/**
+ * NOTE: AES-ECB IS NO LONGER CONSIDERED SAFE, USE IT AT YOUR OWN RISK.
+ * 
+ * @brief Performs AES Electronic Code Book encryption on given plaintext.
+ * 
+ * @param plaintext             Pointer to plaintext buffer.
+ * @param plaintext_size        Size of plaintext buffer.
+ * @param key                   Pointer to key buffer.
+ * @param aes_length            Encryption/Decryption key length. 
+ * @return int                  [0] if sucessful, [-1] on failure. 
+ */
+int uaes_ecb_encryption(uint8_t *plaintext, 
+                        size_t  plaintext_size, 
+                        uint8_t *key, 
+                        aes_length_t aes_length)
+{
+        int err = -1;
+        uaes_ctx_t ctx;
+
+        if(0 == uaes_ctx_init(&ctx, key, aes_length, uAES_CTX_ENCRYPT))
+        {
+                err = uaes_ctx_ecb_encryption(&ctx, plaintext, plaintext_size);
+                uaes_ctx_clear(&ctx);
+        }
+
+        return err;
+}
+
+/**
+ * NOTE: AES-ECB IS NO LONGER CONSIDERED SAFE, USE IT AT YOUR OWN RISK.
+ * 
+ * @brief Performs AES-ECB decryption on given plaintext.
+ * 
+ * @param ciphertext            Pointer to ciphertext buffer.
+ * @param ciphertext_size       Size of ciphertext buffer.
+ * @param key                   Pointer to key buffer.
+ * @param aes_length            Encryption/Decryption key length. 
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes_ecb_decryption(uint8_t *ciphertext,
+                        size_t ciphertext_size,
+                        uint8_t *key,
+                        aes_length_t aes_length)
+{
+        int err = -1;
+        uaes_ctx_t ctx;
+
+        if(0 == uaes_ctx_init(&ctx, key, aes_length, uAES_CTX_DECRYPT))
+        {
+                err = uaes_ctx_ecb_decryption(&ctx, ciphertext, ciphertext_size);
+                uaes_ctx_clear(&ctx);
+        }
+
+        return err;
+}
+
+#if uAES_CFG_PCBC
+/**
+ * @brief Performs AES Propagating Cipher Block Chaining encryption on given plaintext.
+ * 
+ * @param plaintext             Pointer to plaintext buffer.
+ * @param plaintext_size        Plaintext buffer size, a multiple of 16 bytes.
+ * @param key                   Pointer to key buffer.
+ * @param iv                    16-Byte initialisation vector.
+ * @param aes_length            Encryption/Decryption key length.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes_pcbc_encryption(uint8_t *plaintext,
+                         size_t plaintext_size,
+                         uint8_t *key,
+                         uint8_t *iv,
+                         aes_length_t aes_length)
+{
+        int err = -1;
+        uaes_ctx_t ctx;
+
+        if(0 == uaes_ctx_init(&ctx, key, aes_length, uAES_CTX_ENCRYPT))
+        {
+                err = uaes_ctx_pcbc_encryption(&ctx, plaintext, plaintext_size, iv);
+                uaes_ctx_clear(&ctx);
+        }
+
+        return err;
+}
+
+/**
+ * @brief Performs AES-PCBC decryption on given ciphertext.
+ * 
+ * @param ciphertext            Pointer to ciphertext buffer.
+ * @param ciphertext_size       Ciphertext buffer size, a multiple of 16 bytes.
+ * @param key                   Pointer to key buffer.
+ * @param iv                    16-Byte initialisation vector.
+ * @param aes_length            Encryption/Decryption key length.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes_pcbc_decryption(uint8_t *ciphertext,
+                         size_t ciphertext_size,
+                         uint8_t *key,
+                         uint8_t *iv,
+                         aes_length_t aes_length)
+{
+        int err = -1;
+        uaes_ctx_t ctx;
+
+        if(0 == uaes_ctx_init(&ctx, key, aes_length, uAES_CTX_DECRYPT))
+        {
+                err = uaes_ctx_pcbc_decryption(&ctx, ciphertext, ciphertext_size, iv);
+                uaes_ctx_clear(&ctx);
+        }
+
+        return err;
+}
+
+#endif /*uAES_CFG_PCBC*/
+
+#if uAES_CFG_CFB
+/**
+ * @brief Performs AES Cipher Feedback (CFB-128) encryption on given plaintext.
+ * 
+ * @param plaintext             Pointer to plaintext buffer.
+ * @param plaintext_size        Plaintext buffer size, any value.
+ * @param key                   Pointer to key buffer.
+ * @param iv                    16-Byte initialisation vector.
+ * @param aes_length            Encryption/Decryption key length.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes_cfb_encryption(uint8_t *plaintext,
+                        size_t plaintext_size,
+                        uint8_t *key,
+                        uint8_t *iv,
+                        aes_length_t aes_length)
+{
+        int err = -1;
+        uaes_ctx_t ctx;
+
+        if(0 == uaes_ctx_init(&ctx, key, aes_length, uAES_CTX_ENCRYPT))
+        {
+                err = uaes_ctx_cfb_encryption(&ctx, plaintext, plaintext_size, iv);
+                uaes_ctx_clear(&ctx);
+        }
+
+        return err;
+}
+
+/**
+ * @brief Performs AES-CFB decryption on given ciphertext.
+ * 
+ * @param ciphertext            Pointer to ciphertext buffer.
+ * @param ciphertext_size       Ciphertext buffer size, any value.
+ * @param key                   Pointer to key buffer.
+ * @param iv                    16-Byte initialisation vector.
+ * @param aes_length            Encryption/Decryption key length.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes_cfb_decryption(uint8_t *ciphertext,
+                        size_t ciphertext_size,
+                        uint8_t *key,
+                        uint8_t *iv,
+                        aes_length_t aes_length)
+{
+        int err = -1;
+        uaes_ctx_t ctx;
+
+        if(0 == uaes_ctx_init(&ctx, key, aes_length, uAES_CTX_ENCRYPT))
+        {
+                err = uaes_ctx_cfb_decryption(&ctx, ciphertext, ciphertext_size, iv);
+                uaes_ctx_clear(&ctx);
+        }
+
+        return err;
+}
+
+#endif /*uAES_CFG_CFB*/
+
+/**
+ * @brief Computes AES-128 encryption on a single 16 byte plaintext block.
+ * 
+ * @param plaintext             Pointer to plaintext buffer.
+ * @param key                   Pointer to key buffer.
+ * @param plaintext_size        Plaintext buffer size.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes128enc(uint8_t *plaintext, uint8_t *key, size_t plaintext_size)
+{
+        int err = -1;
+        uaes_ctx_t ctx;
+
+        if(0 == uaes_ctx_init(&ctx, key, uAES128, uAES_CTX_ENCRYPT))
+        {
+                err = uaes_ctx_block_encryption(&ctx, plaintext, plaintext_size);
+                uaes_ctx_clear(&ctx);
+        }
+
+        return err;
+}
+
+/**
+ * @brief Computes AES-192 encryption on a single 16 byte plaintext block.
+ * 
+ * @param plaintext             Pointer to plaintext buffer.
+ * @param key                   Pointer to key buffer.
+ * @param plaintext_size        Plaintext buffer size.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes192enc(uint8_t *plaintext, uint8_t *key, size_t plaintext_size)
+{
+        int err = -1;
+        uaes_ctx_t ctx;
+
+        if(0 == uaes_ctx_init(&ctx, key, uAES192, uAES_CTX_ENCRYPT))
+        {
+                err = uaes_ctx_block_encryption(&ctx, plaintext, plaintext_size);
+                uaes_ctx_clear(&ctx);
+        }
+
+        return err;
+}
+
+/**
+ * @brief Computes AES-256 encryption on a single 16 byte plaintext block.
+ * 
+ * @param plaintext             Pointer to plaintext buffer.
+ * @param key                   Pointer to key buffer.
+ * @param plaintext_size        Plaintext buffer size.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes256enc(uint8_t *plaintext, uint8_t *key, size_t plaintext_size)
+{
+        int err = -1;
+        uaes_ctx_t ctx;
+
+        if(0 == uaes_ctx_init(&ctx, key, uAES256, uAES_CTX_ENCRYPT))
+        {
+                err = uaes_ctx_block_encryption(&ctx, plaintext, plaintext_size);
+                uaes_ctx_clear(&ctx);
+        }
+
+        return err;
+}
+
+/**
+ * @brief Computes AES-128 decryption on a single 16 byte ciphertext block.
+ * 
+ * @param ciphertext            Pointer to ciphertext buffer.
+ * @param key                   Pointer to key buffer.
+ * @param ciphertext_size       Ciphertext buffer size.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes128dec(uint8_t *ciphertext, uint8_t *key, size_t ciphertext_size)
+{
+        int err = -1;
+        uaes_ctx_t ctx;
+
+        if(0 == uaes_ctx_init(&ctx, key, uAES128, uAES_CTX_DECRYPT))
+        {
+                err = uaes_ctx_block_decryption(&ctx, ciphertext, ciphertext_size);
+                uaes_ctx_clear(&ctx);
+        }
+
+        return err;
+}
+
+/**
+ * @brief Computes AES-192 decryption on a single 16 byte ciphertext block.
+ * 
+ * @param ciphertext            Pointer to ciphertext buffer.
+ * @param key                   Pointer to key buffer.
+ * @param ciphertext_size       Ciphertext buffer size.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes192dec(uint8_t *ciphertext, uint8_t *key, size_t ciphertext_size)
+{
+        int err = -1;
+        uaes_ctx_t ctx;
+
+        if(0 == uaes_ctx_init(&ctx, key, uAES192, uAES_CTX_DECRYPT))
+        {
+                err = uaes_ctx_block_decryption(&ctx, ciphertext, ciphertext_size);
+                uaes_ctx_clear(&ctx);
+        }
+
+        return err;
+}
+
+/**
+ * @brief Computes AES-256 decryption on a single 16 byte ciphertext block.
+ * 
+ * @param ciphertext            Pointer to ciphertext buffer.
+ * @param key                   Pointer to key buffer.
+ * @param ciphertext_size       Ciphertext buffer size.
+ * @return int                  [0] if sucessful, [-1] on failure.
+ */
+int uaes256dec(uint8_t *ciphertext, uint8_t *key, size_t ciphertext_size)
+{
+        int err = -1;
+        uaes_ctx_t ctx;
+
+        if(0 == uaes_ctx_init(&ctx, key, uAES256, uAES_CTX_DECRYPT))
+        {
+                err = uaes_ctx_block_decryption(&ctx, ciphertext, ciphertext_size);
+                uaes_ctx_clear(&ctx);
+        }
+
+        return err;
+}
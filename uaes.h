@@ -26,8 +26,16 @@
 #ifndef UAES_H
 #define UAES_H
 
+#include <stdint.h>
+#include <stddef.h>
+
+#include "uaes_config.h"
 #include "udbg.h"
 
+#if uAES_CFG_KEYCACHE
+#include <stdatomic.h>
+#endif /*uAES_CFG_KEYCACHE*/
+
 /**
  * @brief The macros below aid on aligning memory sizes in accordance with 
  *        AES encryption format.
@@ -42,9 +50,18 @@
 #define KB  (1024UL)
 #define MB  (KB*KB)
 #define uAES_MAX_INPUT_SIZE   (64UL*MB)
-#define uAES_MAX_KEY_SIZE     (32UL)
+#define uAES_MAX_KEY_SIZE     ( uAES_CFG_MAX_KEY_BITS / 8UL )
 #define uAES_BLOCK_SIZE       (16UL)
 
+/**
+ * @brief Key schedule sizes in 32-bit words, Nb * (Nr + 1).
+ */
+#define uAES_NB               ( 4UL )
+#define uAES128_KSCHD_SIZE    ( 44UL )
+#define uAES192_KSCHD_SIZE    ( 52UL )
+#define uAES256_KSCHD_SIZE    ( 60UL )
+#define uAES_MAX_KSCHD_SIZE   ( uAES_NB * ( (uAES_CFG_MAX_KEY_BITS / 32UL) + 7UL ) )
+
 /**
  * @brief Data type definitions
  */
@@ -66,9 +83,569 @@ typedef enum aes_length
   uAESRGE = 3   // Range of length options
 }aes_length_t;
 
-/* Debug */
+/**
+ * @brief Cipher engines. uAES_ENGINE_AUTO selects the fastest engine that is
+ *        both compiled in and supported by the running CPU.
+ */
+typedef enum uaes_engine_id
+{
+  uAES_ENGINE_AUTO      = 0,  // Best available engine.
+  uAES_ENGINE_PORTABLE  = 1,  // Portable C (T-tables or byte operators).
+  uAES_ENGINE_AESNI     = 2,  // x86 AES-NI instructions.
+  uAES_ENGINE_ARMCE     = 3,  // ARMv8 Crypto Extensions instructions.
+  uAES_ENGINE_BITSLICE  = 4,  // Bitsliced constant-time C, eight blocks at once.
+  uAES_ENGINE_VPERM     = 5,  // SSSE3/NEON vector permute, constant time.
+  uAES_ENGINE_OFFLOAD   = 6,  // Crypto peripheral driver, see uaes_offload_register().
+  uAES_ENGINE_RGE       = 7   // Range of engine options
+}uaes_engine_id_t;
+
+typedef struct uaes_engine uaes_engine_t;
+
+/**
+ * @brief Engine capability flags, see uaes_engine_caps_t.
+ */
+#define uAES_CAP_KEY128       ( 1U << uAES128 )
+#define uAES_CAP_KEY192       ( 1U << uAES192 )
+#define uAES_CAP_KEY256       ( 1U << uAES256 )
+#define uAES_CAP_KEY_ALL      ( uAES_CAP_KEY128 | uAES_CAP_KEY192 | uAES_CAP_KEY256 )
+
+#define uAES_CAP_ECB          ( 0x01U )
+#define uAES_CAP_CBC          ( 0x02U )
+#define uAES_CAP_CTR          ( 0x04U )
+#define uAES_CAP_MODE_ALL     ( uAES_CAP_ECB | uAES_CAP_CBC | uAES_CAP_CTR )
+
+#define uAES_CAP_HARDWARE     ( 0x01U )   // Runs on a crypto peripheral.
+#define uAES_CAP_DMA          ( 0x02U )   // Moves the buffers by DMA.
+#define uAES_CAP_CONST_TIME   ( 0x04U )   // No key or data dependent memory accesses.
+
+/**
+ * @brief Engine capabilities. Software engines take every key size, mode,
+ *        alignment and size; a peripheral driver only gets the calls that
+ *        fit its declaration, the others run in software.
+ */
+typedef struct uaes_engine_caps
+{
+  uint8_t   keys;                            // uAES_CAP_KEY* sizes supported.
+  uint8_t   modes;                           // uAES_CAP_ECB/CBC/CTR whole-buffer modes supported.
+  uint8_t   flags;                           // uAES_CAP_HARDWARE/DMA/CONST_TIME.
+  uint8_t   align;                           // Buffer address alignment in bytes, a power of 2.
+  size_t    min_size;                        // Smallest buffer worth handing over, bytes.
+  size_t    max_size;                        // Largest buffer per call, 0 if unlimited.
+}uaes_engine_caps_t;
+
+/**
+ * @brief Key context usage flags, tell uaes_ctx_init() which directions the
+ *        context is going to be used for.
+ */
+#define uAES_CTX_ENCRYPT      ( 0x01U )
+#define uAES_CTX_DECRYPT      ( 0x02U )
+#define uAES_CTX_BOTH         ( uAES_CTX_ENCRYPT | uAES_CTX_DECRYPT )
+
+#if uAES_CFG_PROFILE
+/**
+ * @brief Profiled stages. The round operation stages are only recorded by the
+ *        byte-oriented portable cipher (uAES_CFG_TTABLE 0 or round tracing on),
+ *        the cipher stage covers whole portable engine calls. A mode stage
+ *        covers a whole call, mode overhead is its count minus the cipher one.
+ */
+typedef enum uaes_prof_stage
+{
+  uAES_PROF_KEY_EXPANSION = 0,  // Key schedule expansion in uaes_ctx_init().
+  uAES_PROF_CIPHER        = 1,  // Portable engine block calls.
+  uAES_PROF_SUB_BYTES     = 2,  // SubBytes and InvSubBytes.
+  uAES_PROF_SHIFT_ROWS    = 3,  // ShiftRows and InvShiftRows.
+  uAES_PROF_MIX_COLUMNS   = 4,  // MixColumns and InvMixColumns.
+  uAES_PROF_ADD_ROUND_KEY = 5,  // AddRoundKey.
+  uAES_PROF_ECB           = 6,  // ECB calls.
+  uAES_PROF_CBC           = 7,  // CBC block runs.
+  uAES_PROF_CTR           = 8,  // CTR keystream runs.
+  uAES_PROF_GCM           = 9,  // GCM init, update and tag calls.
+  uAES_PROF_XTS           = 10, // XTS data unit and sector runs.
+  uAES_PROF_CMAC          = 11, // CMAC init, update and tag calls.
+  uAES_PROF_CCM           = 12, // CCM messages.
+  uAES_PROF_OFFLOAD       = 13, // Calls run by the offload driver.
+  uAES_PROF_PCBC          = 14, // PCBC block runs.
+  uAES_PROF_CFB           = 15, // CFB block runs.
+  uAES_PROF_KSBUF         = 16, // Keystream buffer refills.
+  uAES_PROF_RGE           = 17  // Range of profiled stages
+}uaes_prof_stage_t;
+
+/**
+ * @brief Cycle counts of a key context, see uAES_PROF_CYCLES() in udbg.h for
+ *        the counter used. Counters are plain additions, profile from one thread.
+ */
+typedef struct uaes_prof
+{
+  uint64_t  cycles[uAES_PROF_RGE];           // Cycles spent per stage.
+  uint64_t  calls[uAES_PROF_RGE];            // Times each stage ran.
+}uaes_prof_t;
+#endif /*uAES_CFG_PROFILE*/
+
+/*
+ * Thread safety. Every call keeps its state in the objects passed to it, so
+ * calls on distinct contexts and message states (GCM, CMAC, stream, job,
+ * keystream buffer) need no lock, from threads and RTOS tasks alike. A key
+ * context is only read once initialised and any number of threads may share
+ * one without locking, as long as none of them initialises, clears or
+ * re-engines it meanwhile. uAES_CFG_PROFILE builds are the exception, the
+ * profile counters of a shared context are written without synchronisation,
+ * give each thread its own context when profiling. A message state belongs to
+ * one caller at a time. The process-wide state is set once and then only read:
+ * the CPU feature probes of the engines (idempotent), the offload driver slot
+ * (register it before the library is used from several threads) and the key
+ * cache (locked per set). The worker pool takes one buffer at a time and a
+ * thread that finds it busy runs its own buffer. The debug trace state is
+ * thread-local, see udbg.h. uaes_bench checks concurrent calls on shared and
+ * per-thread contexts.
+ */
+
+/**
+ * @brief Key context, holds an expanded key schedule so it can be reused
+ *        across calls. Owned by the caller, initialised by uaes_ctx_init().
+ *        Once initialised it is only read by the cipher functions, apart
+ *        from the profile of uAES_CFG_PROFILE builds.
+ */
+typedef struct uaes_ctx
+{
+  uint32_t      kschd[uAES_MAX_KSCHD_SIZE];  // Encryption key schedule.
+  uint32_t      dkschd[uAES_MAX_KSCHD_SIZE]; // Equivalent inverse cipher key schedule (uAES_CTX_DECRYPT).
+  size_t        Nk;                          // Key length in 32-bit words.
+  size_t        Nr;                          // Number of rounds.
+  aes_length_t  aes_length;                  // Key length option.
+  uint8_t       usage;                       // uAES_CTX_* flags.
+  const uaes_engine_t *engine;               // Engine running the cipher operations.
+#if uAES_CFG_OFFLOAD
+  uint8_t       offload;                     // ECB, CBC and CTR calls may go to the offload driver.
+#endif /*uAES_CFG_OFFLOAD*/
+#if uAES_CFG_PROFILE
+  uaes_prof_t   prof;                        // Cycle counts, the only field written after init.
+#endif /*uAES_CFG_PROFILE*/
+}uaes_ctx_t;
+
+/**
+ * @brief GCM operation state, one per message. Initialised by uaes_gcm_init()
+ *        and wiped by uaes_gcm_final()/uaes_gcm_verify(). Its fields are private.
+ */
+typedef struct uaes_gcm
+{
+  const uaes_ctx_t *ctx;                     // Key context (uAES_CTX_ENCRYPT).
+  void      (*ghash)(struct uaes_gcm *gcm, const uint8_t *in, size_t nblocks);
+  uint64_t  hl[16];                          // GHASH 4-bit table, low halves of i * H.
+  uint64_t  hh[16];                          // GHASH 4-bit table, high halves of i * H.
+  uint8_t   h[16];                           // Hash subkey E(K, 0^128).
+  uint8_t   j0[16];                          // Pre-counter block.
+  uint8_t   ctr[16];                         // Next counter block.
+  uint8_t   y[16];                           // GHASH state.
+  uint8_t   ks[16];                          // Keystream of the current partial block.
+  uint8_t   part[16];                        // Pending AAD or ciphertext bytes.
+  uint64_t  aad_len;                         // AAD bytes so far.
+  uint64_t  data_len;                        // Plaintext/ciphertext bytes so far.
+  uint8_t   phase;                           // Accepting AAD or data.
+}uaes_gcm_t;
+
+/**
+ * @brief CMAC operation state, one per message. Initialised by uaes_cmac_init()
+ *        and wiped by uaes_cmac_final()/uaes_cmac_verify(). Its fields are private.
+ */
+typedef struct uaes_cmac
+{
+  const uaes_ctx_t *ctx;                     // Key context (uAES_CTX_ENCRYPT).
+  uint8_t   k1[16];                          // Subkey of a complete last block.
+  uint8_t   k2[16];                          // Subkey of a padded last block.
+  uint8_t   x[16];                           // CBC-MAC state.
+  uint8_t   part[16];                        // Last message bytes, held back until final.
+  size_t    fill;                            // Bytes of part in use.
+}uaes_cmac_t;
+
+/**
+ * @brief Buffer segment for the scatter/gather (iovec) functions.
+ */
+typedef struct uaes_iovec
+{
+  uint8_t   *base;                           // Segment start.
+  size_t    len;                             // Segment size in bytes, any value.
+}uaes_iovec_t;
+
+/**
+ * @brief Multi-buffer CBC job, one independent message of uaes_ctx_cbc_encryption_multi().
+ */
+typedef struct uaes_cbc_job
+{
+  const uaes_ctx_t  *ctx;                    // Key context (uAES_CTX_ENCRYPT).
+  const uint8_t     *iv;                     // 16-byte initialisation vector.
+  uint8_t           *buf;                    // Message, encrypted in place.
+  size_t            size;                    // Message size, a multiple of 16 bytes.
+}uaes_cbc_job_t;
+
+/**
+ * @brief Streaming modes, see uaes_stream_init().
+ */
+typedef enum uaes_stream_mode
+{
+  uAES_STREAM_CBC_ENCRYPT       = 0,  // CBC encryption, whole blocks only.
+  uAES_STREAM_CBC_DECRYPT       = 1,  // CBC decryption, whole blocks only.
+  uAES_STREAM_CTR               = 2,  // Counter mode, any size, both directions.
+  uAES_STREAM_CBC_ENCRYPT_PKCS7 = 3,  // CBC encryption, any size, PKCS#7 padding added by final.
+  uAES_STREAM_CBC_DECRYPT_PKCS7 = 4,  // CBC decryption, PKCS#7 padding checked and removed by final.
+  uAES_STREAM_RGE               = 5   // Range of streaming modes
+}uaes_stream_mode_t;
+
+/**
+ * @brief Streaming operation state, one per message. Initialised by
+ *        uaes_stream_init() and wiped by uaes_stream_final(). Its fields are private.
+ */
+typedef struct uaes_stream
+{
+  const uaes_ctx_t    *ctx;                  // Key context.
+  uaes_stream_mode_t  mode;                  // Streaming mode.
+  uint8_t   iv[16];                          // CBC chaining value or next CTR counter block.
+  uint8_t   part[16];                        // Pending CBC input bytes or keystream of the current CTR block.
+  size_t    fill;                            // Bytes of part in use.
+  size_t    ctr_width;                       // CTR counter field size in bytes.
+  uint64_t  ctr_left;                        // CTR counter blocks left before the field wraps.
+}uaes_stream_t;
+
+#if uAES_CFG_JOB
+/**
+ * @brief Sliced job modes, see uaes_job_init().
+ */
+typedef enum uaes_job_mode
+{
+  uAES_JOB_ECB_ENCRYPT  = 0,  // ECB encryption, whole blocks only.
+  uAES_JOB_ECB_DECRYPT  = 1,  // ECB decryption, whole blocks only.
+  uAES_JOB_CBC_ENCRYPT  = 2,  // CBC encryption, whole blocks only.
+  uAES_JOB_CBC_DECRYPT  = 3,  // CBC decryption, whole blocks only.
+  uAES_JOB_CTR          = 4,  // Counter mode, any size, both directions.
+  uAES_JOB_RGE          = 5   // Range of job modes
+}uaes_job_mode_t;
+
+struct uaes_job;
+
+/**
+ * @brief Job completion callback, runs in the context that made the last
+ *        uaes_job_step() call.
+ */
+typedef void (*uaes_job_cb_t)(struct uaes_job *job, void *arg);
+
+/**
+ * @brief Sliced job, one buffer processed a few blocks per uaes_job_step()
+ *        call. Owned by the caller, its fields are private.
+ */
+typedef struct uaes_job
+{
+  const uaes_ctx_t  *ctx;                    // Key context.
+  uaes_job_mode_t   mode;                    // Job mode.
+  uint8_t           *out;                    // Output buffer.
+  const uint8_t     *in;                     // Input buffer, may be out.
+  size_t            size;                    // Buffer size.
+  volatile size_t   ready;                   // Input bytes valid, see uaes_job_feed().
+  volatile size_t   done;                    // Output bytes written.
+  uint8_t           fed;                     // Set once uaes_job_feed() took over ready.
+  size_t            ctr_width;               // CTR counter field size in bytes.
+  uint8_t           iv[16];                  // CBC chaining value or next CTR counter block.
+  uaes_job_cb_t     cb;                      // Completion callback, may be NULL.
+  void              *arg;                    // Callback argument.
+}uaes_job_t;
+#endif /*uAES_CFG_JOB*/
+
+#if uAES_CFG_KSBUF
+/**
+ * @brief Keystream buffer modes, see uaes_ksbuf_init().
+ */
+typedef enum uaes_ksbuf_mode
+{
+  uAES_KSBUF_CTR  = 0,  // Counter mode keystream.
+  uAES_KSBUF_OFB  = 1,  // Output feedback keystream.
+  uAES_KSBUF_RGE  = 2   // Range of keystream buffer modes
+}uaes_ksbuf_mode_t;
+
+struct uaes_ksbuf;
+
+/**
+ * @brief Watermark callback, avail is the number of bytes precomputed.
+ */
+typedef void (*uaes_ksbuf_cb_t)(struct uaes_ksbuf *ks, size_t avail, void *arg);
+
+/**
+ * @brief Keystream precomputed into a caller supplied ring, filled in idle time
+ *        and consumed by packets. Owned by the caller, its fields are private.
+ */
+typedef struct uaes_ksbuf
+{
+  const uaes_ctx_t  *ctx;                    // Key context (uAES_CTX_ENCRYPT).
+  uaes_ksbuf_mode_t mode;                    // Keystream mode.
+  uint8_t           *ring;                   // Keystream ring.
+  size_t            size;                    // Ring size, a power of two.
+  volatile size_t   head;                    // Bytes produced, see uaes_ksbuf_fill().
+  volatile size_t   tail;                    // Bytes consumed, see uaes_ksbuf_xor().
+  size_t            ctr_width;               // CTR counter field size in bytes.
+  uint64_t          ctr_left;                // CTR counter blocks left before the field wraps.
+  uint8_t           iv[16];                  // Next CTR counter block or OFB feedback.
+  size_t            low;                     // Low watermark in bytes.
+  size_t            high;                    // High watermark in bytes.
+  uaes_ksbuf_cb_t   on_low;                  // Low watermark callback, may be NULL.
+  uaes_ksbuf_cb_t   on_high;                 // High watermark callback, may be NULL.
+  void              *arg;                    // Callback argument.
+}uaes_ksbuf_t;
+#endif /*uAES_CFG_KSBUF*/
+
+#if uAES_CFG_KEYCACHE
+/**
+ * @brief Ways of a key cache set. A key identifier maps to one set and may
+ *        sit in any of its ways, the least recently used one is evicted.
+ */
+#define uAES_KEYCACHE_WAYS    ( 8UL )
+
+/**
+ * @brief Key cache set, the cache storage is an array of them owned by the
+ *        caller. Readers copy a context out under a sequence count and never
+ *        block, inserts take the set lock. Its fields are private.
+ */
+typedef struct uaes_keycache_set
+{
+  atomic_flag       lock;                          // Held by inserts.
+  _Atomic uint32_t  seq[uAES_KEYCACHE_WAYS];       // Odd while a way is written.
+  _Atomic uint64_t  id[uAES_KEYCACHE_WAYS];        // Key identifier of each way.
+  _Atomic uint64_t  stamp[uAES_KEYCACHE_WAYS];     // Last use, 0 if empty.
+  _Atomic uint64_t  clock;                         // Use counter of the set.
+  _Atomic uint64_t  hits;
+  _Atomic uint64_t  misses;
+  _Atomic uint64_t  evictions;
+  uaes_ctx_t        ctx[uAES_KEYCACHE_WAYS];       // Cached key contexts, wiped if empty.
+}uaes_keycache_set_t;
+
+/**
+ * @brief Key schedule cache, see uaes_keycache_init().
+ */
+typedef struct uaes_keycache
+{
+  uaes_keycache_set_t *set;                  // Caller's sets.
+  size_t              nsets;                 // Number of sets.
+}uaes_keycache_t;
+
+/**
+ * @brief Key cache counters, summed over the sets by uaes_keycache_stats().
+ */
+typedef struct uaes_keycache_stats
+{
+  uint64_t  hits;                            // Lookups answered from the cache.
+  uint64_t  misses;                          // Lookups that had to expand the key.
+  uint64_t  evictions;                       // Cached keys replaced by another one.
+}uaes_keycache_stats_t;
+#endif /*uAES_CFG_KEYCACHE*/
+
+/* Debug, the trace mask is per thread */
 extern uint8_t   uaes_set_trace_msk(uint8_t msk);
 
+/* Key context API */
+extern int  uaes_ctx_init(uaes_ctx_t *ctx, uint8_t *key, aes_length_t aes_mode, uint8_t usage);
+extern void uaes_ctx_clear(uaes_ctx_t *ctx);
+extern int  uaes_ctx_set_engine(uaes_ctx_t *ctx, uaes_engine_id_t id);
+extern const char *uaes_ctx_engine_name(const uaes_ctx_t *ctx);
+extern int  uaes_engine_available(uaes_engine_id_t id);
+extern int  uaes_engine_caps(uaes_engine_id_t id, uaes_engine_caps_t *caps);
+
+#if uAES_CFG_OFFLOAD
+/* Crypto peripheral offload, one driver at a time (see engine.h) */
+extern int  uaes_offload_register(const uaes_engine_t *engine);
+extern const char *uaes_offload_name(void);
+#endif /*uAES_CFG_OFFLOAD*/
+
+#if uAES_CFG_PROFILE
+/* Profiling, cycle counts per stage of a context */
+extern const uaes_prof_t *uaes_ctx_profile(const uaes_ctx_t *ctx);
+extern void uaes_ctx_profile_reset(uaes_ctx_t *ctx);
+#endif /*uAES_CFG_PROFILE*/
+
+#if uAES_CFG_KEYCACHE
+/* Key schedule cache, shared by threads looking keys up by identifier */
+extern int  uaes_keycache_init(uaes_keycache_t *kc, uaes_keycache_set_t *sets, size_t nsets);
+extern int  uaes_keycache_get(uaes_keycache_t *kc, uint64_t key_id, uint8_t *key, aes_length_t aes_length, uint8_t usage, uaes_ctx_t *ctx);
+extern int  uaes_keycache_lookup(uaes_keycache_t *kc, uint64_t key_id, aes_length_t aes_length, uint8_t usage, uaes_ctx_t *ctx);
+extern void uaes_keycache_invalidate(uaes_keycache_t *kc, uint64_t key_id);
+extern void uaes_keycache_clear(uaes_keycache_t *kc);
+extern void uaes_keycache_stats(const uaes_keycache_t *kc, uaes_keycache_stats_t *stats);
+#endif /*uAES_CFG_KEYCACHE*/
+
+/* Worker pool, spreads large ECB, CTR, XTS and CBC decryption calls over threads (uAES_CFG_THREADS) */
+extern int  uaes_pool_start(size_t nthreads);
+extern void uaes_pool_stop(void);
+
+/** 
+ * NOTE: AES-ECB IS NO LONGER CONSIDERED SAFE, USE IT AT YOUR OWN RISK. 
+ */
+extern int uaes_ctx_ecb_encryption( const uaes_ctx_t *ctx,
+                                    uint8_t   *plaintext,
+                                    size_t    plaintext_size );
+
+extern int uaes_ctx_ecb_decryption( const uaes_ctx_t *ctx,
+                                    uint8_t   *ciphertext,
+                                    size_t    ciphertext_size );
+/* ******************************************************************** */
+
+extern int uaes_ctx_cbc_encryption( const uaes_ctx_t *ctx,
+                                    uint8_t   *plaintext,
+                                    size_t    plaintext_size,
+                                    uint8_t   *init_vec );
+
+extern int uaes_ctx_cbc_decryption( const uaes_ctx_t *ctx,
+                                    uint8_t   *ciphertext,
+                                    size_t    ciphertext_size,
+                                    uint8_t   *init_vec );
+
+#if uAES_CFG_CTS
+/* CBC-CS3 ciphertext stealing, any size from 16 bytes, the output has the size of the input */
+extern int uaes_ctx_cbc_cs3_encryption(const uaes_ctx_t *ctx, uint8_t *plaintext, size_t plaintext_size, uint8_t *iv);
+extern int uaes_ctx_cbc_cs3_decryption(const uaes_ctx_t *ctx, uint8_t *ciphertext, size_t ciphertext_size, uint8_t *iv);
+#endif /*uAES_CFG_CTS*/
+
+#if uAES_CFG_PCBC
+extern int uaes_ctx_pcbc_encryption(const uaes_ctx_t *ctx, uint8_t *plaintext, size_t plaintext_size, uint8_t *iv);
+extern int uaes_ctx_pcbc_decryption(const uaes_ctx_t *ctx, uint8_t *ciphertext, size_t ciphertext_size, uint8_t *iv);
+#endif /*uAES_CFG_PCBC*/
+
+#if uAES_CFG_CFB
+/* CFB-128, any size, both directions run the forward cipher (uAES_CTX_ENCRYPT) */
+extern int uaes_ctx_cfb_encryption(const uaes_ctx_t *ctx, uint8_t *plaintext, size_t plaintext_size, uint8_t *iv);
+extern int uaes_ctx_cfb_decryption(const uaes_ctx_t *ctx, uint8_t *ciphertext, size_t ciphertext_size, uint8_t *iv);
+#endif /*uAES_CFG_CFB*/
+
+/* Out-of-place variants, dst may be src but must not overlap it otherwise */
+extern int uaes_ctx_ecb_encryption_oop(const uaes_ctx_t *ctx, uint8_t *dst, const uint8_t *src, size_t size);
+extern int uaes_ctx_ecb_decryption_oop(const uaes_ctx_t *ctx, uint8_t *dst, const uint8_t *src, size_t size);
+extern int uaes_ctx_cbc_encryption_oop(const uaes_ctx_t *ctx, uint8_t *dst, const uint8_t *src, size_t size, uint8_t *iv);
+extern int uaes_ctx_cbc_decryption_oop(const uaes_ctx_t *ctx, uint8_t *dst, const uint8_t *src, size_t size, uint8_t *iv);
+
+#if uAES_CFG_IOV
+/* Scatter/gather variants, the segments of each list form one logical buffer */
+extern int uaes_ctx_ecb_encryption_iov(const uaes_ctx_t *ctx, const uaes_iovec_t *dst, size_t dst_cnt, const uaes_iovec_t *src, size_t src_cnt);
+extern int uaes_ctx_ecb_decryption_iov(const uaes_ctx_t *ctx, const uaes_iovec_t *dst, size_t dst_cnt, const uaes_iovec_t *src, size_t src_cnt);
+extern int uaes_ctx_cbc_encryption_iov(const uaes_ctx_t *ctx, const uaes_iovec_t *dst, size_t dst_cnt, const uaes_iovec_t *src, size_t src_cnt, const uint8_t *iv);
+extern int uaes_ctx_cbc_decryption_iov(const uaes_ctx_t *ctx, const uaes_iovec_t *dst, size_t dst_cnt, const uaes_iovec_t *src, size_t src_cnt, const uint8_t *iv);
+#endif /*uAES_CFG_IOV*/
+
+#if uAES_CFG_MULTI
+/* Multi-buffer variant, encrypts independent messages with interleaved rounds */
+extern int uaes_ctx_cbc_encryption_multi(const uaes_cbc_job_t *jobs, size_t njobs);
+#endif /*uAES_CFG_MULTI*/
+
+#if uAES_CFG_CTR
+/**
+ * NOTE: ctr_blk is the caller's nonce followed by a big-endian counter of
+ * ctr_width bytes. Never reuse a counter block with the same key.
+ */
+extern int uaes_ctx_ctr_encryption( const uaes_ctx_t *ctx,
+                                    uint8_t   *buf,
+                                    size_t    size,
+                                    uint8_t   *ctr_blk,
+                                    size_t    ctr_width );
+
+extern int uaes_ctx_ctr_decryption( const uaes_ctx_t *ctx,
+                                    uint8_t   *buf,
+                                    size_t    size,
+                                    uint8_t   *ctr_blk,
+                                    size_t    ctr_width );
+#endif /*uAES_CFG_CTR*/
+
+#if uAES_CFG_XTS
+/* XTS, one data unit with any trailing partial block, or a run of sectors */
+extern int uaes_ctx_xts_encryption(const uaes_ctx_t *ctx, const uaes_ctx_t *tweak_ctx, uint8_t *buf, size_t size, const uint8_t *tweak);
+extern int uaes_ctx_xts_decryption(const uaes_ctx_t *ctx, const uaes_ctx_t *tweak_ctx, uint8_t *buf, size_t size, const uint8_t *tweak);
+extern int uaes_ctx_xts_encryption_sectors(const uaes_ctx_t *ctx, const uaes_ctx_t *tweak_ctx, uint8_t *buf, size_t size, size_t sector_size, uint64_t sector);
+extern int uaes_ctx_xts_decryption_sectors(const uaes_ctx_t *ctx, const uaes_ctx_t *tweak_ctx, uint8_t *buf, size_t size, size_t sector_size, uint64_t sector);
+#endif /*uAES_CFG_XTS*/
+
+#if uAES_CFG_STREAM
+/* Streaming API, CBC and CTR over any number of update calls */
+extern int uaes_stream_init(uaes_stream_t *st, const uaes_ctx_t *ctx, uaes_stream_mode_t mode, const uint8_t *iv, size_t ctr_width);
+extern int uaes_stream_update(uaes_stream_t *st, uint8_t *out, const uint8_t *in, size_t size, size_t *out_len);
+extern int uaes_stream_final(uaes_stream_t *st, uint8_t *out, size_t *out_len);
+#endif /*uAES_CFG_STREAM*/
+
+#if uAES_CFG_JOB
+/* Sliced job API, bounded work per call for main loops and low priority interrupts */
+extern int    uaes_job_init(uaes_job_t *job, const uaes_ctx_t *ctx, uaes_job_mode_t mode, uint8_t *out, const uint8_t *in, size_t size, const uint8_t *iv, size_t ctr_width, uaes_job_cb_t cb, void *arg);
+extern int    uaes_job_feed(uaes_job_t *job, size_t ready);
+extern int    uaes_job_step(uaes_job_t *job, size_t max_blocks);
+extern size_t uaes_job_done(const uaes_job_t *job);
+#endif /*uAES_CFG_JOB*/
+
+#if uAES_CFG_KSBUF
+/* Precomputed CTR/OFB keystream, fill() in idle time, xor() on the packet path */
+extern int    uaes_ksbuf_init(uaes_ksbuf_t *ks, const uaes_ctx_t *ctx, uaes_ksbuf_mode_t mode, uint8_t *ring, size_t size, const uint8_t *iv, size_t ctr_width);
+extern int    uaes_ksbuf_watermarks(uaes_ksbuf_t *ks, size_t low, uaes_ksbuf_cb_t on_low, size_t high, uaes_ksbuf_cb_t on_high, void *arg);
+extern int    uaes_ksbuf_fill(uaes_ksbuf_t *ks, size_t max_blocks);
+extern int    uaes_ksbuf_xor(uaes_ksbuf_t *ks, uint8_t *buf, size_t len);
+extern size_t uaes_ksbuf_avail(const uaes_ksbuf_t *ks);
+extern void   uaes_ksbuf_clear(uaes_ksbuf_t *ks);
+#endif /*uAES_CFG_KSBUF*/
+
+#if uAES_CFG_GCM
+/* GCM API, streaming */
+extern int uaes_gcm_init(uaes_gcm_t *gcm, const uaes_ctx_t *ctx, const uint8_t *iv, size_t iv_len);
+extern int uaes_gcm_aad(uaes_gcm_t *gcm, const uint8_t *aad, size_t aad_len);
+extern int uaes_gcm_encrypt_update(uaes_gcm_t *gcm, uint8_t *buf, size_t size);
+extern int uaes_gcm_decrypt_update(uaes_gcm_t *gcm, uint8_t *buf, size_t size);
+extern int uaes_gcm_final(uaes_gcm_t *gcm, uint8_t *tag, size_t tag_len);
+extern int uaes_gcm_verify(uaes_gcm_t *gcm, const uint8_t *tag, size_t tag_len);
+
+/* GCM API, one shot */
+extern int uaes_ctx_gcm_encryption( const uaes_ctx_t *ctx,
+                                    const uint8_t *iv,
+                                    size_t    iv_len,
+                                    const uint8_t *aad,
+                                    size_t    aad_len,
+                                    uint8_t   *buf,
+                                    size_t    size,
+                                    uint8_t   *tag,
+                                    size_t    tag_len );
+
+extern int uaes_ctx_gcm_decryption( const uaes_ctx_t *ctx,
+                                    const uint8_t *iv,
+                                    size_t    iv_len,
+                                    const uint8_t *aad,
+                                    size_t    aad_len,
+                                    uint8_t   *buf,
+                                    size_t    size,
+                                    const uint8_t *tag,
+                                    size_t    tag_len );
+#endif /*uAES_CFG_GCM*/
+
+#if uAES_CFG_CMAC
+/* CMAC API, streaming and one shot */
+extern int uaes_cmac_init(uaes_cmac_t *cmac, const uaes_ctx_t *ctx);
+extern int uaes_cmac_update(uaes_cmac_t *cmac, const uint8_t *msg, size_t len);
+extern int uaes_cmac_final(uaes_cmac_t *cmac, uint8_t *tag, size_t tag_len);
+extern int uaes_cmac_verify(uaes_cmac_t *cmac, const uint8_t *tag, size_t tag_len);
+extern int uaes_ctx_cmac(const uaes_ctx_t *ctx, const uint8_t *msg, size_t len, uint8_t *tag, size_t tag_len);
+#endif /*uAES_CFG_CMAC*/
+
+#if uAES_CFG_CCM
+/* CCM API, one shot, single pass over the payload */
+extern int uaes_ctx_ccm_encryption( const uaes_ctx_t *ctx,
+                                    const uint8_t *nonce,
+                                    size_t    nonce_len,
+                                    const uint8_t *aad,
+                                    size_t    aad_len,
+                                    uint8_t   *buf,
+                                    size_t    size,
+                                    uint8_t   *tag,
+                                    size_t    tag_len );
+
+extern int uaes_ctx_ccm_decryption( const uaes_ctx_t *ctx,
+                                    const uint8_t *nonce,
+                                    size_t    nonce_len,
+                                    const uint8_t *aad,
+                                    size_t    aad_len,
+                                    uint8_t   *buf,
+                                    size_t    size,
+                                    const uint8_t *tag,
+                                    size_t    tag_len );
+#endif /*uAES_CFG_CCM*/
+
+extern int uaes_ctx_block_encryption(const uaes_ctx_t *ctx, uint8_t *plaintext, size_t plaintext_size);
+extern int uaes_ctx_block_decryption(const uaes_ctx_t *ctx, uint8_t *ciphertext, size_t ciphertext_size);
+
 /* Encryption API*/
 
 /** 
@@ -86,6 +663,31 @@ extern int uaes_cbc_encryption( uint8_t   *plaintext,
                                 uint8_t   *init_vec,
                                 aes_length_t  aes_mode );
 
+#if uAES_CFG_CTR
+extern int uaes_ctr_encryption( uint8_t   *buf,
+                                size_t    size,
+                                uint8_t   *key,
+                                uint8_t   *ctr_blk,
+                                size_t    ctr_width,
+                                aes_length_t  aes_mode );
+#endif /*uAES_CFG_CTR*/
+
+#if uAES_CFG_PCBC
+extern int uaes_pcbc_encryption( uint8_t   *plaintext,
+                                 size_t    plaintext_size,
+                                 uint8_t   *key,
+                                 uint8_t   *init_vec,
+                                 aes_length_t  aes_mode );
+#endif /*uAES_CFG_PCBC*/
+
+#if uAES_CFG_CFB
+extern int uaes_cfb_encryption( uint8_t   *plaintext,
+                                size_t    plaintext_size,
+                                uint8_t   *key,
+                                uint8_t   *init_vec,
+                                aes_length_t  aes_mode );
+#endif /*uAES_CFG_CFB*/
+
 extern int uaes128enc(uint8_t *plaintext, uint8_t *key, size_t plaintext_size);
 extern int uaes192enc(uint8_t *plaintext, uint8_t *key, size_t plaintext_size);
 extern int uaes256enc(uint8_t *plaintext, uint8_t *key, size_t plaintext_size);
@@ -107,6 +709,30 @@ extern int uaes_cbc_decryption( uint8_t   *plaintext,
                                 uint8_t   *init_vec,
                                 aes_length_t  aes_mode );
 
+#if uAES_CFG_CTR
+extern int uaes_ctr_decryption( uint8_t   *buf,
+                                size_t    size,
+                                uint8_t   *key,
+                                uint8_t   *ctr_blk,
+                                size_t    ctr_width,
+                                aes_length_t  aes_mode );
+#endif /*uAES_CFG_CTR*/
+
+#if uAES_CFG_PCBC
+extern int uaes_pcbc_decryption( uint8_t   *ciphertext,
+                                 size_t    ciphertext_size,
+                                 uint8_t   *key,
+                                 uint8_t   *init_vec,
+                                 aes_length_t  aes_mode );
+#endif /*uAES_CFG_PCBC*/
+
+#if uAES_CFG_CFB
+extern int uaes_cfb_decryption( uint8_t   *ciphertext,
+                                size_t    ciphertext_size,
+                                uint8_t   *key,
+                                uint8_t   *init_vec,
+                                aes_length_t  aes_mode );
+#endif /*uAES_CFG_CFB*/
 
 extern int uaes128dec(uint8_t *ciphertext, uint8_t *key, size_t ciphertext_size);
 extern int uaes192dec(uint8_t *ciphertext, uint8_t *key, size_t ciphertext_size);
@@ -0,0 +1,351 @@
+/**
+ * @file      uaes_config.h
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     Build configuration, trades ROM, RAM and stack against speed.
+ *            Every option can be overridden with -D on the command line or by
+ *            defining it before this header is included.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef UAES_CONFIG_H
+#define UAES_CONFIG_H
+
+/* ************************************************************************
+ * Tables
+ * ***********************************************************************/
+
+/**
+ * @brief uAES_CFG_SBOX_LUT selects how the substitution boxes are evaluated.
+ *        [1] 256-byte forward and inverse tables stored as const data (default).
+ *        [0] table-free, every byte is inverted in GF(2^8) on the fly. Saves
+ *            512 bytes of ROM at a very large cost in speed.
+ */
+#ifndef uAES_CFG_SBOX_LUT
+#define uAES_CFG_SBOX_LUT   1
+#endif /*uAES_CFG_SBOX_LUT*/
+
+/**
+ * @brief uAES_CFG_TTABLE selects the round engine used by the cipher.
+ *        [4] four 1 KB T-tables, one per row (default, fastest, 8 KB of ROM).
+ *        [1] a single 1 KB T-table, the remaining three are obtained by rotation (2 KB).
+ *        [0] byte-oriented SubBytes/ShiftRows/MixColumns/AddRoundKey operators.
+ */
+#ifndef uAES_CFG_TTABLE
+#if uAES_CFG_SBOX_LUT
+#define uAES_CFG_TTABLE     4
+#else
+#define uAES_CFG_TTABLE     0
+#endif /*uAES_CFG_SBOX_LUT*/
+#endif /*uAES_CFG_TTABLE*/
+
+/**
+ * @brief uAES_CFG_UNROLL selects how the T-table engine runs its rounds.
+ *        [1] fully unrolled, one copy per key size up to uAES_CFG_MAX_KEY_BITS,
+ *            about 13 KB more code per key size (default).
+ *        [0] a single copy looping over the rounds, about 5 KB of code.
+ */
+#ifndef uAES_CFG_UNROLL
+#define uAES_CFG_UNROLL     1
+#endif /*uAES_CFG_UNROLL*/
+
+/* ************************************************************************
+ * Key size
+ * ***********************************************************************/
+
+/**
+ * @brief uAES_CFG_MAX_KEY_BITS is the largest key accepted, 128, 192 or 256.
+ *        Key contexts and the engines' round key copies on the stack are
+ *        sized for it, uaes_ctx_init() rejects longer keys.
+ */
+#ifndef uAES_CFG_MAX_KEY_BITS
+#define uAES_CFG_MAX_KEY_BITS   256
+#endif /*uAES_CFG_MAX_KEY_BITS*/
+
+/* ************************************************************************
+ * Engines
+ * ***********************************************************************/
+
+/**
+ * @brief uAES_CFG_AESNI builds the AES-NI engine on x86 targets. It is only
+ *        selected at runtime if CPUID reports the AES instructions.
+ */
+#ifndef uAES_CFG_AESNI
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define uAES_CFG_AESNI      1
+#else
+#define uAES_CFG_AESNI      0
+#endif
+#endif /*uAES_CFG_AESNI*/
+
+/**
+ * @brief uAES_CFG_ARMCE builds the ARMv8 Crypto Extensions engine. It is always
+ *        used when the compiler targets the extension (__ARM_FEATURE_CRYPTO),
+ *        otherwise, on little-endian Linux targets, it is only selected at
+ *        runtime if HWCAP reports the AES instructions.
+ */
+#ifndef uAES_CFG_ARMCE
+#if (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES)) && !defined(__ARM_BIG_ENDIAN)
+#define uAES_CFG_ARMCE      1
+#elif defined(__linux__) && defined(__GNUC__) && !defined(__clang__) && !defined(__ARM_BIG_ENDIAN) && \
+      ( defined(__aarch64__) || ( defined(__arm__) && defined(__ARM_PCS_VFP) && ( __ARM_ARCH >= 7 ) ) )
+#define uAES_CFG_ARMCE      1
+#else
+#define uAES_CFG_ARMCE      0
+#endif
+#endif /*uAES_CFG_ARMCE*/
+
+/**
+ * @brief uAES_CFG_BITSLICE builds the bitsliced constant-time engine.
+ *        [0] not built.
+ *        [1] built, selected with uaes_ctx_set_engine().
+ *        [2] built and preferred by uAES_ENGINE_AUTO, so the legacy API runs
+ *            without key or data dependent memory accesses.
+ *        Its calls keep 128 bytes of round keys per round on the stack.
+ */
+#ifndef uAES_CFG_BITSLICE
+#define uAES_CFG_BITSLICE   1
+#endif /*uAES_CFG_BITSLICE*/
+
+/**
+ * @brief uAES_CFG_VPERM builds the vector permute constant-time engine, which
+ *        evaluates SubBytes in GF(2^4) with byte shuffles. It uses SSSE3 on x86,
+ *        selected at runtime if CPUID reports it, and NEON on ARM targets built
+ *        with it.
+ *        [0] not built.
+ *        [1] built, selected with uaes_ctx_set_engine().
+ *        [2] built and preferred by uAES_ENGINE_AUTO over the portable engine, so
+ *            CPUs without AES instructions run without key or data dependent
+ *            memory accesses (default where supported).
+ */
+#ifndef uAES_CFG_VPERM
+#if ( (defined(__x86_64__) || defined(__i386__)) || (defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)) ) && defined(__GNUC__)
+#define uAES_CFG_VPERM      2
+#else
+#define uAES_CFG_VPERM      0
+#endif
+#endif /*uAES_CFG_VPERM*/
+
+/**
+ * @brief uAES_CFG_OFFLOAD lets a crypto peripheral driver be registered with
+ *        uaes_offload_register(). ECB, CBC and CTR calls that fit its
+ *        capabilities are handed to it and the rest run in software. Costs
+ *        one pointer test per call while no driver is registered.
+ */
+#ifndef uAES_CFG_OFFLOAD
+#define uAES_CFG_OFFLOAD    1
+#endif /*uAES_CFG_OFFLOAD*/
+
+/**
+ * @brief uAES_GHASH_PMULL builds the PMULL GHASH of the ARMCE engine, it needs
+ *        the AArch64 bit reversal instruction, AArch32 uses the GHASH tables.
+ */
+#ifndef uAES_GHASH_PMULL
+#if uAES_CFG_ARMCE && defined(__aarch64__)
+#define uAES_GHASH_PMULL    1
+#else
+#define uAES_GHASH_PMULL    0
+#endif
+#endif /*uAES_GHASH_PMULL*/
+
+/* ************************************************************************
+ * Modes
+ * ***********************************************************************/
+
+/**
+ * @brief uAES_CFG_CTR, uAES_CFG_CTS, uAES_CFG_PCBC, uAES_CFG_CFB,
+ *        uAES_CFG_GCM, uAES_CFG_XTS, uAES_CFG_CMAC, uAES_CFG_CCM,
+ *        uAES_CFG_STREAM, uAES_CFG_IOV, uAES_CFG_MULTI, uAES_CFG_JOB and
+ *        uAES_CFG_KSBUF build counter mode, CBC ciphertext stealing (CS3),
+ *        PCBC, CFB-128, GCM, XTS, CMAC, CCM, the streaming API, the
+ *        scatter/gather functions, multi-buffer CBC encryption, the sliced job
+ *        API and the precomputed keystream buffer. ECB and CBC are always
+ *        built.
+ *        GCM needs CTR, the streaming, job and keystream buffer APIs only
+ *        offer their CTR mode with it.
+ */
+#ifndef uAES_CFG_CTR
+#define uAES_CFG_CTR        1
+#endif /*uAES_CFG_CTR*/
+#ifndef uAES_CFG_CTS
+#define uAES_CFG_CTS        1
+#endif /*uAES_CFG_CTS*/
+#ifndef uAES_CFG_PCBC
+#define uAES_CFG_PCBC       1
+#endif /*uAES_CFG_PCBC*/
+#ifndef uAES_CFG_CFB
+#define uAES_CFG_CFB        1
+#endif /*uAES_CFG_CFB*/
+#ifndef uAES_CFG_GCM
+#define uAES_CFG_GCM        uAES_CFG_CTR
+#endif /*uAES_CFG_GCM*/
+#ifndef uAES_CFG_XTS
+#define uAES_CFG_XTS        1
+#endif /*uAES_CFG_XTS*/
+#ifndef uAES_CFG_CMAC
+#define uAES_CFG_CMAC       1
+#endif /*uAES_CFG_CMAC*/
+#ifndef uAES_CFG_CCM
+#define uAES_CFG_CCM        1
+#endif /*uAES_CFG_CCM*/
+#ifndef uAES_CFG_STREAM
+#define uAES_CFG_STREAM     1
+#endif /*uAES_CFG_STREAM*/
+#ifndef uAES_CFG_IOV
+#define uAES_CFG_IOV        1
+#endif /*uAES_CFG_IOV*/
+#ifndef uAES_CFG_MULTI
+#define uAES_CFG_MULTI      1
+#endif /*uAES_CFG_MULTI*/
+#ifndef uAES_CFG_JOB
+#define uAES_CFG_JOB        1
+#endif /*uAES_CFG_JOB*/
+#ifndef uAES_CFG_KSBUF
+#define uAES_CFG_KSBUF      1
+#endif /*uAES_CFG_KSBUF*/
+
+/* ************************************************************************
+ * Stack usage
+ * ***********************************************************************/
+
+/**
+ * @brief uAES_CFG_CTR_BLOCKS sets how many counter blocks are encrypted per
+ *        engine call, 16 bytes of stack each. Engines interleave the rounds of
+ *        independent blocks, so it should be at least the widest interleave
+ *        (4 for AES-NI/ARMCE, 8 for the bitsliced engine).
+ */
+#ifndef uAES_CFG_CTR_BLOCKS
+#define uAES_CFG_CTR_BLOCKS     8
+#endif /*uAES_CFG_CTR_BLOCKS*/
+
+/**
+ * @brief uAES_CFG_CBC_BATCH sets the blocks per engine call in the generic CBC
+ *        decryption path, 16 bytes of stack each plus one.
+ */
+#ifndef uAES_CFG_CBC_BATCH
+#define uAES_CFG_CBC_BATCH      8
+#endif /*uAES_CFG_CBC_BATCH*/
+
+/**
+ * @brief uAES_CFG_XTS_BATCH sets the blocks per engine call in XTS, 32 bytes of
+ *        stack each plus 16 per tweak. Runs of sectors share a batch between up
+ *        to this many sectors.
+ */
+#ifndef uAES_CFG_XTS_BATCH
+#define uAES_CFG_XTS_BATCH      8
+#endif /*uAES_CFG_XTS_BATCH*/
+
+/* ************************************************************************
+ * Threads
+ * ***********************************************************************/
+
+/**
+ * @brief uAES_CFG_THREADS is the largest number of worker threads the bulk pool
+ *        may start (see uaes_pool_start()), 0 leaves the pool out and every call
+ *        runs on the calling thread. Needs POSIX threads.
+ */
+#ifndef uAES_CFG_THREADS
+#define uAES_CFG_THREADS    0
+#endif /*uAES_CFG_THREADS*/
+
+/**
+ * @brief uAES_CFG_MT_CHUNK is the unit of work handed to a thread, sized to stay
+ *        in a per-core cache. uAES_CFG_MT_MIN_SIZE is the smallest buffer that
+ *        is split, below it the thread handoff costs more than it saves.
+ *        CBC decryption keeps 16 bytes of stack per chunk of the largest input.
+ */
+#ifndef uAES_CFG_MT_CHUNK
+#define uAES_CFG_MT_CHUNK       (64UL*1024UL)
+#endif /*uAES_CFG_MT_CHUNK*/
+#ifndef uAES_CFG_MT_MIN_SIZE
+#define uAES_CFG_MT_MIN_SIZE    (256UL*1024UL)
+#endif /*uAES_CFG_MT_MIN_SIZE*/
+
+/**
+ * @brief uAES_CFG_KEYCACHE builds the key schedule cache (uaes_keycache_*),
+ *        which keeps expanded keys by caller-chosen identifier so that a hot
+ *        key is expanded once. Needs C11 atomics, 64-bit ones included.
+ */
+#ifndef uAES_CFG_KEYCACHE
+#define uAES_CFG_KEYCACHE   0
+#endif /*uAES_CFG_KEYCACHE*/
+
+/* ************************************************************************
+ * Profiling
+ * ***********************************************************************/
+
+/**
+ * @brief uAES_CFG_PROFILE adds a cycle count profile to every key context,
+ *        filled by key expansion, the portable cipher stages and the modes.
+ *        Read with uaes_ctx_profile(). Costs nothing when 0 (default).
+ */
+#ifndef uAES_CFG_PROFILE
+#define uAES_CFG_PROFILE    0
+#endif /*uAES_CFG_PROFILE*/
+
+/* ************************************************************************
+ * Checks
+ * ***********************************************************************/
+
+#if (uAES_CFG_TTABLE != 0) && (uAES_CFG_TTABLE != 1) && (uAES_CFG_TTABLE != 4)
+#error "uAES_CFG_TTABLE must be 0, 1 or 4"
+#endif
+
+#if uAES_CFG_TTABLE && !uAES_CFG_SBOX_LUT
+#error "uAES_CFG_TTABLE requires uAES_CFG_SBOX_LUT"
+#endif
+
+#if (uAES_CFG_MAX_KEY_BITS != 128) && (uAES_CFG_MAX_KEY_BITS != 192) && (uAES_CFG_MAX_KEY_BITS != 256)
+#error "uAES_CFG_MAX_KEY_BITS must be 128, 192 or 256"
+#endif
+
+#if (uAES_CFG_BITSLICE < 0) || (uAES_CFG_BITSLICE > 2)
+#error "uAES_CFG_BITSLICE must be 0, 1 or 2"
+#endif
+
+#if (uAES_CFG_VPERM < 0) || (uAES_CFG_VPERM > 2)
+#error "uAES_CFG_VPERM must be 0, 1 or 2"
+#endif
+
+#if uAES_CFG_GCM && !uAES_CFG_CTR
+#error "uAES_CFG_GCM requires uAES_CFG_CTR"
+#endif
+
+#if (uAES_CFG_CTR_BLOCKS < 1) || (uAES_CFG_CTR_BLOCKS > 16)
+#error "uAES_CFG_CTR_BLOCKS must be between 1 and 16"
+#endif
+
+#if (uAES_CFG_CBC_BATCH < 1) || (uAES_CFG_CBC_BATCH > 16)
+#error "uAES_CFG_CBC_BATCH must be between 1 and 16"
+#endif
+
+#if (uAES_CFG_XTS_BATCH < 1) || (uAES_CFG_XTS_BATCH > 16)
+#error "uAES_CFG_XTS_BATCH must be between 1 and 16"
+#endif
+
+#if (uAES_CFG_THREADS < 0)
+#error "uAES_CFG_THREADS must not be negative"
+#endif
+
+#if (0 == uAES_CFG_MT_CHUNK) || (0 != (uAES_CFG_MT_CHUNK % 16))
+#error "uAES_CFG_MT_CHUNK must be a multiple of the block size"
+#endif
+
+#endif /*UAES_CONFIG_H*/
@@ -0,0 +1,1812 @@
+/**
+ * @file    bench.c
+ * @author  Antonio Vitor Grossi Bassi
+ * @brief   uAES benchmark, sweeps modes, key sizes, message sizes and engines.
+ * @version 0.1
+ * @date    2026-10-14
+ *
+ *  Copyright (C) 2023, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Output is CSV, one record per line, the first field names the record:
+ *    check,<name>,<mode>,fail                a mode whose known answer test failed
+ *    engine,<name>,<pass|fail>               known answer tests of an engine and a
+ *                                            comparison with the portable engine
+ *    keysetup,<name>,<bits>,<ns>,<cycles>    uaes_ctx_init() with the default engine
+ *    keycache,<bits>,<ns>,<cycles>           uaes_keycache_get() hit (uAES_CFG_KEYCACHE)
+ *    bulk,<name>,<mode>,<bits>,<bytes>,<MB/s>,<cycles/byte>
+ *    shared,<name>,<threads>,<pass|fail>     concurrent calls without locks, see bench_shared()
+ *  Lines starting with '#' are comments. Cycles come from the time stamp
+ *  counter on x86 and are reported as "na" elsewhere.
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "stdint.h"
+#include "string.h"
+#include "time.h"
+#include "pthread.h"
+#include "../uaes.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include "x86intrin.h"
+#define BENCH_CYCLES()        ((uint64_t)__rdtsc())
+#define BENCH_HAS_CYCLES      1
+#else
+#define BENCH_CYCLES()        (0ULL)
+#define BENCH_HAS_CYCLES      0
+#endif
+
+#define BENCH_MIN_SIZE        (16UL)
+#define BENCH_MAX_SIZE        (64UL*MB)
+#define BENCH_DEFAULT_MS      (200UL)
+#define BENCH_KEYSETUP_RUNS   (10000UL)
+#define BENCH_SHARED_THREADS  (4)
+#define BENCH_SHARED_SIZE     (4096UL)
+#define BENCH_SHARED_RUNS     (64)
+#define BENCH_CROSS_SIZE      (23UL*16UL + 7UL)   // Two 8-block batches, a 4-block run, 3 blocks and 7 bytes.
+#define BENCH_POOL_PIECE      (uAES_CFG_MT_MIN_SIZE / 2UL)                              // Serial, below the pool minimum.
+#define BENCH_POOL_ROUND      (2UL * (uAES_CFG_THREADS + 1UL) * uAES_CFG_MT_CHUNK)     // One CBC round of pool.c.
+
+typedef enum
+{
+  BENCH_ECB_ENC = 0,
+  BENCH_ECB_DEC,
+  BENCH_CBC_ENC,
+  BENCH_CBC_DEC,
+  BENCH_CTR,
+  BENCH_GCM_ENC,
+  BENCH_XTS_ENC,
+  BENCH_CCM_ENC,
+  BENCH_CFB_DEC,
+  BENCH_MODES
+}bench_mode_t;
+
+static const char *const mode_name[BENCH_MODES] =
+{
+  "ecb-enc", "ecb-dec", "cbc-enc", "cbc-dec", "ctr", "gcm-enc", "xts-enc", "ccm-enc", "cfb-dec"
+};
+
+/* FIPS-197 Appendix C, the same plaintext under the three key sizes. */
+static const uint8_t fips_pt[16] =
+{
+  0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+static const uint8_t fips_ct[uAESRGE][16] =
+{
+  {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a},
+  {0xdd, 0xa9, 0x7c, 0xa4, 0x86, 0x4c, 0xdf, 0xe0, 0x6e, 0xaf, 0x70, 0xa0, 0xec, 0x0d, 0x71, 0x91},
+  {0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf, 0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89}
+};
+
+/*
+ * SP 800-38A F.1, F.2 and F.5, all four blocks under the three keys, and
+ * F.3.13/F.3.14 (CFB128-AES128) on all four. OFB (F.4.1) is checked on the
+ * first block.
+ */
+static const uint8_t sp_key[uAESRGE][32] =
+{
+  {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+  },
+  {
+    0x8e, 0x73, 0xb0, 0xf7, 0xda, 0x0e, 0x64, 0x52, 0xc8, 0x10, 0xf3, 0x2b, 0x80, 0x90, 0x79, 0xe5,
+    0x62, 0xf8, 0xea, 0xd2, 0x52, 0x2c, 0x6b, 0x7b
+  },
+  {
+    0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae, 0xf0, 0x85, 0x7d, 0x77, 0x81,
+    0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61, 0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4
+  }
+};
+static const uint8_t sp_iv[16] =
+{
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const uint8_t sp_pt[64] =
+{
+  0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+  0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+  0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+  0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+static const uint8_t sp_ecb_ct[uAESRGE][64] =
+{
+  {
+    0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97,
+    0xf5, 0xd3, 0xd5, 0x85, 0x03, 0xb9, 0x69, 0x9d, 0xe7, 0x85, 0x89, 0x5a, 0x96, 0xfd, 0xba, 0xaf,
+    0x43, 0xb1, 0xcd, 0x7f, 0x59, 0x8e, 0xce, 0x23, 0x88, 0x1b, 0x00, 0xe3, 0xed, 0x03, 0x06, 0x88,
+    0x7b, 0x0c, 0x78, 0x5e, 0x27, 0xe8, 0xad, 0x3f, 0x82, 0x23, 0x20, 0x71, 0x04, 0x72, 0x5d, 0xd4
+  },
+  {
+    0xbd, 0x33, 0x4f, 0x1d, 0x6e, 0x45, 0xf2, 0x5f, 0xf7, 0x12, 0xa2, 0x14, 0x57, 0x1f, 0xa5, 0xcc,
+    0x97, 0x41, 0x04, 0x84, 0x6d, 0x0a, 0xd3, 0xad, 0x77, 0x34, 0xec, 0xb3, 0xec, 0xee, 0x4e, 0xef,
+    0xef, 0x7a, 0xfd, 0x22, 0x70, 0xe2, 0xe6, 0x0a, 0xdc, 0xe0, 0xba, 0x2f, 0xac, 0xe6, 0x44, 0x4e,
+    0x9a, 0x4b, 0x41, 0xba, 0x73, 0x8d, 0x6c, 0x72, 0xfb, 0x16, 0x69, 0x16, 0x03, 0xc1, 0x8e, 0x0e
+  },
+  {
+    0xf3, 0xee, 0xd1, 0xbd, 0xb5, 0xd2, 0xa0, 0x3c, 0x06, 0x4b, 0x5a, 0x7e, 0x3d, 0xb1, 0x81, 0xf8,
+    0x59, 0x1c, 0xcb, 0x10, 0xd4, 0x10, 0xed, 0x26, 0xdc, 0x5b, 0xa7, 0x4a, 0x31, 0x36, 0x28, 0x70,
+    0xb6, 0xed, 0x21, 0xb9, 0x9c, 0xa6, 0xf4, 0xf9, 0xf1, 0x53, 0xe7, 0xb1, 0xbe, 0xaf, 0xed, 0x1d,
+    0x23, 0x30, 0x4b, 0x7a, 0x39, 0xf9, 0xf3, 0xff, 0x06, 0x7d, 0x8d, 0x8f, 0x9e, 0x24, 0xec, 0xc7
+  }
+};
+static const uint8_t sp_cbc_ct[uAESRGE][64] =
+{
+  {
+    0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d,
+    0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72, 0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2,
+    0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b, 0x71, 0x16, 0xe6, 0x9e, 0x22, 0x22, 0x95, 0x16,
+    0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac, 0x09, 0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7
+  },
+  {
+    0x4f, 0x02, 0x1d, 0xb2, 0x43, 0xbc, 0x63, 0x3d, 0x71, 0x78, 0x18, 0x3a, 0x9f, 0xa0, 0x71, 0xe8,
+    0xb4, 0xd9, 0xad, 0xa9, 0xad, 0x7d, 0xed, 0xf4, 0xe5, 0xe7, 0x38, 0x76, 0x3f, 0x69, 0x14, 0x5a,
+    0x57, 0x1b, 0x24, 0x20, 0x12, 0xfb, 0x7a, 0xe0, 0x7f, 0xa9, 0xba, 0xac, 0x3d, 0xf1, 0x02, 0xe0,
+    0x08, 0xb0, 0xe2, 0x79, 0x88, 0x59, 0x88, 0x81, 0xd9, 0x20, 0xa9, 0xe6, 0x4f, 0x56, 0x15, 0xcd
+  },
+  {
+    0xf5, 0x8c, 0x4c, 0x04, 0xd6, 0xe5, 0xf1, 0xba, 0x77, 0x9e, 0xab, 0xfb, 0x5f, 0x7b, 0xfb, 0xd6,
+    0x9c, 0xfc, 0x4e, 0x96, 0x7e, 0xdb, 0x80, 0x8d, 0x67, 0x9f, 0x77, 0x7b, 0xc6, 0x70, 0x2c, 0x7d,
+    0x39, 0xf2, 0x33, 0x69, 0xa9, 0xd9, 0xba, 0xcf, 0xa5, 0x30, 0xe2, 0x63, 0x04, 0x23, 0x14, 0x61,
+    0xb2, 0xeb, 0x05, 0xe2, 0xc3, 0x9b, 0xe9, 0xfc, 0xda, 0x6c, 0x19, 0x07, 0x8c, 0x6a, 0x9d, 0x1b
+  }
+};
+#if uAES_CFG_CFB
+static const uint8_t sp_cfb_ct[64] =
+{
+  0x3b, 0x3f, 0xd9, 0x2e, 0xb7, 0x2d, 0xad, 0x20, 0x33, 0x34, 0x49, 0xf8, 0xe8, 0x3c, 0xfb, 0x4a,
+  0xc8, 0xa6, 0x45, 0x37, 0xa0, 0xb3, 0xa9, 0x3f, 0xcd, 0xe3, 0xcd, 0xad, 0x9f, 0x1c, 0xe5, 0x8b,
+  0x26, 0x75, 0x1f, 0x67, 0xa3, 0xcb, 0xb1, 0x40, 0xb1, 0x80, 0x8c, 0xf1, 0x87, 0xa4, 0xf4, 0xdf,
+  0xc0, 0x4b, 0x05, 0x35, 0x7c, 0x5d, 0x1c, 0x0e, 0xea, 0xc4, 0xc6, 0x6f, 0x9f, 0xf7, 0xf2, 0xe6
+};
+#endif /*uAES_CFG_CFB*/
+#if uAES_CFG_PCBC
+/*
+ * PCBC has no published vectors, this is the SP 800-38A key, IV and plaintext
+ * with every block chained with P[i-1] ^ C[i-1], computed with openssl ECB.
+ * The first block is the CBC one.
+ */
+static const uint8_t pcbc_ct[64] =
+{
+  0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d,
+  0x9e, 0x8b, 0xaf, 0xf1, 0x2a, 0xd5, 0x27, 0x0a, 0x0d, 0x1e, 0xef, 0x93, 0xd7, 0x03, 0x79, 0x94,
+  0x57, 0x00, 0xb3, 0x98, 0x03, 0x77, 0x9f, 0xa3, 0x5a, 0x3c, 0x60, 0x0a, 0x49, 0xa1, 0x63, 0xc0,
+  0x33, 0xae, 0x19, 0x9f, 0x27, 0x37, 0x9f, 0x21, 0xbe, 0x6d, 0xd5, 0x7d, 0x29, 0x5c, 0xc8, 0x7d
+};
+#endif /*uAES_CFG_PCBC*/
+#if uAES_CFG_KSBUF
+/* The first OFB block is E(K, IV) ^ P like CFB's. */
+static const uint8_t sp_ofb_ct[16] =
+{
+  0x3b, 0x3f, 0xd9, 0x2e, 0xb7, 0x2d, 0xad, 0x20, 0x33, 0x34, 0x49, 0xf8, 0xe8, 0x3c, 0xfb, 0x4a
+};
+#endif /*uAES_CFG_KSBUF*/
+#if uAES_CFG_CTR
+static const uint8_t sp_ctr_blk[16] =
+{
+  0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+static const uint8_t sp_ctr_ct[uAESRGE][64] =
+{
+  {
+    0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+    0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+    0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+    0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+  },
+  {
+    0x1a, 0xbc, 0x93, 0x24, 0x17, 0x52, 0x1c, 0xa2, 0x4f, 0x2b, 0x04, 0x59, 0xfe, 0x7e, 0x6e, 0x0b,
+    0x09, 0x03, 0x39, 0xec, 0x0a, 0xa6, 0xfa, 0xef, 0xd5, 0xcc, 0xc2, 0xc6, 0xf4, 0xce, 0x8e, 0x94,
+    0x1e, 0x36, 0xb2, 0x6b, 0xd1, 0xeb, 0xc6, 0x70, 0xd1, 0xbd, 0x1d, 0x66, 0x56, 0x20, 0xab, 0xf7,
+    0x4f, 0x78, 0xa7, 0xf6, 0xd2, 0x98, 0x09, 0x58, 0x5a, 0x97, 0xda, 0xec, 0x58, 0xc6, 0xb0, 0x50
+  },
+  {
+    0x60, 0x1e, 0xc3, 0x13, 0x77, 0x57, 0x89, 0xa5, 0xb7, 0xa7, 0xf5, 0x04, 0xbb, 0xf3, 0xd2, 0x28,
+    0xf4, 0x43, 0xe3, 0xca, 0x4d, 0x62, 0xb5, 0x9a, 0xca, 0x84, 0xe9, 0x90, 0xca, 0xca, 0xf5, 0xc5,
+    0x2b, 0x09, 0x30, 0xda, 0xa2, 0x3d, 0xe9, 0x4c, 0xe8, 0x70, 0x17, 0xba, 0x2d, 0x84, 0x98, 0x8d,
+    0xdf, 0xc9, 0xc5, 0x8d, 0xb6, 0x7a, 0xad, 0xa6, 0x13, 0xc2, 0xdd, 0x08, 0x45, 0x79, 0x41, 0xa6
+  }
+};
+#endif /*uAES_CFG_CTR*/
+
+#if uAES_CFG_CTS
+/*
+ * RFC 3962 appendix B, Kerberos CTS is CBC-CS3. Key "chicken teriyaki", zero IV,
+ * the first 17 to 64 bytes of one message. The last two blocks are swapped even
+ * when the size is a block multiple.
+ */
+static const uint8_t cts_key[16] =
+{
+  0x63, 0x68, 0x69, 0x63, 0x6b, 0x65, 0x6e, 0x20, 0x74, 0x65, 0x72, 0x69, 0x79, 0x61, 0x6b, 0x69
+};
+static const uint8_t cts_pt[64] =
+{
+  0x49, 0x20, 0x77, 0x6f, 0x75, 0x6c, 0x64, 0x20, 0x6c, 0x69, 0x6b, 0x65, 0x20, 0x74, 0x68, 0x65,
+  0x20, 0x47, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x6c, 0x20, 0x47, 0x61, 0x75, 0x27, 0x73, 0x20, 0x43,
+  0x68, 0x69, 0x63, 0x6b, 0x65, 0x6e, 0x2c, 0x20, 0x70, 0x6c, 0x65, 0x61, 0x73, 0x65, 0x2c, 0x20,
+  0x61, 0x6e, 0x64, 0x20, 0x77, 0x6f, 0x6e, 0x74, 0x6f, 0x6e, 0x20, 0x73, 0x6f, 0x75, 0x70, 0x2e
+};
+static const size_t cts_len[6] = { 17UL, 31UL, 32UL, 47UL, 48UL, 64UL };
+static const uint8_t cts_ct[6][64] =
+{
+  {
+    0xc6, 0x35, 0x35, 0x68, 0xf2, 0xbf, 0x8c, 0xb4, 0xd8, 0xa5, 0x80, 0x36, 0x2d, 0xa7, 0xff, 0x7f,
+    0x97
+  },
+  {
+    0xfc, 0x00, 0x78, 0x3e, 0x0e, 0xfd, 0xb2, 0xc1, 0xd4, 0x45, 0xd4, 0xc8, 0xef, 0xf7, 0xed, 0x22,
+    0x97, 0x68, 0x72, 0x68, 0xd6, 0xec, 0xcc, 0xc0, 0xc0, 0x7b, 0x25, 0xe2, 0x5e, 0xcf, 0xe5
+  },
+  {
+    0x39, 0x31, 0x25, 0x23, 0xa7, 0x86, 0x62, 0xd5, 0xbe, 0x7f, 0xcb, 0xcc, 0x98, 0xeb, 0xf5, 0xa8,
+    0x97, 0x68, 0x72, 0x68, 0xd6, 0xec, 0xcc, 0xc0, 0xc0, 0x7b, 0x25, 0xe2, 0x5e, 0xcf, 0xe5, 0x84
+  },
+  {
+    0x97, 0x68, 0x72, 0x68, 0xd6, 0xec, 0xcc, 0xc0, 0xc0, 0x7b, 0x25, 0xe2, 0x5e, 0xcf, 0xe5, 0x84,
+    0xb3, 0xff, 0xfd, 0x94, 0x0c, 0x16, 0xa1, 0x8c, 0x1b, 0x55, 0x49, 0xd2, 0xf8, 0x38, 0x02, 0x9e,
+    0x39, 0x31, 0x25, 0x23, 0xa7, 0x86, 0x62, 0xd5, 0xbe, 0x7f, 0xcb, 0xcc, 0x98, 0xeb, 0xf5
+  },
+  {
+    0x97, 0x68, 0x72, 0x68, 0xd6, 0xec, 0xcc, 0xc0, 0xc0, 0x7b, 0x25, 0xe2, 0x5e, 0xcf, 0xe5, 0x84,
+    0x9d, 0xad, 0x8b, 0xbb, 0x96, 0xc4, 0xcd, 0xc0, 0x3b, 0xc1, 0x03, 0xe1, 0xa1, 0x94, 0xbb, 0xd8,
+    0x39, 0x31, 0x25, 0x23, 0xa7, 0x86, 0x62, 0xd5, 0xbe, 0x7f, 0xcb, 0xcc, 0x98, 0xeb, 0xf5, 0xa8
+  },
+  {
+    0x97, 0x68, 0x72, 0x68, 0xd6, 0xec, 0xcc, 0xc0, 0xc0, 0x7b, 0x25, 0xe2, 0x5e, 0xcf, 0xe5, 0x84,
+    0x39, 0x31, 0x25, 0x23, 0xa7, 0x86, 0x62, 0xd5, 0xbe, 0x7f, 0xcb, 0xcc, 0x98, 0xeb, 0xf5, 0xa8,
+    0x48, 0x07, 0xef, 0xe8, 0x36, 0xee, 0x89, 0xa5, 0x26, 0x73, 0x0d, 0xbc, 0x2f, 0x7b, 0xc8, 0x40,
+    0x9d, 0xad, 0x8b, 0xbb, 0x96, 0xc4, 0xcd, 0xc0, 0x3b, 0xc1, 0x03, 0xe1, 0xa1, 0x94, 0xbb, 0xd8
+  }
+};
+#endif /*uAES_CFG_CTS*/
+
+#if uAES_CFG_STREAM
+/*
+ * Last CBC block of the SP 800-38A message padded with PKCS#7 by openssl enc,
+ * the 64-byte message gains a whole pad block, its first 61 bytes end in 3.
+ */
+static const uint8_t pkcs7_ct64[16] =
+{
+  0x8c, 0xb8, 0x28, 0x07, 0x23, 0x0e, 0x13, 0x21, 0xd3, 0xfa, 0xe0, 0x0d, 0x18, 0xcc, 0x20, 0x12
+};
+static const uint8_t pkcs7_ct61[16] =
+{
+  0x4d, 0xa5, 0xb7, 0xc5, 0x5a, 0x0c, 0xad, 0x5b, 0x5d, 0x41, 0x66, 0x59, 0x01, 0x80, 0xc3, 0x63
+};
+#endif /*uAES_CFG_STREAM*/
+
+#if uAES_CFG_XTS
+/*
+ * IEEE 1619-2007 vector 2 (separate keys 11.. and 22.., data unit 0x3333333333,
+ * 32 bytes of 0x44) and vector 15 (17 bytes, the last one stolen).
+ */
+static const uint8_t xts_ct2[32] =
+{
+  0xc4, 0x54, 0x18, 0x5e, 0x6a, 0x16, 0x93, 0x6e, 0x39, 0x33, 0x40, 0x38, 0xac, 0xef, 0x83, 0x8b,
+  0xfb, 0x18, 0x6f, 0xff, 0x74, 0x80, 0xad, 0xc4, 0x28, 0x93, 0x82, 0xec, 0xd6, 0xd3, 0x94, 0xf0
+};
+static const uint8_t xts_key15[2][16] =
+{
+  {0xff, 0xfe, 0xfd, 0xfc, 0xfb, 0xfa, 0xf9, 0xf8, 0xf7, 0xf6, 0xf5, 0xf4, 0xf3, 0xf2, 0xf1, 0xf0},
+  {0xbf, 0xbe, 0xbd, 0xbc, 0xbb, 0xba, 0xb9, 0xb8, 0xb7, 0xb6, 0xb5, 0xb4, 0xb3, 0xb2, 0xb1, 0xb0}
+};
+static const uint8_t xts_tweak15[16] =
+{
+  0x9a, 0x78, 0x56, 0x34, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+static const uint8_t xts_ct15[17] =
+{
+  0x6c, 0x16, 0x25, 0xdb, 0x46, 0x71, 0x52, 0x2d, 0x3d, 0x75, 0x99, 0x60, 0x1d, 0xe7, 0xca, 0x09,
+  0xed
+};
+#endif /*uAES_CFG_XTS*/
+
+#if uAES_CFG_GCM
+/*
+ * GCM specification test cases 1 to 6, 1 and 2 under the all-zero key and IV.
+ * Case 4 is the first 60 bytes of case 3 with AAD, case 5 has an 8-byte IV and
+ * case 6 a 60-byte one. The last vector has a 16-byte IV whose J0 ends in
+ * fffffffe, so the 32-bit counter wraps after the first block (from openssl).
+ */
+static const uint8_t gcm_zero[16] = {0};
+static const uint8_t gcm_ct2[16] =
+{
+  0x03, 0x88, 0xda, 0xce, 0x60, 0xb6, 0xa3, 0x92, 0xf3, 0x28, 0xc2, 0xb9, 0x71, 0xb2, 0xfe, 0x78
+};
+static const uint8_t gcm_key[16] =
+{
+  0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c, 0x6d, 0x6a, 0x8f, 0x94, 0x67, 0x30, 0x83, 0x08
+};
+static const uint8_t gcm_iv[12] =
+{
+  0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad, 0xde, 0xca, 0xf8, 0x88
+};
+static const uint8_t gcm_iv6[60] =
+{
+  0x93, 0x13, 0x22, 0x5d, 0xf8, 0x84, 0x06, 0xe5, 0x55, 0x90, 0x9c, 0x5a, 0xff, 0x52, 0x69, 0xaa,
+  0x6a, 0x7a, 0x95, 0x38, 0x53, 0x4f, 0x7d, 0xa1, 0xe4, 0xc3, 0x03, 0xd2, 0xa3, 0x18, 0xa7, 0x28,
+  0xc3, 0xc0, 0xc9, 0x51, 0x56, 0x80, 0x95, 0x39, 0xfc, 0xf0, 0xe2, 0x42, 0x9a, 0x6b, 0x52, 0x54,
+  0x16, 0xae, 0xdb, 0xf5, 0xa0, 0xde, 0x6a, 0x57, 0xa6, 0x37, 0xb3, 0x9b
+};
+static const uint8_t gcm_iv_wrap[16] =
+{
+  0xaa, 0x41, 0x4a, 0x69, 0x92, 0xb0, 0x02, 0x9d, 0xcf, 0x5c, 0x41, 0xda, 0x2a, 0x97, 0x7f, 0x2a
+};
+static const uint8_t gcm_aad[20] =
+{
+  0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef, 0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,
+  0xab, 0xad, 0xda, 0xd2
+};
+static const uint8_t gcm_pt[64] =
+{
+  0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5, 0xa5, 0x59, 0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a,
+  0x86, 0xa7, 0xa9, 0x53, 0x15, 0x34, 0xf7, 0xda, 0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31, 0x8a, 0x72,
+  0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53, 0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25,
+  0xb1, 0x6a, 0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57, 0xba, 0x63, 0x7b, 0x39, 0x1a, 0xaf, 0xd2, 0x55
+};
+static const uint8_t gcm_ct3[64] =
+{
+  0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24, 0x4b, 0x72, 0x21, 0xb7, 0x84, 0xd0, 0xd4, 0x9c,
+  0xe3, 0xaa, 0x21, 0x2f, 0x2c, 0x02, 0xa4, 0xe0, 0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac, 0xa1, 0x2e,
+  0x21, 0xd5, 0x14, 0xb2, 0x54, 0x66, 0x93, 0x1c, 0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05,
+  0x1b, 0xa3, 0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97, 0x3d, 0x58, 0xe0, 0x91, 0x47, 0x3f, 0x59, 0x85
+};
+static const uint8_t gcm_ct5[60] =
+{
+  0x61, 0x35, 0x3b, 0x4c, 0x28, 0x06, 0x93, 0x4a, 0x77, 0x7f, 0xf5, 0x1f, 0xa2, 0x2a, 0x47, 0x55,
+  0x69, 0x9b, 0x2a, 0x71, 0x4f, 0xcd, 0xc6, 0xf8, 0x37, 0x66, 0xe5, 0xf9, 0x7b, 0x6c, 0x74, 0x23,
+  0x73, 0x80, 0x69, 0x00, 0xe4, 0x9f, 0x24, 0xb2, 0x2b, 0x09, 0x75, 0x44, 0xd4, 0x89, 0x6b, 0x42,
+  0x49, 0x89, 0xb5, 0xe1, 0xeb, 0xac, 0x0f, 0x07, 0xc2, 0x3f, 0x45, 0x98
+};
+static const uint8_t gcm_ct6[60] =
+{
+  0x8c, 0xe2, 0x49, 0x98, 0x62, 0x56, 0x15, 0xb6, 0x03, 0xa0, 0x33, 0xac, 0xa1, 0x3f, 0xb8, 0x94,
+  0xbe, 0x91, 0x12, 0xa5, 0xc3, 0xa2, 0x11, 0xa8, 0xba, 0x26, 0x2a, 0x3c, 0xca, 0x7e, 0x2c, 0xa7,
+  0x01, 0xe4, 0xa9, 0xa4, 0xfb, 0xa4, 0x3c, 0x90, 0xcc, 0xdc, 0xb2, 0x81, 0xd4, 0x8c, 0x7c, 0x6f,
+  0xd6, 0x28, 0x75, 0xd2, 0xac, 0xa4, 0x17, 0x03, 0x4c, 0x34, 0xae, 0xe5
+};
+static const uint8_t gcm_ct_wrap[60] =
+{
+  0x77, 0xff, 0xd1, 0xba, 0x63, 0xb1, 0x41, 0xba, 0xfb, 0x2e, 0xfb, 0x32, 0x9c, 0x9c, 0x25, 0xee,
+  0x99, 0xe5, 0xe0, 0x6e, 0x60, 0x3d, 0xd5, 0xc6, 0x8e, 0xfe, 0x1c, 0xb2, 0xce, 0xfc, 0x06, 0x77,
+  0x2e, 0x7b, 0x14, 0xde, 0xa9, 0x27, 0x60, 0xf7, 0x62, 0x73, 0xdc, 0x0c, 0xce, 0x1d, 0x01, 0x3d,
+  0x2a, 0xd8, 0xc1, 0x12, 0x73, 0xfe, 0x94, 0x96, 0x54, 0x48, 0x53, 0x4b
+};
+static const uint8_t gcm_tag[7][16] =
+{
+  {0x58, 0xe2, 0xfc, 0xce, 0xfa, 0x7e, 0x30, 0x61, 0x36, 0x7f, 0x1d, 0x57, 0xa4, 0xe7, 0x45, 0x5a},
+  {0xab, 0x6e, 0x47, 0xd4, 0x2c, 0xec, 0x13, 0xbd, 0xf5, 0x3a, 0x67, 0xb2, 0x12, 0x57, 0xbd, 0xdf},
+  {0x4d, 0x5c, 0x2a, 0xf3, 0x27, 0xcd, 0x64, 0xa6, 0x2c, 0xf3, 0x5a, 0xbd, 0x2b, 0xa6, 0xfa, 0xb4},
+  {0x5b, 0xc9, 0x4f, 0xbc, 0x32, 0x21, 0xa5, 0xdb, 0x94, 0xfa, 0xe9, 0x5a, 0xe7, 0x12, 0x1a, 0x47},
+  {0x36, 0x12, 0xd2, 0xe7, 0x9e, 0x3b, 0x07, 0x85, 0x56, 0x1b, 0xe1, 0x4a, 0xac, 0xa2, 0xfc, 0xcb},
+  {0x61, 0x9c, 0xc5, 0xae, 0xff, 0xfe, 0x0b, 0xfa, 0x46, 0x2a, 0xf4, 0x3c, 0x16, 0x99, 0xd0, 0x50},
+  {0x73, 0xa4, 0x98, 0xc0, 0xa2, 0xcd, 0x14, 0x94, 0x92, 0xb7, 0xe9, 0x12, 0x25, 0xa7, 0x5c, 0x64}
+};
+
+typedef struct
+{
+  const uint8_t *key;
+  const uint8_t *iv;
+  size_t        iv_len;
+  size_t        aad_len;                  // Leading bytes of gcm_aad.
+  const uint8_t *ct;
+  size_t        size;                     // Leading bytes of gcm_pt or gcm_zero.
+}bench_gcm_vec_t;
+
+static const bench_gcm_vec_t gcm_vec[7] =
+{
+  { gcm_zero, gcm_zero,     12,  0, gcm_zero,     0 },
+  { gcm_zero, gcm_zero,     12,  0, gcm_ct2,     16 },
+  { gcm_key,  gcm_iv,       12,  0, gcm_ct3,     64 },
+  { gcm_key,  gcm_iv,       12, 20, gcm_ct3,     60 },
+  { gcm_key,  gcm_iv,        8, 20, gcm_ct5,     60 },
+  { gcm_key,  gcm_iv6,      60, 20, gcm_ct6,     60 },
+  { gcm_key,  gcm_iv_wrap,  16,  0, gcm_ct_wrap, 60 },
+};
+#endif /*uAES_CFG_GCM*/
+
+#if uAES_CFG_CMAC
+/*
+ * RFC 4493 examples 1 to 4, the SP 800-38A key over the first 0, 16, 40 and 64
+ * bytes of its plaintext. The empty and 40-byte messages end in a padded block
+ * masked with K2, the others in a whole block masked with K1.
+ */
+static const size_t cmac_len[4] = { 0UL, 16UL, 40UL, 64UL };
+static const uint8_t cmac_tag[4][16] =
+{
+  {0xbb, 0x1d, 0x69, 0x29, 0xe9, 0x59, 0x37, 0x28, 0x7f, 0xa3, 0x7d, 0x12, 0x9b, 0x75, 0x67, 0x46},
+  {0x07, 0x0a, 0x16, 0xb4, 0x6b, 0x4d, 0x41, 0x44, 0xf7, 0x9b, 0xdd, 0x9d, 0xd0, 0x4a, 0x28, 0x7c},
+  {0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30, 0x30, 0xca, 0x32, 0x61, 0x14, 0x97, 0xc8, 0x27},
+  {0x51, 0xf0, 0xbe, 0xbf, 0x7e, 0x3b, 0x9d, 0x92, 0xfc, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3c, 0xfe}
+};
+#endif /*uAES_CFG_CMAC*/
+
+#if uAES_CFG_CCM
+/* SP 800-38C C.1, key 40..4f, nonce 10..16, associated data 00..07, payload 20..23. */
+static const uint8_t ccm_ct[4] =
+{
+  0x71, 0x62, 0x01, 0x5b
+};
+static const uint8_t ccm_tag[4] =
+{
+  0x4d, 0xac, 0x25, 0x5d
+};
+#endif /*uAES_CFG_CCM*/
+
+static uint64_t bench_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static int bench_init(uaes_ctx_t *ctx, const uint8_t *key, aes_length_t len, uaes_engine_id_t id)
+{
+  uint8_t k[32];
+
+  memcpy(k, key, 16UL + (8UL * len));
+  if( 0 != uaes_ctx_init(ctx, k, len, uAES_CTX_BOTH) )
+  {
+    return -1;
+  }
+  return uaes_ctx_set_engine(ctx, id);
+}
+
+#if uAES_CFG_STREAM
+/**
+ * @brief         Runs a whole message through the streaming API in uneven chunks.
+ * @param out     Output buffer, size plus 32 bytes.
+ * @param out_len Receives the bytes written by update and final together.
+ * @return int    [0] if every call succeeded, [-1] otherwise.
+ */
+static int bench_stream(const uaes_ctx_t *ctx, uaes_stream_mode_t mode, const uint8_t *iv, size_t ctr_width,
+                        const uint8_t *in, size_t size, uint8_t *out, size_t *out_len)
+{
+  static const size_t chunk[4] = { 1UL, 7UL, 16UL, 23UL };
+  uaes_stream_t st;
+  size_t pos = 0, n = 0, len = 0;
+  int err = 0;
+
+  *out_len = 0;
+  err |= uaes_stream_init(&st, ctx, mode, iv, ctr_width);
+  for(int idx = 0; (0 == err) && (pos < size); idx++, pos += n)
+  {
+    n = ( chunk[idx & 3] < (size - pos) ) ? (chunk[idx & 3]) : (size - pos);
+    err |= uaes_stream_update(&st, &out[*out_len], &in[pos], n, &len);
+    *out_len += len;
+  }
+  err |= uaes_stream_final(&st, &out[*out_len], &len);
+  *out_len += len;
+  return ( 0 == err ) ? (0) : (-1);
+}
+#endif /*uAES_CFG_STREAM*/
+
+#if uAES_CFG_JOB
+/* Completion callback of the job checks, counts its calls. */
+static void bench_job_done(uaes_job_t *job, void *arg)
+{
+  (void)job;
+  (*(int *)arg)++;
+  return;
+}
+#endif /*uAES_CFG_JOB*/
+
+static int bench_mode_built(bench_mode_t mode)
+{
+  switch(mode)
+  {
+    case BENCH_CTR:
+      return uAES_CFG_CTR;
+    case BENCH_GCM_ENC:
+      return uAES_CFG_GCM;
+    case BENCH_XTS_ENC:
+      return uAES_CFG_XTS;
+    case BENCH_CCM_ENC:
+      return uAES_CFG_CCM;
+    case BENCH_CFB_DEC:
+      return uAES_CFG_CFB;
+    default:
+      return 1;
+  }
+}
+
+/**
+ * @brief     FIPS-197 Appendix C and SP 800-38A F.1 under every key size.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_ecb(uaes_engine_id_t id)
+{
+  uaes_ctx_t ctx;
+  uint8_t key[32], buf[64];
+  int err = 0;
+
+  for(int idx = 0; idx < 32; idx++)
+  {
+    key[idx] = (uint8_t)idx;
+  }
+  for(int len = uAES128; len < uAESRGE; len++)
+  {
+    if( (128 + (64 * len)) > uAES_CFG_MAX_KEY_BITS )
+    {
+      continue;
+    }
+    memcpy(buf, fips_pt, 16);
+    err |= bench_init(&ctx, key, (aes_length_t)len, id);
+    err |= uaes_ctx_ecb_encryption(&ctx, buf, 16);
+    err |= memcmp(buf, fips_ct[len], 16);
+    err |= uaes_ctx_ecb_decryption(&ctx, buf, 16);
+    err |= memcmp(buf, fips_pt, 16);
+
+    memcpy(buf, sp_pt, 64);
+    err |= bench_init(&ctx, sp_key[len], (aes_length_t)len, id);
+    err |= uaes_ctx_ecb_encryption(&ctx, buf, 64);
+    err |= memcmp(buf, sp_ecb_ct[len], 64);
+    err |= uaes_ctx_ecb_decryption(&ctx, buf, 64);
+    err |= memcmp(buf, sp_pt, 64);
+  }
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+
+/**
+ * @brief     SP 800-38A F.2 under every key size.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_cbc(uaes_engine_id_t id)
+{
+  uaes_ctx_t ctx;
+  uint8_t buf[64], iv[16];
+  int err = 0;
+
+  for(int len = uAES128; len < uAESRGE; len++)
+  {
+    if( (128 + (64 * len)) > uAES_CFG_MAX_KEY_BITS )
+    {
+      continue;
+    }
+    memcpy(buf, sp_pt, 64);
+    memcpy(iv, sp_iv, 16);
+    err |= bench_init(&ctx, sp_key[len], (aes_length_t)len, id);
+    err |= uaes_ctx_cbc_encryption(&ctx, buf, 64, iv);
+    err |= memcmp(buf, sp_cbc_ct[len], 64);
+    err |= uaes_ctx_cbc_decryption(&ctx, buf, 64, iv);
+    err |= memcmp(buf, sp_pt, 64);
+  }
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+
+/**
+ * @brief     Out-of-place ECB and CBC calls leave the input alone.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_oop(uaes_engine_id_t id)
+{
+  uaes_ctx_t ctx;
+  uint8_t out[64], iv[16];
+  int err = 0;
+
+  memcpy(iv, sp_iv, 16);
+  err |= bench_init(&ctx, sp_key[uAES128], uAES128, id);
+  err |= uaes_ctx_ecb_encryption_oop(&ctx, out, sp_pt, 64);
+  err |= memcmp(out, sp_ecb_ct[uAES128], 64);
+  err |= uaes_ctx_ecb_decryption_oop(&ctx, out, sp_ecb_ct[uAES128], 64);
+  err |= memcmp(out, sp_pt, 64);
+  err |= uaes_ctx_cbc_encryption_oop(&ctx, out, sp_pt, 64, iv);
+  err |= memcmp(out, sp_cbc_ct[uAES128], 64);
+  err |= uaes_ctx_cbc_decryption_oop(&ctx, out, sp_cbc_ct[uAES128], 64, iv);
+  err |= memcmp(out, sp_pt, 64);
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+
+#if uAES_CFG_CTR
+/**
+ * @brief     SP 800-38A F.5 under every key size.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_ctr(uaes_engine_id_t id)
+{
+  uaes_ctx_t ctx;
+  uint8_t buf[64], ctr[16];
+  int err = 0;
+
+  for(int len = uAES128; len < uAESRGE; len++)
+  {
+    if( (128 + (64 * len)) > uAES_CFG_MAX_KEY_BITS )
+    {
+      continue;
+    }
+    memcpy(buf, sp_pt, 64);
+    memcpy(ctr, sp_ctr_blk, 16);
+    err |= bench_init(&ctx, sp_key[len], (aes_length_t)len, id);
+    err |= uaes_ctx_ctr_encryption(&ctx, buf, 64, ctr, 4);
+    err |= memcmp(buf, sp_ctr_ct[len], 64);
+  }
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+#endif /*uAES_CFG_CTR*/
+
+#if uAES_CFG_CTS
+/**
+ * @brief     RFC 3962 appendix B, from one partial block to several whole ones.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_cts(uaes_engine_id_t id)
+{
+  uaes_ctx_t ctx;
+  uint8_t buf[64], zero[16] = {0};
+  int err = 0;
+
+  err |= bench_init(&ctx, cts_key, uAES128, id);
+  for(int vec = 0; vec < 6; vec++)
+  {
+    memcpy(buf, cts_pt, cts_len[vec]);
+    err |= uaes_ctx_cbc_cs3_encryption(&ctx, buf, cts_len[vec], zero);
+    err |= memcmp(buf, cts_ct[vec], cts_len[vec]);
+    err |= uaes_ctx_cbc_cs3_decryption(&ctx, buf, cts_len[vec], zero);
+    err |= memcmp(buf, cts_pt, cts_len[vec]);
+  }
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+#endif /*uAES_CFG_CTS*/
+
+#if uAES_CFG_PCBC
+/**
+ * @brief     Four PCBC blocks, every one after the first chained with the previous
+ *            plaintext and ciphertext.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_pcbc(uaes_engine_id_t id)
+{
+  uaes_ctx_t ctx;
+  uint8_t buf[64], iv[16];
+  int err = 0;
+
+  memcpy(buf, sp_pt, 64);
+  memcpy(iv, sp_iv, 16);
+  err |= bench_init(&ctx, sp_key[uAES128], uAES128, id);
+  err |= uaes_ctx_pcbc_encryption(&ctx, buf, 64, iv);
+  err |= memcmp(buf, pcbc_ct, 64);
+  err |= uaes_ctx_pcbc_decryption(&ctx, buf, 64, iv);
+  err |= memcmp(buf, sp_pt, 64);
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+#endif /*uAES_CFG_PCBC*/
+
+#if uAES_CFG_CFB
+/**
+ * @brief     SP 800-38A F.3.13 and F.3.14, the four blocks decrypted in one batch,
+ *            and again cut short inside the last block.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_cfb(uaes_engine_id_t id)
+{
+  uaes_ctx_t ctx;
+  uint8_t buf[64], iv[16];
+  int err = 0;
+
+  memcpy(buf, sp_pt, 64);
+  memcpy(iv, sp_iv, 16);
+  err |= bench_init(&ctx, sp_key[uAES128], uAES128, id);
+  err |= uaes_ctx_cfb_encryption(&ctx, buf, 64, iv);
+  err |= memcmp(buf, sp_cfb_ct, 64);
+  err |= uaes_ctx_cfb_decryption(&ctx, buf, 64, iv);
+  err |= memcmp(buf, sp_pt, 64);
+  memcpy(buf, sp_cfb_ct, 64);
+  err |= uaes_ctx_cfb_decryption(&ctx, buf, 61, iv);
+  err |= memcmp(buf, sp_pt, 61);
+  err |= memcmp(&buf[61], &sp_cfb_ct[61], 3);
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+#endif /*uAES_CFG_CFB*/
+
+#if uAES_CFG_KSBUF
+/**
+ * @brief     The keystream ring in OFB (SP 800-38A F.4.1) and CTR (F.5.1) mode,
+ *            first block.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_ksbuf(uaes_engine_id_t id)
+{
+  uaes_ctx_t ctx;
+  uaes_ksbuf_t ks;
+  uint8_t ring[64], buf[16];
+  int err = 0;
+
+  memcpy(buf, sp_pt, 16);
+  err |= bench_init(&ctx, sp_key[uAES128], uAES128, id);
+  err |= uaes_ksbuf_init(&ks, &ctx, uAES_KSBUF_OFB, ring, sizeof(ring), sp_iv, 0);
+  err |= ( 1 == uaes_ksbuf_fill(&ks, 8) ) ? (0) : (-1);
+  err |= uaes_ksbuf_xor(&ks, buf, 16);
+  err |= memcmp(buf, sp_ofb_ct, 16);
+#if uAES_CFG_CTR
+  memcpy(buf, sp_pt, 16);
+  err |= uaes_ksbuf_init(&ks, &ctx, uAES_KSBUF_CTR, ring, sizeof(ring), sp_ctr_blk, 4);
+  err |= uaes_ksbuf_fill(&ks, 1);
+  err |= uaes_ksbuf_xor(&ks, buf, 16);
+  err |= memcmp(buf, sp_ctr_ct[uAES128], 16);
+#endif /*uAES_CFG_CTR*/
+  uaes_ksbuf_clear(&ks);
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+#endif /*uAES_CFG_KSBUF*/
+
+#if uAES_CFG_STREAM
+/**
+ * @brief     The SP 800-38A messages fed a few bytes at a time.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_stream(uaes_engine_id_t id)
+{
+  uaes_ctx_t ctx;
+  uint8_t out[64 + 32];
+  size_t len = 0;
+  int err = 0;
+
+  err |= bench_init(&ctx, sp_key[uAES128], uAES128, id);
+  err |= bench_stream(&ctx, uAES_STREAM_CBC_ENCRYPT, sp_iv, 0, sp_pt, 64, out, &len);
+  err |= ( 64 == len ) ? (memcmp(out, sp_cbc_ct[uAES128], 64)) : (-1);
+  err |= bench_stream(&ctx, uAES_STREAM_CBC_DECRYPT, sp_iv, 0, sp_cbc_ct[uAES128], 64, out, &len);
+  err |= ( 64 == len ) ? (memcmp(out, sp_pt, 64)) : (-1);
+#if uAES_CFG_CTR
+  err |= bench_stream(&ctx, uAES_STREAM_CTR, sp_ctr_blk, 4, sp_pt, 64, out, &len);
+  err |= ( 64 == len ) ? (memcmp(out, sp_ctr_ct[uAES128], 64)) : (-1);
+  err |= bench_stream(&ctx, uAES_STREAM_CTR, sp_ctr_blk, 4, sp_pt, 61, out, &len);
+  err |= ( 61 == len ) ? (memcmp(out, sp_ctr_ct[uAES128], 61)) : (-1);
+#endif /*uAES_CFG_CTR*/
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+
+/**
+ * @brief     The PKCS#7 stream modes fed a few bytes at a time, so decryption holds
+ *            its last block back across calls. A pad block is added to a block
+ *            multiple, a bad pad and a cut ciphertext are refused.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_pkcs7(uaes_engine_id_t id)
+{
+  uaes_ctx_t ctx;
+  uint8_t ct[80 + 32], pt[80 + 32];
+  size_t len = 0;
+  int err = 0;
+
+  err |= bench_init(&ctx, sp_key[uAES128], uAES128, id);
+  err |= bench_stream(&ctx, uAES_STREAM_CBC_ENCRYPT_PKCS7, sp_iv, 0, sp_pt, 64, ct, &len);
+  err |= ( 80 == len ) ? (memcmp(ct, sp_cbc_ct[uAES128], 64) | memcmp(&ct[64], pkcs7_ct64, 16)) : (-1);
+  err |= bench_stream(&ctx, uAES_STREAM_CBC_DECRYPT_PKCS7, sp_iv, 0, ct, 80, pt, &len);
+  err |= ( 64 == len ) ? (memcmp(pt, sp_pt, 64)) : (-1);
+
+  err |= bench_stream(&ctx, uAES_STREAM_CBC_ENCRYPT_PKCS7, sp_iv, 0, sp_pt, 61, ct, &len);
+  err |= ( 64 == len ) ? (memcmp(ct, sp_cbc_ct[uAES128], 48) | memcmp(&ct[48], pkcs7_ct61, 16)) : (-1);
+  err |= bench_stream(&ctx, uAES_STREAM_CBC_DECRYPT_PKCS7, sp_iv, 0, ct, 64, pt, &len);
+  err |= ( 61 == len ) ? (memcmp(pt, sp_pt, 61)) : (-1);
+
+  /* The SP 800-38A plaintext ends in 0x10 without fifteen more of them. */
+  err |= ( -1 == bench_stream(&ctx, uAES_STREAM_CBC_DECRYPT_PKCS7, sp_iv, 0, sp_cbc_ct[uAES128], 64, pt, &len) ) ? (0) : (-1);
+  err |= ( -1 == bench_stream(&ctx, uAES_STREAM_CBC_DECRYPT_PKCS7, sp_iv, 0, ct, 63, pt, &len) ) ? (0) : (-1);
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+#endif /*uAES_CFG_STREAM*/
+
+#if uAES_CFG_IOV
+/**
+ * @brief     SP 800-38A F.1 and F.2 over scattered segments, blocks 0 and 1 of
+ *            the input and block 1 of the output straddle segments.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_iov(uaes_engine_id_t id)
+{
+  uaes_ctx_t ctx;
+  uint8_t in[64], out[64], iv[16];
+  const uaes_iovec_t src[4] = { { &in[0], 5 }, { &in[5], 20 }, { NULL, 0 }, { &in[25], 39 } };
+  const uaes_iovec_t dst[3] = { { &out[0], 16 }, { &out[16], 3 }, { &out[19], 45 } };
+  int err = 0;
+
+  memcpy(iv, sp_iv, 16);
+  err |= bench_init(&ctx, sp_key[uAES128], uAES128, id);
+  memcpy(in, sp_pt, 64);
+  err |= uaes_ctx_ecb_encryption_iov(&ctx, dst, 3, src, 4);
+  err |= memcmp(out, sp_ecb_ct[uAES128], 64);
+  memcpy(in, sp_ecb_ct[uAES128], 64);
+  err |= uaes_ctx_ecb_decryption_iov(&ctx, dst, 3, src, 4);
+  err |= memcmp(out, sp_pt, 64);
+  memcpy(in, sp_pt, 64);
+  err |= uaes_ctx_cbc_encryption_iov(&ctx, dst, 3, src, 4, iv);
+  err |= memcmp(out, sp_cbc_ct[uAES128], 64);
+  memcpy(in, sp_cbc_ct[uAES128], 64);
+  err |= uaes_ctx_cbc_decryption_iov(&ctx, dst, 3, src, 4, iv);
+  err |= memcmp(out, sp_pt, 64);
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+#endif /*uAES_CFG_IOV*/
+
+#if uAES_CFG_MULTI
+/**
+ * @brief     More jobs than lanes, so lanes are refilled, under every key size and
+ *            of mixed sizes, against SP 800-38A F.2.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_multi(uaes_engine_id_t id)
+{
+  uint8_t msg[11][64], iv[16];
+  uaes_cbc_job_t jobs[11];
+  uaes_ctx_t mctx[uAESRGE];
+  const int nlen = 1 + ((uAES_CFG_MAX_KEY_BITS - 128) / 64);
+  int mlen[11];
+  int err = 0;
+
+  memcpy(iv, sp_iv, 16);
+  for(int len = uAES128; len < nlen; len++)
+  {
+    err |= bench_init(&mctx[len], sp_key[len], (aes_length_t)len, id);
+  }
+  for(int job = 0; job < 11; job++)
+  {
+    mlen[job]      = job % nlen;
+    jobs[job].ctx  = &mctx[mlen[job]];
+    jobs[job].iv   = iv;
+    jobs[job].buf  = ( 5 == job ) ? (NULL) : (msg[job]);
+    jobs[job].size = ( 5 == job ) ? (0UL) : (16UL * (1UL + ((size_t)job & 3UL)));
+    memcpy(msg[job], sp_pt, 64);
+  }
+  err |= uaes_ctx_cbc_encryption_multi(jobs, 11);
+  for(int job = 0; job < 11; job++)
+  {
+    /* A CBC message cut short is a prefix of the full one. */
+    err |= memcmp(msg[job], ( 5 == job ) ? (sp_pt) : (sp_cbc_ct[mlen[job]]), jobs[job].size);
+    err |= memcmp(&msg[job][jobs[job].size], &sp_pt[jobs[job].size], 64 - jobs[job].size);
+  }
+  for(int len = uAES128; len < nlen; len++)
+  {
+    uaes_ctx_clear(&mctx[len]);
+  }
+  return ( 0 == err ) ? (0) : (-1);
+}
+#endif /*uAES_CFG_MULTI*/
+
+#if uAES_CFG_JOB
+/**
+ * @brief     Sliced jobs against SP 800-38A F.2 and F.5.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_job(uaes_engine_id_t id)
+{
+  uaes_ctx_t ctx;
+  uaes_job_t job;
+  uint8_t out[64], iv[16];
+  int calls = 0;
+  int err = 0;
+
+  memcpy(iv, sp_iv, 16);
+  err |= bench_init(&ctx, sp_key[uAES128], uAES128, id);
+  /* Input arriving a few bytes at a time, a block is only run once it is whole. */
+  err |= uaes_job_init(&job, &ctx, uAES_JOB_CBC_ENCRYPT, out, sp_pt, 64, iv, 0, bench_job_done, &calls);
+  err |= uaes_job_feed(&job, 0);
+  err |= ( 0 == uaes_job_step(&job, 8) ) ? (0) : (-1);
+  err |= uaes_job_feed(&job, 20);
+  err |= ( (0 == uaes_job_step(&job, 8)) && (16 == uaes_job_done(&job)) ) ? (0) : (-1);
+  err |= ( -1 == uaes_job_feed(&job, 10) ) ? (0) : (-1);
+  err |= uaes_job_feed(&job, 50);
+  err |= ( (0 == uaes_job_step(&job, 1)) && (32 == uaes_job_done(&job)) ) ? (0) : (-1);
+  err |= ( (0 == uaes_job_step(&job, 8)) && (48 == uaes_job_done(&job)) ) ? (0) : (-1);
+  err |= ( 0 == calls ) ? (0) : (-1);
+  err |= uaes_job_feed(&job, 64);
+  err |= ( 1 == uaes_job_step(&job, 8) ) ? (0) : (-1);
+  err |= ( 1 == uaes_job_step(&job, 8) ) ? (0) : (-1);
+  err |= ( 1 == calls ) ? (0) : (-1);
+  err |= memcmp(out, sp_cbc_ct[uAES128], 64);
+#if uAES_CFG_CTR
+  /* The whole input ready from the start, one block per step, 61 bytes. */
+  calls = 0;
+  err |= uaes_job_init(&job, &ctx, uAES_JOB_CTR, out, sp_pt, 61, sp_ctr_blk, 4, bench_job_done, &calls);
+  for(int step = 0; (step < 3) && (0 == err); step++)
+  {
+    err |= uaes_job_step(&job, 1);
+  }
+  err |= ( 1 == uaes_job_step(&job, 1) ) ? (0) : (-1);
+  err |= ( 1 == calls ) ? (0) : (-1);
+  err |= memcmp(out, sp_ctr_ct[uAES128], 61);
+#endif /*uAES_CFG_CTR*/
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+#endif /*uAES_CFG_JOB*/
+
+#if uAES_CFG_XTS
+/**
+ * @brief     IEEE 1619-2007 vectors 2 and 15.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_xts(uaes_engine_id_t id)
+{
+  uaes_ctx_t ctx, tweak_ctx;
+  uint8_t key[16], xts[32];
+  int err = 0;
+
+  memset(key, 0x11, 16);
+  memset(xts, 0x44, sizeof(xts));
+  err |= bench_init(&ctx, key, uAES128, id);
+  memset(key, 0x22, 16);
+  err |= bench_init(&tweak_ctx, key, uAES128, id);
+  err |= uaes_ctx_xts_encryption_sectors(&ctx, &tweak_ctx, xts, sizeof(xts), sizeof(xts), 0x3333333333ULL);
+  err |= memcmp(xts, xts_ct2, sizeof(xts));
+  err |= uaes_ctx_xts_decryption_sectors(&ctx, &tweak_ctx, xts, sizeof(xts), sizeof(xts), 0x3333333333ULL);
+  for(size_t pos = 0; pos < sizeof(xts); pos++)
+  {
+    err |= ( 0x44 == xts[pos] ) ? (0) : (-1);
+  }
+
+  for(int idx = 0; idx < 17; idx++)
+  {
+    xts[idx] = (uint8_t)idx;
+  }
+  err |= bench_init(&ctx, xts_key15[0], uAES128, id);
+  err |= bench_init(&tweak_ctx, xts_key15[1], uAES128, id);
+  err |= uaes_ctx_xts_encryption(&ctx, &tweak_ctx, xts, 17, xts_tweak15);
+  err |= memcmp(xts, xts_ct15, 17);
+  err |= uaes_ctx_xts_decryption(&ctx, &tweak_ctx, xts, 17, xts_tweak15);
+  for(int idx = 0; idx < 17; idx++)
+  {
+    err |= ( idx == xts[idx] ) ? (0) : (-1);
+  }
+  uaes_ctx_clear(&tweak_ctx);
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+#endif /*uAES_CFG_XTS*/
+
+#if uAES_CFG_GCM
+/**
+ * @brief     GCM specification test cases 1 to 6 and a counter wrap, both ways,
+ *            test case 4 again through split calls that leave partial blocks,
+ *            and a tampered tag.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_gcm(uaes_engine_id_t id)
+{
+  static const size_t split[4] = { 1UL, 17UL, 23UL, 19UL };
+  uaes_ctx_t ctx;
+  uaes_gcm_t gcm;
+  uint8_t buf[64], tag[16];
+  size_t pos = 0;
+  int err = 0;
+
+  for(int vec = 0; vec < 7; vec++)
+  {
+    const bench_gcm_vec_t *v = &gcm_vec[vec];
+    const uint8_t *pt = ( gcm_zero == v->key ) ? (gcm_zero) : (gcm_pt);
+
+    memcpy(buf, pt, v->size);
+    err |= bench_init(&ctx, v->key, uAES128, id);
+    err |= uaes_ctx_gcm_encryption(&ctx, v->iv, v->iv_len, gcm_aad, v->aad_len, buf, v->size, tag, 16);
+    err |= memcmp(buf, v->ct, v->size);
+    err |= memcmp(tag, gcm_tag[vec], 16);
+    err |= uaes_ctx_gcm_decryption(&ctx, v->iv, v->iv_len, gcm_aad, v->aad_len, buf, v->size, gcm_tag[vec], 16);
+    err |= memcmp(buf, pt, v->size);
+  }
+
+  /* Test case 4, the AAD in two calls and the data in four. */
+  memcpy(buf, gcm_pt, 60);
+  err |= uaes_gcm_init(&gcm, &ctx, gcm_iv, 12);
+  err |= uaes_gcm_aad(&gcm, gcm_aad, 7);
+  err |= uaes_gcm_aad(&gcm, &gcm_aad[7], 13);
+  pos = 0;
+  for(int idx = 0; idx < 4; pos += split[idx++])
+  {
+    err |= uaes_gcm_encrypt_update(&gcm, &buf[pos], split[idx]);
+  }
+  err |= uaes_gcm_final(&gcm, tag, 16);
+  err |= memcmp(buf, gcm_ct3, 60);
+  err |= memcmp(tag, gcm_tag[3], 16);
+  err |= uaes_gcm_init(&gcm, &ctx, gcm_iv, 12);
+  err |= uaes_gcm_aad(&gcm, gcm_aad, 20);
+  pos = 0;
+  for(int idx = 3; idx >= 0; pos += split[idx--])
+  {
+    err |= uaes_gcm_decrypt_update(&gcm, &buf[pos], split[idx]);
+  }
+  err |= uaes_gcm_verify(&gcm, gcm_tag[3], 16);
+  err |= memcmp(buf, gcm_pt, 60);
+
+  /* A tampered tag is refused and the buffer zeroed. */
+  memcpy(buf, gcm_ct3, 60);
+  memcpy(tag, gcm_tag[3], 16);
+  tag[15] ^= 0x01;
+  err |= ( -1 == uaes_ctx_gcm_decryption(&ctx, gcm_iv, 12, gcm_aad, 20, buf, 60, tag, 16) ) ? (0) : (-1);
+  for(pos = 0; pos < 60; pos++)
+  {
+    err |= ( 0x00 == buf[pos] ) ? (0) : (-1);
+  }
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+#endif /*uAES_CFG_GCM*/
+
+#if uAES_CFG_CMAC
+/**
+ * @brief     RFC 4493 examples 1 to 4 in one call, example 3 again in pieces that
+ *            leave a partial block, and a tampered tag.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_cmac(uaes_engine_id_t id)
+{
+  uaes_ctx_t ctx;
+  uaes_cmac_t cmac;
+  uint8_t tag[16];
+  int err = 0;
+
+  err |= bench_init(&ctx, sp_key[uAES128], uAES128, id);
+  for(int vec = 0; vec < 4; vec++)
+  {
+    err |= uaes_ctx_cmac(&ctx, sp_pt, cmac_len[vec], tag, 16);
+    err |= memcmp(tag, cmac_tag[vec], 16);
+  }
+  err |= uaes_cmac_init(&cmac, &ctx);
+  err |= uaes_cmac_update(&cmac, sp_pt, 7);
+  err |= uaes_cmac_update(&cmac, &sp_pt[7], 0);
+  err |= uaes_cmac_update(&cmac, &sp_pt[7], 33);
+  err |= uaes_cmac_verify(&cmac, cmac_tag[2], 16);
+
+  memcpy(tag, cmac_tag[2], 16);
+  tag[0] ^= 0x80;
+  err |= uaes_cmac_init(&cmac, &ctx);
+  err |= uaes_cmac_update(&cmac, sp_pt, 40);
+  err |= ( -1 == uaes_cmac_verify(&cmac, tag, 16) ) ? (0) : (-1);
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+#endif /*uAES_CFG_CMAC*/
+
+#if uAES_CFG_CCM
+/**
+ * @brief     SP 800-38C C.1 both ways, then a tampered tag and a tampered
+ *            ciphertext, both refused with the buffer zeroed.
+ * @param id  Engine.
+ * @return int [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_check_ccm(uaes_engine_id_t id)
+{
+  uaes_ctx_t ctx;
+  uint8_t key[16], nonce[7], aad[8], buf[4], tag[4];
+  int err = 0;
+
+  for(int idx = 0; idx < 16; idx++)
+  {
+    key[idx] = (uint8_t)(0x40 + idx);
+  }
+  for(int idx = 0; idx < 7; idx++)
+  {
+    nonce[idx] = (uint8_t)(0x10 + idx);
+  }
+  for(int idx = 0; idx < 8; idx++)
+  {
+    aad[idx] = (uint8_t)idx;
+  }
+  for(int idx = 0; idx < 4; idx++)
+  {
+    buf[idx] = (uint8_t)(0x20 + idx);
+  }
+  err |= bench_init(&ctx, key, uAES128, id);
+  err |= uaes_ctx_ccm_encryption(&ctx, nonce, 7, aad, 8, buf, 4, tag, 4);
+  err |= memcmp(buf, ccm_ct, 4);
+  err |= memcmp(tag, ccm_tag, 4);
+  err |= uaes_ctx_ccm_decryption(&ctx, nonce, 7, aad, 8, buf, 4, tag, 4);
+  for(int idx = 0; idx < 4; idx++)
+  {
+    err |= ( (0x20 + idx) == buf[idx] ) ? (0) : (-1);
+  }
+
+  for(int bad = 0; bad < 2; bad++)
+  {
+    memcpy(buf, ccm_ct, 4);
+    memcpy(tag, ccm_tag, 4);
+    buf[0] ^= ( 0 == bad ) ? (0x00) : (0x01);
+    tag[3] ^= ( 0 == bad ) ? (0x01) : (0x00);
+    err |= ( -1 == uaes_ctx_ccm_decryption(&ctx, nonce, 7, aad, 8, buf, 4, tag, 4) ) ? (0) : (-1);
+    for(int idx = 0; idx < 4; idx++)
+    {
+      err |= ( 0x00 == buf[idx] ) ? (0) : (-1);
+    }
+  }
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+#endif /*uAES_CFG_CCM*/
+
+#if uAES_CFG_THREADS
+/**
+ * @brief         Runs a buffer through one of the modes the worker pool takes, in
+ *                pieces of piece bytes carrying the IV, counter or sector number
+ *                from one to the next. With a piece below uAES_CFG_MT_MIN_SIZE no
+ *                call reaches the pool.
+ * @return int    [0] if every call succeeded, [-1] otherwise.
+ */
+static int bench_pool_op(const uaes_ctx_t *ctx, const uaes_ctx_t *tweak_ctx, bench_mode_t mode,
+                         uint8_t *buf, size_t size, size_t piece)
+{
+  /* The counter starts below a carry out of its low three bytes. */
+  uint8_t iv[16] = { [13] = 0xff, [14] = 0xff, [15] = 0x00 }, next[16];
+  size_t len = 0;
+  int err = 0;
+
+  for(size_t pos = 0; pos < size; pos += len)
+  {
+    len = ( piece < (size - pos) ) ? (piece) : (size - pos);
+    switch(mode)
+    {
+      case BENCH_ECB_ENC:
+        err |= uaes_ctx_ecb_encryption(ctx, &buf[pos], len);
+        break;
+      case BENCH_ECB_DEC:
+        err |= uaes_ctx_ecb_decryption(ctx, &buf[pos], len);
+        break;
+      case BENCH_CBC_DEC:
+        memcpy(next, &buf[pos + len - 16UL], 16);
+        err |= uaes_ctx_cbc_decryption(ctx, &buf[pos], len, iv);
+        memcpy(iv, next, 16);
+        break;
+#if uAES_CFG_CTR
+      case BENCH_CTR:
+        err |= uaes_ctx_ctr_encryption(ctx, &buf[pos], len, iv, 8);
+        break;
+#endif /*uAES_CFG_CTR*/
+#if uAES_CFG_XTS
+      case BENCH_XTS_ENC:
+        err |= uaes_ctx_xts_encryption_sectors(ctx, tweak_ctx, &buf[pos], len, 512UL, (uint64_t)(pos / 512UL));
+        break;
+#endif /*uAES_CFG_XTS*/
+      default:
+        err = -1;
+        break;
+    }
+  }
+  (void)tweak_ctx;
+  return ( 0 == err ) ? (0) : (-1);
+}
+
+/**
+ * @brief     Compares the worker pool with serial calls on sizes around
+ *            uAES_CFG_MT_MIN_SIZE and around the CBC rounds, where the pool
+ *            splits a buffer or leaves its tail to the calling thread. The pool
+ *            is started for the check unless -j already did.
+ * @param id  Engine.
+ * @return int [0] if every output matches, [-1] otherwise.
+ */
+static int bench_check_pool(uaes_engine_id_t id)
+{
+  static const bench_mode_t modes[5] = { BENCH_ECB_ENC, BENCH_ECB_DEC, BENCH_CBC_DEC, BENCH_CTR, BENCH_XTS_ENC };
+  static const size_t sizes[8] =
+  {
+    uAES_CFG_MT_MIN_SIZE - 16UL, uAES_CFG_MT_MIN_SIZE, uAES_CFG_MT_MIN_SIZE + 16UL,
+    BENCH_POOL_ROUND - 16UL, BENCH_POOL_ROUND, BENCH_POOL_ROUND + 16UL,
+    BENCH_POOL_ROUND + uAES_CFG_MT_MIN_SIZE - 16UL, (2UL * BENCH_POOL_ROUND) + uAES_CFG_MT_MIN_SIZE
+  };
+  const size_t max = sizes[7] + 7UL;
+  uint8_t *ref = malloc(max), *out = malloc(max);
+  const int started = ( 0 == uaes_pool_start(3) ) ? (1) : (0);
+  uaes_ctx_t ctx, tweak;
+  uint8_t key[32], tweak_key[32];
+  int err = ( (NULL != ref) && (NULL != out) ) ? (0) : (-1);
+
+  for(int idx = 0; idx < 32; idx++)
+  {
+    key[idx]       = (uint8_t)(0x17 ^ idx);
+    tweak_key[idx] = (uint8_t)(0x71 ^ idx);
+  }
+  err |= bench_init(&ctx, key, uAES128, id);
+  err |= bench_init(&tweak, tweak_key, uAES128, id);
+  for(int mode = 0; (0 == err) && (mode < 5); mode++)
+  {
+    for(int sz = 0; (sz < 8) && bench_mode_built(modes[mode]); sz++)
+    {
+      /* CTR also ends in a partial block, XTS takes whole 512-byte sectors. */
+      const size_t size = sizes[sz] + ( (BENCH_CTR == modes[mode]) ? (7UL) : (0UL) );
+
+      if( (BENCH_XTS_ENC == modes[mode]) && (0 != (size % 512UL)) )
+      {
+        continue;
+      }
+      for(size_t pos = 0; pos < size; pos++)
+      {
+        ref[pos] = out[pos] = (uint8_t)((pos * 29U) ^ (pos >> 9));
+      }
+      err |= bench_pool_op(&ctx, &tweak, modes[mode], ref, size, BENCH_POOL_PIECE);
+      err |= bench_pool_op(&ctx, &tweak, modes[mode], out, size, size);
+      err |= memcmp(out, ref, size);
+    }
+  }
+  if( started )
+  {
+    uaes_pool_stop();
+  }
+  uaes_ctx_clear(&ctx);
+  uaes_ctx_clear(&tweak);
+  free(ref);
+  free(out);
+  return ( 0 == err ) ? (0) : (-1);
+}
+#endif /*uAES_CFG_THREADS*/
+
+typedef struct
+{
+  const char  *name;
+  int         (*run)(uaes_engine_id_t id);
+}bench_check_t;
+
+/* Known answer tests, one per mode, in the order they are run. */
+static const bench_check_t bench_checks[] =
+{
+  { "ecb",    bench_check_ecb },
+  { "cbc",    bench_check_cbc },
+  { "oop",    bench_check_oop },
+#if uAES_CFG_CTR
+  { "ctr",    bench_check_ctr },
+#endif /*uAES_CFG_CTR*/
+#if uAES_CFG_CTS
+  { "cts",    bench_check_cts },
+#endif /*uAES_CFG_CTS*/
+#if uAES_CFG_PCBC
+  { "pcbc",   bench_check_pcbc },
+#endif /*uAES_CFG_PCBC*/
+#if uAES_CFG_CFB
+  { "cfb",    bench_check_cfb },
+#endif /*uAES_CFG_CFB*/
+#if uAES_CFG_KSBUF
+  { "ksbuf",  bench_check_ksbuf },
+#endif /*uAES_CFG_KSBUF*/
+#if uAES_CFG_STREAM
+  { "stream", bench_check_stream },
+  { "pkcs7",  bench_check_pkcs7 },
+#endif /*uAES_CFG_STREAM*/
+#if uAES_CFG_IOV
+  { "iov",    bench_check_iov },
+#endif /*uAES_CFG_IOV*/
+#if uAES_CFG_MULTI
+  { "multi",  bench_check_multi },
+#endif /*uAES_CFG_MULTI*/
+#if uAES_CFG_JOB
+  { "job",    bench_check_job },
+#endif /*uAES_CFG_JOB*/
+#if uAES_CFG_XTS
+  { "xts",    bench_check_xts },
+#endif /*uAES_CFG_XTS*/
+#if uAES_CFG_GCM
+  { "gcm",    bench_check_gcm },
+#endif /*uAES_CFG_GCM*/
+#if uAES_CFG_CMAC
+  { "cmac",   bench_check_cmac },
+#endif /*uAES_CFG_CMAC*/
+#if uAES_CFG_CCM
+  { "ccm",    bench_check_ccm },
+#endif /*uAES_CFG_CCM*/
+#if uAES_CFG_THREADS
+  { "pool",   bench_check_pool },
+#endif /*uAES_CFG_THREADS*/
+};
+
+/**
+ * @brief         Runs the known answer tests on an engine, a check,<name>,<mode>,fail
+ *                record is printed for each mode that fails.
+ * @param id      Engine.
+ * @param name    Engine name.
+ * @return int    [0] if every vector matches, [-1] otherwise.
+ */
+static int bench_validate(uaes_engine_id_t id, const char *name)
+{
+  int err = 0;
+
+  for(size_t idx = 0; idx < (sizeof(bench_checks) / sizeof(bench_checks[0])); idx++)
+  {
+    if( 0 != bench_checks[idx].run(id) )
+    {
+      printf("check,%s,%s,fail\n", name, bench_checks[idx].name);
+      err = -1;
+    }
+  }
+  return err;
+}
+
+static int bench_run(const uaes_ctx_t *ctx, const uaes_ctx_t *tweak_ctx, bench_mode_t mode, uint8_t *buf, size_t size)
+{
+  uint8_t iv[16] = {0};
+  int err = -1;
+
+  switch(mode)
+  {
+    case BENCH_ECB_ENC:
+      err = uaes_ctx_ecb_encryption(ctx, buf, size);
+      break;
+    case BENCH_ECB_DEC:
+      err = uaes_ctx_ecb_decryption(ctx, buf, size);
+      break;
+    case BENCH_CBC_ENC:
+      err = uaes_ctx_cbc_encryption(ctx, buf, size, iv);
+      break;
+    case BENCH_CBC_DEC:
+      err = uaes_ctx_cbc_decryption(ctx, buf, size, iv);
+      break;
+#if uAES_CFG_CTR
+    case BENCH_CTR:
+      err = uaes_ctx_ctr_encryption(ctx, buf, size, iv, 8);
+      break;
+#endif /*uAES_CFG_CTR*/
+#if uAES_CFG_GCM
+    case BENCH_GCM_ENC:
+      {
+        uint8_t tag[16];
+        err = uaes_ctx_gcm_encryption(ctx, iv, 12, NULL, 0, buf, size, tag, 16);
+      }
+      break;
+#endif /*uAES_CFG_GCM*/
+#if uAES_CFG_XTS
+    case BENCH_XTS_ENC:
+      /* 512-byte sectors. */
+      err = uaes_ctx_xts_encryption_sectors(ctx, tweak_ctx, buf, size, (size < 512UL) ? (size) : (512UL), 0);
+      break;
+#endif /*uAES_CFG_XTS*/
+#if uAES_CFG_CCM
+    case BENCH_CCM_ENC:
+      {
+        uint8_t tag[16];
+        /* 11-byte nonce, its 4-byte length field covers every size. */
+        err = uaes_ctx_ccm_encryption(ctx, iv, 11, NULL, 0, buf, size, tag, 16);
+      }
+      break;
+#endif /*uAES_CFG_CCM*/
+#if uAES_CFG_CFB
+    case BENCH_CFB_DEC:
+      err = uaes_ctx_cfb_decryption(ctx, buf, size, iv);
+      break;
+#endif /*uAES_CFG_CFB*/
+    default:
+      break;
+  }
+  return err;
+}
+
+/**
+ * @brief     Checks every mode of an engine against the portable engine on buffers
+ *            long enough for the interleaved and batched paths, a block multiple
+ *            and, for the modes that take any size, one with a partial last block.
+ * @param id  Engine.
+ * @return int [0] if every output matches, [-1] otherwise.
+ */
+static int bench_cross(uaes_engine_id_t id)
+{
+  static uint8_t ref[BENCH_CROSS_SIZE], out[BENCH_CROSS_SIZE];
+  const size_t sizes[2] = { BENCH_CROSS_SIZE & ~15UL, BENCH_CROSS_SIZE };
+  uaes_ctx_t ctx, tweak, pctx, ptweak;
+  uint8_t key[32], tweak_key[32];
+  int err = 0;
+
+  for(int idx = 0; idx < 32; idx++)
+  {
+    key[idx]       = (uint8_t)(0x69 ^ idx);
+    tweak_key[idx] = (uint8_t)(0x96 ^ idx);
+  }
+  for(int len = uAES128; len < uAESRGE; len++)
+  {
+    if( (128 + (64 * len)) > uAES_CFG_MAX_KEY_BITS )
+    {
+      continue;
+    }
+    err |= bench_init(&ctx, key, (aes_length_t)len, id);
+    err |= bench_init(&tweak, tweak_key, (aes_length_t)len, id);
+    err |= bench_init(&pctx, key, (aes_length_t)len, uAES_ENGINE_PORTABLE);
+    err |= bench_init(&ptweak, tweak_key, (aes_length_t)len, uAES_ENGINE_PORTABLE);
+    for(int mode = 0; mode < BENCH_MODES; mode++)
+    {
+      /* ECB and CBC take whole blocks only. */
+      const int nsizes = ( BENCH_CTR > mode ) ? (1) : (2);
+
+      for(int sz = 0; (sz < nsizes) && bench_mode_built((bench_mode_t)mode); sz++)
+      {
+        for(size_t pos = 0; pos < sizes[sz]; pos++)
+        {
+          ref[pos] = out[pos] = (uint8_t)((pos * 13U) + (unsigned)len);
+        }
+        err |= bench_run(&pctx, &ptweak, (bench_mode_t)mode, ref, sizes[sz]);
+        err |= bench_run(&ctx, &tweak, (bench_mode_t)mode, out, sizes[sz]);
+        err |= memcmp(out, ref, sizes[sz]);
+      }
+    }
+  }
+  uaes_ctx_clear(&ctx);
+  uaes_ctx_clear(&tweak);
+  uaes_ctx_clear(&pctx);
+  uaes_ctx_clear(&ptweak);
+  return ( 0 == err ) ? (0) : (-1);
+}
+
+static void bench_cycles_field(char *str, size_t len, uint64_t cycles, double units)
+{
+  if( BENCH_HAS_CYCLES )
+  {
+    snprintf(str, len, "%.2f", (double)cycles / units);
+  }
+  else
+  {
+    snprintf(str, len, "na");
+  }
+  return;
+}
+
+/**
+ * @brief         Times one mode and size, repeated until min_ns has elapsed.
+ * @return int    [0] if sucessful, [-1] if the call failed.
+ */
+static int bench_bulk(const uaes_ctx_t *ctx, const uaes_ctx_t *tweak_ctx, bench_mode_t mode, int len, uint8_t *buf, size_t size, uint64_t min_ns)
+{
+  char cpb[32];
+  uint64_t runs = 0, t0 = 0, t1 = 0, c0 = 0, c1 = 0;
+  double secs = 0.0;
+
+  if( 0 != bench_run(ctx, tweak_ctx, mode, buf, size) )
+  {
+    return -1;
+  }
+  t0 = bench_ns();
+  c0 = BENCH_CYCLES();
+  do
+  {
+    bench_run(ctx, tweak_ctx, mode, buf, size);
+    runs++;
+    t1 = bench_ns();
+  }while( (t1 - t0) < min_ns );
+  c1 = BENCH_CYCLES();
+
+  secs = (double)(t1 - t0) / 1e9;
+  bench_cycles_field(cpb, sizeof(cpb), c1 - c0, (double)runs * (double)size);
+  printf("bulk,%s,%s,%d,%zu,%.2f,%s\n", uaes_ctx_engine_name(ctx), mode_name[mode], 128 + (64 * len), size,
+         ((double)runs * (double)size) / (secs * 1e6), cpb);
+  fflush(stdout);
+  return 0;
+}
+
+typedef struct
+{
+  const uaes_ctx_t  *shared;                       // Context every thread reads.
+  const uaes_ctx_t  *tweak;                        // XTS tweak key context, shared too.
+  const uint8_t     *key;                          // Key of shared, for the thread's own context.
+  uaes_engine_id_t  id;                            // Engine of shared.
+  const uint8_t     (*ref)[BENCH_SHARED_SIZE];     // Expected output of each mode.
+  uint8_t           buf[BENCH_SHARED_SIZE];
+  int               err;
+}bench_shared_t;
+
+static void bench_shared_input(uint8_t *buf)
+{
+  for(size_t pos = 0; pos < BENCH_SHARED_SIZE; pos++)
+  {
+    buf[pos] = (uint8_t)(pos * 7U);
+  }
+  return;
+}
+
+/**
+ * @brief     Runs every mode, alternating between the shared context and one owned
+ *            by the thread, and checks each output.
+ * @param arg Pointer to bench_shared_t.
+ * @return    NULL.
+ */
+static void *bench_shared_worker(void *arg)
+{
+  bench_shared_t *w = (bench_shared_t *)arg;
+  uaes_ctx_t own;
+
+  w->err |= bench_init(&own, w->key, uAES128, w->id);
+  for(int run = 0; run < BENCH_SHARED_RUNS; run++)
+  {
+    for(int mode = 0; mode < BENCH_MODES; mode++)
+    {
+      if( bench_mode_built((bench_mode_t)mode) )
+      {
+        bench_shared_input(w->buf);
+        w->err |= bench_run( (0 == (run & 1)) ? (w->shared) : (&own), w->tweak, (bench_mode_t)mode, w->buf, BENCH_SHARED_SIZE);
+        w->err |= memcmp(w->buf, w->ref[mode], BENCH_SHARED_SIZE);
+      }
+    }
+  }
+  uaes_ctx_clear(&own);
+  return NULL;
+}
+
+/**
+ * @brief     Calls every mode from several threads at once with no lock, on one
+ *            shared context and on a context per thread. Once initialised a
+ *            context is only read, so the outputs must match a serial run on the
+ *            portable engine.
+ * @param id  Engine.
+ * @return int [0] if every output matches, [-1] otherwise.
+ */
+static int bench_shared(uaes_engine_id_t id)
+{
+  static uint8_t ref[BENCH_MODES][BENCH_SHARED_SIZE];
+  static bench_shared_t w[BENCH_SHARED_THREADS];
+  pthread_t thread[BENCH_SHARED_THREADS];
+  uint8_t key[16], tweak_key[16];
+  uaes_ctx_t ctx, tweak;
+  int err = 0, started = 0;
+
+  for(int idx = 0; idx < 16; idx++)
+  {
+    key[idx]       = (uint8_t)(0x3c ^ idx);
+    tweak_key[idx] = (uint8_t)(0xc3 ^ idx);
+  }
+  /* The expected outputs come from the portable engine, not the one under test. */
+  err |= bench_init(&ctx, key, uAES128, uAES_ENGINE_PORTABLE);
+  err |= bench_init(&tweak, tweak_key, uAES128, uAES_ENGINE_PORTABLE);
+  for(int mode = 0; mode < BENCH_MODES; mode++)
+  {
+    if( bench_mode_built((bench_mode_t)mode) )
+    {
+      bench_shared_input(ref[mode]);
+      err |= bench_run(&ctx, &tweak, (bench_mode_t)mode, ref[mode], BENCH_SHARED_SIZE);
+    }
+  }
+  err |= bench_init(&ctx, key, uAES128, id);
+  err |= bench_init(&tweak, tweak_key, uAES128, id);
+  for(; (0 == err) && (started < BENCH_SHARED_THREADS); started++)
+  {
+    w[started].shared = &ctx;
+    w[started].tweak  = &tweak;
+    w[started].key    = key;
+    w[started].id     = id;
+    w[started].ref    = (const uint8_t (*)[BENCH_SHARED_SIZE])ref;
+    w[started].err    = 0;
+    if( 0 != pthread_create(&thread[started], NULL, bench_shared_worker, &w[started]) )
+    {
+      err = -1;
+      break;
+    }
+  }
+  for(int idx = 0; idx < started; idx++)
+  {
+    pthread_join(thread[idx], NULL);
+    err |= w[idx].err;
+  }
+  uaes_ctx_clear(&tweak);
+  uaes_ctx_clear(&ctx);
+  return ( 0 == err ) ? (0) : (-1);
+}
+
+static void bench_keysetup(void)
+{
+  uaes_ctx_t ctx;
+  uint8_t key[32] = {0};
+  char cyc[32];
+  uint64_t t0 = 0, t1 = 0, c0 = 0, c1 = 0;
+
+  for(int len = uAES128; len < uAESRGE; len++)
+  {
+    if( (128 + (64 * len)) > uAES_CFG_MAX_KEY_BITS )
+    {
+      continue;
+    }
+    t0 = bench_ns();
+    c0 = BENCH_CYCLES();
+    for(size_t run = 0; run < BENCH_KEYSETUP_RUNS; run++)
+    {
+      key[0] = (uint8_t)run;
+      uaes_ctx_init(&ctx, key, (aes_length_t)len, uAES_CTX_BOTH);
+    }
+    c1 = BENCH_CYCLES();
+    t1 = bench_ns();
+    bench_cycles_field(cyc, sizeof(cyc), c1 - c0, (double)BENCH_KEYSETUP_RUNS);
+    printf("keysetup,%s,%d,%.1f,%s\n", uaes_ctx_engine_name(&ctx), 128 + (64 * len),
+           (double)(t1 - t0) / (double)BENCH_KEYSETUP_RUNS, cyc);
+  }
+  uaes_ctx_clear(&ctx);
+  return;
+}
+
+#if uAES_CFG_KEYCACHE
+static void bench_keycache(void)
+{
+  static uaes_keycache_set_t sets[4];
+  uaes_keycache_t kc;
+  uaes_ctx_t ctx;
+  uint8_t key[32] = {0};
+  char cyc[32];
+  uint64_t t0 = 0, t1 = 0, c0 = 0, c1 = 0;
+
+  uaes_keycache_init(&kc, sets, 4UL);
+  for(int len = uAES128; len < uAESRGE; len++)
+  {
+    if( (128 + (64 * len)) > uAES_CFG_MAX_KEY_BITS )
+    {
+      continue;
+    }
+    /* Cycle through half as many keys as the cache holds, so that nearly every call hits. */
+    t0 = bench_ns();
+    c0 = BENCH_CYCLES();
+    for(size_t run = 0; run < BENCH_KEYSETUP_RUNS; run++)
+    {
+      key[0] = (uint8_t)(run % (2UL * uAES_KEYCACHE_WAYS));
+      uaes_keycache_get(&kc, ((uint64_t)len << 8) | key[0], key, (aes_length_t)len, uAES_CTX_BOTH, &ctx);
+    }
+    c1 = BENCH_CYCLES();
+    t1 = bench_ns();
+    bench_cycles_field(cyc, sizeof(cyc), c1 - c0, (double)BENCH_KEYSETUP_RUNS);
+    printf("keycache,%d,%.1f,%s\n", 128 + (64 * len), (double)(t1 - t0) / (double)BENCH_KEYSETUP_RUNS, cyc);
+  }
+  uaes_keycache_clear(&kc);
+  uaes_ctx_clear(&ctx);
+  return;
+}
+#endif /*uAES_CFG_KEYCACHE*/
+
+static void bench_usage(const char *name)
+{
+  fprintf(stderr, "usage: %s [-t ms] [-s max_bytes] [-e engine] [-j threads]\n", name);
+  fprintf(stderr, "  -t  minimum time per measurement, default %lu ms\n", BENCH_DEFAULT_MS);
+  fprintf(stderr, "  -s  largest message, 16 to %lu bytes (default)\n", BENCH_MAX_SIZE);
+  fprintf(stderr, "  -e  only this engine, 1 to %d\n", uAES_ENGINE_OFFLOAD - 1);
+  fprintf(stderr, "  -j  start the worker pool with this many threads\n");
+  return;
+}
+
+int main(int argc, char **argv)
+{
+  uint64_t min_ns = BENCH_DEFAULT_MS * 1000000ULL;
+  size_t max_size = BENCH_MAX_SIZE;
+  long only = 0;
+  uaes_ctx_t ctx, tweak;
+  uint8_t key[32], tweak_key[32];
+  uint8_t *buf = NULL;
+  int err = 0;
+
+  for(int arg = 1; arg < argc; arg++)
+  {
+    if( (arg + 1) >= argc )
+    {
+      bench_usage(argv[0]);
+      return 1;
+    }
+    if( 0 == strcmp(argv[arg], "-t") )
+    {
+      min_ns = strtoull(argv[++arg], NULL, 0) * 1000000ULL;
+    }
+    else if( 0 == strcmp(argv[arg], "-s") )
+    {
+      max_size = strtoull(argv[++arg], NULL, 0);
+    }
+    else if( 0 == strcmp(argv[arg], "-e") )
+    {
+      only = strtol(argv[++arg], NULL, 0);
+    }
+    else if( 0 == strcmp(argv[arg], "-j") )
+    {
+      if( 0 != uaes_pool_start(strtoull(argv[++arg], NULL, 0)) )
+      {
+        fprintf(stderr, "worker pool not available\n");
+        return 1;
+      }
+    }
+    else
+    {
+      bench_usage(argv[0]);
+      return 1;
+    }
+  }
+  if( (BENCH_MIN_SIZE > max_size) || (BENCH_MAX_SIZE < max_size) )
+  {
+    bench_usage(argv[0]);
+    return 1;
+  }
+
+  buf = malloc(max_size);
+  if( NULL == buf )
+  {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  for(size_t pos = 0; pos < max_size; pos++)
+  {
+    buf[pos] = (uint8_t)(pos * 31U);
+  }
+  for(int idx = 0; idx < 32; idx++)
+  {
+    key[idx]       = (uint8_t)(0xa5 ^ idx);
+    tweak_key[idx] = (uint8_t)(0x5a ^ idx);
+  }
+
+  printf("# uaes_bench, min %llu ms per measurement, cycles %s\n",
+         (unsigned long long)(min_ns / 1000000ULL), BENCH_HAS_CYCLES ? "from the time stamp counter" : "not available");
+  bench_keysetup();
+#if uAES_CFG_KEYCACHE
+  bench_keycache();
+#endif /*uAES_CFG_KEYCACHE*/
+
+  for(int id = uAES_ENGINE_PORTABLE; id < uAES_ENGINE_OFFLOAD; id++)
+  {
+    if( ((0 != only) && (only != id)) || !uaes_engine_available((uaes_engine_id_t)id) )
+    {
+      continue;
+    }
+    bench_init(&ctx, key, uAES128, (uaes_engine_id_t)id);
+    if( (0 != bench_validate((uaes_engine_id_t)id, uaes_ctx_engine_name(&ctx))) || (0 != bench_cross((uaes_engine_id_t)id)) )
+    {
+      printf("engine,%s,fail\n", uaes_ctx_engine_name(&ctx));
+      err = 1;
+      continue;
+    }
+    printf("engine,%s,pass\n", uaes_ctx_engine_name(&ctx));
+    if( 0 != bench_shared((uaes_engine_id_t)id) )
+    {
+      printf("shared,%s,%d,fail\n", uaes_ctx_engine_name(&ctx), BENCH_SHARED_THREADS);
+      err = 1;
+      continue;
+    }
+    printf("shared,%s,%d,pass\n", uaes_ctx_engine_name(&ctx), BENCH_SHARED_THREADS);
+
+    for(int mode = 0; mode < BENCH_MODES; mode++)
+    {
+      if( !bench_mode_built((bench_mode_t)mode) )
+      {
+        continue;
+      }
+      for(int len = uAES128; len < uAESRGE; len++)
+      {
+        if( ((128 + (64 * len)) > uAES_CFG_MAX_KEY_BITS)                               ||
+            (0 != bench_init(&ctx, key, (aes_length_t)len, (uaes_engine_id_t)id))         ||
+            (0 != bench_init(&tweak, tweak_key, (aes_length_t)len, (uaes_engine_id_t)id)) )
+        {
+          continue;
+        }
+        for(size_t size = BENCH_MIN_SIZE; size <= max_size; size *= 4UL)
+        {
+          if( 0 != bench_bulk(&ctx, &tweak, (bench_mode_t)mode, len, buf, size, min_ns) )
+          {
+            fprintf(stderr, "%s failed at %zu bytes\n", mode_name[mode], size);
+            err = 1;
+          }
+        }
+      }
+    }
+  }
+
+  uaes_ctx_clear(&ctx);
+  uaes_ctx_clear(&tweak);
+  uaes_pool_stop();
+  free(buf);
+  return err;
+}
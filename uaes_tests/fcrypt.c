@@ -0,0 +1,431 @@
+/**
+ * @file    fcrypt.c
+ * @author  Antonio Vitor Grossi Bassi
+ * @brief   File and pipe encryption tool over the uAES streaming API.
+ * @version 0.1
+ * @date    2026-10-14
+ *
+ *  Copyright (C) 2023, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  A reader thread fills a ring of buffers, the main thread encrypts them
+ *  and a writer thread drains them, so disk reads, the cipher and disk
+ *  writes overlap. Input of any size is streamed, memory use is the ring
+ *  only. CBC output is padded with PKCS#7 by the stream, CTR output has the
+ *  input size. Without -i, encryption draws a random IV and writes it in front of
+ *  the output, and decryption takes it from the front of the input.
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "stdint.h"
+#include "string.h"
+#include "time.h"
+#include "pthread.h"
+#include "../uaes.h"
+
+#if !uAES_CFG_STREAM
+#error "fcrypt needs uAES_CFG_STREAM"
+#endif /*uAES_CFG_STREAM*/
+
+#define FC_NBUFS              (3UL)
+#define FC_DEFAULT_BUF_SIZE   (4UL*MB)
+#define FC_MAX_BUF_SIZE       (uAES_MAX_INPUT_SIZE)
+#define FC_CTR_WIDTH          (8UL)
+
+typedef enum
+{
+  FC_FREE = 0,    // Owned by the reader.
+  FC_FILLED,      // Owned by the cipher.
+  FC_DONE         // Owned by the writer.
+}fc_state_t;
+
+typedef struct
+{
+  uint8_t     *data;
+  uint8_t     *out;                 // Cipher output, data itself except for CBC decryption.
+  size_t      len;
+  int         last;                 // Holds the end of the input.
+  fc_state_t  state;
+}fc_buf_t;
+
+typedef struct
+{
+  pthread_mutex_t lock;
+  pthread_cond_t  cond;
+  fc_buf_t        buf[FC_NBUFS];
+  size_t          buf_size;         // Data bytes per buffer, a multiple of 16.
+  FILE            *in;
+  FILE            *out;
+  int             err;
+}fc_ring_t;
+
+static uint64_t fc_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief         Waits until a buffer reaches a state or the pipeline failed.
+ * @param ring    Pointer to ring.
+ * @param buf     Pointer to buffer.
+ * @param state   State to wait for.
+ * @return int    [0] once the buffer is in the state, [-1] on pipeline failure.
+ */
+static int fc_wait(fc_ring_t *ring, fc_buf_t *buf, fc_state_t state)
+{
+  int err = 0;
+
+  pthread_mutex_lock(&ring->lock);
+  while( (state != buf->state) && (0 == ring->err) )
+  {
+    pthread_cond_wait(&ring->cond, &ring->lock);
+  }
+  err = ring->err;
+  pthread_mutex_unlock(&ring->lock);
+  return err;
+}
+
+static void fc_post(fc_ring_t *ring, fc_buf_t *buf, fc_state_t state)
+{
+  pthread_mutex_lock(&ring->lock);
+  buf->state = state;
+  pthread_cond_broadcast(&ring->cond);
+  pthread_mutex_unlock(&ring->lock);
+  return;
+}
+
+static void fc_fail(fc_ring_t *ring)
+{
+  pthread_mutex_lock(&ring->lock);
+  ring->err = -1;
+  pthread_cond_broadcast(&ring->cond);
+  pthread_mutex_unlock(&ring->lock);
+  return;
+}
+
+/**
+ * @brief         Reader thread, fills whole buffers and looks one byte ahead so
+ *                the buffer holding the end of the input is marked as last.
+ */
+static void *fc_reader(void *arg)
+{
+  fc_ring_t *ring = (fc_ring_t *)arg;
+  fc_buf_t *buf = NULL;
+  int c = 0, last = 0;
+
+  for(size_t idx = 0; !last; idx = (idx + 1UL) % FC_NBUFS)
+  {
+    buf = &ring->buf[idx];
+    if( 0 != fc_wait(ring, buf, FC_FREE) )
+    {
+      break;
+    }
+    buf->len  = fread(buf->data, 1UL, ring->buf_size, ring->in);
+    buf->last = 1;
+    if( ferror(ring->in) )
+    {
+      fc_fail(ring);
+      break;
+    }
+    if( (ring->buf_size == buf->len) && (EOF != (c = getc(ring->in))) )
+    {
+      ungetc(c, ring->in);
+      buf->last = 0;
+    }
+    /* The buffer belongs to the next stage once posted. */
+    last = buf->last;
+    fc_post(ring, buf, FC_FILLED);
+  }
+  return NULL;
+}
+
+static void *fc_writer(void *arg)
+{
+  fc_ring_t *ring = (fc_ring_t *)arg;
+  fc_buf_t *buf = NULL;
+  int last = 0;
+
+  for(size_t idx = 0; !last; idx = (idx + 1UL) % FC_NBUFS)
+  {
+    buf = &ring->buf[idx];
+    if( 0 != fc_wait(ring, buf, FC_DONE) )
+    {
+      break;
+    }
+    if( buf->len != fwrite(buf->out, 1UL, buf->len, ring->out) )
+    {
+      fc_fail(ring);
+      break;
+    }
+    last = buf->last;
+    fc_post(ring, buf, FC_FREE);
+  }
+  if( (0 == ring->err) && (0 != fflush(ring->out)) )
+  {
+    fc_fail(ring);
+  }
+  return NULL;
+}
+
+/**
+ * @brief         Runs one buffer through the stream, PKCS#7 padding is added and
+ *                checked by the stream itself. Encryption and CTR work in place,
+ *                the stream holds the last CBC block back when decrypting so that
+ *                output goes to a buffer of its own. Both have 16 spare bytes for
+ *                the final block.
+ * @param st      Pointer to stream state.
+ * @param buf     Pointer to buffer, len becomes the output size.
+ * @return int    [0] if sucessful, [-1] on failure or bad padding.
+ */
+static int fc_cipher(uaes_stream_t *st, fc_buf_t *buf)
+{
+  size_t done = 0, tail = 0;
+
+  if( 0 != uaes_stream_update(st, buf->out, buf->data, buf->len, &done) )
+  {
+    return -1;
+  }
+  if( buf->last && (0 != uaes_stream_final(st, &buf->out[done], &tail)) )
+  {
+    return -1;
+  }
+  buf->len = done + tail;
+  return 0;
+}
+
+static int fc_hex(uint8_t *dst, size_t max, const char *str, size_t *len)
+{
+  unsigned int byte = 0;
+  size_t n = strlen(str);
+
+  if( (0 != (n % 2UL)) || ((2UL * max) < n) )
+  {
+    return -1;
+  }
+  for(size_t pos = 0; pos < n; pos += 2UL)
+  {
+    if( 1 != sscanf(&str[pos], "%2x", &byte) )
+    {
+      return -1;
+    }
+    dst[pos / 2UL] = (uint8_t)byte;
+  }
+  *len = n / 2UL;
+  return 0;
+}
+
+static void fc_usage(const char *name)
+{
+  fprintf(stderr, "usage: %s -k key [-d] [-m cbc|ctr] [-i iv] [-b MB] [-j threads] [input [output]]\n", name);
+  fprintf(stderr, "  -k  key in hex, 16, 24 or 32 bytes\n");
+  fprintf(stderr, "  -d  decrypt, default is encrypt\n");
+  fprintf(stderr, "  -m  mode, cbc (PKCS#7 padded, default) or ctr\n");
+  fprintf(stderr, "  -i  16-byte IV or counter block in hex, by default a random one is\n");
+  fprintf(stderr, "      written in front of the output and read back from the input\n");
+  fprintf(stderr, "  -b  buffer size, %lu buffers, default %lu MB\n", FC_NBUFS, FC_DEFAULT_BUF_SIZE / MB);
+  fprintf(stderr, "  -j  start the worker pool with this many threads, serial if unavailable\n");
+  fprintf(stderr, "  input and output default to stdin and stdout, \"-\" selects them too\n");
+  return;
+}
+
+int main(int argc, char **argv)
+{
+  fc_ring_t ring;
+  uaes_ctx_t ctx;
+  uaes_stream_t st;
+  pthread_t reader, writer;
+  uaes_stream_mode_t mode = uAES_STREAM_CBC_ENCRYPT;
+  const char *in_name = "-", *out_name = "-";
+  uint8_t key[32], iv[16];
+  size_t key_len = 0, iv_len = 0, done = 0;
+  uint64_t t0 = 0, t1 = 0, cipher_ns = 0, total = 0;
+  int decrypt = 0, ctr = 0, files = 0, last = 0, err = 0;
+  FILE *rnd = NULL;
+  fc_buf_t *buf = NULL;
+
+  memset(&ring, 0x00, sizeof(ring));
+  ring.buf_size = FC_DEFAULT_BUF_SIZE;
+  for(int arg = 1; arg < argc; arg++)
+  {
+    if( 0 == strcmp(argv[arg], "-d") )
+    {
+      decrypt = 1;
+    }
+    else if( (0 == strcmp(argv[arg], "-k")) && ((arg + 1) < argc) )
+    {
+      err |= fc_hex(key, sizeof(key), argv[++arg], &key_len);
+    }
+    else if( (0 == strcmp(argv[arg], "-i")) && ((arg + 1) < argc) )
+    {
+      err |= fc_hex(iv, sizeof(iv), argv[++arg], &iv_len);
+      err |= ( sizeof(iv) == iv_len ) ? (0) : (-1);
+    }
+    else if( (0 == strcmp(argv[arg], "-m")) && ((arg + 1) < argc) )
+    {
+      arg++;
+      ctr = ( 0 == strcmp(argv[arg], "ctr") ) ? (1) : (0);
+      err |= ( ctr || (0 == strcmp(argv[arg], "cbc")) ) ? (0) : (-1);
+    }
+    else if( (0 == strcmp(argv[arg], "-b")) && ((arg + 1) < argc) )
+    {
+      ring.buf_size = strtoull(argv[++arg], NULL, 0) * MB;
+      err |= ( (0 < ring.buf_size) && (FC_MAX_BUF_SIZE >= ring.buf_size) ) ? (0) : (-1);
+    }
+    else if( (0 == strcmp(argv[arg], "-j")) && ((arg + 1) < argc) )
+    {
+      if( 0 != uaes_pool_start(strtoull(argv[++arg], NULL, 0)) )
+      {
+        /* Built without uAES_CFG_THREADS, the output is the same, only serial. */
+        fprintf(stderr, "worker pool not available, running serial\n");
+      }
+    }
+    else if( ('-' != argv[arg][0]) || (0 == strcmp(argv[arg], "-")) )
+    {
+      in_name  = ( 0 == files ) ? (argv[arg]) : (in_name);
+      out_name = ( 1 == files ) ? (argv[arg]) : (out_name);
+      err |= ( 2 > files++ ) ? (0) : (-1);
+    }
+    else
+    {
+      err = -1;
+    }
+  }
+  if( (0 != err) || ((16UL != key_len) && (24UL != key_len) && (32UL != key_len)) || (ctr && !uAES_CFG_CTR) )
+  {
+    fc_usage(argv[0]);
+    return 1;
+  }
+  mode = ( ctr ) ? (uAES_STREAM_CTR) : ( ( decrypt ) ? (uAES_STREAM_CBC_DECRYPT_PKCS7) : (uAES_STREAM_CBC_ENCRYPT_PKCS7) );
+
+  ring.in  = ( 0 == strcmp(in_name, "-") ) ? (stdin) : (fopen(in_name, "rb"));
+  ring.out = ( 0 == strcmp(out_name, "-") ) ? (stdout) : (fopen(out_name, "wb"));
+  if( (NULL == ring.in) || (NULL == ring.out) )
+  {
+    fprintf(stderr, "cannot open %s\n", ( NULL == ring.in ) ? (in_name) : (out_name));
+    return 1;
+  }
+
+  /* The IV travels in front of the data unless it was given. */
+  if( 0 == iv_len )
+  {
+    if( decrypt )
+    {
+      iv_len = fread(iv, 1UL, sizeof(iv), ring.in);
+    }
+    else if( NULL != (rnd = fopen("/dev/urandom", "rb")) )
+    {
+      iv_len = fread(iv, 1UL, sizeof(iv), rnd);
+      fclose(rnd);
+      iv_len = ( (sizeof(iv) == iv_len) && (sizeof(iv) == fwrite(iv, 1UL, sizeof(iv), ring.out)) ) ? (iv_len) : (0UL);
+    }
+    if( sizeof(iv) != iv_len )
+    {
+      fprintf(stderr, "no IV\n");
+      return 1;
+    }
+  }
+
+  if( (0 != uaes_ctx_init(&ctx, key, (aes_length_t)((key_len - 16UL) / 8UL), ( uAES_STREAM_CBC_DECRYPT_PKCS7 == mode ) ? (uAES_CTX_DECRYPT) : (uAES_CTX_ENCRYPT))) ||
+      (0 != uaes_stream_init(&st, &ctx, mode, iv, FC_CTR_WIDTH)) )
+  {
+    fprintf(stderr, "key setup failed\n");
+    return 1;
+  }
+  memset(key, 0x00, sizeof(key));
+
+  /* Spare block for the PKCS#7 final block, CBC decryption writes apart. */
+  for(size_t idx = 0; idx < FC_NBUFS; idx++)
+  {
+    ring.buf[idx].data = (uint8_t *)malloc(ring.buf_size + uAES_BLOCK_SIZE);
+    ring.buf[idx].out  = ( uAES_STREAM_CBC_DECRYPT_PKCS7 == mode ) ? ((uint8_t *)malloc(ring.buf_size + uAES_BLOCK_SIZE)) : (ring.buf[idx].data);
+    err |= ( (NULL != ring.buf[idx].data) && (NULL != ring.buf[idx].out) ) ? (0) : (-1);
+  }
+  if( 0 != err )
+  {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  pthread_mutex_init(&ring.lock, NULL);
+  pthread_cond_init(&ring.cond, NULL);
+
+  t0 = fc_ns();
+  if( (0 != pthread_create(&reader, NULL, fc_reader, &ring)) || (0 != pthread_create(&writer, NULL, fc_writer, &ring)) )
+  {
+    fprintf(stderr, "cannot start threads\n");
+    return 1;
+  }
+  for(size_t idx = 0; !last; idx = (idx + 1UL) % FC_NBUFS)
+  {
+    buf = &ring.buf[idx];
+    if( 0 != fc_wait(&ring, buf, FC_FILLED) )
+    {
+      break;
+    }
+    total += buf->len;
+    t1 = fc_ns();
+    err = fc_cipher(&st, buf);
+    cipher_ns += fc_ns() - t1;
+    if( 0 != err )
+    {
+      fprintf(stderr, "%s\n", ( uAES_STREAM_CBC_DECRYPT_PKCS7 == mode ) ? ("bad input or key") : ("cipher failed"));
+      fc_fail(&ring);
+      break;
+    }
+    last = buf->last;
+    fc_post(&ring, buf, FC_DONE);
+  }
+  pthread_join(reader, NULL);
+  pthread_join(writer, NULL);
+  t1 = fc_ns();
+  err = ( (0 == err) && (0 == ring.err) && last ) ? (0) : (-1);
+  if( !last )
+  {
+    /* Stopped early, final() still wipes the stream state. */
+    uaes_stream_final(&st, iv, &done);
+    memset(iv, 0x00, sizeof(iv));
+  }
+
+  if( stdout != ring.out )
+  {
+    err = ( 0 == fclose(ring.out) ) ? (err) : (-1);
+  }
+  if( stdin != ring.in )
+  {
+    fclose(ring.in);
+  }
+  for(size_t idx = 0; idx < FC_NBUFS; idx++)
+  {
+    if( ring.buf[idx].out != ring.buf[idx].data )
+    {
+      memset(ring.buf[idx].out, 0x00, ring.buf_size + uAES_BLOCK_SIZE);
+      free(ring.buf[idx].out);
+    }
+    memset(ring.buf[idx].data, 0x00, ring.buf_size + uAES_BLOCK_SIZE);
+    free(ring.buf[idx].data);
+  }
+  uaes_ctx_clear(&ctx);
+  uaes_pool_stop();
+
+  fprintf(stderr, "fcrypt: %llu bytes in %.3f s, %.1f MB/s, cipher %.1f MB/s%s\n",
+          (unsigned long long)total, (double)(t1 - t0) / 1e9,
+          ( t1 > t0 ) ? ((double)total * 1e3 / (double)(t1 - t0)) : (0.0),
+          ( 0 < cipher_ns ) ? ((double)total * 1e3 / (double)cipher_ns) : (0.0),
+          ( 0 == err ) ? ("") : (", FAILED"));
+  return ( 0 == err ) ? (0) : (1);
+}
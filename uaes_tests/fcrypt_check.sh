@@ -0,0 +1,74 @@
+#!/bin/sh
+#
+# fcrypt_check.sh - round trips fcrypt against openssl enc.
+#
+#  Copyright (C) 2023, Antonio Vitor Grossi Bassi
+#
+#  This program is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# usage: fcrypt_check.sh [path/to/fcrypt]
+#
+# For CBC and CTR, 128 and 256-bit keys and sizes around block and buffer
+# boundaries, fcrypt output is decrypted by openssl and openssl output by
+# fcrypt, with 1 MB buffers so the larger files span several of them. One
+# more round trip goes through pipes with the IV carried in the stream.
+# Prints one line per failure and exits with 1 if there was any.
+
+FCRYPT=${1:-./fcrypt}
+TMP=$(mktemp -d) || exit 1
+trap 'rm -rf "$TMP"' EXIT
+
+# The counter block keeps its low 64 bits far from wrapping, fcrypt's counter
+# field is 64 bits wide and openssl's is 128.
+IV=000102030405060708090a0b0c0d0e0f
+FAIL=0
+
+fail()
+{
+  echo "fcrypt_check: $*"
+  FAIL=1
+}
+
+for KEY in 2b7e151628aed2a6abf7158809cf4f3c 603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4
+do
+  BITS=$(( ${#KEY} * 4 ))
+  for MODE in cbc ctr
+  do
+    for SIZE in 0 1 15 16 17 4095 4096 65537 1048576 3145733
+    do
+      head -c "$SIZE" /dev/urandom > "$TMP/pt"
+
+      "$FCRYPT" -k "$KEY" -i "$IV" -m "$MODE" -b 1 "$TMP/pt" "$TMP/ct" 2> /dev/null &&
+      openssl enc -d -aes-"$BITS"-"$MODE" -K "$KEY" -iv "$IV" -in "$TMP/ct" -out "$TMP/rt" 2> /dev/null &&
+      cmp -s "$TMP/pt" "$TMP/rt" || fail "$MODE-$BITS $SIZE bytes, openssl cannot decrypt fcrypt"
+
+      openssl enc -e -aes-"$BITS"-"$MODE" -K "$KEY" -iv "$IV" -in "$TMP/pt" -out "$TMP/ct" 2> /dev/null &&
+      "$FCRYPT" -d -k "$KEY" -i "$IV" -m "$MODE" -b 1 "$TMP/ct" "$TMP/rt" 2> /dev/null &&
+      cmp -s "$TMP/pt" "$TMP/rt" || fail "$MODE-$BITS $SIZE bytes, fcrypt cannot decrypt openssl"
+    done
+
+    head -c 2500000 /dev/urandom > "$TMP/pt"
+    "$FCRYPT" -k "$KEY" -m "$MODE" -b 1 < "$TMP/pt" 2> /dev/null |
+    "$FCRYPT" -d -k "$KEY" -m "$MODE" -b 1 2> /dev/null > "$TMP/rt"
+    cmp -s "$TMP/pt" "$TMP/rt" || fail "$MODE-$BITS pipe round trip"
+  done
+done
+
+# Plaintext ending in a zero pad byte must make CBC decryption fail.
+head -c 32 /dev/zero > "$TMP/pt"
+openssl enc -e -aes-128-cbc -nopad -K 2b7e151628aed2a6abf7158809cf4f3c -iv "$IV" -in "$TMP/pt" -out "$TMP/ct" 2> /dev/null
+"$FCRYPT" -d -k 2b7e151628aed2a6abf7158809cf4f3c -i "$IV" "$TMP/ct" "$TMP/rt" 2> /dev/null && fail "cbc bad padding accepted"
+
+[ 0 = "$FAIL" ] && echo "fcrypt_check: pass"
+exit $FAIL
@@ -54,6 +54,12 @@ typedef enum
 #define ARG_MSK_CIPHERTYPE    (LSB << 3UL)
 #define ARG_MSK_OUTFNAME      (LSB << 4UL)
 #define ARG_MSK_MODE          (LSB << 5UL)
+#define ARG_MSK_DIRECT        (LSB << 6UL)
+
+#define BMP_FILE_HDR_SIZE     (14UL)
+#define BMP_INFO_HDR_SIZE     (40UL)
+#define BMP_MAX_HDR_SIZE      (1UL*MB)
+#define BMP_CHUNK_SIZE        (256UL*KB)
 
 static unsigned int __strnlen(char *ptr, unsigned int limit)
 {
@@ -70,6 +76,173 @@ int rd_argmsk(uint32_t *argmsk, uint32_t msk)
   return (*argmsk & msk) ? (0UL) : (1UL);
 }
 
+static uint32_t rd_le32(const uint8_t *p)
+{
+  return ((uint32_t)p[0]) | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int copy_bytes(FILE *in, FILE *out, uint8_t *buf, size_t size)
+{
+  size_t n = 0;
+
+  while(0 < size)
+  {
+    n = (size < BMP_CHUNK_SIZE) ? (size) : (BMP_CHUNK_SIZE);
+    if( (n != fread(buf, 1UL, n, in)) || (n != fwrite(buf, 1UL, n, out)) )
+    {
+      return -1;
+    }
+    size -= n;
+  }
+  return 0;
+}
+
+/**
+ * @brief Encrypts or decrypts the pixel array of one BMP stream into another.
+ *
+ * @param in      Input file, at its start.
+ * @param out     Output file.
+ * @param buf     BMP_CHUNK_SIZE bytes of scratch memory.
+ * @param ctx     Key context initialised for the operation.
+ * @param cipher  uAES_ECB, uAES_CBC, uAES_PCBC or uAES_CFB.
+ * @param op      uAES_ENCRYPT or uAES_DECRYPT.
+ * @param iv      16-byte initialisation vector, unused by ECB.
+ * @return int    [0] if sucessful, [-1] on failure.
+ */
+static int bmp_stream(FILE *in, FILE *out, uint8_t *buf, const uaes_ctx_t *ctx,
+                      cipher_t cipher, uaes_mode_t op, const uint8_t *iv)
+{
+  int err = 0;
+  uint8_t hdr[BMP_FILE_HDR_SIZE + BMP_INFO_HDR_SIZE];
+  uint8_t chain[uAES_BLOCK_SIZE] = {0}, next[uAES_BLOCK_SIZE];
+  uint32_t offset = 0, width = 0, bpp = 0, compression = 0;
+  int32_t height = 0;
+  size_t pixels = 0, n = 0, blocks = 0;
+
+  if( (sizeof(hdr) != fread(hdr, 1UL, sizeof(hdr), in)) || ('B' != hdr[0]) || ('M' != hdr[1]) )
+  {
+    return -1;
+  }
+  offset      = rd_le32(&hdr[10]);
+  width       = rd_le32(&hdr[18]);
+  height      = (int32_t)rd_le32(&hdr[22]);
+  bpp         = (uint32_t)hdr[28] | ((uint32_t)hdr[29] << 8);
+  compression = rd_le32(&hdr[30]);
+  /* Only BI_RGB and BI_BITFIELDS store the pixels as plain rows. */
+  if( (BMP_INFO_HDR_SIZE > rd_le32(&hdr[14])) || (sizeof(hdr) > offset) || (BMP_MAX_HDR_SIZE < offset) ||
+      ((0 != compression) && (3 != compression)) || (0 == bpp) || (0 == width) || (0 == height) )
+  {
+    return -1;
+  }
+  /* Rows are padded to 4 bytes, a negative height means top-down rows. */
+  pixels = ((((size_t)width * bpp) + 31UL) / 32UL) * 4UL * (size_t)( (0 > height) ? (-(int64_t)height) : (height) );
+
+  if( (sizeof(hdr) != fwrite(hdr, 1UL, sizeof(hdr), out)) ||
+      (0 != copy_bytes(in, out, buf, offset - sizeof(hdr))) )
+  {
+    return -1;
+  }
+  if( uAES_ECB != cipher )
+  {
+    memcpy(chain, iv, uAES_BLOCK_SIZE);
+  }
+  while( (0 == err) && (0 < pixels) )
+  {
+    n = (pixels < BMP_CHUNK_SIZE) ? (pixels) : (BMP_CHUNK_SIZE);
+    if( n != fread(buf, 1UL, n, in) )
+    {
+      return -1;
+    }
+    /* Chunks are whole blocks except for the last one. */
+    blocks = n & ~(uAES_BLOCK_SIZE - 1UL);
+    if( 0 == blocks )
+    {
+      err = 0;
+    }
+    else if( uAES_ECB == cipher )
+    {
+      err = ( uAES_ENCRYPT == op ) ? (uaes_ctx_ecb_encryption(ctx, buf, blocks)) : (uaes_ctx_ecb_decryption(ctx, buf, blocks));
+    }
+    else if( uAES_ENCRYPT == op )
+    {
+      /* PCBC chains P ^ C, CBC and CFB the last ciphertext block. */
+      memcpy(next, &buf[blocks - uAES_BLOCK_SIZE], uAES_BLOCK_SIZE);
+      err = ( uAES_CBC == cipher )  ? (uaes_ctx_cbc_encryption(ctx, buf, blocks, chain)) :
+            ( uAES_PCBC == cipher ) ? (uaes_ctx_pcbc_encryption(ctx, buf, blocks, chain)) :
+                                      (uaes_ctx_cfb_encryption(ctx, buf, blocks, chain));
+      for(size_t idx = 0; idx < uAES_BLOCK_SIZE; idx++)
+      {
+        chain[idx] = ( uAES_PCBC == cipher ) ? (next[idx] ^ buf[blocks - uAES_BLOCK_SIZE + idx]) : (buf[blocks - uAES_BLOCK_SIZE + idx]);
+      }
+    }
+    else
+    {
+      memcpy(next, &buf[blocks - uAES_BLOCK_SIZE], uAES_BLOCK_SIZE);
+      err = ( uAES_CBC == cipher )  ? (uaes_ctx_cbc_decryption(ctx, buf, blocks, chain)) :
+            ( uAES_PCBC == cipher ) ? (uaes_ctx_pcbc_decryption(ctx, buf, blocks, chain)) :
+                                      (uaes_ctx_cfb_decryption(ctx, buf, blocks, chain));
+      for(size_t idx = 0; idx < uAES_BLOCK_SIZE; idx++)
+      {
+        chain[idx] = ( uAES_PCBC == cipher ) ? (next[idx] ^ buf[blocks - uAES_BLOCK_SIZE + idx]) : (next[idx]);
+      }
+    }
+    if( (0 == err) && (n != fwrite(buf, 1UL, n, out)) )
+    {
+      err = -1;
+    }
+    pixels -= n;
+  }
+  /* Whatever follows the pixel array, like an ICC profile, is kept as is. */
+  while( (0 == err) && (0 < (n = fread(buf, 1UL, BMP_CHUNK_SIZE, in))) )
+  {
+    err = ( n == fwrite(buf, 1UL, n, out) ) ? (0) : (-1);
+  }
+  return err;
+}
+
+/**
+ * @brief Direct mode, encrypts the pixel array of an uncompressed BMP file as it
+ *        is stored (rows and their padding in file order) with a single key
+ *        context. The file is streamed in BMP_CHUNK_SIZE pieces so memory use
+ *        does not depend on the image size. Headers and colour table are copied
+ *        unchanged, the last (size % 16) pixel bytes are left in clear.
+ *
+ * @param path    Input file name.
+ * @param outf    Output file name.
+ * @param ctx     Key context initialised for the operation.
+ * @param cipher  uAES_ECB, uAES_CBC, uAES_PCBC or uAES_CFB.
+ * @param op      uAES_ENCRYPT or uAES_DECRYPT.
+ * @param iv      16-byte initialisation vector, unused by ECB.
+ * @return int    [0] if sucessful, [-1] on failure.
+ */
+static int scrypt_direct(const char *path, const char *outf, const uaes_ctx_t *ctx,
+                         cipher_t cipher, uaes_mode_t op, const uint8_t *iv)
+{
+  int err = -1;
+  FILE *in  = fopen(path, "rb");
+  FILE *out = ( NULL != in ) ? (fopen(outf, "wb")) : (NULL);
+  uint8_t *buf = (uint8_t *)malloc(BMP_CHUNK_SIZE);
+
+  if( (NULL != in) && (NULL != out) && (NULL != buf) )
+  {
+    err = bmp_stream(in, out, buf, ctx, cipher, op, iv);
+  }
+  if( NULL != buf )
+  {
+    memset(buf, 0x00, BMP_CHUNK_SIZE);
+    free(buf);
+  }
+  if( (NULL != out) && (0 != fclose(out)) )
+  {
+    err = -1;
+  }
+  if( NULL != in )
+  {
+    fclose(in);
+  }
+  return err;
+}
+
 int main(int argc, char **argv)
 {
   char path[MAX_FPATHSTR] = {0};
@@ -90,6 +263,7 @@ int main(int argc, char **argv)
   uint8_t *iv = NULL;
   uint8_t *r = NULL, *g = NULL, *b = NULL;
   uint8_t key[MAX_KEYSIZE] = {0};
+  uaes_ctx_t ctx;
   BMP *img    = NULL; 
 
   if(1UL < argc)
@@ -148,12 +322,24 @@ int main(int argc, char **argv)
         {
           cipher_mode = uAES_CBC;
         }
+        else if(0 == strcmp(argv[arg], "PCBC"))
+        {
+          cipher_mode = uAES_PCBC;
+        }
+        else if(0 == strcmp(argv[arg], "CFB"))
+        {
+          cipher_mode = uAES_CFB;
+        }
       }
       else if((0 == strcmp(argv[arg], "-d"))  && (rd_argmsk(&argmsk, ARG_MSK_MODE)))
       {
         argmsk = ((argmsk & (~ARG_MSK_MODE)) | (ARG_MSK_MODE));
         operation_mode = uAES_DECRYPT;
       }
+      else if((0 == strcmp(argv[arg], "-z"))  && (rd_argmsk(&argmsk, ARG_MSK_DIRECT)))
+      {
+        argmsk = ((argmsk & (~ARG_MSK_DIRECT)) | (ARG_MSK_DIRECT));
+      }
       else if(0 == strcmp(argv[arg], "-h"))
       {
         printf("scrypt: Test script for uAES API, applies AES encryption on bitmap image files.\n");
@@ -161,8 +347,10 @@ int main(int argc, char **argv)
         printf("Takes following arguments:\n\"-f\", file name with extension.\n\"-o\", output file name with extension.\n");
         printf("\"-k\", AES key value, if lenght is less than the specified in argument \"-t\" padding is applied.\n");
         printf("\"-t\", Cryptography mode, can be 128, 192 or 256.\n");
-        printf("\"-c\", Cipher mode, can be EBC or CBC.\n");
+        printf("\"-c\", Cipher mode, can be EBC, CBC, PCBC or CFB.\n");
         printf("\"-d\", Specifies decryption operation. If nothing is specified, encryption is performed.\n");
+        printf("\"-z\", Direct mode, the pixel array is encrypted as stored in the file, in one pass and\n");
+        printf("      bounded memory, instead of as separate R, G and B planes.\n");
         printf("example: scrypt -f \"yourpic.bmp\" -o \"res.bmp\" -k \"youarebeautiful!\" -t 128 -c ECB\n\n");
         exit(EXIT_SUCCESS);
       }
@@ -197,6 +385,35 @@ int main(int argc, char **argv)
       key_buf_size = aligned_size;
     }
 
+    switch(encryption_type)
+    {
+      case uAES128:
+        iv = input_aes128;
+        break;
+      case uAES192:
+        iv = input_aes192;
+        break;
+      case uAES256:
+        iv = input_aes256;
+        break;
+      default:
+        break;
+    }
+
+    /* One key context serves every call below, CFB only runs the forward cipher. */
+    if(0 != uaes_ctx_init(&ctx, key, encryption_type,
+                          ((uAES_ENCRYPT == operation_mode) || (uAES_CFB == cipher_mode)) ? (uAES_CTX_ENCRYPT) : (uAES_CTX_DECRYPT)))
+    {
+      return -1;
+    }
+
+    if(0 == rd_argmsk(&argmsk, ARG_MSK_DIRECT))
+    {
+      err = scrypt_direct(path, outf, &ctx, cipher_mode, operation_mode, iv);
+      uaes_ctx_clear(&ctx);
+      return err;
+    }
+
     img = bopen(path);
     if(NULL != img)
     {
@@ -206,77 +423,91 @@ int main(int argc, char **argv)
       r = (uint8_t *)calloc(1UL, pxLayer_size);
       g = (uint8_t *)calloc(1UL, pxLayer_size);
       b = (uint8_t *)calloc(1UL, pxLayer_size);
+    }
 
-      for(int x = 0; x < w; x++)
+    if( (NULL != r) && (NULL != g) && (NULL != b) )
+    {
+      for(int y = 0; y < h; y++)
       {
-        for(int y = 0; y < h; y++)
+        for(int x = 0; x < w; x++)
         {
-          get_pixel_rgb(img, x, y, &r[(y*img->width) + x], &g[(y*img->width) + x], &b[(y*img->width) + x]);
+          get_pixel_rgb(img, x, y, &r[(y*w) + x], &g[(y*w) + x], &b[(y*w) + x]);
         }
       }
-    }
-
-    if( (NULL != r) && (NULL != g) && (NULL != b) )
-    {
       switch (cipher_mode)
       {
         case uAES_ECB:
         {
           if(uAES_ENCRYPT == operation_mode)
           {
-            err = uaes_ecb_encryption(r, pxLayer_size, key, encryption_type);
-            err = uaes_ecb_encryption(g, pxLayer_size, key, encryption_type);
-            err = uaes_ecb_encryption(b, pxLayer_size, key, encryption_type);
+            err = uaes_ctx_ecb_encryption(&ctx, r, pxLayer_size);
+            err = uaes_ctx_ecb_encryption(&ctx, g, pxLayer_size);
+            err = uaes_ctx_ecb_encryption(&ctx, b, pxLayer_size);
           }
           else if(uAES_DECRYPT == operation_mode)
           {
-            err = uaes_ecb_decryption(r, pxLayer_size, key, encryption_type);
-            err = uaes_ecb_decryption(g, pxLayer_size, key, encryption_type);
-            err = uaes_ecb_decryption(b, pxLayer_size, key, encryption_type);
+            err = uaes_ctx_ecb_decryption(&ctx, r, pxLayer_size);
+            err = uaes_ctx_ecb_decryption(&ctx, g, pxLayer_size);
+            err = uaes_ctx_ecb_decryption(&ctx, b, pxLayer_size);
           }
-          for(int x = 0; x < w; x++)
-          {
-            for(int y = 0; y < h; y++)
-            {
-              set_pixel_rgb(img, x, y, r[(y*img->width) + x], g[(y*img->width) + x], b[(y*img->width) + x]);
-            }
-          } 
           break;
         }
         case uAES_CBC:
         {
-          switch(encryption_type)
+          if( uAES_ENCRYPT == operation_mode )
           {
-            case uAES128:
-              iv = input_aes128;
-              break;
-            case uAES192:
-              iv = input_aes192;
-              break;
-            case uAES256:
-              iv = input_aes256;
-              break;
+            err = uaes_ctx_cbc_encryption(&ctx, r, pxLayer_size, iv);
+            err = uaes_ctx_cbc_encryption(&ctx, g, pxLayer_size, iv);
+            err = uaes_ctx_cbc_encryption(&ctx, b, pxLayer_size, iv);
           }
+          else if(uAES_DECRYPT == operation_mode)
+          { 
+            err = uaes_ctx_cbc_decryption(&ctx, r, pxLayer_size, iv);
+            err = uaes_ctx_cbc_decryption(&ctx, g, pxLayer_size, iv);
+            err = uaes_ctx_cbc_decryption(&ctx, b, pxLayer_size, iv);
+          }
+          break;
+        }
+        case uAES_PCBC:
+        {
           if( uAES_ENCRYPT == operation_mode )
           {
-            err = uaes_cbc_encryption(r, pxLayer_size, key, iv, encryption_type);
-            err = uaes_cbc_encryption(g, pxLayer_size, key, iv, encryption_type);
-            err = uaes_cbc_encryption(b, pxLayer_size, key, iv, encryption_type);
+            err = uaes_ctx_pcbc_encryption(&ctx, r, pxLayer_size, iv);
+            err = uaes_ctx_pcbc_encryption(&ctx, g, pxLayer_size, iv);
+            err = uaes_ctx_pcbc_encryption(&ctx, b, pxLayer_size, iv);
           }
           else if(uAES_DECRYPT == operation_mode)
-          { 
-            err = uaes_cbc_decryption(r, pxLayer_size, key, iv, encryption_type);
-            err = uaes_cbc_decryption(g, pxLayer_size, key, iv, encryption_type);
-            err = uaes_cbc_decryption(b, pxLayer_size, key, iv, encryption_type);
+          {
+            err = uaes_ctx_pcbc_decryption(&ctx, r, pxLayer_size, iv);
+            err = uaes_ctx_pcbc_decryption(&ctx, g, pxLayer_size, iv);
+            err = uaes_ctx_pcbc_decryption(&ctx, b, pxLayer_size, iv);
           }
-          for(int x = 0; x < w; x++)
+          break;
+        }
+        case uAES_CFB:
+        {
+          if( uAES_ENCRYPT == operation_mode )
           {
-            for(int y = 0; y < h; y++)
-            {
-              set_pixel_rgb(img, x, y, r[(y*img->width) + x], g[(y*img->width) + x], b[(y*img->width) + x]);
-            }
+            err = uaes_ctx_cfb_encryption(&ctx, r, pxLayer_size, iv);
+            err = uaes_ctx_cfb_encryption(&ctx, g, pxLayer_size, iv);
+            err = uaes_ctx_cfb_encryption(&ctx, b, pxLayer_size, iv);
           }
+          else if(uAES_DECRYPT == operation_mode)
+          {
+            err = uaes_ctx_cfb_decryption(&ctx, r, pxLayer_size, iv);
+            err = uaes_ctx_cfb_decryption(&ctx, g, pxLayer_size, iv);
+            err = uaes_ctx_cfb_decryption(&ctx, b, pxLayer_size, iv);
+          }
+          break;
+        }
+        default:
           break;
+      }
+      for(int y = 0; y < h; y++)
+      {
+        for(int x = 0; x < w; x++)
+        {
+          set_pixel_rgb(img, x, y, r[(y*w) + x], g[(y*w) + x], b[(y*w) + x]);
         }
       }
       bwrite(img, outf);
@@ -285,6 +516,7 @@ int main(int argc, char **argv)
       free(g);
       free(b);
     }
+    uaes_ctx_clear(&ctx);
   }/*if(1UL < argc)*/
   return err;
 }
@@ -27,6 +27,10 @@
 #ifndef UDBG_H
 #define UDBG_H
 
+#include <stdint.h>
+
+#include "uaes_config.h"
+
 /* 
  * trace macro options:
  *            +----+----+----+----+----+----+----+----+
@@ -43,8 +47,29 @@
  * 
  */
 
-extern uint8_t trace_msk;
-extern int debug_line;
+/*
+ * The trace mask and line counter only exist in __uAES_DEBUG__ builds and are
+ * thread-local, uaes_set_trace_msk() enables tracing for the calling thread
+ * and threads tracing at the same time number their lines independently.
+ * uAES_THREAD_LOCAL may be defined empty for a single threaded target whose
+ * toolchain has no TLS support.
+ */
+#ifdef __uAES_DEBUG__
+#ifndef uAES_THREAD_LOCAL
+#if defined(__STDC_VERSION__) && ( 201112L <= __STDC_VERSION__ )
+#define uAES_THREAD_LOCAL     _Thread_local
+#elif defined(__GNUC__)
+#define uAES_THREAD_LOCAL     __thread
+#else
+#define uAES_THREAD_LOCAL
+#endif
+#endif /*uAES_THREAD_LOCAL*/
+extern uAES_THREAD_LOCAL uint8_t trace_msk;
+extern uAES_THREAD_LOCAL int debug_line;
+#define uAES_TRACE_ON( msk )  ( 0 != ( trace_msk & (msk) ) )
+#else
+#define uAES_TRACE_ON( msk )  ( 0 )
+#endif /*__uAES_DEBUG__*/
 
 #define uAES_TRACE_MSK_FWD    0x01
 #define uAES_TRACE_MSK_INV    0x02
@@ -56,23 +81,84 @@ extern int debug_line;
 
 #ifdef __uAES_DEBUG__
 #define uAES_TRACE( msk, fmt, ... )do {                         \
-  if( trace_msk & msk )                                         \
-    printf("dbg[%d]:" fmt "\n", debug_line, ##__VA_ARGS__ );  \
-  debug_line++;                                                 \
+  if( uAES_TRACE_ON(msk) )                                      \
+  {                                                             \
+    printf("dbg[%d]:" fmt "\n", debug_line, ##__VA_ARGS__ );    \
+    debug_line++;                                               \
+  }                                                             \
 } while(0)
 #define uAES_TRACE_BLOCK( msk, fmt, block, ... ) do {           \
-  if( trace_msk & msk )                                         \
+  if( uAES_TRACE_ON(msk) )                                      \
   {                                                             \
-    printf("dbg[%d]:" fmt, debug_line, ##__VA_ARGS__);        \
+    printf("dbg[%d]:" fmt, debug_line, ##__VA_ARGS__);          \
     for(size_t pos = 0; pos < 16; pos++)                        \
       printf("%.2x", block[pos]);                               \
+    printf("\n");                                               \
+    debug_line++;                                               \
   }                                                             \
-  debug_line++;                                                 \
-  printf("\n");                                                 \
-}while (0)                                                                    
+}while (0)
 #else
 #define uAES_TRACE( msk, fmt, ... )do {} while (0)
 #define uAES_TRACE_BLOCK( msk, fmt, block, ... )do {} while(0)
 #endif /*__UAES_DEBUG__*/
 
+/*
+ * Profiling hooks (uAES_CFG_PROFILE), cycle counts are added to the profile
+ * of the key context, see uaes_ctx_profile(). uAES_PROF_CYCLES() reads the
+ * cycle counter, it can be defined before this header for other targets:
+ *  - Cortex-M3/M4/M7/M33: DWT CYCCNT, 32 bits. The application enables it
+ *    (DEMCR.TRCENA, then DWT_CTRL.CYCCNTENA) before profiling.
+ *  - x86: time stamp counter.
+ *  - AArch64: virtual counter (CNTVCT_EL0), it ticks at CNTFRQ_EL0 and not at
+ *    the core clock.
+ * When profiling is compiled out the hooks expand to nothing.
+ */
+#if uAES_CFG_PROFILE
+#ifndef uAES_PROF_CYCLES
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__) || defined(__ARM_ARCH_8_1M_MAIN__)
+#define uAES_PROF_CYCLES()      ( (uint64_t)( *(volatile uint32_t *)0xE0001004UL ) )
+#define uAES_PROF_MASK          ( 0xFFFFFFFFULL )
+#elif ( defined(__x86_64__) || defined(__i386__) ) && defined(__GNUC__)
+static inline uint64_t uaes_prof_tsc(void)
+{
+  uint32_t lo = 0, hi = 0;
+  __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+  return ( (uint64_t)hi << 32 ) | lo;
+}
+#define uAES_PROF_CYCLES()      uaes_prof_tsc()
+#elif defined(__aarch64__) && defined(__GNUC__)
+static inline uint64_t uaes_prof_cntvct(void)
+{
+  uint64_t cnt = 0;
+  __asm__ __volatile__("isb\n\tmrs %0, cntvct_el0" : "=r"(cnt));
+  return cnt;
+}
+#define uAES_PROF_CYCLES()      uaes_prof_cntvct()
+#else
+#error "uAES_CFG_PROFILE needs uAES_PROF_CYCLES() for this target"
+#endif
+#endif /*uAES_PROF_CYCLES*/
+#ifndef uAES_PROF_MASK
+#define uAES_PROF_MASK          ( 0xFFFFFFFFFFFFFFFFULL )
+#endif /*uAES_PROF_MASK*/
+
+/* The profile is the only part of a context written after uaes_ctx_init(). */
+#define uAES_PROF_START( t0 )   const uint64_t t0 = uAES_PROF_CYCLES()
+#define uAES_PROF_STOP( ctx, stage, t0 ) do {                                 \
+  uaes_prof_t *prof__ = &( (uaes_ctx_t *)(ctx) )->prof;                     \
+  prof__->cycles[stage] += ( uAES_PROF_CYCLES() - (t0) ) & uAES_PROF_MASK;  \
+  prof__->calls[stage]++;                                                   \
+} while(0)
+#else
+#define uAES_PROF_START( t0 )   do {} while(0)
+#define uAES_PROF_STOP( ctx, stage, t0 ) do {} while(0)
+#endif /*uAES_CFG_PROFILE*/
+
+/* Profiles a single statement. */
+#define uAES_PROF_OP( ctx, stage, op ) do {                       \
+  uAES_PROF_START(t0__);                                          \
+  op;                                                             \
+  uAES_PROF_STOP(ctx, stage, t0__);                               \
+} while(0)
+
 #endif /*UDBG_H*/
@@ -0,0 +1,462 @@
+/**
+ * @file      vperm.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     Vector permute constant-time engine, SubBytes through GF(2^4) with SSSE3 or NEON byte shuffles.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_VPERM
+
+/*
+ * GF(2^8) is taken as GF(2^4)[y]/(y^2 + a*y + a) with a = 0x0c, so every state
+ * byte is x = i*y + k with two GF(2^4) nibbles. A GF(2)-linear map, two 16-entry
+ * shuffles, moves x to this representation, and its inverse is
+ *
+ *  1/x = F1(io) + F2(jo), io = j + 1/(1/i + a/k), jo = i + 1/(1/j + a/k), j = i + k
+ *
+ * where 1/0 is kept as an index with bit 7 set, which a shuffle turns into zero.
+ * Every step is a lookup of one nibble in a 16-byte table held in a register, so
+ * no memory address depends on the key or the data. The affine transform and the
+ * basis changes are folded into the input and output tables, the state and round
+ * keys stay in the FIPS-197 layout shared with the other engines.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <cpuid.h>
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+/* Enabled per function, the rest of the library stays runnable without SSSE3. */
+#define VPERM_FN          __attribute__((target("ssse3")))
+#define CPUID_ECX_SSSE3   ( 1U << 9 )
+
+typedef __m128i vperm_t;
+
+#define LOAD(p)           _mm_loadu_si128((const __m128i *)(const void *)(p))
+#define STORE(p, v)       _mm_storeu_si128((__m128i *)(void *)(p), (v))
+#define V_XOR(a, b)       _mm_xor_si128((a), (b))
+#define V_LO(x)           _mm_and_si128((x), _mm_set1_epi8(0x0f))
+#define V_HI(x)           _mm_and_si128(_mm_srli_epi16((x), 4), _mm_set1_epi8(0x0f))
+#define V_SHUF(t, i)      _mm_shuffle_epi8((t), (i))
+#define V_XTIME(x)        _mm_xor_si128(_mm_add_epi8((x), (x)), \
+                                        _mm_and_si128(_mm_cmpgt_epi8(_mm_setzero_si128(), (x)), _mm_set1_epi8(0x1b)))
+#define V_DUP8(b)         _mm_set1_epi8((char)(b))
+#define V_DUP32(w)        _mm_set1_epi32((int)(w))
+#define V_LANE0(x)        ( (uint32_t)_mm_cvtsi128_si32(x) )
+
+/* 0 = not probed yet, 1 = supported, -1 = unsupported. */
+static volatile int vperm_support = 0;
+
+static int vperm_available(void)
+{
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+  if(0 == vperm_support)
+  {
+    vperm_support = ( __get_cpuid(1, &eax, &ebx, &ecx, &edx) && ( ecx & CPUID_ECX_SSSE3 ) ) ? (1) : (-1);
+  }
+  return ( 1 == vperm_support ) ? (1) : (0);
+}
+
+#else
+
+#include <arm_neon.h>
+
+/* Built with NEON enabled (always on AArch64), always usable. */
+#define VPERM_FN
+
+typedef uint8x16_t vperm_t;
+
+#define LOAD(p)           vld1q_u8((const uint8_t *)(const void *)(p))
+#define STORE(p, v)       vst1q_u8((uint8_t *)(void *)(p), (v))
+#define V_XOR(a, b)       veorq_u8((a), (b))
+#define V_LO(x)           vandq_u8((x), vdupq_n_u8(0x0f))
+#define V_HI(x)           vshrq_n_u8((x), 4)
+#define V_XTIME(x)        veorq_u8(vshlq_n_u8((x), 1), \
+                                   vandq_u8(vreinterpretq_u8_s8(vshrq_n_s8(vreinterpretq_s8_u8(x), 7)), vdupq_n_u8(0x1b)))
+#define V_DUP8(b)         vdupq_n_u8(b)
+#define V_DUP32(w)        vreinterpretq_u8_u32(vdupq_n_u32(w))
+#define V_LANE0(x)        vgetq_lane_u32(vreinterpretq_u32_u8(x), 0)
+
+#if defined(__aarch64__)
+#define V_SHUF(t, i)      vqtbl1q_u8((t), (i))
+#else
+/* AArch32 has no 16-byte table lookup, both halves go through VTBL with the whole table. */
+static inline uint8x16_t vperm_tbl(uint8x16_t t, uint8x16_t i)
+{
+  uint8x8x2_t tab = { { vget_low_u8(t), vget_high_u8(t) } };
+
+  return vcombine_u8(vtbl2_u8(tab, vget_low_u8(i)), vtbl2_u8(tab, vget_high_u8(i)));
+}
+#define V_SHUF(t, i)      vperm_tbl((t), (i))
+#endif /*__aarch64__*/
+
+static int vperm_available(void)
+{
+  return 1;
+}
+
+#endif /*__x86_64__ || __i386__*/
+
+#define VPERM_INLINE      VPERM_FN static inline __attribute__((always_inline))
+
+/*
+ * Shuffle tables. Indices from the inversion are either below 16 or have bit 7
+ * set, PSHUFB and VTBL agree on both.
+ */
+enum
+{
+  VP_INV = 0,   // 1/n in GF(2^4), 1/0 = 0x80
+  VP_AK,        // a/n in GF(2^4), a/0 = 0x80
+  VP_ELO,       // forward input map, low and high nibble
+  VP_EHI,
+  VP_SB1,       // forward output, affine transform of F1 and F2
+  VP_SB2,
+  VP_DLO,       // inverse input map, inverse affine transform and 0x63 folded in
+  VP_DHI,
+  VP_OUT1,      // inverse output, F1 and F2
+  VP_OUT2,
+  VP_SR,        // ShiftRows
+  VP_ISR,       // InvShiftRows
+  VP_ROT1,      // rotates each column by one and two rows
+  VP_ROT2,
+  VP_TABLES
+};
+
+static const uint8_t vperm_tab[VP_TABLES][16] =
+{
+  { 0x80, 0x01, 0x08, 0x0d, 0x0f, 0x06, 0x05, 0x0e, 0x02, 0x0c, 0x0b, 0x0a, 0x09, 0x03, 0x07, 0x04 },
+  { 0x80, 0x02, 0x01, 0x0c, 0x08, 0x0b, 0x0d, 0x0a, 0x04, 0x0e, 0x07, 0x05, 0x03, 0x06, 0x09, 0x0f },
+  { 0x00, 0x01, 0x37, 0x36, 0xd0, 0xd1, 0xe7, 0xe6, 0xd2, 0xd3, 0xe5, 0xe4, 0x02, 0x03, 0x35, 0x34 },
+  { 0x00, 0xbb, 0x7b, 0xc0, 0xbf, 0x04, 0xc4, 0x7f, 0xc8, 0x73, 0xb3, 0x08, 0x77, 0xcc, 0x0c, 0xb7 },
+  { 0x00, 0xfa, 0x6a, 0x35, 0xbb, 0x2b, 0x5f, 0x41, 0x8e, 0xcf, 0x1e, 0xe4, 0x90, 0x74, 0xd1, 0xa5 },
+  { 0x00, 0x81, 0x76, 0x99, 0xfd, 0x0a, 0xef, 0x7c, 0x64, 0x18, 0x93, 0x12, 0xf7, 0xe5, 0x8b, 0x6e },
+  { 0xd1, 0x8b, 0x72, 0x28, 0x79, 0x23, 0xda, 0x80, 0xe2, 0xb8, 0x41, 0x1b, 0x4a, 0x10, 0xe9, 0xb3 },
+  { 0x00, 0x63, 0x6c, 0x0f, 0x44, 0x27, 0x28, 0x4b, 0xaa, 0xc9, 0xc6, 0xa5, 0xee, 0x8d, 0x82, 0xe1 },
+  { 0x00, 0x9c, 0x1d, 0x8e, 0x44, 0xc5, 0x93, 0xd8, 0xca, 0x12, 0x4b, 0xd7, 0x81, 0x56, 0x59, 0x0f },
+  { 0x00, 0x6f, 0xc2, 0x99, 0x6b, 0xc6, 0x5b, 0x04, 0xf2, 0xf6, 0x5f, 0x30, 0xad, 0x9d, 0xa9, 0x34 },
+  { 0x00, 0x05, 0x0a, 0x0f, 0x04, 0x09, 0x0e, 0x03, 0x08, 0x0d, 0x02, 0x07, 0x0c, 0x01, 0x06, 0x0b },
+  { 0x00, 0x0d, 0x0a, 0x07, 0x04, 0x01, 0x0e, 0x0b, 0x08, 0x05, 0x02, 0x0f, 0x0c, 0x09, 0x06, 0x03 },
+  { 0x01, 0x02, 0x03, 0x00, 0x05, 0x06, 0x07, 0x04, 0x09, 0x0a, 0x0b, 0x08, 0x0d, 0x0e, 0x0f, 0x0c },
+  { 0x02, 0x03, 0x00, 0x01, 0x06, 0x07, 0x04, 0x05, 0x0a, 0x0b, 0x08, 0x09, 0x0e, 0x0f, 0x0c, 0x0d },
+};
+
+#define TAB(n)            LOAD(vperm_tab[n])
+
+/**
+ * @brief         Substitutes every byte of x, the tables select the direction.
+ * @param x       State.
+ * @param lo, hi  Input map tables, low and high nibble.
+ * @param f1, f2  Output tables of io and jo.
+ * @return vperm_t Substituted state, without 0x63 in the forward direction.
+ */
+VPERM_INLINE vperm_t vperm_sub(vperm_t x, vperm_t lo, vperm_t hi, vperm_t f1, vperm_t f2)
+{
+  const vperm_t inv = TAB(VP_INV), ak = TAB(VP_AK);
+  vperm_t i, k, j, a_k, iak, jak;
+
+  x   = V_XOR(V_SHUF(lo, V_LO(x)), V_SHUF(hi, V_HI(x)));
+  i   = V_HI(x);
+  k   = V_LO(x);
+  j   = V_XOR(i, k);
+  a_k = V_SHUF(ak, k);
+  iak = V_XOR(V_SHUF(inv, i), a_k);
+  jak = V_XOR(V_SHUF(inv, j), a_k);
+  i   = V_XOR(V_SHUF(inv, iak), j);
+  j   = V_XOR(V_SHUF(inv, jak), V_HI(x));
+  return V_XOR(V_SHUF(f1, i), V_SHUF(f2, j));
+}
+
+#define SUB_ENC(x)        vperm_sub((x), TAB(VP_ELO), TAB(VP_EHI), TAB(VP_SB1), TAB(VP_SB2))
+#define SUB_DEC(x)        vperm_sub((x), TAB(VP_DLO), TAB(VP_DHI), TAB(VP_OUT1), TAB(VP_OUT2))
+
+VPERM_INLINE vperm_t vperm_mix(vperm_t x)
+{
+  const vperm_t r1 = V_SHUF(x, TAB(VP_ROT1));
+  const vperm_t t = V_XOR(x, r1);
+
+  return V_XOR(V_XOR(V_XTIME(t), r1), V_SHUF(t, TAB(VP_ROT2)));
+}
+
+/* InvMixColumns is MixColumns after adding 4*(a[r] + a[r + 2]) to every a[r]. */
+VPERM_INLINE vperm_t vperm_inv_mix(vperm_t x)
+{
+  const vperm_t u = V_XTIME(V_XOR(x, V_SHUF(x, TAB(VP_ROT2))));
+
+  return vperm_mix(V_XOR(x, V_XTIME(u)));
+}
+
+/* The forward output tables leave out 0x63, it passes MixColumns unchanged and goes into the round keys. */
+#define ENC_ROUND(b, k)   V_XOR(vperm_mix(V_SHUF(SUB_ENC(b), TAB(VP_SR))), (k))
+#define ENC_LAST(b, k)    V_XOR(V_SHUF(SUB_ENC(b), TAB(VP_SR)), (k))
+#define DEC_ROUND(b, k)   V_XOR(vperm_inv_mix(V_SHUF(SUB_DEC(b), TAB(VP_ISR))), (k))
+#define DEC_LAST(b, k)    V_XOR(V_SHUF(SUB_DEC(b), TAB(VP_ISR)), (k))
+
+/**
+ * @brief           Computes SubWord(word) with the vector S-box.
+ * @param word      Key schedule word.
+ * @return uint32_t Substituted word.
+ */
+VPERM_FN static uint32_t vperm_sub_word(uint32_t word)
+{
+  return V_LANE0(SUB_ENC(V_DUP32(word))) ^ 0x63636363UL;
+}
+
+/**
+ * @brief       Expands the key schedules with the vector S-box, so the key does not
+ *              leak through the cache either.
+ * @param ctx   Pointer to key context, Nk, Nr and usage already set.
+ * @param key   Pointer to key buffer.
+ */
+VPERM_FN static void vperm_setkey(uaes_ctx_t *ctx, uint8_t *key)
+{
+  static const uint8_t rcon[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+  const size_t Nk = ctx->Nk, Nr = ctx->Nr, Ns = uAES_NB * (Nr + 1UL);
+  uint32_t *w = ctx->kschd;
+  uint32_t tmp = 0;
+
+  for(size_t idx = 0; idx < Nk; idx++)
+  {
+    w[idx] = ( uint32_t )( key[4*idx] | key[4*idx + 1] << 8 | key[4*idx + 2] << 16 | (uint32_t)key[4*idx + 3] << 24 );
+  }
+  for(size_t idx = Nk; idx < Ns; idx++)
+  {
+    tmp = w[idx - 1];
+    if( 0 == ( idx % Nk ) )
+    {
+      tmp = vperm_sub_word(( tmp >> 8 ) | ( tmp << 24 )) ^ rcon[( idx / Nk ) - 1];
+    }
+    else if( ( Nk > 6 ) && ( 4 == ( idx % Nk ) ) )
+    {
+      tmp = vperm_sub_word(tmp);
+    }
+    w[idx] = w[idx - Nk] ^ tmp;
+  }
+
+  if(0 != (ctx->usage & uAES_CTX_DECRYPT))
+  {
+    STORE(&ctx->dkschd[0], LOAD(&w[4*Nr]));
+    for(size_t round = 1; round < Nr; round++)
+    {
+      STORE(&ctx->dkschd[4*round], vperm_inv_mix(LOAD(&w[4*(Nr - round)])));
+    }
+    STORE(&ctx->dkschd[4*Nr], LOAD(&w[0]));
+  }
+  return;
+}
+
+/**
+ * @brief       Loads the encryption round keys, 0x63 added to all but the first.
+ * @param rk    Round keys, Nr + 1.
+ * @param ctx   Pointer to key context.
+ */
+VPERM_INLINE void vperm_enc_keys(vperm_t *rk, const uaes_ctx_t *ctx)
+{
+  rk[0] = LOAD(&ctx->kschd[0]);
+  for(size_t round = 1; round <= ctx->Nr; round++)
+  {
+    rk[round] = V_XOR(LOAD(&ctx->kschd[4*round]), V_DUP8(0x63));
+  }
+  return;
+}
+
+VPERM_INLINE void vperm_dec_keys(vperm_t *rk, const uaes_ctx_t *ctx)
+{
+  for(size_t round = 0; round <= ctx->Nr; round++)
+  {
+    rk[round] = LOAD(&ctx->dkschd[4*round]);
+  }
+  return;
+}
+
+VPERM_FN static void vperm_encrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks)
+{
+  const size_t Nr = ctx->Nr;
+  vperm_t rk[uAES_MAX_KSCHD_SIZE / 4];
+  vperm_t b0, b1, b2, b3;
+  size_t round = 0;
+
+  vperm_enc_keys(rk, ctx);
+
+  /* Four independent blocks hide the latency of the shuffle chains. */
+  for(; nblocks >= 4; nblocks -= 4, in += 64, out += 64)
+  {
+    b0 = V_XOR(LOAD(in),      rk[0]);
+    b1 = V_XOR(LOAD(in + 16), rk[0]);
+    b2 = V_XOR(LOAD(in + 32), rk[0]);
+    b3 = V_XOR(LOAD(in + 48), rk[0]);
+    for(round = 1; round < Nr; round++)
+    {
+      b0 = ENC_ROUND(b0, rk[round]);
+      b1 = ENC_ROUND(b1, rk[round]);
+      b2 = ENC_ROUND(b2, rk[round]);
+      b3 = ENC_ROUND(b3, rk[round]);
+    }
+    STORE(out,      ENC_LAST(b0, rk[Nr]));
+    STORE(out + 16, ENC_LAST(b1, rk[Nr]));
+    STORE(out + 32, ENC_LAST(b2, rk[Nr]));
+    STORE(out + 48, ENC_LAST(b3, rk[Nr]));
+  }
+  for(; nblocks > 0; nblocks--, in += 16, out += 16)
+  {
+    b0 = V_XOR(LOAD(in), rk[0]);
+    for(round = 1; round < Nr; round++)
+    {
+      b0 = ENC_ROUND(b0, rk[round]);
+    }
+    STORE(out, ENC_LAST(b0, rk[Nr]));
+  }
+  return;
+}
+
+VPERM_FN static void vperm_decrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks)
+{
+  const size_t Nr = ctx->Nr;
+  vperm_t rk[uAES_MAX_KSCHD_SIZE / 4];
+  vperm_t b0, b1, b2, b3;
+  size_t round = 0;
+
+  vperm_dec_keys(rk, ctx);
+
+  for(; nblocks >= 4; nblocks -= 4, in += 64, out += 64)
+  {
+    b0 = V_XOR(LOAD(in),      rk[0]);
+    b1 = V_XOR(LOAD(in + 16), rk[0]);
+    b2 = V_XOR(LOAD(in + 32), rk[0]);
+    b3 = V_XOR(LOAD(in + 48), rk[0]);
+    for(round = 1; round < Nr; round++)
+    {
+      b0 = DEC_ROUND(b0, rk[round]);
+      b1 = DEC_ROUND(b1, rk[round]);
+      b2 = DEC_ROUND(b2, rk[round]);
+      b3 = DEC_ROUND(b3, rk[round]);
+    }
+    STORE(out,      DEC_LAST(b0, rk[Nr]));
+    STORE(out + 16, DEC_LAST(b1, rk[Nr]));
+    STORE(out + 32, DEC_LAST(b2, rk[Nr]));
+    STORE(out + 48, DEC_LAST(b3, rk[Nr]));
+  }
+  for(; nblocks > 0; nblocks--, in += 16, out += 16)
+  {
+    b0 = V_XOR(LOAD(in), rk[0]);
+    for(round = 1; round < Nr; round++)
+    {
+      b0 = DEC_ROUND(b0, rk[round]);
+    }
+    STORE(out, DEC_LAST(b0, rk[Nr]));
+  }
+  return;
+}
+
+VPERM_FN static void vperm_cbc_encrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *iv)
+{
+  const size_t Nr = ctx->Nr;
+  vperm_t rk[uAES_MAX_KSCHD_SIZE / 4];
+  vperm_t chain = LOAD(iv);
+  size_t round = 0;
+
+  vperm_enc_keys(rk, ctx);
+
+  for(; nblocks > 0; nblocks--, in += 16, out += 16)
+  {
+    chain = V_XOR(V_XOR(LOAD(in), chain), rk[0]);
+    for(round = 1; round < Nr; round++)
+    {
+      chain = ENC_ROUND(chain, rk[round]);
+    }
+    chain = ENC_LAST(chain, rk[Nr]);
+    STORE(out, chain);
+  }
+  STORE(iv, chain);
+  return;
+}
+
+VPERM_FN static void vperm_cbc_decrypt(const uaes_ctx_t *ctx, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *iv)
+{
+  const size_t Nr = ctx->Nr;
+  vperm_t rk[uAES_MAX_KSCHD_SIZE / 4];
+  vperm_t chain = LOAD(iv);
+  vperm_t c0, c1, c2, c3, b0, b1, b2, b3;
+  size_t round = 0;
+
+  vperm_dec_keys(rk, ctx);
+
+  /* Ciphertexts are loaded before any store, so in-place buffers are safe. */
+  for(; nblocks >= 4; nblocks -= 4, in += 64, out += 64)
+  {
+    c0 = LOAD(in);
+    c1 = LOAD(in + 16);
+    c2 = LOAD(in + 32);
+    c3 = LOAD(in + 48);
+    b0 = V_XOR(c0, rk[0]);
+    b1 = V_XOR(c1, rk[0]);
+    b2 = V_XOR(c2, rk[0]);
+    b3 = V_XOR(c3, rk[0]);
+    for(round = 1; round < Nr; round++)
+    {
+      b0 = DEC_ROUND(b0, rk[round]);
+      b1 = DEC_ROUND(b1, rk[round]);
+      b2 = DEC_ROUND(b2, rk[round]);
+      b3 = DEC_ROUND(b3, rk[round]);
+    }
+    STORE(out,      V_XOR(DEC_LAST(b0, rk[Nr]), chain));
+    STORE(out + 16, V_XOR(DEC_LAST(b1, rk[Nr]), c0));
+    STORE(out + 32, V_XOR(DEC_LAST(b2, rk[Nr]), c1));
+    STORE(out + 48, V_XOR(DEC_LAST(b3, rk[Nr]), c2));
+    chain = c3;
+  }
+  for(; nblocks > 0; nblocks--, in += 16, out += 16)
+  {
+    c0 = LOAD(in);
+    b0 = V_XOR(c0, rk[0]);
+    for(round = 1; round < Nr; round++)
+    {
+      b0 = DEC_ROUND(b0, rk[round]);
+    }
+    STORE(out, V_XOR(DEC_LAST(b0, rk[Nr]), chain));
+    chain = c0;
+  }
+  STORE(iv, chain);
+  return;
+}
+
+const uaes_engine_t uaes_engine_vperm =
+{
+  .name         = "vperm",
+  .id           = uAES_ENGINE_VPERM,
+  .available    = vperm_available,
+  .setkey       = vperm_setkey,
+  .encrypt      = vperm_encrypt,
+  .decrypt      = vperm_decrypt,
+  .cbc_encrypt  = vperm_cbc_encrypt,
+  .cbc_decrypt  = vperm_cbc_decrypt,
+  .cbc_encrypt_lanes = NULL,
+  .caps         = uAES_CAPS_SOFTWARE(uAES_CAP_CONST_TIME),
+};
+
+#endif /*uAES_CFG_VPERM*/
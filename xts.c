@@ -0,0 +1,434 @@
+/**
+ * @file      xts.c
+ * @author    Antonio V. G. Bassi (antoniovitor.gb@gmail.com)
+ * @brief     XTS-AES (IEEE 1619) with ciphertext stealing, single data units and runs of sectors.
+ * @version   0.0
+ * @date      2026-10-14 YYYY-MM-DD
+ * @note      tab = 2 spaces!
+ *
+ *  Copyright (C) 2022, Antonio Vitor Grossi Bassi
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "uaes.h"
+#include "engine.h"
+
+#if uAES_CFG_XTS
+
+/*
+ * Each data unit (sector) is encrypted under the data key with its own tweak,
+ * T = E(K2, i) for the unit number i, and T is multiplied by alpha in
+ * GF(2^128) from one block to the next. A batch of blocks is whitened with
+ * its tweaks, run through the engine in one call and whitened again. A run of
+ * sectors fills every batch with blocks of up to uAES_CFG_XTS_BATCH sectors
+ * side by side, so small sectors still keep the engine pipelines full and the
+ * tweak blocks of the group are encrypted in one call too. A unit that is not
+ * a multiple of 16 bytes ends with ciphertext stealing.
+ */
+
+/* Little-endian 64-bit access, compilers turn both into a single load or store. */
+static uint64_t xts_load64(const uint8_t *p)
+{
+  return (uint64_t)p[0]         | ( (uint64_t)p[1] << 8 )  | ( (uint64_t)p[2] << 16 ) | ( (uint64_t)p[3] << 24 ) |
+         ( (uint64_t)p[4] << 32 ) | ( (uint64_t)p[5] << 40 ) | ( (uint64_t)p[6] << 48 ) | ( (uint64_t)p[7] << 56 );
+}
+
+static void xts_store64(uint8_t *p, uint64_t v)
+{
+  p[0] = (uint8_t)v;          p[1] = (uint8_t)( v >> 8 );  p[2] = (uint8_t)( v >> 16 ); p[3] = (uint8_t)( v >> 24 );
+  p[4] = (uint8_t)( v >> 32 ); p[5] = (uint8_t)( v >> 40 ); p[6] = (uint8_t)( v >> 48 ); p[7] = (uint8_t)( v >> 56 );
+  return;
+}
+
+/* Multiplies the tweak hi:lo by alpha in GF(2^128) without branching on it. */
+#define XTS_MUL_ALPHA(lo, hi) do {                                    \
+  const uint64_t carry__ = 0ULL - ( (hi) >> 63 );                     \
+  (hi) = ( (hi) << 1 ) | ( (lo) >> 63 );                              \
+  (lo) = ( (lo) << 1 ) ^ ( carry__ & 0x87ULL );                       \
+} while(0)
+
+/**
+ * @brief     Multiplies a tweak by alpha.
+ * @param t   16-byte tweak, little-endian, updated.
+ */
+static void xts_mul_alpha(uint8_t *t)
+{
+  uint64_t lo = xts_load64(t), hi = xts_load64(&t[8]);
+
+  XTS_MUL_ALPHA(lo, hi);
+  xts_store64(t, lo);
+  xts_store64(&t[8], hi);
+  return;
+}
+
+/* dst = a ^ b on 16 bytes, any alignment, the pointers may be equal. */
+static void xts_xor(uint8_t *dst, const uint8_t *a, const uint8_t *b)
+{
+  uint64_t x[2], y[2];
+
+  memcpy(x, a, sizeof(x));
+  memcpy(y, b, sizeof(y));
+  x[0] ^= y[0];
+  x[1] ^= y[1];
+  memcpy(dst, x, sizeof(x));
+  return;
+}
+
+/**
+ * @brief         Runs one block through the cipher between two whitenings with t.
+ * @param ctx     Pointer to data key context.
+ * @param blk     16-byte block, processed in place.
+ * @param t       16-byte tweak.
+ * @param decrypt [0] encrypt, [1] decrypt.
+ */
+static void xts_block(const uaes_ctx_t *ctx, uint8_t *blk, const uint8_t *t, int decrypt)
+{
+  xts_xor(blk, blk, t);
+  if(decrypt)
+  {
+    ctx->engine->decrypt(ctx, blk, blk, 1UL);
+  }
+  else
+  {
+    ctx->engine->encrypt(ctx, blk, blk, 1UL);
+  }
+  xts_xor(blk, blk, t);
+  return;
+}
+
+/**
+ * @brief         Ciphertext stealing over the last full block of a unit and the
+ *                r bytes that follow it.
+ * @param ctx     Pointer to data key context.
+ * @param p       Pointer to the last full block.
+ * @param r       Trailing bytes, 1 to 15.
+ * @param t       Tweak of the last full block.
+ * @param decrypt [0] encrypt, [1] decrypt.
+ */
+static void xts_steal(const uaes_ctx_t *ctx, uint8_t *p, size_t r, const uint8_t *t, int decrypt)
+{
+  uint8_t tm[uAES_BLOCK_SIZE];
+  uint8_t cc[uAES_BLOCK_SIZE];
+
+  /* Encryption uses T(m-1) then T(m), decryption the other way round. */
+  memcpy(tm, t, uAES_BLOCK_SIZE);
+  xts_mul_alpha(tm);
+  memcpy(cc, p, uAES_BLOCK_SIZE);
+  xts_block(ctx, cc, decrypt ? (tm) : (t), decrypt);
+  memcpy(p, &p[uAES_BLOCK_SIZE], r);
+  memcpy(&p[r], &cc[r], uAES_BLOCK_SIZE - r);
+  memcpy(&p[uAES_BLOCK_SIZE], cc, r);
+  xts_block(ctx, p, decrypt ? (t) : (tm), decrypt);
+
+  uaes_wipe(tm, sizeof(tm));
+  uaes_wipe(cc, sizeof(cc));
+  return;
+}
+
+/**
+ * @brief           Processes nunits data units of unit_size bytes laid out back to back,
+ *                  their blocks interleaved in each engine call.
+ * @param ctx       Pointer to data key context.
+ * @param buf       Pointer to the first unit, processed in place.
+ * @param unit_size Unit size, at least 16 bytes.
+ * @param nunits    Number of units, 1 to uAES_CFG_XTS_BATCH.
+ * @param t         Encrypted tweak of each unit, clobbered.
+ * @param decrypt   [0] encrypt, [1] decrypt.
+ */
+static void xts_units(const uaes_ctx_t *ctx,
+                      uint8_t *buf,
+                      size_t unit_size,
+                      size_t nunits,
+                      uint8_t (*t)[16],
+                      int decrypt)
+{
+  uint8_t blk[uAES_BLOCK_SIZE * uAES_CFG_XTS_BATCH];
+  uint64_t tw[2 * uAES_CFG_XTS_BATCH];
+  uint64_t lo[uAES_CFG_XTS_BATCH], hi[uAES_CFG_XTS_BATCH];
+  const size_t tail = unit_size & uAES_BLOCK_ALIGN_MASK;
+  const size_t nfull = ( unit_size / uAES_BLOCK_SIZE ) - ( ( 0 != tail ) ? (1UL) : (0UL) );
+  const size_t per = uAES_CFG_XTS_BATCH / nunits;
+  size_t run = 0, n = 0;
+  uint8_t *p = NULL;
+
+  /* The tweaks stay in registers as two 64-bit halves, bytes are only formed at the ends. */
+  for(size_t unit = 0; unit < nunits; unit++)
+  {
+    lo[unit] = xts_load64(t[unit]);
+    hi[unit] = xts_load64(&t[unit][8]);
+  }
+  for(size_t pos = 0; pos < nfull; pos += run)
+  {
+    run = ( (nfull - pos) < per ) ? (nfull - pos) : (per);
+    n = 0;
+    for(size_t unit = 0; unit < nunits; unit++)
+    {
+      for(size_t idx = 0; idx < run; idx++, n++)
+      {
+        p = &buf[(unit * unit_size) + (uAES_BLOCK_SIZE * (pos + idx))];
+        tw[2*n]     = lo[unit];
+        tw[2*n + 1] = hi[unit];
+        xts_store64(&blk[uAES_BLOCK_SIZE * n],     xts_load64(p)     ^ lo[unit]);
+        xts_store64(&blk[uAES_BLOCK_SIZE * n + 8], xts_load64(&p[8]) ^ hi[unit]);
+        XTS_MUL_ALPHA(lo[unit], hi[unit]);
+      }
+    }
+    if(decrypt)
+    {
+      ctx->engine->decrypt(ctx, blk, blk, n);
+    }
+    else
+    {
+      ctx->engine->encrypt(ctx, blk, blk, n);
+    }
+    n = 0;
+    for(size_t unit = 0; unit < nunits; unit++)
+    {
+      for(size_t idx = 0; idx < run; idx++, n++)
+      {
+        p = &buf[(unit * unit_size) + (uAES_BLOCK_SIZE * (pos + idx))];
+        xts_store64(p,     xts_load64(&blk[uAES_BLOCK_SIZE * n])     ^ tw[2*n]);
+        xts_store64(&p[8], xts_load64(&blk[uAES_BLOCK_SIZE * n + 8]) ^ tw[2*n + 1]);
+      }
+    }
+  }
+  if(0 != tail)
+  {
+    for(size_t unit = 0; unit < nunits; unit++)
+    {
+      xts_store64(t[unit], lo[unit]);
+      xts_store64(&t[unit][8], hi[unit]);
+      xts_steal(ctx, &buf[(unit * unit_size) + (uAES_BLOCK_SIZE * nfull)], tail, t[unit], decrypt);
+    }
+  }
+
+  uaes_wipe(blk, sizeof(blk));
+  uaes_wipe(tw, sizeof(tw));
+  uaes_wipe(lo, sizeof(lo));
+  uaes_wipe(hi, sizeof(hi));
+  return;
+}
+
+/**
+ * @brief             Processes consecutive sectors, the arguments are checked by the caller.
+ * @param ctx         Pointer to data key context.
+ * @param tweak_ctx   Pointer to tweak key context.
+ * @param buf         Pointer to the first sector, processed in place.
+ * @param nsectors    Number of sectors.
+ * @param sector_size Sector size, at least 16 bytes.
+ * @param sector      Number of sector 0 of the whole call.
+ * @param first       Index of the first sector of buf within the call, sector n of the
+ *                    call has the 128-bit little-endian tweak value sector + n.
+ * @param decrypt     [0] encrypt, [1] decrypt.
+ */
+void uaes_xts_sectors(const uaes_ctx_t *ctx,
+                      const uaes_ctx_t *tweak_ctx,
+                      uint8_t *buf,
+                      size_t nsectors,
+                      size_t sector_size,
+                      uint64_t sector,
+                      uint64_t first,
+                      int decrypt)
+{
+  uint8_t t[uAES_CFG_XTS_BATCH][16];
+  uint64_t lo = 0;
+  size_t group = 0;
+  uAES_PROF_START(t0);
+
+  for(; nsectors > 0; nsectors -= group, buf += group * sector_size, first += group)
+  {
+    group = ( nsectors < uAES_CFG_XTS_BATCH ) ? (nsectors) : (uAES_CFG_XTS_BATCH);
+    uaes_wipe(t, sizeof(t));
+    for(size_t unit = 0; unit < group; unit++)
+    {
+      /* The sum wraps at most once, the carry goes into byte 8. */
+      lo = sector + first + unit;
+      xts_store64(t[unit], lo);
+      t[unit][8] = ( lo < sector ) ? (1U) : (0U);
+    }
+    tweak_ctx->engine->encrypt(tweak_ctx, t[0], t[0], group);
+    xts_units(ctx, buf, sector_size, group, t, decrypt);
+  }
+  uaes_wipe(t, sizeof(t));
+  uAES_PROF_STOP(ctx, uAES_PROF_XTS, t0);
+  return;
+}
+
+/**
+ * @brief         Checks the contexts of an XTS call.
+ * @return int    [1] if usable, [0] otherwise.
+ */
+static int xts_ctx_ok(const uaes_ctx_t *ctx, const uaes_ctx_t *tweak_ctx, int decrypt)
+{
+  return ( (NULL != ctx)                                                                      &&
+           (NULL != tweak_ctx)                                                                &&
+           (0 != (ctx->usage & ( decrypt ? (uAES_CTX_DECRYPT) : (uAES_CTX_ENCRYPT) )))        &&
+           (0 != (tweak_ctx->usage & uAES_CTX_ENCRYPT))                                       &&
+           (ctx->aes_length == tweak_ctx->aes_length) ) ? (1) : (0);
+}
+
+/**
+ * @brief           Processes one data unit in place.
+ * @return int      [0] if sucessful, [-1] on failure.
+ */
+static int xts_unit(const uaes_ctx_t *ctx,
+                    const uaes_ctx_t *tweak_ctx,
+                    uint8_t *buf,
+                    size_t size,
+                    const uint8_t *tweak,
+                    int decrypt)
+{
+  int err = -1;
+  uint8_t t[1][16];
+  uAES_PROF_START(t0);
+
+  if(xts_ctx_ok(ctx, tweak_ctx, decrypt)      &&
+     (NULL != buf)                            &&
+     (NULL != tweak)                          &&
+     (uAES_BLOCK_SIZE <= size)                &&
+     (uAES_MAX_INPUT_SIZE >= size))
+  {
+    tweak_ctx->engine->encrypt(tweak_ctx, t[0], tweak, 1UL);
+    xts_units(ctx, buf, size, 1UL, t, decrypt);
+    uaes_wipe(t, sizeof(t));
+    uAES_PROF_STOP(ctx, uAES_PROF_XTS, t0);
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief             Processes a run of equally sized sectors in place, spread over the
+ *                    worker pool when it is running (see uaes_pool_start()).
+ * @return int        [0] if sucessful, [-1] on failure.
+ */
+static int xts_run(const uaes_ctx_t *ctx,
+                   const uaes_ctx_t *tweak_ctx,
+                   uint8_t *buf,
+                   size_t size,
+                   size_t sector_size,
+                   uint64_t sector,
+                   int decrypt)
+{
+  int err = -1;
+
+  if(xts_ctx_ok(ctx, tweak_ctx, decrypt)          &&
+     (NULL != buf)                                &&
+     (uAES_BLOCK_SIZE <= sector_size)             &&
+     (0 < size)                                   &&
+     (uAES_MAX_INPUT_SIZE >= size)                &&
+     (0 == (size % sector_size)))
+  {
+    if(0 != uaes_pool_xts(ctx, tweak_ctx, buf, size, sector_size, sector, decrypt))
+    {
+      uaes_xts_sectors(ctx, tweak_ctx, buf, size / sector_size, sector_size, sector, 0ULL, decrypt);
+    }
+    err = 0;
+  }
+
+  return err;
+}
+
+/**
+ * @brief             Performs XTS-AES encryption of one data unit in place. The XTS key
+ *                    is two keys of the same length, one context for each.
+ * @param ctx         Pointer to data key (Key1) context, uAES_CTX_ENCRYPT.
+ * @param tweak_ctx   Pointer to tweak key (Key2) context, uAES_CTX_ENCRYPT. Must not
+ *                    hold the same key as ctx.
+ * @param buf         Pointer to data buffer.
+ * @param size        Data unit size, at least 16 bytes. A trailing partial block is
+ *                    handled by ciphertext stealing.
+ * @param tweak       16-byte tweak value before encryption, the data unit sequence
+ *                    number as a little-endian integer for IEEE 1619.
+ * @return int        [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_xts_encryption(const uaes_ctx_t *ctx,
+                            const uaes_ctx_t *tweak_ctx,
+                            uint8_t *buf,
+                            size_t size,
+                            const uint8_t *tweak)
+{
+  return xts_unit(ctx, tweak_ctx, buf, size, tweak, 0);
+}
+
+/**
+ * @brief             Performs XTS-AES decryption of one data unit in place.
+ * @param ctx         Pointer to data key (Key1) context, uAES_CTX_DECRYPT.
+ * @param tweak_ctx   Pointer to tweak key (Key2) context, uAES_CTX_ENCRYPT.
+ * @param buf         Pointer to data buffer.
+ * @param size        Data unit size, at least 16 bytes.
+ * @param tweak       16-byte tweak value before encryption.
+ * @return int        [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_xts_decryption(const uaes_ctx_t *ctx,
+                            const uaes_ctx_t *tweak_ctx,
+                            uint8_t *buf,
+                            size_t size,
+                            const uint8_t *tweak)
+{
+  return xts_unit(ctx, tweak_ctx, buf, size, tweak, 1);
+}
+
+/**
+ * @brief             Performs XTS-AES encryption of consecutive sectors in place, sector
+ *                    n of the buffer uses the tweak value sector + n (128-bit little-endian).
+ *                    Blocks of neighbouring sectors share engine calls and large buffers
+ *                    are spread over the worker pool when it is running.
+ * @param ctx         Pointer to data key (Key1) context, uAES_CTX_ENCRYPT.
+ * @param tweak_ctx   Pointer to tweak key (Key2) context, uAES_CTX_ENCRYPT.
+ * @param buf         Pointer to data buffer.
+ * @param size        Buffer size, a multiple of sector_size.
+ * @param sector_size Sector size, at least 16 bytes, any multiple of 16 bytes plus 0 to
+ *                    15 stolen bytes.
+ * @param sector      Number of the first sector.
+ * @return int        [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_xts_encryption_sectors(const uaes_ctx_t *ctx,
+                                    const uaes_ctx_t *tweak_ctx,
+                                    uint8_t *buf,
+                                    size_t size,
+                                    size_t sector_size,
+                                    uint64_t sector)
+{
+  return xts_run(ctx, tweak_ctx, buf, size, sector_size, sector, 0);
+}
+
+/**
+ * @brief             Performs XTS-AES decryption of consecutive sectors in place.
+ * @param ctx         Pointer to data key (Key1) context, uAES_CTX_DECRYPT.
+ * @param tweak_ctx   Pointer to tweak key (Key2) context, uAES_CTX_ENCRYPT.
+ * @param buf         Pointer to data buffer.
+ * @param size        Buffer size, a multiple of sector_size.
+ * @param sector_size Sector size, at least 16 bytes.
+ * @param sector      Number of the first sector.
+ * @return int        [0] if sucessful, [-1] on failure.
+ */
+int uaes_ctx_xts_decryption_sectors(const uaes_ctx_t *ctx,
+                                    const uaes_ctx_t *tweak_ctx,
+                                    uint8_t *buf,
+                                    size_t size,
+                                    size_t sector_size,
+                                    uint64_t sector)
+{
+  return xts_run(ctx, tweak_ctx, buf, size, sector_size, sector, 1);
+}
+
+#endif /*uAES_CFG_XTS*/